@@ -52,6 +52,12 @@ enum {
 	/** Maximum active async calls per phone */
 	IPC_MAX_ASYNC_CALLS = 64,
 
+	/**
+	 * Maximum number of requests sent and of calls or answers
+	 * received by one SYS_IPC_BATCH invocation.
+	 */
+	IPC_BATCH_MAX = 16,
+
 	/**
 	 * Maximum buffer size allowed for IPC_M_DATA_WRITE and
 	 * IPC_M_DATA_READ requests.
@@ -122,6 +128,18 @@ typedef struct {
 	cap_call_handle_t cap_handle;
 } ipc_data_t;
 
+/** Asynchronous request submitted by SYS_IPC_BATCH */
+typedef struct {
+	/** Phone to send the request over */
+	cap_phone_handle_t phone;
+	/** Interface, method and payload of the request */
+	sysarg_t args[IPC_CALL_LEN];
+	/** User-defined label associated with the answer */
+	sysarg_t label;
+	/** Outcome of the submission, filled in by the kernel */
+	errno_t rc;
+} ipc_batch_call_t;
+
 /* Functions for manipulating calling data */
 
 static inline void ipc_set_retval(ipc_data_t *data, errno_t retval)
@@ -214,6 +214,24 @@ enum {
 	 * - other arguments are specific to the debug method
 	 */
 	IPC_M_DEBUG,
+
+	/** Receive a capability to a wait queue of the recipient.
+	 *
+	 * The sender and the recipient can then use the wait queue to
+	 * signal each other, e.g. about progress in shared memory.
+	 *
+	 * Sender:
+	 *  - uspace: arg1 .. <custom>
+	 *            arg2 .. <custom>
+	 *            arg3 .. <custom>
+	 *            arg4 .. <custom>
+	 *  - kernel: arg5 .. new sender's waitq capability
+	 *
+	 * Recipient:
+	 *  - uspace: arg1 .. recipient's waitq capability
+	 *
+	 */
+	IPC_M_WAITQ_SHARE_IN,
 };
 
 /** Last system IPC method */
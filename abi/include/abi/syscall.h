@@ -111,6 +111,8 @@ typedef enum {
 
 	SYS_KLOG,
 	SYS_KIO_READ,
+
+	SYS_IPC_BATCH,
 } syscall_t;
 
 #endif
@@ -49,6 +49,7 @@ enum {
 	/** Maximum name sizes */
 	TASK_NAME_BUFLEN = 64,
 	EXC_NAME_BUFLEN  = 20,
+	SLAB_NAME_BUFLEN = 20,
 };
 
 /** Item value type
@@ -66,11 +67,13 @@ typedef enum {
  *
  */
 typedef struct {
-	unsigned int id;         /**< CPU ID as stored by kernel */
-	bool active;             /**< CPU is activate */
-	uint16_t frequency_mhz;  /**< Frequency in MHz */
-	uint64_t idle_cycles;    /**< Number of idle cycles */
-	uint64_t busy_cycles;    /**< Number of busy cycles */
+	unsigned int id;           /**< CPU ID as stored by kernel */
+	bool active;               /**< CPU is activate */
+	uint16_t frequency_mhz;    /**< Frequency in MHz */
+	uint64_t idle_cycles;      /**< Number of idle cycles */
+	uint64_t busy_cycles;      /**< Number of busy cycles */
+	uint64_t steal_attempts;   /**< Work-stealing victims probed */
+	uint64_t steal_successes;  /**< Threads stolen from other CPUs */
 } stats_cpu_t;
 
 /** Physical memory statistics
@@ -144,6 +147,21 @@ typedef struct {
 	uint64_t count;              /**< Number of handled exceptions */
 } stats_exc_t;
 
+/** Statistics about a single kernel slab cache
+ *
+ */
+typedef struct {
+	char name[SLAB_NAME_BUFLEN];  /**< Cache name */
+	uint64_t size;                /**< Object size (bytes) */
+	uint64_t allocated_slabs;     /**< Number of allocated slabs */
+	uint64_t allocated_objs;      /**< Number of allocated objects */
+	uint64_t cached_objs;         /**< Objects cached in magazines */
+	uint64_t mag_size;            /**< Current magazine size */
+	uint64_t mag_hits;            /**< Allocations served by magazines */
+	uint64_t mag_misses;          /**< Allocations served by slabs */
+	uint64_t depot_contention;    /**< Contended magazine depot locks */
+} stats_slab_t;
+
 /** Load fixed-point value */
 typedef uint32_t load_t;
 
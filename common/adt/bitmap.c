@@ -42,10 +42,14 @@
 #include <align.h>
 #include <assert.h>
 #include <macros.h>
+#include <mem.h>
 
 #define ALL_ONES    0xff
 #define ALL_ZEROES  0x00
 
+/** Number of bits examined at once when scanning the bitmap. */
+#define BITMAP_WORD  (sizeof(uint64_t) * BITMAP_ELEMENT)
+
 /** Unchecked version of bitmap_get()
  *
  * This version of bitmap_get() does not do any boundary checks.
@@ -236,6 +240,190 @@ void bitmap_copy(bitmap_t *dst, bitmap_t *src, size_t count)
 	}
 }
 
+/** Find the lowest set bit in a byte.
+ *
+ * @param byte Non-zero byte.
+ *
+ * @return Index of the lowest set bit.
+ *
+ */
+static unsigned int bitmap_byte_ctz(uint8_t byte)
+{
+	unsigned int n = 0;
+
+	assert(byte != 0);
+
+	if ((byte & 0x0f) == 0) {
+		n += 4;
+		byte >>= 4;
+	}
+
+	if ((byte & 0x03) == 0) {
+		n += 2;
+		byte >>= 2;
+	}
+
+	if ((byte & 0x01) == 0)
+		n++;
+
+	return n;
+}
+
+/** Count set bits in a word.
+ *
+ * @param word Word to examine.
+ *
+ * @return Number of set bits in the word.
+ *
+ */
+static unsigned int bitmap_word_popcount(uint64_t word)
+{
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) +
+	    ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	word += word >> 8;
+	word += word >> 16;
+	word += word >> 32;
+
+	return word & 0x7f;
+}
+
+/** Load a word from the bitmap.
+ *
+ * @param bitmap Bitmap structure.
+ * @param byte   Index of the first byte of the word.
+ *
+ * @return Word holding the bitmap bytes in memory order.
+ *
+ */
+static uint64_t bitmap_word_get(bitmap_t *bitmap, size_t byte)
+{
+	uint64_t word;
+
+	memcpy(&word, &bitmap->bits[byte], sizeof(word));
+	return word;
+}
+
+/** Find the first bit which differs from a pattern.
+ *
+ * Whole words matching the pattern are skipped at once, the first
+ * differing bit is then located using its byte.
+ *
+ * @param bitmap  Bitmap structure.
+ * @param start   First bit to examine.
+ * @param end     Bit following the last bit to examine.
+ * @param pattern ALL_ONES to find a zero bit, ALL_ZEROES to find
+ *                a set bit.
+ *
+ * @return Index of the bit found or end if there is none.
+ *
+ */
+static size_t bitmap_find_bit(bitmap_t *bitmap, size_t start, size_t end,
+    uint8_t pattern)
+{
+	uint64_t word_pattern = pattern ? UINT64_MAX : 0;
+	size_t i = start;
+
+	assert(end <= bitmap->elements);
+
+	while (i < end) {
+		size_t byte = i / BITMAP_ELEMENT;
+
+		if ((i & BITMAP_REMAINER) == 0 &&
+		    (byte % sizeof(uint64_t)) == 0) {
+			/* Skip aligned words which match the pattern. */
+			while (i + BITMAP_WORD <= end &&
+			    bitmap_word_get(bitmap, byte) == word_pattern) {
+				i += BITMAP_WORD;
+				byte += sizeof(uint64_t);
+			}
+
+			if (i >= end)
+				break;
+		}
+
+		uint8_t diff = (bitmap->bits[byte] ^ pattern) &
+		    (ALL_ONES << (i & BITMAP_REMAINER));
+
+		if (diff != 0) {
+			i = byte * BITMAP_ELEMENT + bitmap_byte_ctz(diff);
+			return min(i, end);
+		}
+
+		i = (byte + 1) * BITMAP_ELEMENT;
+	}
+
+	return end;
+}
+
+/** Find the first zero bit in a range.
+ *
+ * @param bitmap Bitmap structure.
+ * @param start  First bit to examine.
+ * @param end    Bit following the last bit to examine.
+ *
+ * @return Index of the first zero bit or end if there is none.
+ *
+ */
+size_t bitmap_find_zero(bitmap_t *bitmap, size_t start, size_t end)
+{
+	return bitmap_find_bit(bitmap, start, end, ALL_ONES);
+}
+
+/** Find the first set bit in a range.
+ *
+ * @param bitmap Bitmap structure.
+ * @param start  First bit to examine.
+ * @param end    Bit following the last bit to examine.
+ *
+ * @return Index of the first set bit or end if there is none.
+ *
+ */
+size_t bitmap_find_one(bitmap_t *bitmap, size_t start, size_t end)
+{
+	return bitmap_find_bit(bitmap, start, end, ALL_ZEROES);
+}
+
+/** Count zero bits in a range.
+ *
+ * @param bitmap Bitmap structure.
+ * @param start  Starting bit.
+ * @param count  Number of bits to examine.
+ *
+ * @return Number of zero bits in the range.
+ *
+ */
+size_t bitmap_count_zeroes(bitmap_t *bitmap, size_t start, size_t count)
+{
+	size_t end = start + count;
+	size_t ones = 0;
+	size_t i = start;
+
+	assert(end <= bitmap->elements);
+
+	/* Leading bits up to the word boundary */
+	while (i < end && (i % BITMAP_WORD) != 0) {
+		ones += bitmap_get_fast(bitmap, i);
+		i++;
+	}
+
+	/* Whole words */
+	while (i + BITMAP_WORD <= end) {
+		ones += bitmap_word_popcount(bitmap_word_get(bitmap,
+		    i / BITMAP_ELEMENT));
+		i += BITMAP_WORD;
+	}
+
+	/* Trailing bits */
+	while (i < end) {
+		ones += bitmap_get_fast(bitmap, i);
+		i++;
+	}
+
+	return count - ones;
+}
+
 static int constraint_satisfy(size_t index, size_t base, size_t constraint)
 {
 	return (((base + index) & constraint) == 0);
@@ -86,6 +86,10 @@ extern bool bitmap_allocate_range(bitmap_t *, size_t, size_t, size_t, size_t,
     size_t *);
 extern void bitmap_copy(bitmap_t *, bitmap_t *, size_t);
 
+extern size_t bitmap_find_zero(bitmap_t *, size_t, size_t);
+extern size_t bitmap_find_one(bitmap_t *, size_t, size_t);
+extern size_t bitmap_count_zeroes(bitmap_t *, size_t, size_t);
+
 #endif
 
 /** @}
@@ -41,6 +41,8 @@
 #include <arch/cpu.h>
 #include <arch/context.h>
 #include <adt/list.h>
+#include <time/timewheel.h>
+#include <mm/frame_pcp.h>
 #include <arch.h>
 
 #define CPU                  (CURRENT->cpu)
@@ -77,6 +79,9 @@ typedef struct cpu_local {
 	context_t scheduler_context;
 
 	struct thread *prev_thread;
+
+	/** Seed for choosing work-stealing victims. */
+	unsigned int steal_seed;
 } cpu_local_t;
 
 /** CPU structure.
@@ -92,8 +97,11 @@ typedef struct cpu {
 	atomic_size_t nrdy;
 	runq_t rq[RQ_COUNT];
 
+	/** Caches of single frames, see mm/frame.c */
+	frame_pcp_t frame_pcp[FRAME_PCP_COUNT];
+
 	IRQ_SPINLOCK_DECLARE(timeoutlock);
-	list_t timeout_active_list;
+	timewheel_t timeout_wheel;
 
 	/**
 	 * Processor cycle accounting.
@@ -101,6 +109,12 @@ typedef struct cpu {
 	atomic_time_stat_t idle_cycles;
 	atomic_time_stat_t busy_cycles;
 
+	/**
+	 * Work-stealing accounting of the idle path.
+	 */
+	atomic_size_t steal_attempts;
+	atomic_size_t steal_successes;
+
 	/**
 	 * Processor ID assigned by kernel.
 	 */
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_FRAME_PCP_H_
+#define KERN_FRAME_PCP_H_
+
+#include <typedefs.h>
+#include <synch/spinlock.h>
+
+/** Capacity of a per-CPU cache of single frames */
+#define FRAME_PCP_SIZE  64
+
+/** Number of frames taken from the zones when a per-CPU cache is empty */
+#define FRAME_PCP_BATCH  16
+
+/** Number of freed frames collected before they are processed in a batch */
+#define FRAME_PCP_PENDING  16
+
+/** Per-CPU cache for frames which can be identity-mapped */
+#define FRAME_PCP_LOWMEM   0
+/** Per-CPU cache for frames preferably outside the identity-mapped region */
+#define FRAME_PCP_HIGHMEM  1
+
+#define FRAME_PCP_COUNT  2
+
+/** Per-CPU cache of single frames
+ *
+ * Frames in the cache are marked as allocated in their zones and have
+ * a reference count of one, which is owned by the cache. Freed frames
+ * are first collected in the pending array and their references are
+ * dropped in a batch, with the zones lock taken only once.
+ */
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+
+	/** Number of frames ready for allocation */
+	size_t count;
+	/** Frames ready for allocation */
+	pfn_t frames[FRAME_PCP_SIZE];
+
+	/** Number of freed frames pending a reference drop */
+	size_t pending;
+	/** Freed frames pending a reference drop */
+	pfn_t pending_frames[FRAME_PCP_PENDING];
+} frame_pcp_t;
+
+#endif
+
+/** @}
+ */
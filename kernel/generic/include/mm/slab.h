@@ -39,10 +39,20 @@
 #include <synch/spinlock.h>
 #include <atomic.h>
 #include <mm/frame.h>
+#include <abi/sysinfo.h>
 
-/** Initial Magazine size (TODO: dynamically growing magazines) */
+/** Initial Magazine size */
 #define SLAB_MAG_SIZE  4
 
+/** Number of supported magazine sizes (SLAB_MAG_SIZE, 2 * SLAB_MAG_SIZE, ...) */
+#define SLAB_MAG_SIZES  5
+
+/** Number of depot operations between magazine size adjustments */
+#define SLAB_MAG_TUNE_PERIOD  1024
+
+/** Contended depot operations per period which make magazines grow */
+#define SLAB_MAG_TUNE_CONTENTION  (SLAB_MAG_TUNE_PERIOD >> 4)
+
 /** If object size is less, store control structure inside SLAB */
 #define SLAB_INSIDE_SIZE  (PAGE_SIZE >> 3)
 
@@ -103,6 +113,19 @@ typedef struct {
 	atomic_size_t cached_objs;
 	/** How many magazines in magazines list */
 	atomic_size_t magazine_counter;
+	/** Allocations satisfied from CPU magazines */
+	atomic_size_t mag_hits;
+	/** Allocations which had to go to the slab layer */
+	atomic_size_t mag_misses;
+	/** Depot operations which found maglock taken */
+	atomic_size_t depot_contention;
+
+	/** Number of slots in newly allocated magazines */
+	atomic_size_t mag_size;
+	/** Depot operations in the current tuning period (under maglock) */
+	size_t depot_ops;
+	/** Contended depot operations in the current period (under maglock) */
+	size_t depot_contended;
 
 	/* Slabs */
 	list_t full_slabs;     /**< List of full slabs */
@@ -132,6 +155,9 @@ extern void slab_enable_cpucache(void);
 /* kconsole debug */
 extern void slab_print_list(void);
 
+/* statistics */
+extern size_t slab_get_stats(stats_slab_t *, size_t);
+
 #endif
 
 /** @}
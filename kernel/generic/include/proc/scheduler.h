@@ -45,6 +45,9 @@
 #define RQ_COUNT          16
 #define NEEDS_RELINK_MAX  (HZ)
 
+/** Maximum number of CPUs an idle CPU probes for work to steal. */
+#define STEAL_VICTIMS_MAX  4
+
 /** Scheduler run queue structure. */
 typedef struct {
 	IRQ_SPINLOCK_DECLARE(lock);
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup kernel_time
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_TIMEWHEEL_H_
+#define KERN_TIMEWHEEL_H_
+
+#include <adt/list.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Number of bits of the expiration tick resolved by one wheel level */
+#define TIMEWHEEL_LEVEL_BITS  6
+#define TIMEWHEEL_SLOTS       (1 << TIMEWHEEL_LEVEL_BITS)
+#define TIMEWHEEL_SLOT_MASK   (TIMEWHEEL_SLOTS - 1)
+#define TIMEWHEEL_LEVELS      5
+
+/** Hierarchical timing wheel of active timeouts
+ *
+ * Level @c l holds timeouts that expire between 2^(l * TIMEWHEEL_LEVEL_BITS)
+ * and 2^((l + 1) * TIMEWHEEL_LEVEL_BITS) ticks after @c tick. Timeouts in
+ * the upper levels are cascaded down as the wheel turns, so that only
+ * level 0 is ever looked at when firing timeouts.
+ */
+typedef struct {
+	/** Next clock tick to be processed. */
+	uint64_t tick;
+	/** Number of timeouts in the wheel. */
+	size_t count;
+	/** Lists of timeouts. */
+	list_t slot[TIMEWHEEL_LEVELS][TIMEWHEEL_SLOTS];
+} timewheel_t;
+
+#endif
+
+/** @}
+ */
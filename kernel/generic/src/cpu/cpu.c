@@ -92,6 +92,11 @@ void cpu_init(void)
 				irq_spinlock_initialize(&cpus[i].rq[j].lock, "cpus[].rq[].lock");
 				list_initialize(&cpus[i].rq[j].rq);
 			}
+
+			for (unsigned int j = 0; j < FRAME_PCP_COUNT; j++) {
+				irq_spinlock_initialize(&cpus[i].frame_pcp[j].lock,
+				    "cpus[].frame_pcp[].lock");
+			}
 		}
 
 #ifdef CONFIG_SMP
@@ -108,6 +113,10 @@ void cpu_init(void)
 	CPU->idle_cycles = ATOMIC_TIME_INITIALIZER();
 	CPU->busy_cycles = ATOMIC_TIME_INITIALIZER();
 
+	atomic_store(&CPU->steal_attempts, 0);
+	atomic_store(&CPU->steal_successes, 0);
+	CPU_LOCAL->steal_seed = CPU->id + 1;
+
 	cpu_identify();
 	cpu_arch_init();
 }
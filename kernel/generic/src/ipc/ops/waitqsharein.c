@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+/** @file
+ */
+
+#include <ipc/sysipc_ops.h>
+#include <ipc/ipc.h>
+#include <cap/cap.h>
+#include <abi/errno.h>
+#include <arch.h>
+
+static errno_t request_preprocess(call_t *call, phone_t *phone)
+{
+	/*
+	 * Allocate the capability for the waitq, but don't publish it yet.
+	 * That will be done once the recipient hands over its waitq.
+	 */
+	cap_handle_t handle;
+	errno_t rc = cap_alloc(TASK, &handle);
+	if (rc != EOK) {
+		ipc_set_arg5(&call->data, cap_handle_raw(CAP_NIL));
+		return rc;
+	}
+
+	call->priv = 0;
+
+	/* Remember the handle */
+	ipc_set_arg5(&call->data, cap_handle_raw(handle));
+
+	return EOK;
+}
+
+static errno_t request_forget(call_t *call)
+{
+	cap_handle_t handle = (cap_handle_t) ipc_get_arg5(&call->data);
+
+	if (!cap_handle_valid(handle))
+		return EOK;
+
+	cap_free(TASK, handle);
+	return EOK;
+}
+
+static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
+{
+	if (ipc_get_retval(&answer->data) == EOK) {
+		/* Take a reference to the recipient's waitq */
+		kobject_t *kobj = kobject_get(TASK,
+		    (cap_handle_t) ipc_get_arg1(&answer->data),
+		    KOBJECT_TYPE_WAITQ);
+		if (kobj)
+			answer->priv = (sysarg_t) kobj;
+		else
+			ipc_set_retval(&answer->data, ENOENT);
+	}
+
+	/* Restore the sender's handle in answer's ARG5 */
+	ipc_set_arg5(&answer->data, ipc_get_arg5(olddata));
+
+	return EOK;
+}
+
+static errno_t answer_process(call_t *answer)
+{
+	cap_handle_t handle = (cap_handle_t) ipc_get_arg5(&answer->data);
+	/* Move the reference from answer->priv to kobj */
+	kobject_t *kobj = (kobject_t *) answer->priv;
+	answer->priv = 0;
+
+	if (ipc_get_retval(&answer->data)) {
+		if (kobj)
+			kobject_put(kobj);
+		if (cap_handle_valid(handle))
+			cap_free(TASK, handle);
+	} else {
+		/* Hand over the reference to the capability */
+		cap_publish(TASK, handle, kobj);
+	}
+
+	return EOK;
+}
+
+sysipc_ops_t ipc_m_waitq_share_in_ops = {
+	.request_preprocess = request_preprocess,
+	.request_forget = request_forget,
+	.request_process = null_request_process,
+	.answer_cleanup = null_answer_cleanup,
+	.answer_preprocess = answer_preprocess,
+	.answer_process = answer_process,
+};
+
+/** @}
+ */
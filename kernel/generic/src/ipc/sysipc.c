@@ -110,6 +110,7 @@ static inline bool method_is_immutable(sysarg_t imethod)
 	case IPC_M_DATA_WRITE:
 	case IPC_M_DATA_READ:
 	case IPC_M_STATE_CHANGE_AUTHORIZE:
+	case IPC_M_WAITQ_SHARE_IN:
 		return true;
 	default:
 		return false;
@@ -139,6 +140,7 @@ static inline bool answer_need_old(call_t *call)
 	case IPC_M_DATA_WRITE:
 	case IPC_M_DATA_READ:
 	case IPC_M_STATE_CHANGE_AUTHORIZE:
+	case IPC_M_WAITQ_SHARE_IN:
 		return true;
 	default:
 		return false;
@@ -409,17 +411,19 @@ sys_errno_t sys_ipc_call_async_fast(cap_phone_handle_t handle, sysarg_t imethod,
 	return EOK;
 }
 
-/** Make an asynchronous IPC call allowing to transmit the entire payload.
+/** Send an asynchronous call with the entire payload already in the kernel.
+ *
+ * Common code for sys_ipc_call_async_slow() and sys_ipc_batch().
  *
  * @param handle  Phone capability for the call.
- * @param data    Userspace address of call data with the request.
+ * @param args    Interface, method and payload of the call.
  * @param label   User-defined label.
  *
  * @return See sys_ipc_call_async_fast().
  *
  */
-sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_data_t data,
-    sysarg_t label)
+static errno_t ipc_call_async_internal(cap_phone_handle_t handle,
+    const sysarg_t *args, sysarg_t label)
 {
 	kobject_t *kobj = kobject_get(TASK, handle, KOBJECT_TYPE_PHONE);
 	if (!kobj)
@@ -436,13 +440,7 @@ sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_da
 		return ENOMEM;
 	}
 
-	errno_t rc = copy_from_uspace(&call->data.args, data + offsetof(ipc_data_t, args),
-	    sizeof(call->data.args));
-	if (rc != EOK) {
-		kobject_put(call->kobject);
-		kobject_put(kobj);
-		return (sys_errno_t) rc;
-	}
+	memcpy(call->data.args, args, sizeof(call->data.args));
 
 	/* Set the user-defined label */
 	call->data.answer_label = label;
@@ -458,6 +456,28 @@ sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_da
 	return EOK;
 }
 
+/** Make an asynchronous IPC call allowing to transmit the entire payload.
+ *
+ * @param handle  Phone capability for the call.
+ * @param data    Userspace address of call data with the request.
+ * @param label   User-defined label.
+ *
+ * @return See sys_ipc_call_async_fast().
+ *
+ */
+sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_data_t data,
+    sysarg_t label)
+{
+	sysarg_t args[IPC_CALL_LEN];
+
+	errno_t rc = copy_from_uspace(args, data + offsetof(ipc_data_t, args),
+	    sizeof(args));
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	return (sys_errno_t) ipc_call_async_internal(handle, args, label);
+}
+
 /** Forward a received call to another destination
  *
  * Common code for both the fast and the slow version.
@@ -764,9 +784,10 @@ sys_errno_t sys_ipc_hangup(cap_phone_handle_t handle)
  *                 for explanation.
  *
  * @return An error code on error.
+ *
  */
-sys_errno_t sys_ipc_wait_for_call(uspace_ptr_ipc_data_t calldata, uint32_t usec,
-    unsigned int flags)
+static errno_t ipc_wait_for_call_internal(uspace_ptr_ipc_data_t calldata,
+    uint32_t usec, unsigned int flags)
 {
 	call_t *call = NULL;
 	errno_t rc;
@@ -865,6 +886,94 @@ error:
 	return rc;
 }
 
+/** Wait for an incoming IPC call or an answer.
+ *
+ * @param calldata Pointer to buffer where the call/answer data is stored.
+ * @param usec     Timeout. See waitq_sleep_timeout() for explanation.
+ * @param flags    Select mode of sleep operation. See waitq_sleep_timeout()
+ *                 for explanation.
+ *
+ * @return An error code on error.
+ */
+sys_errno_t sys_ipc_wait_for_call(uspace_ptr_ipc_data_t calldata, uint32_t usec,
+    unsigned int flags)
+{
+	return (sys_errno_t) ipc_wait_for_call_internal(calldata, usec, flags);
+}
+
+/** Submit several asynchronous calls and reap several calls or answers.
+ *
+ * All requests in @a calls are sent first, in order, exactly as if they were
+ * sent by separate sys_ipc_call_async_slow() invocations. The outcome of each
+ * submission is stored in its rc field. Afterwards, the function waits for the
+ * first incoming call or answer according to @a usec and @a flags and then
+ * collects any further calls or answers that are already pending, without
+ * blocking, until @a results is full.
+ *
+ * @param calls    Userspace array of requests to send.
+ * @param ncalls   Number of requests in @a calls.
+ * @param results  Userspace array receiving the calls/answers.
+ * @param nresults Userspace address holding the capacity of @a results
+ *                 on input and the number of reaped entries on output.
+ * @param usec     Timeout of the first wait. See waitq_sleep_timeout().
+ * @param flags    Mode of the first wait. See waitq_sleep_timeout().
+ *
+ * @return EOK if at least one entry was reaped or nothing was to be reaped.
+ * @return EINVAL if @a ncalls or the capacity exceed IPC_BATCH_MAX.
+ * @return Error code of the first wait otherwise.
+ *
+ */
+sys_errno_t sys_ipc_batch(uspace_ptr_ipc_batch_call_t calls, size_t ncalls,
+    uspace_ptr_ipc_data_t results, uspace_ptr_size_t nresults, uint32_t usec,
+    unsigned int flags)
+{
+	size_t capacity;
+	errno_t rc = copy_from_uspace(&capacity, nresults, sizeof(capacity));
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	if ((ncalls > IPC_BATCH_MAX) || (capacity > IPC_BATCH_MAX))
+		return (sys_errno_t) EINVAL;
+
+	for (size_t i = 0; i < ncalls; i++) {
+		uspace_addr_t ureq = calls + i * sizeof(ipc_batch_call_t);
+		ipc_batch_call_t req;
+
+		rc = copy_from_uspace(&req, ureq, sizeof(req));
+		if (rc != EOK)
+			return (sys_errno_t) rc;
+
+		req.rc = ipc_call_async_internal(req.phone, req.args, req.label);
+
+		rc = copy_to_uspace(ureq + offsetof(ipc_batch_call_t, rc),
+		    &req.rc, sizeof(req.rc));
+		if (rc != EOK)
+			return (sys_errno_t) rc;
+	}
+
+	size_t count = 0;
+	errno_t wait_rc = EOK;
+	while (count < capacity) {
+		wait_rc = ipc_wait_for_call_internal(
+		    results + count * sizeof(ipc_data_t),
+		    (count == 0) ? usec : SYNCH_NO_TIMEOUT,
+		    (count == 0) ? flags : SYNCH_FLAGS_NON_BLOCKING);
+		if (wait_rc != EOK)
+			break;
+
+		count++;
+	}
+
+	rc = copy_to_uspace(nresults, &count, sizeof(count));
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	if (count > 0)
+		return EOK;
+
+	return (sys_errno_t) wait_rc;
+}
+
 /** Interrupt one thread from sys_ipc_wait_for_call().
  *
  */
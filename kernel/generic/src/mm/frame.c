@@ -39,6 +39,11 @@
  * This file contains the physical frame allocator and memory zone management.
  * The frame allocator is built on top of the two-level bitmap structure.
  *
+ * Single frames without address constraints are allocated from small
+ * per-CPU caches, which are refilled from the zones and drained back
+ * to them in batches. This way, the most common allocations and
+ * deallocations do not need to take the zones lock.
+ *
  */
 
 #include <typedefs.h>
@@ -56,11 +61,13 @@
 #include <log.h>
 #include <align.h>
 #include <mm/slab.h>
+#include <atomic.h>
 #include <bitops.h>
 #include <macros.h>
 #include <config.h>
 #include <str.h>
 #include <proc/thread.h> /* THREAD */
+#include <cpu.h>
 
 zones_t zones = {
 	.count = 0,
@@ -76,6 +83,13 @@ static CONDVAR_INITIALIZE(mem_avail_cv);
 static size_t mem_avail_req = 0;  /**< Number of frames requested. */
 static size_t mem_avail_gen = 0;  /**< Generation counter. */
 
+/** Number of threads waiting for memory.
+ *
+ * While non-zero, freed frames bypass the per-CPU caches so that the
+ * waiters are signalled.
+ */
+static atomic_size_t mem_avail_waiters = 0;
+
 /** Initialize frame structure.
  *
  * @param frame Frame structure to be initialized.
@@ -862,6 +876,262 @@ static size_t try_find_zone(size_t count, bool lowmem,
 	    frame_constraint, hint);
 }
 
+/** Signal threads waiting for memory that some frames were freed.
+ *
+ * @param freed Number of frames returned to the zones.
+ *
+ */
+static void frame_mem_avail_signal(size_t freed)
+{
+	/* Disabled interrupts needed to prevent deadlock with TLB shootdown. */
+	irq_spinlock_lock(&mem_avail_lock, true);
+
+	if (mem_avail_req > 0)
+		mem_avail_req -= min(mem_avail_req, freed);
+
+	if (mem_avail_req == 0) {
+		mem_avail_gen++;
+		condvar_broadcast(&mem_avail_cv);
+	}
+
+	irq_spinlock_unlock(&mem_avail_lock, true);
+}
+
+/** Check whether a frame lies in the identity-mapped region.
+ *
+ * @param pfn Frame number.
+ *
+ * @return True if the frame is low memory.
+ *
+ */
+_NO_TRACE static bool frame_is_lowmem(pfn_t pfn)
+{
+	return (PFN2ADDR(pfn) <
+	    KA2PA(config.identity_base) + config.identity_size);
+}
+
+/** Drop references of frames freed into a per-CPU cache.
+ *
+ * Frames whose last reference is dropped stay in the cache if there
+ * is room for them, otherwise they are returned to their zones.
+ *
+ * Assume the per-CPU cache is locked, interrupts are disabled and
+ * zones lock is locked.
+ *
+ * @param pcp      Per-CPU cache.
+ * @param released Incremented by the number of frames returned
+ *                 to the zones.
+ *
+ * @return Number of frames whose last reference was dropped.
+ *
+ */
+_NO_TRACE static size_t frame_pcp_flush(frame_pcp_t *pcp, size_t *released)
+{
+	size_t freed = 0;
+
+	for (size_t i = 0; i < pcp->pending; i++) {
+		pfn_t pfn = pcp->pending_frames[i];
+		size_t znum = find_zone(pfn, 1, 0);
+
+		assert(znum != (size_t) -1);
+
+		zone_t *zone = &zones.info[znum];
+		frame_t *frame = zone_get_frame(zone, pfn - zone->base);
+
+		assert(frame->refcount > 0);
+
+		if ((frame->refcount == 1) && (pcp->count < FRAME_PCP_SIZE)) {
+			/* Keep the last reference for the cache. */
+			pcp->frames[pcp->count++] = pfn;
+			freed++;
+		} else {
+			size_t cnt = zone_frame_free(zone, pfn - zone->base);
+			freed += cnt;
+			*released += cnt;
+		}
+	}
+
+	pcp->pending = 0;
+	return freed;
+}
+
+/** Return all frames of a per-CPU cache to their zones.
+ *
+ * Assume the per-CPU cache is locked, interrupts are disabled and
+ * zones lock is locked.
+ *
+ * @param pcp      Per-CPU cache.
+ * @param released Incremented by the number of frames returned
+ *                 to the zones.
+ *
+ * @return Number of frames whose last reference was dropped.
+ *
+ */
+_NO_TRACE static size_t frame_pcp_drain(frame_pcp_t *pcp, size_t *released)
+{
+	size_t freed = frame_pcp_flush(pcp, released);
+
+	for (size_t i = 0; i < pcp->count; i++) {
+		pfn_t pfn = pcp->frames[i];
+		size_t znum = find_zone(pfn, 1, 0);
+
+		assert(znum != (size_t) -1);
+
+		*released += zone_frame_free(&zones.info[znum],
+		    pfn - zones.info[znum].base);
+	}
+
+	pcp->count = 0;
+	return freed;
+}
+
+/** Return frames held by all per-CPU caches to the zones.
+ *
+ * Must be called without the zones lock.
+ *
+ * @return Number of frames returned to the zones.
+ *
+ */
+static size_t frame_pcp_drain_all(void)
+{
+	if (cpus == NULL)
+		return 0;
+
+	size_t freed = 0;
+	size_t released = 0;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		for (size_t j = 0; j < FRAME_PCP_COUNT; j++) {
+			frame_pcp_t *pcp = &cpus[i].frame_pcp[j];
+
+			irq_spinlock_lock(&pcp->lock, true);
+			irq_spinlock_lock(&zones.lock, false);
+
+			freed += frame_pcp_drain(pcp, &released);
+
+			irq_spinlock_unlock(&zones.lock, false);
+			irq_spinlock_unlock(&pcp->lock, true);
+		}
+	}
+
+	if (released > 0)
+		frame_mem_avail_signal(released);
+
+	if (freed > 0)
+		reserve_free(freed);
+	return released;
+}
+
+/** Allocate a single frame from the per-CPU cache.
+ *
+ * If the cache is empty, it is refilled with up to FRAME_PCP_BATCH
+ * frames taken from the zones under a single acquisition of the
+ * zones lock.
+ *
+ * @param lowmem True if the frame must be identity-mappable.
+ *
+ * @return Allocated frame or zero if none is available.
+ *
+ */
+static pfn_t frame_pcp_alloc(bool lowmem)
+{
+	ipl_t ipl = interrupts_disable();
+
+	if (CPU == NULL) {
+		interrupts_restore(ipl);
+		return 0;
+	}
+
+	frame_pcp_t *pcp =
+	    &CPU->frame_pcp[lowmem ? FRAME_PCP_LOWMEM : FRAME_PCP_HIGHMEM];
+
+	irq_spinlock_lock(&pcp->lock, false);
+
+	if (pcp->count == 0) {
+		irq_spinlock_lock(&zones.lock, false);
+
+		size_t hint = 0;
+		while (pcp->count < FRAME_PCP_BATCH) {
+			size_t znum = try_find_zone(1, lowmem, 0, hint);
+			if (znum == (size_t) -1)
+				break;
+
+			pcp->frames[pcp->count++] =
+			    zone_frame_alloc(&zones.info[znum], 1, 0) +
+			    zones.info[znum].base;
+			hint = znum;
+		}
+
+		irq_spinlock_unlock(&zones.lock, false);
+	}
+
+	pfn_t pfn = 0;
+	if (pcp->count > 0)
+		pfn = pcp->frames[--pcp->count];
+
+	irq_spinlock_unlock(&pcp->lock, false);
+	interrupts_restore(ipl);
+
+	return pfn;
+}
+
+/** Free a single frame into the per-CPU cache.
+ *
+ * The reference to the frame is not dropped immediately, but once
+ * FRAME_PCP_PENDING frames are collected.
+ *
+ * @param pfn Frame to free.
+ *
+ * @return False if there is no per-CPU cache to use yet or if some
+ *         thread is waiting for memory.
+ *
+ */
+static bool frame_pcp_free(pfn_t pfn)
+{
+	ipl_t ipl = interrupts_disable();
+
+	if (CPU == NULL) {
+		interrupts_restore(ipl);
+		return false;
+	}
+
+	frame_pcp_t *pcp = &CPU->frame_pcp[frame_is_lowmem(pfn) ?
+	    FRAME_PCP_LOWMEM : FRAME_PCP_HIGHMEM];
+
+	irq_spinlock_lock(&pcp->lock, false);
+
+	/*
+	 * Checked under the cache lock so that a waiter draining the caches
+	 * after raising the count cannot miss the frame.
+	 */
+	if (atomic_load(&mem_avail_waiters) > 0) {
+		irq_spinlock_unlock(&pcp->lock, false);
+		interrupts_restore(ipl);
+		return false;
+	}
+
+	size_t freed = 0;
+	size_t released = 0;
+
+	if (pcp->pending == FRAME_PCP_PENDING) {
+		irq_spinlock_lock(&zones.lock, false);
+		freed = frame_pcp_flush(pcp, &released);
+		irq_spinlock_unlock(&zones.lock, false);
+	}
+
+	pcp->pending_frames[pcp->pending++] = pfn;
+
+	irq_spinlock_unlock(&pcp->lock, false);
+	interrupts_restore(ipl);
+
+	if (released > 0)
+		frame_mem_avail_signal(released);
+
+	if (freed > 0)
+		reserve_free(freed);
+	return true;
+}
+
 /** Allocate frames of physical memory.
  *
  * @param count      Number of continuous frames to allocate.
@@ -887,17 +1157,39 @@ uintptr_t frame_alloc_generic(size_t count, frame_flags_t flags,
 	if (!(flags & FRAME_NO_RESERVE))
 		reserve_force_alloc(count);
 
-loop:
-	irq_spinlock_lock(&zones.lock, true);
-
 	// TODO: Print diagnostic if neither is explicitly specified.
 	bool lowmem = (flags & FRAME_LOWMEM) || !(flags & FRAME_HIGHMEM);
 
+	/*
+	 * Single unconstrained frames come from the per-CPU cache.
+	 */
+	if ((count == 1) && (frame_constraint == 0)) {
+		pfn_t pfn = frame_pcp_alloc(lowmem);
+		if (pfn != 0)
+			return PFN2ADDR(pfn);
+	}
+
+loop:
+	irq_spinlock_lock(&zones.lock, true);
+
 	/*
 	 * First, find suitable frame zone.
 	 */
 	size_t znum = try_find_zone(count, lowmem, frame_constraint, hint);
 
+	/*
+	 * If no memory, return frames held by per-CPU caches.
+	 */
+	if (znum == (size_t) -1) {
+		irq_spinlock_unlock(&zones.lock, true);
+		size_t released = frame_pcp_drain_all();
+		irq_spinlock_lock(&zones.lock, true);
+
+		if (released > 0)
+			znum = try_find_zone(count, lowmem,
+			    frame_constraint, hint);
+	}
+
 	/*
 	 * If no memory, reclaim some slab memory,
 	 * if it does not help, reclaim all.
@@ -920,6 +1212,17 @@ loop:
 				znum = try_find_zone(count, lowmem,
 				    frame_constraint, hint);
 		}
+
+		/* Reclaimed slab frames may have gone to the per-CPU caches. */
+		if (znum == (size_t) -1) {
+			irq_spinlock_unlock(&zones.lock, true);
+			size_t released = frame_pcp_drain_all();
+			irq_spinlock_lock(&zones.lock, true);
+
+			if (released > 0)
+				znum = try_find_zone(count, lowmem,
+				    frame_constraint, hint);
+		}
 	}
 
 	if (znum == (size_t) -1) {
@@ -950,6 +1253,9 @@ loop:
 		    "%zu available.", THREAD->tid, count, avail);
 #endif
 
+		/* Frames freed from now on are returned to the zones. */
+		atomic_inc(&mem_avail_waiters);
+
 		/* Disabled interrupts needed to prevent deadlock with TLB shootdown. */
 		irq_spinlock_lock(&mem_avail_lock, true);
 
@@ -960,11 +1266,23 @@ loop:
 
 		size_t gen = mem_avail_gen;
 
+		irq_spinlock_unlock(&mem_avail_lock, true);
+
+		/*
+		 * Frames freed into the per-CPU caches before the waiter count
+		 * was raised would not signal us.
+		 */
+		(void) frame_pcp_drain_all();
+
+		irq_spinlock_lock(&mem_avail_lock, true);
+
 		while (gen == mem_avail_gen)
 			condvar_wait(&mem_avail_cv, &mem_avail_lock);
 
 		irq_spinlock_unlock(&mem_avail_lock, true);
 
+		atomic_dec(&mem_avail_waiters);
+
 #ifdef CONFIG_DEBUG
 		log(LF_OTHER, LVL_DEBUG, "Thread %" PRIu64 " woken up.",
 		    THREAD->tid);
@@ -1002,6 +1320,11 @@ uintptr_t frame_alloc(size_t count, frame_flags_t flags, uintptr_t constraint)
  */
 void frame_free_generic(uintptr_t start, size_t count, frame_flags_t flags)
 {
+	/* Single frames go to the per-CPU cache. */
+	if ((count == 1) && !(flags & FRAME_NO_RESERVE) &&
+	    (frame_pcp_free(ADDR2PFN(start))))
+		return;
+
 	size_t freed = 0;
 
 	irq_spinlock_lock(&zones.lock, true);
@@ -1022,19 +1345,7 @@ void frame_free_generic(uintptr_t start, size_t count, frame_flags_t flags)
 	irq_spinlock_unlock(&zones.lock, true);
 
 	/* Signal that some memory has been freed. */
-
-	/* Disabled interrupts needed to prevent deadlock with TLB shootdown. */
-	irq_spinlock_lock(&mem_avail_lock, true);
-
-	if (mem_avail_req > 0)
-		mem_avail_req -= min(mem_avail_req, freed);
-
-	if (mem_avail_req == 0) {
-		mem_avail_gen++;
-		condvar_broadcast(&mem_avail_cv);
-	}
-
-	irq_spinlock_unlock(&mem_avail_lock, true);
+	frame_mem_avail_signal(freed);
 
 	if (!(flags & FRAME_NO_RESERVE))
 		reserve_free(freed);
@@ -45,8 +45,6 @@
  *
  * Following features are not currently supported but would be easy to do:
  * @li cache coloring
- * @li dynamic magazine growing (different magazine sizes are already
- *     supported, but we would need to adjust allocation strategy)
  *
  * The slab allocator supports per-CPU caches ('magazines') to facilitate
  * good SMP scaling.
@@ -61,6 +59,13 @@
  * the object is deallocated into slab). If the magazine is full, it is
  * put into cpu-shared list of magazines and a new one is allocated.
  *
+ * Magazine sizes adapt to the load of each cache. Every operation on the
+ * cache-wide list of full magazines (the depot) notes whether the depot lock
+ * was contended. If the contention within a tuning period is too high, the
+ * cache starts to allocate magazines of double size, so that CPUs need to
+ * visit the depot less often. Magazines of different sizes can coexist in
+ * one cache, each size being allocated from its own magazine cache.
+ *
  * The CPU-bound magazine is actually a pair of magazines in order to avoid
  * thrashing when somebody is allocating/deallocating 1 item at the magazine
  * size boundary. LIFO order is enforced, which should avoid fragmentation
@@ -116,12 +121,21 @@
 #include <macros.h>
 #include <cpu.h>
 #include <stdlib.h>
+#include <str.h>
 
 IRQ_SPINLOCK_STATIC_INITIALIZE(slab_cache_lock);
 static LIST_INITIALIZE(slab_cache_list);
 
-/** Magazine cache */
-static slab_cache_t mag_cache;
+/** Magazine caches, one for each magazine size */
+static slab_cache_t mag_cache[SLAB_MAG_SIZES];
+
+static const char *mag_cache_names[SLAB_MAG_SIZES] = {
+	"slab_magazine_t",
+	"slab_magazine8_t",
+	"slab_magazine16_t",
+	"slab_magazine32_t",
+	"slab_magazine64_t"
+};
 
 /** Cache for cache descriptors */
 static slab_cache_t slab_cache_cache;
@@ -326,6 +340,61 @@ _NO_TRACE static void *slab_obj_create(slab_cache_t *cache, unsigned int flags)
  * CPU-Cache slab functions
  */
 
+/** Return magazine cache for magazines with given number of slots
+ *
+ */
+_NO_TRACE static slab_cache_t *mag_cache_get(size_t size)
+{
+	size_t i = 0;
+	while ((SLAB_MAG_SIZE << i) < size)
+		i++;
+
+	assert(i < SLAB_MAG_SIZES);
+	return &mag_cache[i];
+}
+
+/** Lock the magazine depot of a cache
+ *
+ * Account for contention on the depot lock and grow the magazine size
+ * of the cache if the depot has been contended too often during the
+ * last tuning period.
+ *
+ * @return Interrupt priority level to be passed to depot_unlock().
+ *
+ */
+_NO_TRACE static ipl_t depot_lock(slab_cache_t *cache)
+{
+	ipl_t ipl = interrupts_disable();
+
+	if (!irq_spinlock_trylock(&cache->maglock)) {
+		irq_spinlock_lock(&cache->maglock, false);
+		cache->depot_contended++;
+		atomic_inc(&cache->depot_contention);
+	}
+
+	if (++cache->depot_ops >= SLAB_MAG_TUNE_PERIOD) {
+		size_t size = atomic_load(&cache->mag_size);
+
+		if ((cache->depot_contended > SLAB_MAG_TUNE_CONTENTION) &&
+		    (size < (SLAB_MAG_SIZE << (SLAB_MAG_SIZES - 1))))
+			atomic_store(&cache->mag_size, size << 1);
+
+		cache->depot_ops = 0;
+		cache->depot_contended = 0;
+	}
+
+	return ipl;
+}
+
+/** Unlock the magazine depot of a cache
+ *
+ */
+_NO_TRACE static void depot_unlock(slab_cache_t *cache, ipl_t ipl)
+{
+	irq_spinlock_unlock(&cache->maglock, false);
+	interrupts_restore(ipl);
+}
+
 /** Find a full magazine in cache, take it from list and return it
  *
  * @param first If true, return first, else last mag.
@@ -337,7 +406,7 @@ _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
 	slab_magazine_t *mag = NULL;
 	link_t *cur;
 
-	irq_spinlock_lock(&cache->maglock, true);
+	ipl_t ipl = depot_lock(cache);
 	if (!list_empty(&cache->magazines)) {
 		if (first)
 			cur = list_first(&cache->magazines);
@@ -348,7 +417,7 @@ _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
 		list_remove(&mag->link);
 		atomic_dec(&cache->magazine_counter);
 	}
-	irq_spinlock_unlock(&cache->maglock, true);
+	depot_unlock(cache, ipl);
 
 	return mag;
 }
@@ -359,12 +428,12 @@ _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
 _NO_TRACE static void put_mag_to_cache(slab_cache_t *cache,
     slab_magazine_t *mag)
 {
-	irq_spinlock_lock(&cache->maglock, true);
+	ipl_t ipl = depot_lock(cache);
 
 	list_prepend(&mag->link, &cache->magazines);
 	atomic_inc(&cache->magazine_counter);
 
-	irq_spinlock_unlock(&cache->maglock, true);
+	depot_unlock(cache, ipl);
 }
 
 /** Free all objects in magazine and free memory associated with magazine
@@ -383,7 +452,7 @@ _NO_TRACE static size_t magazine_destroy(slab_cache_t *cache,
 		atomic_dec(&cache->cached_objs);
 	}
 
-	slab_free(&mag_cache, mag);
+	slab_free(mag_cache_get(mag->size), mag);
 
 	return frames;
 }
@@ -484,12 +553,13 @@ _NO_TRACE static slab_magazine_t *make_empty_current_mag(slab_cache_t *cache)
 	 * this would deadlock.
 	 *
 	 */
-	slab_magazine_t *newmag = slab_alloc(&mag_cache,
+	size_t size = atomic_load(&cache->mag_size);
+	slab_magazine_t *newmag = slab_alloc(mag_cache_get(size),
 	    FRAME_ATOMIC | FRAME_NO_RECLAIM);
 	if (!newmag)
 		return NULL;
 
-	newmag->size = SLAB_MAG_SIZE;
+	newmag->size = size;
 	newmag->busy = 0;
 
 	/* Flush last to magazine list */
@@ -602,6 +672,7 @@ _NO_TRACE static void _slab_cache_create(slab_cache_t *cache, const char *name,
 	cache->constructor = constructor;
 	cache->destructor = destructor;
 	cache->flags = flags;
+	atomic_store(&cache->mag_size, SLAB_MAG_SIZE);
 
 	list_initialize(&cache->full_slabs);
 	list_initialize(&cache->partial_slabs);
@@ -698,6 +769,9 @@ _NO_TRACE static size_t _slab_reclaim(slab_cache_t *cache, unsigned int flags)
 
 			irq_spinlock_unlock(&cache->mag_cache[i].lock, true);
 		}
+
+		/* Start growing the magazines from scratch. */
+		atomic_store(&cache->mag_size, SLAB_MAG_SIZE);
 	}
 
 	return frames;
@@ -766,9 +840,15 @@ void *slab_alloc(slab_cache_t *cache, unsigned int flags)
 
 	void *result = NULL;
 
-	if (!(cache->flags & SLAB_CACHE_NOMAGAZINE))
+	if (!(cache->flags & SLAB_CACHE_NOMAGAZINE)) {
 		result = magazine_obj_get(cache);
 
+		if (result)
+			atomic_inc(&cache->mag_hits);
+		else
+			atomic_inc(&cache->mag_misses);
+	}
+
 	if (!result)
 		result = slab_obj_create(cache, flags);
 
@@ -807,7 +887,8 @@ size_t slab_reclaim(unsigned int flags)
 void slab_print_list(void)
 {
 	printf("[cache name      ] [size  ] [pages ] [obj/pg] [slabs ]"
-	    " [cached] [alloc ] [ctl]\n");
+	    " [cached] [alloc ] [ctl] [magsz ] [hits    ] [misses  ]"
+	    " [depot-c ]\n");
 
 	size_t skip = 0;
 	while (true) {
@@ -860,23 +941,74 @@ void slab_print_list(void)
 		long cached_objs = atomic_load(&cache->cached_objs);
 		long allocated_objs = atomic_load(&cache->allocated_objs);
 		unsigned int flags = cache->flags;
+		size_t mag_size = atomic_load(&cache->mag_size);
+		size_t mag_hits = atomic_load(&cache->mag_hits);
+		size_t mag_misses = atomic_load(&cache->mag_misses);
+		size_t depot_contention = atomic_load(&cache->depot_contention);
 
 		irq_spinlock_unlock(&slab_cache_lock, true);
 
-		printf("%-18s %8zu %8zu %8zu %8ld %8ld %8ld %-5s\n",
+		printf("%-18s %8zu %8zu %8zu %8ld %8ld %8ld %-5s %8zu %10zu"
+		    " %10zu %10zu\n",
 		    name, size, frames, objects, allocated_slabs,
 		    cached_objs, allocated_objs,
-		    flags & SLAB_CACHE_SLINSIDE ? "in" : "out");
+		    flags & SLAB_CACHE_SLINSIDE ? "in" : "out",
+		    (flags & SLAB_CACHE_NOMAGAZINE) ? 0 : mag_size,
+		    mag_hits, mag_misses, depot_contention);
 	}
 }
 
+/** Get statistics of slab caches
+ *
+ * @param stats Array to fill in or NULL if only the number of caches
+ *              is of interest.
+ * @param count Number of items in @a stats.
+ *
+ * @return Number of slab caches in the system, which may be more
+ *         than the number of filled in items.
+ *
+ */
+size_t slab_get_stats(stats_slab_t *stats, size_t count)
+{
+	irq_spinlock_lock(&slab_cache_lock, true);
+
+	size_t i = 0;
+	list_foreach(slab_cache_list, link, slab_cache_t, cache) {
+		if ((stats != NULL) && (i < count)) {
+			str_cpy(stats[i].name, SLAB_NAME_BUFLEN, cache->name);
+			stats[i].size = cache->size;
+			stats[i].allocated_slabs =
+			    atomic_load(&cache->allocated_slabs);
+			stats[i].allocated_objs =
+			    atomic_load(&cache->allocated_objs);
+			stats[i].cached_objs = atomic_load(&cache->cached_objs);
+			stats[i].mag_size =
+			    (cache->flags & SLAB_CACHE_NOMAGAZINE) ? 0 :
+			    atomic_load(&cache->mag_size);
+			stats[i].mag_hits = atomic_load(&cache->mag_hits);
+			stats[i].mag_misses = atomic_load(&cache->mag_misses);
+			stats[i].depot_contention =
+			    atomic_load(&cache->depot_contention);
+		}
+
+		i++;
+	}
+
+	irq_spinlock_unlock(&slab_cache_lock, true);
+
+	return i;
+}
+
 void slab_cache_init(void)
 {
-	/* Initialize magazine cache */
-	_slab_cache_create(&mag_cache, "slab_magazine_t",
-	    sizeof(slab_magazine_t) + SLAB_MAG_SIZE * sizeof(void *),
-	    sizeof(uintptr_t), NULL, NULL, SLAB_CACHE_NOMAGAZINE |
-	    SLAB_CACHE_SLINSIDE);
+	/* Initialize magazine caches */
+	for (size_t i = 0; i < SLAB_MAG_SIZES; i++) {
+		_slab_cache_create(&mag_cache[i], mag_cache_names[i],
+		    sizeof(slab_magazine_t) +
+		    (SLAB_MAG_SIZE << i) * sizeof(void *),
+		    sizeof(uintptr_t), NULL, NULL, SLAB_CACHE_NOMAGAZINE |
+		    SLAB_CACHE_SLINSIDE);
+	}
 
 	/* Initialize slab_cache cache */
 	_slab_cache_create(&slab_cache_cache, "slab_cache_cache",
@@ -64,6 +64,7 @@
 #include <stdio.h>
 #include <log.h>
 #include <stacktrace.h>
+#include <macros.h>
 
 atomic_size_t nrdy;  /**< Number of ready threads in the system. */
 
@@ -151,6 +152,10 @@ static thread_t *try_find_thread(int *rq_index)
 	return NULL;
 }
 
+#ifdef CONFIG_SMP
+static thread_t *try_steal_thread(int *);
+#endif
+
 /** Get thread to be scheduled
  *
  * Get the optimal thread to be scheduled
@@ -171,6 +176,18 @@ static thread_t *find_best_thread(int *rq_index)
 		if (thread != NULL)
 			return thread;
 
+#ifdef CONFIG_SMP
+		/*
+		 * Before going to sleep, try to take some work
+		 * from a busy neighbour instead of waiting for
+		 * kcpulb to push it to us.
+		 */
+		thread = try_steal_thread(rq_index);
+
+		if (thread != NULL)
+			return thread;
+#endif
+
 		/*
 		 * For there was nothing to run, the CPU goes to sleep
 		 * until a hardware interrupt or an IPI comes.
@@ -614,10 +631,21 @@ void thread_main_func(void)
 
 #ifdef CONFIG_SMP
 
+/** Remove a migratable thread from the tail of another CPU's run queue
+ *
+ * The thread is detached from @a old_cpu and marked as belonging to the
+ * current CPU, but it is not appended to any local run queue. The global
+ * nrdy counter is left untouched.
+ *
+ * @param old_cpu CPU to steal from.
+ * @param i       Index of the run queue to steal from.
+ *
+ * @return Stolen thread or NULL if there was nothing to steal.
+ *
+ */
 static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 {
 	runq_t *old_rq = &old_cpu->rq[i];
-	runq_t *new_rq = &CPU->rq[i];
 
 	ipl_t ipl = interrupts_disable();
 
@@ -646,15 +674,11 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 		thread->stolen = true;
 		atomic_set_unordered(&thread->cpu, CPU);
 
-		/*
-		 * Ready thread on local CPU
-		 */
-
 #ifdef KCPULB_VERBOSE
 		log(LF_OTHER, LVL_DEBUG,
-		    "kcpulb%u: TID %" PRIu64 " -> cpu%u, "
+		    "cpu%u: TID %" PRIu64 " stolen from cpu%u, "
 		    "nrdy=%ld, avg=%ld", CPU->id, thread->tid,
-		    CPU->id, atomic_load(&CPU->nrdy),
+		    old_cpu->id, atomic_load(&CPU->nrdy),
 		    atomic_load(&nrdy) / config.cpu_active);
 #endif
 
@@ -663,14 +687,7 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 		list_remove(&thread->rq_link);
 		irq_spinlock_unlock(&old_rq->lock, false);
 
-		/* Append thread to local queue. */
-		irq_spinlock_lock(&new_rq->lock, false);
-		list_append(&thread->rq_link, &new_rq->rq);
-		new_rq->n++;
-		irq_spinlock_unlock(&new_rq->lock, false);
-
 		atomic_dec(&old_cpu->nrdy);
-		atomic_inc(&CPU->nrdy);
 		interrupts_restore(ipl);
 		return thread;
 	}
@@ -680,6 +697,87 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 	return NULL;
 }
 
+/** Steal a thread from another CPU and make it ready on the local CPU
+ *
+ * @param old_cpu CPU to steal from.
+ * @param i       Index of the run queue to steal from.
+ *
+ * @return Stolen thread or NULL if there was nothing to steal.
+ *
+ */
+static thread_t *migrate_thread_from(cpu_t *old_cpu, int i)
+{
+	thread_t *thread = steal_thread_from(old_cpu, i);
+	if (thread == NULL)
+		return NULL;
+
+	runq_t *new_rq = &CPU->rq[i];
+
+	ipl_t ipl = interrupts_disable();
+
+	/* Append thread to local queue. */
+	irq_spinlock_lock(&new_rq->lock, false);
+	list_append(&thread->rq_link, &new_rq->rq);
+	new_rq->n++;
+	irq_spinlock_unlock(&new_rq->lock, false);
+
+	atomic_inc(&CPU->nrdy);
+	interrupts_restore(ipl);
+
+	return thread;
+}
+
+/** Try to steal a thread for an idle CPU
+ *
+ * Probe at most STEAL_VICTIMS_MAX randomly chosen CPUs which have
+ * ready threads and take the first migratable thread from the tail
+ * of the highest-priority non-empty run queue. The stolen thread
+ * is returned directly so that it can run without waiting for
+ * the kcpulb load balancer.
+ *
+ * @param rq_index Place to store the index of the run queue the
+ *                 thread was taken from.
+ *
+ * @return Thread to be scheduled or NULL if nothing could be stolen.
+ *
+ */
+static thread_t *try_steal_thread(int *rq_index)
+{
+	assert(interrupts_disabled());
+	assert(CPU != NULL);
+
+	size_t active = config.cpu_active;
+	if ((active < 2) || (atomic_load(&nrdy) == 0))
+		return NULL;
+
+	size_t victims = min(active - 1, STEAL_VICTIMS_MAX);
+
+	for (size_t v = 0; v < victims; v++) {
+		cpu_t *victim =
+		    &cpus[RANDI(CPU_LOCAL->steal_seed) % active];
+
+		if ((victim == CPU) || (atomic_load(&victim->nrdy) == 0))
+			continue;
+
+		atomic_inc(&CPU->steal_attempts);
+
+		for (int i = 0; i < RQ_COUNT; i++) {
+			thread_t *thread = steal_thread_from(victim, i);
+			if (thread == NULL)
+				continue;
+
+			/* The thread goes straight to running. */
+			atomic_dec(&nrdy);
+			atomic_inc(&CPU->steal_successes);
+
+			*rq_index = i;
+			return thread;
+		}
+	}
+
+	return NULL;
+}
+
 /** Load balancing thread
  *
  * SMP load balancing thread, supervising thread supplies
@@ -737,7 +835,7 @@ not_satisfied:
 			if (atomic_load(&cpu->nrdy) <= average)
 				continue;
 
-			if (steal_thread_from(cpu, rq) && --count == 0)
+			if (migrate_thread_from(cpu, rq) && --count == 0)
 				goto satisfied;
 		}
 	}
@@ -137,6 +137,9 @@ static syshandler_t syscall_table[] = {
 
 	[SYS_KLOG] = (syshandler_t) sys_klog,
 	[SYS_KIO_READ] = (syshandler_t) sys_kio_read,
+
+	/* Batched IPC. */
+	[SYS_IPC_BATCH] = (syshandler_t) sys_ipc_batch,
 };
 
 /** Dispatch system call */
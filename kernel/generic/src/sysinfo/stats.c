@@ -43,6 +43,7 @@
 #include <synch/mutex.h>
 #include <time/clock.h>
 #include <mm/frame.h>
+#include <mm/slab.h>
 #include <proc/task.h>
 #include <proc/thread.h>
 #include <interrupt.h>
@@ -52,6 +53,7 @@
 #include <cpu.h>
 #include <arch.h>
 #include <stdlib.h>
+#include <macros.h>
 
 /** Bits of fixed-point precision for load */
 #define LOAD_FIXED_SHIFT  11
@@ -124,6 +126,9 @@ static void *get_stats_cpus(struct sysinfo_item *item, size_t *size,
 
 		stats_cpus[i].busy_cycles = atomic_time_read(&cpus[i].busy_cycles);
 		stats_cpus[i].idle_cycles = atomic_time_read(&cpus[i].idle_cycles);
+
+		stats_cpus[i].steal_attempts = atomic_load(&cpus[i].steal_attempts);
+		stats_cpus[i].steal_successes = atomic_load(&cpus[i].steal_successes);
 	}
 
 	return ((void *) stats_cpus);
@@ -661,6 +666,41 @@ static void *get_stats_exceptions(struct sysinfo_item *item, size_t *size,
 	return ((void *) stats_exceptions);
 }
 
+/** Get slab cache statistics
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing several stats_slab_t structures.
+ *         If the return value is not NULL, it should be freed
+ *         in the context of the sysinfo request.
+ */
+static void *get_stats_slabs(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	/* Count the caches first, we cannot allocate while walking them */
+	size_t count = slab_get_stats(NULL, 0);
+
+	*size = sizeof(stats_slab_t) * count;
+	if (dry_run)
+		return NULL;
+
+	stats_slab_t *stats_slabs = (stats_slab_t *) malloc(*size);
+	if (stats_slabs == NULL) {
+		/* No free space for allocation */
+		*size = 0;
+		return NULL;
+	}
+
+	/* Caches created in the meantime are not reported */
+	count = min(count, slab_get_stats(stats_slabs, count));
+	*size = sizeof(stats_slab_t) * count;
+
+	return ((void *) stats_slabs);
+}
+
 /** Get exception statistics
  *
  * Get statistics of a given exception. The exception number
@@ -852,6 +892,7 @@ void stats_init(void)
 	sysinfo_set_item_gen_data("system.threads", NULL, get_stats_threads, NULL);
 	sysinfo_set_item_gen_data("system.ipccs", NULL, get_stats_ipccs, NULL);
 	sysinfo_set_item_gen_data("system.exceptions", NULL, get_stats_exceptions, NULL);
+	sysinfo_set_item_gen_data("system.slabs", NULL, get_stats_slabs, NULL);
 	sysinfo_set_subtree_fn("system.tasks", NULL, get_stats_task, NULL);
 	sysinfo_set_subtree_fn("system.threads", NULL, get_stats_thread, NULL);
 	sysinfo_set_subtree_fn("system.exceptions", NULL, get_stats_exception, NULL);
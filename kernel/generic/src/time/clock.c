@@ -147,38 +147,8 @@ void clock(void)
 	/* Account CPU usage */
 	cpu_update_accounting();
 
-	/*
-	 * To avoid lock ordering problems,
-	 * run all expired timeouts as you visit them.
-	 *
-	 */
-
-	irq_spinlock_lock(&CPU->timeoutlock, false);
-
-	link_t *cur;
-	while ((cur = list_first(&CPU->timeout_active_list)) != NULL) {
-		timeout_t *timeout = list_get_instance(cur, timeout_t, link);
-
-		if (current_clock_tick <= timeout->deadline) {
-			break;
-		}
-
-		list_remove(cur);
-		timeout_handler_t handler = timeout->handler;
-		void *arg = timeout->arg;
-		atomic_bool *finished = &timeout->finished;
-
-		irq_spinlock_unlock(&CPU->timeoutlock, false);
-
-		handler(arg);
-
-		/* Signal that the handler is finished. */
-		atomic_store_explicit(finished, true, memory_order_release);
-
-		irq_spinlock_lock(&CPU->timeoutlock, false);
-	}
-
-	irq_spinlock_unlock(&CPU->timeoutlock, false);
+	/* Run expired timeouts. */
+	timeout_process(current_clock_tick);
 
 	/*
 	 * Do CPU usage accounting and find out whether to preempt THREAD.
@@ -34,6 +34,9 @@
 /**
  * @file
  * @brief Timeout management functions.
+ *
+ * Active timeouts of each CPU are kept in a hierarchical timing wheel,
+ * which makes both registering and unregistering a timeout O(1).
  */
 
 #include <time/timeout.h>
@@ -54,7 +57,16 @@
 void timeout_init(void)
 {
 	irq_spinlock_initialize(&CPU->timeoutlock, "cpu.timeoutlock");
-	list_initialize(&CPU->timeout_active_list);
+
+	timewheel_t *wheel = &CPU->timeout_wheel;
+
+	wheel->tick = CPU_LOCAL->current_clock_tick;
+	wheel->count = 0;
+
+	for (unsigned int l = 0; l < TIMEWHEEL_LEVELS; l++) {
+		for (unsigned int i = 0; i < TIMEWHEEL_SLOTS; i++)
+			list_initialize(&wheel->slot[l][i]);
+	}
 }
 
 /** Initialize timeout
@@ -79,6 +91,76 @@ deadline_t timeout_deadline_in_usec(uint32_t usec)
 	return CPU_LOCAL->current_clock_tick + us2ticks(usec);
 }
 
+/** Insert timeout into the slot of the wheel corresponding to its deadline
+ *
+ * A timeout fires on the first clock tick greater than its deadline.
+ * Timeouts which are already due are put into the slot of the next
+ * processed tick, timeouts beyond the range of the wheel are parked in
+ * the farthest slot of the top level and re-inserted when it cascades.
+ *
+ * @param wheel   Timing wheel, its CPU's timeoutlock must be held.
+ * @param timeout Timeout to insert.
+ *
+ */
+static void timewheel_insert(timewheel_t *wheel, timeout_t *timeout)
+{
+	uint64_t expires = (timeout->deadline < DEADLINE_NEVER) ?
+	    timeout->deadline + 1 : DEADLINE_NEVER;
+
+	if (expires < wheel->tick)
+		expires = wheel->tick;
+
+	uint64_t delta = expires - wheel->tick;
+	unsigned int level;
+
+	for (level = 0; level < TIMEWHEEL_LEVELS - 1; level++) {
+		if (delta < (UINT64_C(1) << ((level + 1) * TIMEWHEEL_LEVEL_BITS)))
+			break;
+	}
+
+	uint64_t range = UINT64_C(1) << (TIMEWHEEL_LEVELS * TIMEWHEEL_LEVEL_BITS);
+	if (delta >= range)
+		expires = wheel->tick + range - 1;
+
+	unsigned int index = (expires >> (level * TIMEWHEEL_LEVEL_BITS)) &
+	    TIMEWHEEL_SLOT_MASK;
+
+	list_append(&timeout->link, &wheel->slot[level][index]);
+	wheel->count++;
+}
+
+/** Move timeouts from upper levels down as the wheel reaches them
+ *
+ * Must be called once for each processed tick before level 0 is
+ * looked at.
+ *
+ * @param wheel Timing wheel, its CPU's timeoutlock must be held.
+ *
+ */
+static void timewheel_cascade(timewheel_t *wheel)
+{
+	for (unsigned int level = 1; level < TIMEWHEEL_LEVELS; level++) {
+		/* Only cascade when all lower levels have wrapped around. */
+		if ((wheel->tick & ((UINT64_C(1) <<
+		    (level * TIMEWHEEL_LEVEL_BITS)) - 1)) != 0)
+			break;
+
+		unsigned int index = (wheel->tick >>
+		    (level * TIMEWHEEL_LEVEL_BITS)) & TIMEWHEEL_SLOT_MASK;
+
+		list_t list;
+		list_initialize(&list);
+		list_concat(&list, &wheel->slot[level][index]);
+
+		link_t *cur;
+		while ((cur = list_first(&list)) != NULL) {
+			list_remove(cur);
+			wheel->count--;
+			timewheel_insert(wheel, list_get_instance(cur, timeout_t, link));
+		}
+	}
+}
+
 static void timeout_register_deadline_locked(timeout_t *timeout, deadline_t deadline,
     timeout_handler_t handler, void *arg)
 {
@@ -92,21 +174,7 @@ static void timeout_register_deadline_locked(timeout_t *timeout, deadline_t dead
 		.finished = ATOMIC_VAR_INIT(false),
 	};
 
-	/* Insert timeout into the active timeouts list according to timeout->deadline. */
-
-	link_t *last = list_last(&CPU->timeout_active_list);
-	if (last == NULL || timeout->deadline >= list_get_instance(last, timeout_t, link)->deadline) {
-		list_append(&timeout->link, &CPU->timeout_active_list);
-	} else {
-		for (link_t *cur = list_first(&CPU->timeout_active_list); cur != NULL;
-		    cur = list_next(cur, &CPU->timeout_active_list)) {
-
-			if (timeout->deadline < list_get_instance(cur, timeout_t, link)->deadline) {
-				list_insert_before(&timeout->link, cur);
-				break;
-			}
-		}
-	}
+	timewheel_insert(&CPU->timeout_wheel, timeout);
 }
 
 /** Register timeout
@@ -159,6 +227,7 @@ bool timeout_unregister(timeout_t *timeout)
 	bool success = link_in_use(&timeout->link);
 	if (success) {
 		list_remove(&timeout->link);
+		timeout->cpu->timeout_wheel.count--;
 	}
 
 	irq_spinlock_unlock(&timeout->cpu->timeoutlock, true);
@@ -172,5 +241,61 @@ bool timeout_unregister(timeout_t *timeout)
 	return success;
 }
 
+/** Run expired timeouts
+ *
+ * Turn the timing wheel of the current CPU up to @a current_tick and
+ * run handlers of all timeouts that expired on the way. To avoid lock
+ * ordering problems, the handlers are run as they are visited, with
+ * the timeout lock released.
+ *
+ * Only call from the clock interrupt with interrupts disabled.
+ *
+ * @param current_tick Current clock tick of this CPU.
+ *
+ */
+void timeout_process(uint64_t current_tick)
+{
+	timewheel_t *wheel = &CPU->timeout_wheel;
+
+	irq_spinlock_lock(&CPU->timeoutlock, false);
+
+	while (wheel->tick <= current_tick) {
+		if (wheel->count == 0) {
+			/* Nothing to cascade or fire, skip the idle ticks. */
+			wheel->tick = current_tick + 1;
+			break;
+		}
+
+		timewheel_cascade(wheel);
+
+		list_t *slot = &wheel->slot[0][wheel->tick & TIMEWHEEL_SLOT_MASK];
+
+		link_t *cur;
+		while ((cur = list_first(slot)) != NULL) {
+			timeout_t *timeout = list_get_instance(cur, timeout_t, link);
+
+			list_remove(cur);
+			wheel->count--;
+
+			timeout_handler_t handler = timeout->handler;
+			void *arg = timeout->arg;
+			atomic_bool *finished = &timeout->finished;
+
+			irq_spinlock_unlock(&CPU->timeoutlock, false);
+
+			handler(arg);
+
+			/* Signal that the handler is finished. */
+			atomic_store_explicit(finished, true, memory_order_release);
+
+			irq_spinlock_lock(&CPU->timeoutlock, false);
+		}
+
+		wheel->tick++;
+	}
+
+	irq_spinlock_unlock(&CPU->timeoutlock, false);
+}
+
 /** @}
  */
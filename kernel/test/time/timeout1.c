@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <test.h>
+#include <arch.h>
+#include <atomic.h>
+#include <cpu.h>
+#include <proc/thread.h>
+#include <stdlib.h>
+#include <time/timeout.h>
+#include <arch/asm.h>
+#include <arch/cycle.h>
+#include <typedefs.h>
+
+/** Number of timeouts kept pending while measuring */
+#define PENDING  16384
+
+/** Timeouts of the expiration run fire within this many microseconds */
+#define EXPIRE_SPREAD  200000
+
+/** Maximum number of polls waiting for the timeouts to fire */
+#define EXPIRE_POLLS  100
+
+typedef struct {
+	timeout_t timeout;
+	bool early;
+} test_timeout_t;
+
+static atomic_size_t fired;
+static atomic_size_t fired_early;
+
+static uint32_t seed = 0xdeadbeef;
+
+static uint32_t random(uint32_t max)
+{
+	uint32_t rc = seed % max;
+	seed = (((seed << 2) ^ (seed >> 2)) * 487) + rc;
+	return rc;
+}
+
+static void handler(void *arg)
+{
+	test_timeout_t *tt = (test_timeout_t *) arg;
+
+	/* Handlers run on the CPU the timeout was registered on. */
+	if (CPU_LOCAL->current_clock_tick <= tt->timeout.deadline)
+		atomic_inc(&fired_early);
+
+	atomic_inc(&fired);
+}
+
+const char *test_timeout1(void)
+{
+	test_timeout_t *tts = malloc(PENDING * sizeof(test_timeout_t));
+	if (tts == NULL)
+		return "Unable to allocate timeouts";
+
+	/* Register/unregister cost with many timeouts pending. */
+
+	uint64_t start = get_cycle();
+	for (size_t i = 0; i < PENDING; i++) {
+		timeout_initialize(&tts[i].timeout);
+		timeout_register(&tts[i].timeout,
+		    1000000000 + random(1000000000), handler, &tts[i]);
+	}
+	uint64_t reg_cycles = get_cycle() - start;
+
+	start = get_cycle();
+	size_t unregistered = 0;
+	for (size_t i = 0; i < PENDING; i++) {
+		if (timeout_unregister(&tts[i].timeout))
+			unregistered++;
+	}
+	uint64_t unreg_cycles = get_cycle() - start;
+
+	TPRINTF("Registered %d timeouts in %" PRIu64 " cycles (%" PRIu64
+	    " per timeout)\n", PENDING, reg_cycles, reg_cycles / PENDING);
+	TPRINTF("Unregistered %d timeouts in %" PRIu64 " cycles (%" PRIu64
+	    " per timeout)\n", PENDING, unreg_cycles, unreg_cycles / PENDING);
+
+	if (unregistered != PENDING) {
+		free(tts);
+		return "Far-future timeout fired";
+	}
+
+	/* Expiration of many timeouts. */
+
+	atomic_store(&fired, 0);
+	atomic_store(&fired_early, 0);
+
+	start = get_cycle();
+	for (size_t i = 0; i < PENDING; i++) {
+		timeout_initialize(&tts[i].timeout);
+		timeout_register(&tts[i].timeout, random(EXPIRE_SPREAD),
+		    handler, &tts[i]);
+	}
+	reg_cycles = get_cycle() - start;
+
+	TPRINTF("Registered %d expiring timeouts in %" PRIu64 " cycles (%"
+	    PRIu64 " per timeout)\n", PENDING, reg_cycles, reg_cycles / PENDING);
+
+	start = get_cycle();
+	for (unsigned int poll = 0; poll < EXPIRE_POLLS; poll++) {
+		if (atomic_load(&fired) == PENDING)
+			break;
+
+		thread_usleep(EXPIRE_SPREAD / 10);
+	}
+	uint64_t expire_cycles = get_cycle() - start;
+
+	size_t count = atomic_load(&fired);
+	TPRINTF("%zu timeouts fired within %" PRIu64 " cycles\n", count,
+	    expire_cycles);
+
+	/* Make sure no handler can run after the array is gone. */
+	for (size_t i = 0; i < PENDING; i++)
+		timeout_unregister(&tts[i].timeout);
+
+	free(tts);
+
+	if (count != PENDING)
+		return "Not all timeouts fired";
+
+	if (atomic_load(&fired_early) != 0)
+		return "Timeout fired before its deadline";
+
+	return NULL;
+}
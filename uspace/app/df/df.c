@@ -50,10 +50,12 @@
 
 #define HEADER_TABLE     "Filesystem           Size           Used      Available Used%% Mounted on"
 #define HEADER_TABLE_BLK "Filesystem  Blk. Size     Total        Used   Available Used%% Mounted on"
+#define HEADER_TABLE_CACHE "Filesystem        Hits      Misses   Evictions Hit%% Mounted on"
 
 #define PERCENTAGE(x, tot) (tot ? (100ULL * (x) / (tot)) : 0)
 
 static bool display_blocks;
+static bool display_cache;
 
 static errno_t size_to_human_readable(uint64_t, size_t, char **);
 static void print_header(void);
@@ -67,9 +69,10 @@ int main(int argc, char *argv[])
 	errno_t rc;
 
 	display_blocks = false;
+	display_cache = false;
 
 	/* Parse command-line options */
-	while ((optres = getopt(argc, argv, "ubh")) != -1) {
+	while ((optres = getopt(argc, argv, "ubch")) != -1) {
 		switch (optres) {
 		case 'h':
 			print_usage();
@@ -79,6 +82,10 @@ int main(int argc, char *argv[])
 			display_blocks = true;
 			break;
 
+		case 'c':
+			display_cache = true;
+			break;
+
 		case '?':
 			fprintf(stderr, "Unrecognized option: -%c\n", optopt);
 			errflg++;
@@ -132,7 +139,9 @@ static errno_t size_to_human_readable(uint64_t nblocks, size_t block_size, char
 
 static void print_header(void)
 {
-	if (!display_blocks)
+	if (display_cache)
+		printf(HEADER_TABLE_CACHE);
+	else if (!display_blocks)
 		printf(HEADER_TABLE);
 	else
 		printf(HEADER_TABLE_BLK);
@@ -149,7 +158,13 @@ static errno_t print_statfs(vfs_statfs_t *st, char *name, char *mountpoint)
 
 	printf("%10s", name);
 
-	if (!display_blocks) {
+	if (display_cache) {
+		/* Hits / Misses / Evictions / Hit% / Mounted on */
+		uint64_t const accesses = st->f_chits + st->f_cmisses;
+		printf(" %11" PRIu64 " %11" PRIu64 " %11" PRIu64 " %3u%% %s\n",
+		    st->f_chits, st->f_cmisses, st->f_cevicts,
+		    (unsigned) PERCENTAGE(st->f_chits, accesses), mountpoint);
+	} else if (!display_blocks) {
 		/* Print size */
 		rc = size_to_human_readable(st->f_blocks, st->f_bsize, &str);
 		if (rc != EOK)
@@ -195,6 +210,7 @@ static void print_usage(void)
 	printf("Options:\n");
 	printf("  -h Print help\n");
 	printf("  -b Print exact block sizes and numbers\n");
+	printf("  -c Print block cache statistics\n");
 }
 
 /** @}
@@ -47,6 +47,7 @@
 #include <stdlib.h>
 #include <str.h>
 #include <task.h>
+#include <time.h>
 #include <ui/ui.h>
 #include <ui/window.h>
 #include <ui/wdecor.h>
@@ -1272,6 +1273,161 @@ static errno_t demo_display(const char *display_svc)
 	return EOK;
 }
 
+/** Number of rectangles to fill in one benchmark run */
+#define BENCH_RECTS 20000
+
+/** Measure rectangle fill rate.
+ *
+ * Fill a number of small rectangles, changing color every ten rectangles,
+ * then update the display. This is a rough model of UI painting.
+ *
+ * @param gc Graphic context
+ * @param w Width
+ * @param h Height
+ * @param rrate Place to store number of rectangles per second
+ * @return EOK on success or an error code
+ */
+static errno_t bench_rects(gfx_context_t *gc, gfx_coord_t w, gfx_coord_t h,
+    unsigned *rrate)
+{
+	gfx_color_t *color[10];
+	gfx_rect_t rect;
+	struct timespec t0, t1;
+	nsec_t dt;
+	int i;
+	errno_t rc;
+
+	for (i = 0; i < 10; i++)
+		color[i] = NULL;
+
+	for (i = 0; i < 10; i++) {
+		rc = gfx_color_new_rgb_i16(rand() % 0x10000,
+		    rand() % 0x10000, rand() % 0x10000, &color[i]);
+		if (rc != EOK)
+			goto error;
+	}
+
+	rc = clear_scr(gc, w, h);
+	if (rc != EOK)
+		goto error;
+
+	rc = gfx_update(gc);
+	if (rc != EOK)
+		goto error;
+
+	getuptime(&t0);
+
+	for (i = 0; i < BENCH_RECTS; i++) {
+		if (i % 10 == 0) {
+			rc = gfx_set_color(gc, color[(i / 10) % 10]);
+			if (rc != EOK)
+				goto error;
+		}
+
+		rect.p0.x = rand() % (w - 16);
+		rect.p0.y = rand() % (h - 16);
+		rect.p1.x = rect.p0.x + 1 + rand() % 16;
+		rect.p1.y = rect.p0.y + 1 + rand() % 16;
+
+		rc = gfx_fill_rect(gc, &rect);
+		if (rc != EOK)
+			goto error;
+	}
+
+	rc = gfx_update(gc);
+	if (rc != EOK)
+		goto error;
+
+	getuptime(&t1);
+	dt = ts_sub_diff(&t1, &t0);
+	if (dt <= 0)
+		dt = 1;
+
+	*rrate = SEC2NSEC((uint64_t) BENCH_RECTS) / dt;
+
+	for (i = 0; i < 10; i++)
+		gfx_color_delete(color[i]);
+	return EOK;
+error:
+	for (i = 0; i < 10; i++) {
+		if (color[i] != NULL)
+			gfx_color_delete(color[i]);
+	}
+	return rc;
+}
+
+/** Run rectangle fill benchmark on display server.
+ *
+ * Compare fill rate with and without command batching.
+ */
+static errno_t demo_bench(const char *display_svc)
+{
+	display_t *display = NULL;
+	gfx_context_t *gc;
+	display_wnd_params_t params;
+	display_window_t *window = NULL;
+	unsigned rate;
+	errno_t rc;
+
+	rc = display_open(display_svc, &display);
+	if (rc != EOK) {
+		printf("Error opening display.\n");
+		return rc;
+	}
+
+	display_wnd_params_init(&params);
+	params.rect.p0.x = 0;
+	params.rect.p0.y = 0;
+	params.rect.p1.x = 400;
+	params.rect.p1.y = 300;
+	params.caption = "GFX Benchmark";
+
+	rc = display_window_create(display, &params, &wnd_cb, NULL, &window);
+	if (rc != EOK) {
+		printf("Error creating window.\n");
+		goto error;
+	}
+
+	rc = display_window_get_gc(window, &gc);
+	if (rc != EOK) {
+		printf("Error getting graphics context.\n");
+		goto error;
+	}
+
+	rc = bench_rects(gc, 400, 300, &rate);
+	if (rc != EOK) {
+		printf("Error running benchmark.\n");
+		goto error;
+	}
+
+	printf("Unbatched: %u rects/s\n", rate);
+	(void) gfx_context_delete(gc);
+
+	rc = display_window_get_batch_gc(window, &gc);
+	if (rc != EOK) {
+		printf("Error getting graphics context.\n");
+		goto error;
+	}
+
+	rc = bench_rects(gc, 400, 300, &rate);
+	if (rc != EOK) {
+		printf("Error running benchmark.\n");
+		goto error;
+	}
+
+	printf("Batched: %u rects/s\n", rate);
+	(void) gfx_context_delete(gc);
+
+	display_window_destroy(window);
+	display_close(display);
+	return EOK;
+error:
+	if (window != NULL)
+		display_window_destroy(window);
+	display_close(display);
+	return rc;
+}
+
 static void demo_quit(void)
 {
 	fibril_mutex_lock(&quit_lock);
@@ -1326,7 +1482,7 @@ static void uiwnd_kbd_event(ui_window_t *window, void *arg, kbd_event_t *event)
 
 static void print_syntax(void)
 {
-	printf("Syntax: gfxdemo [-d <display>] {console|display|ui}\n");
+	printf("Syntax: gfxdemo [-d <display>] {console|display|ui|bench}\n");
 }
 
 int main(int argc, char *argv[])
@@ -1366,6 +1522,10 @@ int main(int argc, char *argv[])
 		rc = demo_display(display_svc);
 		if (rc != EOK)
 			return 1;
+	} else if (str_cmp(argv[i], "bench") == 0) {
+		rc = demo_bench(display_svc);
+		if (rc != EOK)
+			return 1;
 	} else {
 		print_syntax();
 		return 1;
@@ -38,6 +38,7 @@
 #include "hbench.h"
 
 benchmark_t *benchmarks[] = {
+	&benchmark_dir_lookup,
 	&benchmark_dir_read,
 	&benchmark_fibril_mutex,
 	&benchmark_file_read,
@@ -45,11 +46,18 @@ benchmark_t *benchmarks[] = {
 	&benchmark_seq_read,
 	&benchmark_malloc1,
 	&benchmark_malloc2,
+	&benchmark_malloc3,
+	&benchmark_malloc4,
 	&benchmark_ns_ping,
+	&benchmark_ping_batch,
 	&benchmark_ping_pong,
 	&benchmark_read1k,
+	&benchmark_read1k_ring,
+	&benchmark_route_lookup,
 	&benchmark_taskgetid,
+	&benchmark_udp_echo,
 	&benchmark_write1k,
+	&benchmark_write1k_ring,
 };
 
 size_t benchmark_count = sizeof(benchmarks) / sizeof(benchmarks[0]);
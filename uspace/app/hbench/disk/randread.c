@@ -32,6 +32,7 @@
 
 #include <block.h>
 #include <loc.h>
+#include <str.h>
 #include <str_error.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -42,6 +43,8 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 {
 	const char *disk;
 	const char *nbstr;
+	const char *ringstr;
+	bool ring;
 	service_id_t svcid;
 	size_t block_size;
 	aoff64_t dev_nblocks;
@@ -66,6 +69,10 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 		goto error;
 	}
 
+	/* With ring=1 the blocks are transferred through a request ring. */
+	ringstr = bench_env_param_get(env, "ring", "0");
+	ring = str_cmp(ringstr, "0") != 0;
+
 	rc = loc_service_get_id(disk, &svcid, 0);
 	if (rc != EOK) {
 		bench_run_fail(run, "failed resolving device '%s'", disk);
@@ -98,6 +105,15 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 		goto error;
 	}
 
+	if (ring) {
+		rc = block_ring_init(svcid);
+		if (rc != EOK) {
+			bench_run_fail(run, "failed setting up request ring: %s",
+			    str_error(rc));
+			goto error;
+		}
+	}
+
 	buf = malloc(block_size * nb);
 	if (buf == NULL) {
 		bench_run_fail(run, "failed to allocate buffer (%zu bytes)",
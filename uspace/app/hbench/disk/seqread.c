@@ -32,6 +32,8 @@
 
 #include <block.h>
 #include <loc.h>
+#include <mem.h>
+#include <str.h>
 #include <str_error.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -42,6 +44,11 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 {
 	const char *disk;
 	const char *nbstr;
+	const char *cachestr;
+	block_t *block;
+	bool cached;
+	const char *ringstr;
+	bool ring;
 	service_id_t svcid;
 	size_t block_size;
 	aoff64_t dev_nblocks;
@@ -66,6 +73,17 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 		goto error;
 	}
 
+	/*
+	 * With cache=1 the blocks are read through the block cache,
+	 * which reads ahead of sequential readers.
+	 */
+	cachestr = bench_env_param_get(env, "cache", "0");
+	cached = str_cmp(cachestr, "0") != 0;
+
+	/* With ring=1 the blocks are transferred through a request ring. */
+	ringstr = bench_env_param_get(env, "ring", "0");
+	ring = str_cmp(ringstr, "0") != 0;
+
 	rc = loc_service_get_id(disk, &svcid, 0);
 	if (rc != EOK) {
 		bench_run_fail(run, "failed resolving device '%s'", disk);
@@ -98,6 +116,23 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 		goto error;
 	}
 
+	if (ring) {
+		rc = block_ring_init(svcid);
+		if (rc != EOK) {
+			bench_run_fail(run, "failed setting up request ring: %s",
+			    str_error(rc));
+			goto error;
+		}
+	}
+
+	if (cached) {
+		rc = block_cache_init(svcid, block_size, 0, CACHE_MODE_WT);
+		if (rc != EOK) {
+			bench_run_fail(run, "failed initializing block cache.");
+			goto error;
+		}
+	}
+
 	buf = malloc(block_size);
 	if (buf == NULL) {
 		bench_run_fail(run, "failed to allocate buffer (%zu bytes)",
@@ -109,7 +144,15 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 	for (i = 0; i < size; i++) {
 		baddr = i % (dev_nblocks - nb + 1);
 
-		rc = block_read_direct(svcid, baddr, 1, buf);
+		if (cached) {
+			rc = block_get(&block, svcid, baddr, BLOCK_FLAGS_NONE);
+			if (rc == EOK) {
+				memcpy(buf, block->data, block_size);
+				rc = block_put(block);
+			}
+		} else {
+			rc = block_read_direct(svcid, baddr, 1, buf);
+		}
 		if (rc != EOK) {
 			bench_run_fail(run, "failed to read blocks %llu-%llu: "
 			    "%s", (unsigned long long)baddr,
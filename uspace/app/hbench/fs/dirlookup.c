@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include <vfs/vfs.h>
+#include "../hbench.h"
+
+/*
+ * Measures latency of looking up names in a directory of a given size.
+ * The setup creates directory 'dirname' with 'entries' empty files, the
+ * benchmark then stats them in pseudo-random order. Every other lookup
+ * is for a name that does not exist.
+ *
+ * The default directory is on the root file system (ext4 in the default
+ * configurations). Note that /tmp is tmpfs, which keeps its directories
+ * in memory anyway.
+ */
+
+static const char *dir_path;
+static unsigned entry_count;
+static unsigned entries_created;
+static bool dir_created;
+
+/** Pseudo-random number generator cheap enough not to skew the results */
+static uint32_t lookup_rand(uint32_t *state)
+{
+	*state = *state * 1103515245U + 12345U;
+	return *state >> 8;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *countstr;
+	char path[256];
+	unsigned i;
+	errno_t rc;
+
+	dir_path = bench_env_param_get(env, "dirname", "/data/hbench-lookup");
+	countstr = bench_env_param_get(env, "entries", "1000");
+	if (sscanf(countstr, "%u", &entry_count) < 1 || entry_count == 0)
+		return bench_run_fail(run, "'entries' must be a positive number.");
+
+	rc = vfs_link_path(dir_path, KIND_DIRECTORY, NULL);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed to create %s: %s",
+		    dir_path, str_error(rc));
+	}
+
+	dir_created = true;
+
+	for (i = 0; i < entry_count; i++) {
+		snprintf(path, sizeof(path), "%s/file%u", dir_path, i);
+		rc = vfs_link_path(path, KIND_FILE, NULL);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed to create %s: %s",
+			    path, str_error(rc));
+		}
+
+		entries_created++;
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	char path[256];
+	unsigned i;
+
+	for (i = 0; i < entries_created; i++) {
+		snprintf(path, sizeof(path), "%s/file%u", dir_path, i);
+		(void) vfs_unlink_path(path);
+	}
+
+	entries_created = 0;
+
+	if (dir_created) {
+		(void) vfs_unlink_path(dir_path);
+		dir_created = false;
+	}
+
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	uint32_t state = 1;
+	char path[256];
+	vfs_stat_t st;
+	unsigned idx;
+	uint64_t i;
+	errno_t rc;
+
+	bench_run_start(run);
+	for (i = 0; i < size; i++) {
+		idx = lookup_rand(&state) % entry_count;
+
+		if ((i % 2) == 0) {
+			snprintf(path, sizeof(path), "%s/file%u", dir_path, idx);
+			rc = vfs_stat_path(path, &st);
+			if (rc != EOK) {
+				bench_run_stop(run);
+				return bench_run_fail(run, "failed to stat %s: %s",
+				    path, str_error(rc));
+			}
+		} else {
+			snprintf(path, sizeof(path), "%s/missing%u", dir_path, idx);
+			rc = vfs_stat_path(path, &st);
+			if (rc != ENOENT) {
+				bench_run_stop(run);
+				return bench_run_fail(run, "unexpected result for %s: %s",
+				    path, str_error(rc));
+			}
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_dir_lookup = {
+	.name = "dir_lookup",
+	.desc = "Look up names in a directory (set 'dirname' and 'entries').",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
@@ -131,6 +131,7 @@ extern benchmark_t *benchmarks[];
 extern size_t benchmark_count;
 
 /* Put your benchmark descriptors here (and also to benchlist.c). */
+extern benchmark_t benchmark_dir_lookup;
 extern benchmark_t benchmark_dir_read;
 extern benchmark_t benchmark_fibril_mutex;
 extern benchmark_t benchmark_file_read;
@@ -138,11 +139,18 @@ extern benchmark_t benchmark_rand_read;
 extern benchmark_t benchmark_seq_read;
 extern benchmark_t benchmark_malloc1;
 extern benchmark_t benchmark_malloc2;
+extern benchmark_t benchmark_malloc3;
+extern benchmark_t benchmark_malloc4;
 extern benchmark_t benchmark_ns_ping;
+extern benchmark_t benchmark_ping_batch;
 extern benchmark_t benchmark_ping_pong;
 extern benchmark_t benchmark_read1k;
+extern benchmark_t benchmark_read1k_ring;
+extern benchmark_t benchmark_route_lookup;
 extern benchmark_t benchmark_taskgetid;
+extern benchmark_t benchmark_udp_echo;
 extern benchmark_t benchmark_write1k;
+extern benchmark_t benchmark_write1k_ring;
 
 #endif
 
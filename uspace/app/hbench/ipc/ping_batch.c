@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <ipc_test.h>
+#include <async.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Same as ping_pong, but the pings are made by several fibrils at once,
+ * each over its own session. With more than one fibril ready, the async
+ * framework submits the requests and collects the answers in batches,
+ * so the result can be compared with ping_pong to see the difference in
+ * messages per second.
+ */
+
+typedef struct {
+	ipc_test_t *test;
+	uint64_t niter;
+	errno_t rc;
+} worker_t;
+
+static worker_t *workers = NULL;
+static size_t nworkers = 0;
+
+static FIBRIL_MUTEX_INITIALIZE(done_lock);
+static FIBRIL_CONDVAR_INITIALIZE(done_cv);
+static size_t done_count;
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	for (size_t i = 0; i < nworkers; i++)
+		ipc_test_destroy(workers[i].test);
+
+	free(workers);
+	workers = NULL;
+	nworkers = 0;
+	return true;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *fibrils = bench_env_param_get(env, "fibrils", "8");
+	size_t count;
+
+	int nitem = sscanf(fibrils, "%zu", &count);
+	if ((nitem < 1) || (count == 0))
+		return bench_run_fail(run, "'fibrils' must be a positive number.");
+
+	workers = calloc(count, sizeof(worker_t));
+	if (workers == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	for (nworkers = 0; nworkers < count; nworkers++) {
+		errno_t rc = ipc_test_create(&workers[nworkers].test);
+		if (rc != EOK) {
+			teardown(env, run);
+			return bench_run_fail(run,
+			    "failed contacting IPC test server (have you run /srv/test/ipc-test?): %s (%d)",
+			    str_error(rc), rc);
+		}
+	}
+
+	return true;
+}
+
+static errno_t worker_fn(void *arg)
+{
+	worker_t *worker = arg;
+
+	worker->rc = EOK;
+	for (uint64_t count = 0; count < worker->niter; count++) {
+		errno_t rc = ipc_test_ping(worker->test);
+		if (rc != EOK) {
+			worker->rc = rc;
+			break;
+		}
+	}
+
+	fibril_mutex_lock(&done_lock);
+	done_count++;
+	fibril_condvar_broadcast(&done_cv);
+	fibril_mutex_unlock(&done_lock);
+
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	fid_t *fids = calloc(nworkers, sizeof(fid_t));
+	if (fids == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	for (size_t i = 0; i < nworkers; i++) {
+		workers[i].niter = niter / nworkers;
+		if (i < niter % nworkers)
+			workers[i].niter++;
+
+		fids[i] = fibril_create(worker_fn, &workers[i]);
+		if (fids[i] == 0) {
+			for (size_t j = 0; j < i; j++)
+				fibril_destroy(fids[j]);
+			free(fids);
+			return bench_run_fail(run, "failed creating fibril");
+		}
+	}
+
+	done_count = 0;
+
+	bench_run_start(run);
+
+	for (size_t i = 0; i < nworkers; i++)
+		fibril_add_ready(fids[i]);
+
+	fibril_mutex_lock(&done_lock);
+	while (done_count < nworkers)
+		fibril_condvar_wait(&done_cv, &done_lock);
+	fibril_mutex_unlock(&done_lock);
+
+	bench_run_stop(run);
+
+	free(fids);
+
+	for (size_t i = 0; i < nworkers; i++) {
+		errno_t rc = workers[i].rc;
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed sending ping message: %s (%d)",
+			    str_error(rc), rc);
+		}
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_ping_batch = {
+	.name = "ping_batch",
+	.desc = "IPC ping-pong benchmark with concurrent fibrils (param 'fibrils')",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
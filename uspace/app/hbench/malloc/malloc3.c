@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "../hbench.h"
+
+/*
+ * Allocate and free blocks of mixed sizes in random order, keeping
+ * a window of live blocks. Most of the blocks are small, but some go
+ * up to several kilobytes, so both the small-block caches and the
+ * general heap are exercised.
+ */
+
+enum {
+	window_size = 256
+};
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	void *window[window_size] = { NULL };
+	uint32_t seed = 1;
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		/* Linear congruential generator (Numerical Recipes) */
+		seed = seed * 1664525 + 1013904223;
+
+		size_t slot = (seed >> 16) % window_size;
+		size_t size = 1 + (seed >> 4) % (16 << (seed % 9));
+
+		free(window[slot]);
+		window[slot] = malloc(size);
+		if (window[slot] == NULL) {
+			for (size_t i = 0; i < window_size; i++)
+				free(window[i]);
+			return bench_run_fail(run,
+			    "failed to allocate %zuB in run %" PRIu64 " (out of %" PRIu64 ")",
+			    size, count, niter);
+		}
+	}
+
+	for (size_t i = 0; i < window_size; i++)
+		free(window[i]);
+
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_malloc3 = {
+	.name = "malloc3",
+	.desc = "User-space memory allocator benchmark, allocate and free blocks of mixed sizes",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../hbench.h"
+
+/*
+ * Allocate and free small blocks from several threads at once. The work
+ * is split among fibrils which run on the given number of threads, so the
+ * result shows how the allocator scales when there is contention.
+ */
+
+enum {
+	window_size = 16
+};
+
+typedef struct {
+	uint64_t niter;
+	bool failed;
+} worker_t;
+
+static FIBRIL_MUTEX_INITIALIZE(done_lock);
+static FIBRIL_CONDVAR_INITIALIZE(done_cv);
+static size_t done_count;
+
+/** Number of threads running fibrils (including the main one) */
+static size_t nthreads = 1;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *threads = bench_env_param_get(env, "threads", "4");
+	size_t count;
+
+	int nitem = sscanf(threads, "%zu", &count);
+	if ((nitem < 1) || (count == 0))
+		return bench_run_fail(run, "'threads' must be a positive number.");
+
+	if (count > nthreads) {
+		nthreads += fibril_test_spawn_runners(count - nthreads);
+		if (nthreads < count)
+			return bench_run_fail(run, "failed creating threads");
+	}
+
+	return true;
+}
+
+static errno_t worker_fn(void *arg)
+{
+	worker_t *worker = arg;
+	void *window[window_size] = { NULL };
+
+	worker->failed = false;
+	for (uint64_t count = 0; count < worker->niter; count++) {
+		size_t slot = count % window_size;
+		size_t size = 16 + 16 * (count % 8);
+
+		free(window[slot]);
+		window[slot] = malloc(size);
+		if (window[slot] == NULL) {
+			worker->failed = true;
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < window_size; i++)
+		free(window[i]);
+
+	fibril_mutex_lock(&done_lock);
+	done_count++;
+	fibril_condvar_broadcast(&done_cv);
+	fibril_mutex_unlock(&done_lock);
+
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	size_t nworkers = nthreads;
+
+	worker_t *workers = calloc(nworkers, sizeof(worker_t));
+	fid_t *fids = calloc(nworkers, sizeof(fid_t));
+	if (workers == NULL || fids == NULL) {
+		free(workers);
+		free(fids);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	for (size_t i = 0; i < nworkers; i++) {
+		workers[i].niter = niter / nworkers;
+		if (i < niter % nworkers)
+			workers[i].niter++;
+
+		fids[i] = fibril_create(worker_fn, &workers[i]);
+		if (fids[i] == 0) {
+			for (size_t j = 0; j < i; j++)
+				fibril_destroy(fids[j]);
+			free(workers);
+			free(fids);
+			return bench_run_fail(run, "failed creating fibril");
+		}
+	}
+
+	done_count = 0;
+
+	bench_run_start(run);
+
+	for (size_t i = 0; i < nworkers; i++)
+		fibril_add_ready(fids[i]);
+
+	fibril_mutex_lock(&done_lock);
+	while (done_count < nworkers)
+		fibril_condvar_wait(&done_cv, &done_lock);
+	fibril_mutex_unlock(&done_lock);
+
+	bench_run_stop(run);
+
+	bool failed = false;
+	for (size_t i = 0; i < nworkers; i++)
+		failed = failed || workers[i].failed;
+
+	free(workers);
+	free(fids);
+
+	if (failed)
+		return bench_run_fail(run, "failed to allocate memory");
+
+	return true;
+}
+
+benchmark_t benchmark_malloc4 = {
+	.name = "malloc4",
+	.desc = "User-space memory allocator benchmark, allocate and free from several threads",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <inet/rtable.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * Measures longest-prefix-match lookups in a routing table, as done by
+ * the internet server for every outgoing packet. The table is filled with
+ * 'routes' random IPv4 prefixes (plus a default route) and looked up
+ * with random destination addresses.
+ */
+
+/** Routing table entry */
+typedef struct {
+	inet_rtable_entry_t entry;
+	inet_naddr_t dest;
+} route_t;
+
+static inet_rtable_t rtable;
+static route_t *routes;
+static unsigned route_count;
+
+/** Pseudo-random number generator cheap enough not to skew the results */
+static uint32_t route_rand(uint32_t *state)
+{
+	*state = *state * 1103515245U + 12345U;
+	return *state;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *countstr;
+	uint32_t state = 1;
+	unsigned i;
+	errno_t rc;
+
+	countstr = bench_env_param_get(env, "routes", "10000");
+	if (sscanf(countstr, "%u", &route_count) < 1)
+		return bench_run_fail(run, "'routes' must be a number.");
+
+	/* One more for the default route */
+	routes = calloc(route_count + 1, sizeof(route_t));
+	if (routes == NULL)
+		return bench_run_fail(run, "failed to allocate %u routes",
+		    route_count);
+
+	inet_rtable_init(&rtable);
+
+	for (i = 0; i <= route_count; i++) {
+		if (i == route_count) {
+			inet_naddr_set(0, 0, &routes[i].dest);
+		} else {
+			/* Prefix lengths typical of a routing table */
+			inet_naddr_set(route_rand(&state),
+			    16 + route_rand(&state) % 17, &routes[i].dest);
+		}
+
+		rc = inet_rtable_insert(&rtable, &routes[i].dest,
+		    &routes[i].entry, &routes[i]);
+		if (rc != EOK) {
+			route_count = i;
+			return bench_run_fail(run, "failed to insert route");
+		}
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	unsigned i;
+
+	if (routes == NULL)
+		return true;
+
+	for (i = 0; i <= route_count; i++) {
+		if (routes[i].entry.node != NULL)
+			inet_rtable_remove(&rtable, &routes[i].entry);
+	}
+
+	inet_rtable_fini(&rtable);
+	free(routes);
+	routes = NULL;
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	uint32_t state = 2;
+	inet_addr_t addr;
+	route_t *route;
+	uint64_t i;
+
+	bench_run_start(run);
+	for (i = 0; i < size; i++) {
+		inet_addr_set(route_rand(&state), &addr);
+		route = inet_rtable_lookup(&rtable, &addr);
+		if (route == NULL) {
+			bench_run_stop(run);
+			return bench_run_fail(run, "no route found");
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_route_lookup = {
+	.name = "route_lookup",
+	.desc = "Routing table lookups (set 'routes' to the table size).",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
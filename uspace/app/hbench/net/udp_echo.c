@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <byteorder.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <inet/endpoint.h>
+#include <inet/hostport.h>
+#include <inet/udp.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Measures how many UDP datagrams per second we can push through the
+ * network stack and the NIC driver. Datagrams are sent to the 'dest'
+ * host:port, which should run an echo service (e.g. on the host side of
+ * a QEMU user-mode or tap link). Up to 'window' datagrams are in flight
+ * at any time. With echo=0 the replies are not awaited and only the
+ * transmit path is measured.
+ */
+
+/** How long to wait for an echo before considering datagrams lost */
+#define ECHO_TIMEOUT_USEC (1000 * 1000)
+
+/** Header of each datagram */
+typedef struct {
+	/** Identifies the run the datagram belongs to */
+	uint32_t run_id;
+	/** Sequence number within the run */
+	uint32_t seq;
+} udp_echo_hdr_t;
+
+static udp_t *udp;
+static udp_assoc_t *assoc;
+
+static FIBRIL_MUTEX_INITIALIZE(echo_lock);
+static FIBRIL_CONDVAR_INITIALIZE(echo_cv);
+static uint32_t echo_run_id;
+static uint64_t echo_received;
+
+static void udp_echo_recv_msg(udp_assoc_t *assoc, udp_rmsg_t *rmsg)
+{
+	udp_echo_hdr_t hdr;
+	errno_t rc;
+
+	if (udp_rmsg_size(rmsg) < sizeof(hdr))
+		return;
+
+	rc = udp_rmsg_read(rmsg, 0, &hdr, sizeof(hdr));
+	if (rc != EOK)
+		return;
+
+	fibril_mutex_lock(&echo_lock);
+	/* Ignore late echoes from previous runs */
+	if (uint32_t_be2host(hdr.run_id) == echo_run_id) {
+		++echo_received;
+		fibril_condvar_broadcast(&echo_cv);
+	}
+	fibril_mutex_unlock(&echo_lock);
+}
+
+static void udp_echo_recv_err(udp_assoc_t *assoc, udp_rerr_t *rerr)
+{
+}
+
+static void udp_echo_link_state(udp_assoc_t *assoc, udp_link_state_t lstate)
+{
+}
+
+static udp_cb_t udp_echo_cb = {
+	.recv_msg = udp_echo_recv_msg,
+	.recv_err = udp_echo_recv_err,
+	.link_state = udp_echo_link_state
+};
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *dest;
+	const char *errmsg;
+	inet_ep2_t epp;
+	errno_t rc;
+
+	dest = bench_env_param_get(env, "dest", NULL);
+	if (dest == NULL)
+		return bench_run_fail(run, "You must specify 'dest' parameter.");
+
+	inet_ep2_init(&epp);
+	rc = inet_hostport_plookup_one(dest, ip_any, &epp.remote, NULL,
+	    &errmsg);
+	if (rc != EOK)
+		return bench_run_fail(run, "%s (host:port %s)", errmsg, dest);
+
+	rc = udp_create(&udp);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed connecting to UDP service: "
+		    "%s", str_error(rc));
+	}
+
+	rc = udp_assoc_create(udp, &epp, &udp_echo_cb, NULL, &assoc);
+	if (rc != EOK) {
+		udp_destroy(udp);
+		udp = NULL;
+		return bench_run_fail(run, "failed creating association: %s",
+		    str_error(rc));
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	udp_assoc_destroy(assoc);
+	assoc = NULL;
+	udp_destroy(udp);
+	udp = NULL;
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	const char *lenstr;
+	const char *wndstr;
+	const char *echostr;
+	udp_echo_hdr_t *hdr;
+	unsigned length;
+	unsigned window;
+	bool echo;
+	uint64_t sent;
+	uint64_t lost;
+	uint64_t received;
+	char *buf;
+	errno_t rc;
+
+	lenstr = bench_env_param_get(env, "length", "64");
+	if (sscanf(lenstr, "%u", &length) < 1 || length < sizeof(*hdr))
+		return bench_run_fail(run, "'length' must be at least %zu.",
+		    sizeof(*hdr));
+
+	wndstr = bench_env_param_get(env, "window", "32");
+	if (sscanf(wndstr, "%u", &window) < 1 || window < 1)
+		return bench_run_fail(run, "'window' must be a positive number.");
+
+	echostr = bench_env_param_get(env, "echo", "1");
+	echo = str_cmp(echostr, "0") != 0;
+
+	buf = calloc(1, length);
+	if (buf == NULL)
+		return bench_run_fail(run, "failed to allocate buffer (%u bytes)",
+		    length);
+
+	hdr = (udp_echo_hdr_t *) buf;
+
+	fibril_mutex_lock(&echo_lock);
+	++echo_run_id;
+	echo_received = 0;
+	hdr->run_id = host2uint32_t_be(echo_run_id);
+	fibril_mutex_unlock(&echo_lock);
+
+	sent = 0;
+	lost = 0;
+	received = 0;
+
+	bench_run_start(run);
+	while ((echo ? received + lost : sent) < size) {
+		/* Fill the window */
+		while (sent < size && (!echo || sent - received - lost < window)) {
+			hdr->seq = host2uint32_t_be(sent);
+			rc = udp_assoc_send_msg(assoc, NULL, buf, length);
+			if (rc != EOK) {
+				bench_run_stop(run);
+				free(buf);
+				return bench_run_fail(run, "failed sending "
+				    "datagram: %s", str_error(rc));
+			}
+
+			++sent;
+		}
+
+		if (!echo)
+			continue;
+
+		fibril_mutex_lock(&echo_lock);
+		rc = EOK;
+		while (echo_received == received && rc != ETIMEOUT) {
+			rc = fibril_condvar_wait_timeout(&echo_cv, &echo_lock,
+			    ECHO_TIMEOUT_USEC);
+		}
+		received = echo_received;
+		fibril_mutex_unlock(&echo_lock);
+
+		if (rc == ETIMEOUT) {
+			if (received == 0) {
+				bench_run_stop(run);
+				free(buf);
+				return bench_run_fail(run, "no echo received.");
+			}
+
+			/* Give up on whatever is still in flight */
+			lost = sent - min(received, sent);
+		}
+
+		/* Late echoes of datagrams counted as lost */
+		if (received + lost > sent)
+			lost = sent - min(received, sent);
+	}
+	bench_run_stop(run);
+
+	free(buf);
+	return true;
+}
+
+benchmark_t benchmark_udp_echo = {
+	.name = "udp_echo",
+	.desc = "UDP datagrams per second (must set 'dest' parameter).",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
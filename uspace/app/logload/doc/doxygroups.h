@@ -0,0 +1,4 @@
+/** @addtogroup logload logload
+ * @brief Logger load generator
+ * @ingroup apps
+ */
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup logload
+ * @{
+ */
+/** @file Generate load on the logger and measure its throughput.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <getopt.h>
+#include <io/log.h>
+#include <perf.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+
+#define NAME "logload"
+
+/** Number of messages between checks whether to stop. */
+#define BURST 64
+
+static log_level_t level = LVL_NOTE;
+static size_t msg_size = 64;
+static char *payload;
+
+static atomic_bool stop;
+static atomic_ullong messages;
+static atomic_uint running;
+
+static errno_t generator(void *arg)
+{
+	uintptr_t id = (uintptr_t) arg;
+	unsigned long long seq = 0;
+
+	while (!atomic_load(&stop)) {
+		for (unsigned i = 0; i < BURST; i++) {
+			log_msg(LOG_DEFAULT, level, "%" PRIuPTR ":%llu %s",
+			    id, seq++, payload);
+		}
+
+		atomic_fetch_add(&messages, BURST);
+		fibril_yield();
+	}
+
+	atomic_fetch_sub(&running, 1);
+	return EOK;
+}
+
+static void print_usage(const char *progname)
+{
+	printf("Usage: %s [options]\n", progname);
+	printf("Log messages as fast as possible and report throughput.\n");
+	printf("Run several instances to load the logger from more tasks.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("  -d, --duration <s>  Seconds to run for (default 10).\n");
+	printf("  -f, --fibrils <n>   Number of logging fibrils (default 1).\n");
+	printf("  -l, --level <lvl>   Level of the messages (default note).\n");
+	printf("  -s, --size <bytes>  Size of the message payload (default 64).\n");
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned duration = 10;
+	unsigned fibrils = 1;
+
+	const char *short_options = "hd:f:l:s:";
+	struct option long_options[] = {
+		{ "duration", required_argument, NULL, 'd' },
+		{ "fibrils", required_argument, NULL, 'f' },
+		{ "help", no_argument, NULL, 'h' },
+		{ "level", required_argument, NULL, 'l' },
+		{ "size", required_argument, NULL, 's' },
+		{ 0, 0, NULL, 0 }
+	};
+
+	int opt = 0;
+	while ((opt = getopt_long(argc, argv, short_options, long_options,
+	    NULL)) > 0) {
+		switch (opt) {
+		case 'd':
+			duration = strtoul(optarg, NULL, 10);
+			if (duration == 0) {
+				fprintf(stderr, "Invalid -d argument.\n");
+				return 1;
+			}
+			break;
+		case 'f':
+			fibrils = strtoul(optarg, NULL, 10);
+			if (fibrils == 0) {
+				fprintf(stderr, "Invalid -f argument.\n");
+				return 1;
+			}
+			break;
+		case 'h':
+			print_usage(argv[0]);
+			return 0;
+		case 'l':
+			if (log_level_from_str(optarg, &level) != EOK) {
+				fprintf(stderr, "Invalid -l argument.\n");
+				return 1;
+			}
+			break;
+		case 's':
+			msg_size = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	payload = malloc(msg_size + 1);
+	if (payload == NULL) {
+		fprintf(stderr, "%s: Out of memory.\n", NAME);
+		return 2;
+	}
+	memset(payload, 'x', msg_size);
+	payload[msg_size] = '\0';
+
+	errno_t rc = log_init(NAME);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Failed to connect to logger: %s.\n", NAME,
+		    str_error(rc));
+		return 2;
+	}
+
+	printf("%s: %u fibril(s) logging %zu byte messages at level %s "
+	    "for %u s.\n", NAME, fibrils, msg_size, log_level_str(level),
+	    duration);
+
+	stopwatch_t sw;
+	stopwatch_init(&sw);
+	stopwatch_start(&sw);
+
+	for (unsigned i = 0; i < fibrils; i++) {
+		fid_t fid = fibril_create(generator, (void *) (uintptr_t) i);
+		if (fid == 0) {
+			fprintf(stderr, "%s: Failed to create fibril.\n", NAME);
+			break;
+		}
+		atomic_fetch_add(&running, 1);
+		fibril_add_ready(fid);
+	}
+
+	unsigned long long last = 0;
+	for (unsigned s = 0; s < duration; s++) {
+		fibril_usleep(1000000);
+		unsigned long long now = atomic_load(&messages);
+		printf("%s: %llu messages/s\n", NAME, now - last);
+		last = now;
+	}
+
+	atomic_store(&stop, true);
+	while (atomic_load(&running) > 0)
+		fibril_yield();
+
+	/* Include the time needed by the logger to write everything out. */
+	rc = log_sync();
+	stopwatch_stop(&sw);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Failed to sync log: %s.\n", NAME,
+		    str_error(rc));
+	}
+
+	unsigned long long total = atomic_load(&messages);
+	usec_t usec = NSEC2USEC(stopwatch_get_nanos(&sw));
+	if (usec == 0)
+		usec = 1;
+
+	printf("%s: %llu messages in %llu us, %llu messages/s sustained.\n",
+	    NAME, total, (unsigned long long) usec,
+	    total * 1000000 / usec);
+
+	return 0;
+}
+
+/** @}
+ */
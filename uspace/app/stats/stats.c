@@ -59,6 +59,7 @@ typedef enum {
 	LIST_THREADS,
 	LIST_IPCCS,
 	LIST_CPUS,
+	LIST_SLABS,
 	PRINT_LOAD,
 	PRINT_UPTIME,
 	PRINT_ARCH
@@ -193,6 +194,31 @@ static void list_cpus(void)
 	free(cpus);
 }
 
+static void list_slabs(void)
+{
+	size_t count;
+	stats_slab_t *slabs = stats_get_slabs(&count);
+
+	if (slabs == NULL) {
+		fprintf(stderr, "%s: Unable to get slab cache statistics\n",
+		    NAME);
+		return;
+	}
+
+	printf("[cache name        ] [size  ] [alloc   ] [cached  ] [magsz]"
+	    " [hits      ] [misses    ] [depot-c   ]\n");
+
+	for (size_t i = 0; i < count; i++) {
+		printf("%-20s %8" PRIu64 " %10" PRIu64 " %10" PRIu64
+		    " %7" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+		    slabs[i].name, slabs[i].size, slabs[i].allocated_objs,
+		    slabs[i].cached_objs, slabs[i].mag_size, slabs[i].mag_hits,
+		    slabs[i].mag_misses, slabs[i].depot_contention);
+	}
+
+	free(slabs);
+}
+
 static void print_load(void)
 {
 	size_t count;
@@ -367,7 +393,7 @@ static void print_arch(void)
 static void usage(const char *name)
 {
 	printf(
-	    "Usage: %s [-t task_id] [-i task_id] [-at] [-ai] [-c] [-l] [-u] [-d]\n"
+	    "Usage: %s [-t task_id] [-i task_id] [-at] [-ai] [-c] [-s] [-l] [-u] [-d]\n"
 	    "\n"
 	    "Options:\n"
 	    "\t-t task_id | --task=task_id\n"
@@ -385,6 +411,9 @@ static void usage(const char *name)
 	    "\t-c | --cpus\n"
 	    "\t\tList CPUs\n"
 	    "\n"
+	    "\t-s | --slabs\n"
+	    "\t\tList kernel slab caches\n"
+	    "\n"
 	    "\t-l | --load\n"
 	    "\t\tPrint system load\n"
 	    "\n"
@@ -468,6 +497,12 @@ int main(int argc, char *argv[])
 			continue;
 		}
 
+		/* Slab caches */
+		if ((off = arg_parse_short_long(argv[i], "-s", "--slabs")) != -1) {
+			output_toggle = LIST_SLABS;
+			continue;
+		}
+
 		/* Load */
 		if ((off = arg_parse_short_long(argv[i], "-l", "--load")) != -1) {
 			output_toggle = PRINT_LOAD;
@@ -500,6 +535,9 @@ int main(int argc, char *argv[])
 	case LIST_CPUS:
 		list_cpus();
 		break;
+	case LIST_SLABS:
+		list_slabs();
+		break;
 	case PRINT_LOAD:
 		print_load();
 		break;
@@ -116,6 +116,9 @@ const sc_desc_t syscall_desc[] = {
 
 	[SYS_KLOG] = { "klog", 5, V_ERRNO },
 	[SYS_KIO_READ] = { "kio_read", 3, V_INTEGER },
+
+	/* Batched IPC. */
+	[SYS_IPC_BATCH] = { "ipc_batch", 6, V_ERRNO },
 };
 
 const size_t syscall_desc_len = (sizeof(syscall_desc) / sizeof(sc_desc_t));
@@ -32,9 +32,11 @@
 #include <stdint.h>
 
 #include <as.h>
+#include <byteorder.h>
 #include <ddf/driver.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
+#include <macros.h>
 #include <ops/nic.h>
 #include <pci_dev_iface.h>
 #include <nic/nic.h>
@@ -56,6 +58,19 @@
 #define TX_BUF_SIZE	BUFFER_SIZE
 #define CT_BUF_SIZE	BUFFER_SIZE
 
+/**
+ * Maximum number of frames delivered in one batch. RX buffers are loaned to
+ * the received frames and only given back to the device after the batch has
+ * been delivered, so do not hold too many of them at once.
+ */
+#define RX_BATCH	(RX_BUFFERS / 2)
+
+/**
+ * Maximum number of TX buffers a single frame may occupy. Large enough for
+ * the biggest TSO frame, while leaving room in the ring for other frames.
+ */
+#define TX_CHAIN_MAX	(TX_BUFFERS / 2)
+
 static ddf_dev_ops_t virtio_net_dev_ops;
 
 static errno_t virtio_net_dev_add(ddf_dev_t *dev);
@@ -69,46 +84,198 @@ static driver_t virtio_net_driver = {
 	.driver_ops = &virtio_net_driver_ops
 };
 
-/** VirtIO net IRQ handler.
+/** Receive a frame spread over several merged RX buffers.
  *
- * @param icall IRQ event notification
- * @param arg Argument (nic_t *)
+ * Such frames cannot be loaned from a single buffer, so they are copied
+ * into a newly allocated frame.
+ *
+ * @param nic NIC
+ * @param descno First RX descriptor of the frame
+ * @param len Length of data in the first RX buffer
+ * @param nbufs Total number of RX buffers of the frame
+ * @param done Array of consumed RX descriptors to append to
+ * @param ndone Number of descriptors in @a done
+ *
+ * @return Received frame or NULL if it had to be dropped
  */
-static void virtio_net_irq_handler(ipc_call_t *icall, void *arg)
+static nic_frame_t *virtio_net_rx_merged(nic_t *nic, uint16_t descno,
+    uint32_t len, uint16_t nbufs, uint16_t *done, unsigned *ndone)
 {
-	nic_t *nic = (nic_t *)arg;
 	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	uint16_t descs[RX_BUFFERS];
+	uint32_t lens[RX_BUFFERS];
+	size_t size = len - sizeof(virtio_net_hdr_t);
 
-	uint16_t descno;
-	uint32_t len;
-	while (virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descno, &len)) {
-		virtio_net_hdr_t *hdr =
-		    (virtio_net_hdr_t *) virtio_net->rx_buf[descno];
-		if (len <= sizeof(*hdr)) {
-			ddf_msg(LVL_WARN,
-			    "RX data length too short, packet dropped");
-			virtio_virtq_produce_available(vdev, RX_QUEUE_1,
-			    descno);
-			continue;
+	if (nbufs > RX_BUFFERS) {
+		ddf_msg(LVL_WARN, "Bad number of merged RX buffers, packet "
+		    "dropped");
+
+		/*
+		 * Skip the rest of the frame so that the next frame is not
+		 * parsed from its middle and the buffers are given back.
+		 */
+		for (uint16_t i = 1; i < nbufs && *ndone < RX_BUFFERS; i++) {
+			if (!virtio_virtq_consume_used(vdev, RX_QUEUE_1,
+			    &descs[0], &lens[0]))
+				break;
+			done[(*ndone)++] = descs[0];
 		}
 
-		nic_frame_t *frame = nic_alloc_frame(nic, len - sizeof(*hdr));
-		if (frame) {
-			memcpy(frame->data, &hdr[1], len - sizeof(*hdr));
-			nic_received_frame(nic, frame);
-		} else {
-			ddf_msg(LVL_WARN,
-			    "Cannot allocate RX frame, packet dropped");
+		return NULL;
+	}
+
+	descs[0] = descno;
+	lens[0] = len;
+
+	/* The device makes all buffers of the frame used at once */
+	for (uint16_t i = 1; i < nbufs; i++) {
+		if (!virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descs[i],
+		    &lens[i])) {
+			ddf_msg(LVL_WARN, "Missing merged RX buffers, packet "
+			    "dropped");
+			return NULL;
 		}
+		done[(*ndone)++] = descs[i];
+		size += lens[i];
+	}
 
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, descno);
+	nic_frame_t *frame = nic_alloc_frame(nic, size);
+	if (!frame) {
+		ddf_msg(LVL_WARN, "Cannot allocate RX frame, packet dropped");
+		return NULL;
 	}
 
-	while (virtio_virtq_consume_used(vdev, TX_QUEUE_1, &descno, &len)) {
+	uint8_t *dst = frame->data;
+	memcpy(dst, (virtio_net_hdr_t *) virtio_net->rx_buf[descs[0]] + 1,
+	    lens[0] - sizeof(virtio_net_hdr_t));
+	dst += lens[0] - sizeof(virtio_net_hdr_t);
+	for (uint16_t i = 1; i < nbufs; i++) {
+		memcpy(dst, virtio_net->rx_buf[descs[i]], lens[i]);
+		dst += lens[i];
+	}
+
+	return frame;
+}
+
+/** Deliver received frames to the NIC framework.
+ *
+ * Frames are collected into batches of at most RX_BATCH frames. Frames
+ * which fit into a single RX buffer are not copied, the buffer is loaned
+ * to the frame. All RX buffers of a batch are given back to the device
+ * once the batch has been delivered.
+ *
+ * @param nic NIC
+ */
+static void virtio_net_rx(nic_t *nic)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	bool mrg_rxbuf = (vdev->features & VIRTIO_NET_F_MRG_RXBUF) != 0;
+	uint16_t done[RX_BUFFERS];
+	unsigned ndone;
+	unsigned nframes;
+	uint16_t descno;
+	uint32_t len;
+
+	do {
+		nic_frame_list_t *frames = nic_alloc_frame_list();
+		ndone = 0;
+		nframes = 0;
+
+		while (nframes < RX_BATCH &&
+		    virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descno, &len)) {
+			done[ndone++] = descno;
+			nframes++;
+
+			virtio_net_hdr_t *hdr =
+			    (virtio_net_hdr_t *) virtio_net->rx_buf[descno];
+			if (len <= sizeof(*hdr)) {
+				ddf_msg(LVL_WARN,
+				    "RX data length too short, packet dropped");
+				continue;
+			}
+
+			nic_frame_t *frame;
+			uint16_t nbufs = mrg_rxbuf ?
+			    uint16_t_le2host(hdr->num_buffers) : 1;
+			if (nbufs > 1) {
+				frame = virtio_net_rx_merged(nic, descno, len,
+				    nbufs, done, &ndone);
+			} else {
+				frame = nic_alloc_loaned_frame(nic, &hdr[1],
+				    len - sizeof(*hdr));
+				if (!frame) {
+					ddf_msg(LVL_WARN, "Cannot allocate RX "
+					    "frame, packet dropped");
+				}
+			}
+
+			if (!frame)
+				continue;
+
+			if (frames)
+				nic_frame_list_append(frames, frame);
+			else
+				nic_received_frame(nic, frame);
+		}
+
+		/* Frames are delivered synchronously, buffers can be reused */
+		nic_received_frame_list(nic, frames);
+		virtio_virtq_produce_available_batch(vdev, RX_QUEUE_1, done,
+		    ndone);
+	} while (nframes == RX_BATCH);
+}
+
+/** Free a chain of TX descriptors.
+ *
+ * @param virtio_net VirtIO net device
+ * @param descno First descriptor of the chain
+ */
+static void virtio_net_tx_free_chain(virtio_net_t *virtio_net, uint16_t descno)
+{
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+
+	while (descno != (uint16_t) -1U) {
+		uint16_t next = virtio_virtq_desc_get_next(vdev, TX_QUEUE_1,
+		    descno);
 		virtio_free_desc(vdev, TX_QUEUE_1, &virtio_net->tx_free_head,
 		    descno);
+		descno = next;
 	}
+}
+
+/** Reclaim TX descriptors of frames already sent by the device.
+ *
+ * @param virtio_net VirtIO net device
+ */
+static void virtio_net_tx_reclaim(virtio_net_t *virtio_net)
+{
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	uint16_t descno;
+	uint32_t len;
+
+	while (virtio_virtq_consume_used(vdev, TX_QUEUE_1, &descno, &len))
+		virtio_net_tx_free_chain(virtio_net, descno);
+}
+
+/** VirtIO net IRQ handler.
+ *
+ * @param icall IRQ event notification
+ * @param arg Argument (nic_t *)
+ */
+static void virtio_net_irq_handler(ipc_call_t *icall, void *arg)
+{
+	nic_t *nic = (nic_t *)arg;
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+
+	uint16_t descno;
+	uint32_t len;
+
+	virtio_net_rx(nic);
+	virtio_net_tx_reclaim(virtio_net);
+
 	while (virtio_virtq_consume_used(vdev, CT_QUEUE_1, &descno, &len)) {
 		virtio_free_desc(vdev, CT_QUEUE_1, &virtio_net->ct_free_head,
 		    descno);
@@ -203,7 +370,9 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 
 	/* Reset the device and negotiate the feature bits */
 	rc = virtio_device_setup_start(vdev,
-	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ);
+	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ,
+	    VIRTIO_NET_F_MRG_RXBUF | VIRTIO_NET_F_CSUM |
+	    VIRTIO_NET_F_HOST_TSO4);
 	if (rc != EOK)
 		goto fail;
 
@@ -255,6 +424,7 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 	/*
 	 * Give all RX buffers to the NIC
 	 */
+	uint16_t rx_descs[RX_BUFFERS];
 	for (unsigned i = 0; i < RX_BUFFERS; i++) {
 		/*
 		 * Associtate the buffer with the descriptor, set length and
@@ -263,13 +433,15 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 		virtio_virtq_desc_set(vdev, RX_QUEUE_1, i,
 		    virtio_net->rx_buf_p[i], RX_BUF_SIZE, VIRTQ_DESC_F_WRITE,
 		    0);
-		/*
-		 * Put the set descriptor into the available ring of the RX
-		 * queue.
-		 */
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, i);
+		rx_descs[i] = i;
 	}
 
+	/*
+	 * Put the set descriptors into the available ring of the RX queue.
+	 */
+	virtio_virtq_produce_available_batch(vdev, RX_QUEUE_1, rx_descs,
+	    RX_BUFFERS);
+
 	/*
 	 * Put all TX and CT buffers on a free list
 	 */
@@ -278,6 +450,12 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 	virtio_create_desc_free_list(vdev, CT_QUEUE_1, CT_BUFFERS,
 	    &virtio_net->ct_free_head);
 
+	/*
+	 * Sent TX buffers are reclaimed when sending further frames, we do
+	 * not need an interrupt for each of them.
+	 */
+	virtio_virtq_set_interrupt(vdev, TX_QUEUE_1, false);
+
 	/*
 	 * Read the MAC address
 	 */
@@ -330,39 +508,109 @@ static void virtio_net_uninitialize(ddf_dev_t *dev)
 	virtio_pci_dev_cleanup(&virtio_net->virtio_dev);
 }
 
-static void virtio_net_send(nic_t *nic, void *data, size_t size)
+/** Transmit a frame.
+ *
+ * Frames that do not fit into a single TX buffer (e.g. TSO frames) are
+ * spread over a chain of buffers.
+ *
+ * @param nic NIC
+ * @param data Frame data
+ * @param size Frame size in bytes
+ * @param offload Requested transmit offload or @c NULL
+ */
+static void virtio_net_xmit(nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
 {
 	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	uint16_t descs[TX_CHAIN_MAX];
 
-	if (size > sizeof(virtio_net) + TX_BUF_SIZE) {
+	size_t total = sizeof(virtio_net_hdr_t) + size;
+	unsigned nbufs = (total + TX_BUF_SIZE - 1) / TX_BUF_SIZE;
+	if (nbufs > TX_CHAIN_MAX) {
 		ddf_msg(LVL_WARN, "TX data too big, frame dropped");
 		return;
 	}
 
-	uint16_t descno = virtio_alloc_desc(vdev, TX_QUEUE_1,
-	    &virtio_net->tx_free_head);
-	if (descno == (uint16_t) -1U) {
-		ddf_msg(LVL_WARN, "No TX buffers available, frame dropped");
-		return;
+	virtio_net_tx_reclaim(virtio_net);
+
+	for (unsigned i = 0; i < nbufs; i++) {
+		descs[i] = virtio_alloc_desc(vdev, TX_QUEUE_1,
+		    &virtio_net->tx_free_head);
+		if (descs[i] == (uint16_t) -1U) {
+			while (i > 0) {
+				virtio_free_desc(vdev, TX_QUEUE_1,
+				    &virtio_net->tx_free_head, descs[--i]);
+			}
+			ddf_msg(LVL_WARN, "No TX buffers available, frame "
+			    "dropped");
+			return;
+		}
+		assert(descs[i] < TX_BUFFERS);
 	}
-	assert(descno < TX_BUFFERS);
 
-	/* Setup the packet header */
-	virtio_net_hdr_t *hdr = (virtio_net_hdr_t *) virtio_net->tx_buf[descno];
+	virtio_net_hdr_t *hdr = (virtio_net_hdr_t *) virtio_net->tx_buf[descs[0]];
 	memset(hdr, 0, sizeof(virtio_net_hdr_t));
 	hdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
-	hdr->num_buffers = 0;
 
-	/* Copy packet data into the buffer just past the header */
-	memcpy(&hdr[1], data, size);
+	if (offload != NULL && offload->csum_start != 0) {
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		hdr->csum_start = host2uint16_t_le(offload->csum_start);
+		hdr->csum_offset = host2uint16_t_le(offload->csum_offset);
+	}
+
+	if (offload != NULL && offload->gso_size != 0 &&
+	    size > offload->hdr_len + offload->gso_size) {
+		hdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+		hdr->gso_size = host2uint16_t_le(offload->gso_size);
+		hdr->hdr_len = host2uint16_t_le(offload->hdr_len);
+	}
 
 	/*
-	 * Set the descriptor, put it into the virtqueue and notify the device
+	 * The frame data only lives in the caller's buffer until we return,
+	 * so copy it into the DMA buffers just past the header.
 	 */
-	virtio_virtq_desc_set(vdev, TX_QUEUE_1, descno,
-	    virtio_net->tx_buf_p[descno], sizeof(virtio_net_hdr_t) + size, 0, 0);
-	virtio_virtq_produce_available(vdev, TX_QUEUE_1, descno);
+	uint8_t *src = data;
+	size_t left = size;
+	for (unsigned i = 0; i < nbufs; i++) {
+		size_t hsize = (i == 0) ? sizeof(virtio_net_hdr_t) : 0;
+		size_t xfer = min(left, TX_BUF_SIZE - hsize);
+
+		memcpy((uint8_t *) virtio_net->tx_buf[descs[i]] + hsize, src,
+		    xfer);
+		src += xfer;
+		left -= xfer;
+
+		virtio_virtq_desc_set(vdev, TX_QUEUE_1, descs[i],
+		    virtio_net->tx_buf_p[descs[i]], hsize + xfer,
+		    (i + 1 < nbufs) ? VIRTQ_DESC_F_NEXT : 0,
+		    (i + 1 < nbufs) ? descs[i + 1] : 0);
+	}
+
+	/* Put the chain into the virtqueue and notify the device */
+	virtio_virtq_produce_available(vdev, TX_QUEUE_1, descs[0]);
+}
+
+static void virtio_net_send(nic_t *nic, void *data, size_t size)
+{
+	virtio_net_xmit(nic, data, size, NULL);
+}
+
+static void virtio_net_send_offload(nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	uint32_t needed = NIC_OFFLOAD_TX_CSUM;
+
+	if (offload->gso_size != 0)
+		needed |= NIC_OFFLOAD_TSO4;
+
+	if ((virtio_net->offload & needed) != needed) {
+		ddf_msg(LVL_WARN, "TX offload not enabled, frame dropped");
+		return;
+	}
+
+	virtio_net_xmit(nic, data, size, offload);
 }
 
 static errno_t virtio_net_on_multicast_mode_change(nic_t *nic,
@@ -417,6 +665,7 @@ static errno_t virtio_net_dev_add(ddf_dev_t *dev)
 	ddf_fun_set_ops(fun, &virtio_net_dev_ops);
 
 	nic_set_send_frame_handler(nic, virtio_net_send);
+	nic_set_send_frame_offload_handler(nic, virtio_net_send_offload);
 	nic_set_filtering_change_handlers(nic, NULL,
 	    virtio_net_on_multicast_mode_change,
 	    virtio_net_on_broadcast_mode_change, NULL, NULL);
@@ -477,10 +726,60 @@ static errno_t virtio_net_get_operation_mode(ddf_fun_t *fun, int *speed,
 	return EOK;
 }
 
+/** Get transmit offloads supported by the device.
+ *
+ * Only offloads whose feature bits were negotiated are supported.
+ */
+static uint32_t virtio_net_offload_supported(virtio_net_t *virtio_net)
+{
+	uint32_t features = virtio_net->virtio_dev.features;
+	uint32_t supported = 0;
+
+	if ((features & VIRTIO_NET_F_CSUM) != 0) {
+		supported |= NIC_OFFLOAD_TX_CSUM;
+		if ((features & VIRTIO_NET_F_HOST_TSO4) != 0)
+			supported |= NIC_OFFLOAD_TSO4;
+	}
+
+	return supported;
+}
+
+static errno_t virtio_net_offload_probe(ddf_fun_t *fun, uint32_t *supported,
+    uint32_t *active)
+{
+	nic_t *nic = nic_get_from_ddf_fun(fun);
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+
+	*supported = virtio_net_offload_supported(virtio_net);
+	*active = virtio_net->offload;
+	return EOK;
+}
+
+static errno_t virtio_net_offload_set(ddf_fun_t *fun, uint32_t mask,
+    uint32_t active)
+{
+	nic_t *nic = nic_get_from_ddf_fun(fun);
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+
+	uint32_t offload = (virtio_net->offload & ~mask) | (active & mask);
+	if ((offload & ~virtio_net_offload_supported(virtio_net)) != 0)
+		return ENOTSUP;
+
+	/* Segmentation produces partial checksums */
+	if ((offload & NIC_OFFLOAD_TSO4) != 0 &&
+	    (offload & NIC_OFFLOAD_TX_CSUM) == 0)
+		return EINVAL;
+
+	virtio_net->offload = offload;
+	return EOK;
+}
+
 static nic_iface_t virtio_net_nic_iface = {
 	.get_device_info = virtio_net_get_device_info,
 	.get_cable_state = virtio_net_get_cable_state,
 	.get_operation_mode = virtio_net_get_operation_mode,
+	.offload_probe = virtio_net_offload_probe,
+	.offload_set = virtio_net_offload_set,
 };
 
 int main(void)
@@ -33,8 +33,8 @@
 #include <abi/cap.h>
 #include <nic/nic.h>
 
-#define RX_BUFFERS	8
-#define TX_BUFFERS	8
+#define RX_BUFFERS	64
+#define TX_BUFFERS	128
 #define CT_BUFFERS	4
 
 /** Device handles packets with partial checksum. */
@@ -43,10 +43,18 @@
 #define VIRTIO_NET_F_GUEST_CSUM		(1U << 2)
 /** Device has given MAC address. */
 #define VIRTIO_NET_F_MAC		(1U << 5)
+/** Device can receive TSOv4. */
+#define VIRTIO_NET_F_HOST_TSO4		(1U << 11)
+/** Driver can merge receive buffers. */
+#define VIRTIO_NET_F_MRG_RXBUF		(1U << 15)
 /** Control channel is available */
 #define VIRTIO_NET_F_CTRL_VQ		(1U << 17)
 
-#define VIRTIO_NET_HDR_GSO_NONE 0
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM	1
+
+#define VIRTIO_NET_HDR_GSO_NONE		0
+#define VIRTIO_NET_HDR_GSO_TCPV4	1
+
 typedef struct {
 	uint8_t flags;
 	uint8_t gso_type;
@@ -71,6 +79,8 @@ typedef struct {
 	uintptr_t ct_buf_p[CT_BUFFERS];
 
 	uint16_t tx_free_head;
+	/** Enabled transmit offloads (NIC_OFFLOAD_xxx) */
+	uint32_t offload;
 	uint16_t ct_free_head;
 
 	int irq;
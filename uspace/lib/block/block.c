@@ -55,24 +55,95 @@
 #include <str_error.h>
 #include <offset.h>
 #include <inttypes.h>
+#include <limits.h>
 #include "block.h"
 
 #define MAX_WRITE_RETRIES 10
 
+/** Maximum number of blocks read ahead of a sequential reader */
+#define READAHEAD_MAX 8
+
+/** Write-behind flusher period (microseconds) */
+#define FLUSH_INTERVAL 500000
+
+/** Number of dirty unreferenced blocks that wakes up the flusher early */
+#define FLUSH_BATCH 8
+
+/** Maximum number of blocks written back in one flusher pass */
+#define FLUSH_MAX 64
+
+/** Number of independently locked partitions of a block cache */
+#define CACHE_STRIPES 8
+
+/** Number of recycled block addresses remembered by each stripe */
+#define CACHE_GHOSTS 4
+
+/** Number of block device requests which can be in flight through the ring */
+#define BD_RING_SLOTS 16
+
+/** Largest block device transfer submitted through the ring (bytes) */
+#define BD_RING_SLOT_SIZE (64 * 1024)
+
 /** Lock protecting the device connection list */
 static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
 /** Device connection list head. */
 static LIST_INITIALIZE(dcl);
 
+/** Cache stripe.
+ *
+ * Blocks are distributed among the stripes by their logical address. Each
+ * stripe has its own lock, hash table and lists of unreferenced blocks.
+ *
+ * The unreferenced blocks are managed by a simplified 2Q policy. Blocks enter
+ * the cache as probationary and are recycled from a1_list in FIFO order. The
+ * addresses of recently recycled probationary blocks are remembered and
+ * a block that is requested again soon after it was recycled becomes hot.
+ * Hot blocks live on am_list in LRU order and are recycled only if there is
+ * no probationary block left, so that one scan of a large file does not wipe
+ * out frequently used metadata.
+ */
+typedef struct {
+	fibril_mutex_t lock;
+	hash_table_t block_hash;
+	unsigned blocks;          /**< Number of blocks in block_hash. */
+	list_t a1_list;           /**< Unreferenced probationary blocks. */
+	unsigned a1_count;        /**< Number of blocks on a1_list. */
+	list_t am_list;           /**< Unreferenced hot blocks. */
+	/** Addresses of recycled probationary blocks. */
+	aoff64_t ghost[CACHE_GHOSTS];
+	unsigned ghost_count;
+	unsigned ghost_next;
+
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+} cache_stripe_t;
+
+/*
+ * Locking order: stripe lock, block lock, cache lock. A second stripe lock
+ * may only be taken using fibril_mutex_trylock().
+ */
 typedef struct {
 	fibril_mutex_t lock;
 	size_t lblock_size;       /**< Logical block size. */
 	unsigned blocks_cluster;  /**< Physical blocks per block_t */
 	unsigned block_count;     /**< Total number of blocks. */
 	unsigned blocks_cached;   /**< Number of cached blocks. */
-	hash_table_t block_hash;
-	list_t free_list;
 	enum cache_mode mode;
+
+	/** Logical block expected next by a sequential reader. */
+	aoff64_t seq_next;
+	/** Number of blocks in the current sequential run. */
+	unsigned seq_len;
+
+	/** Signalled to wake up the flusher and when the flusher exits. */
+	fibril_condvar_t flush_cv;
+	/** Dirty blocks put on the free lists since the last flush (hint). */
+	unsigned dirty_hint;
+	bool flusher_running;
+	bool flusher_stop;
+
+	cache_stripe_t stripes[CACHE_STRIPES];
 } cache_t;
 
 typedef struct {
@@ -90,6 +161,7 @@ typedef struct {
 static errno_t read_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static errno_t write_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static aoff64_t ba_ltop(devcon_t *, aoff64_t);
+static errno_t cache_flusher(void *);
 
 static devcon_t *devcon_search(service_id_t service_id)
 {
@@ -282,11 +354,16 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 		return ENOMEM;
 
 	fibril_mutex_initialize(&cache->lock);
-	list_initialize(&cache->free_list);
 	cache->lblock_size = size;
 	cache->block_count = blocks;
 	cache->blocks_cached = 0;
 	cache->mode = mode;
+	cache->seq_next = 0;
+	cache->seq_len = 0;
+	fibril_condvar_initialize(&cache->flush_cv);
+	cache->dirty_hint = 0;
+	cache->flusher_running = false;
+	cache->flusher_stop = false;
 
 	/* Allow 1:1 or small-to-large block size translation */
 	if (cache->lblock_size % devcon->pblock_size != 0) {
@@ -296,12 +373,42 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 
 	cache->blocks_cluster = cache->lblock_size / devcon->pblock_size;
 
-	if (!hash_table_create(&cache->block_hash, 0, 0, &cache_ops)) {
-		free(cache);
-		return ENOMEM;
+	for (size_t i = 0; i < CACHE_STRIPES; i++) {
+		cache_stripe_t *stripe = &cache->stripes[i];
+
+		if (!hash_table_create(&stripe->block_hash, 0, 0, &cache_ops)) {
+			while (i-- > 0)
+				hash_table_destroy(&cache->stripes[i].block_hash);
+			free(cache);
+			return ENOMEM;
+		}
+
+		fibril_mutex_initialize(&stripe->lock);
+		stripe->blocks = 0;
+		list_initialize(&stripe->a1_list);
+		stripe->a1_count = 0;
+		list_initialize(&stripe->am_list);
+		stripe->ghost_count = 0;
+		stripe->ghost_next = 0;
+		stripe->hits = 0;
+		stripe->misses = 0;
+		stripe->evictions = 0;
 	}
 
 	devcon->cache = cache;
+
+	if (mode == CACHE_MODE_WB) {
+		/*
+		 * Start the write-behind flusher. Without it, dirty blocks
+		 * are written back one by one as they are recycled.
+		 */
+		fid_t fid = fibril_create(cache_flusher, devcon);
+		if (fid != 0) {
+			cache->flusher_running = true;
+			fibril_add_ready(fid);
+		}
+	}
+
 	return EOK;
 }
 
@@ -317,45 +424,266 @@ errno_t block_cache_fini(service_id_t service_id)
 		return EOK;
 	cache = devcon->cache;
 
+	/* Stop the flusher */
+	fibril_mutex_lock(&cache->lock);
+	cache->flusher_stop = true;
+	fibril_condvar_broadcast(&cache->flush_cv);
+	while (cache->flusher_running)
+		fibril_condvar_wait(&cache->flush_cv, &cache->lock);
+	fibril_mutex_unlock(&cache->lock);
+
 	/*
 	 * We are expecting to find all blocks for this device handle on the
-	 * free list, i.e. the block reference count should be zero. Do not
-	 * bother with the cache and block locks because we are single-threaded.
+	 * free lists, i.e. the block reference count should be zero. Do not
+	 * bother with the stripe and block locks because we are
+	 * single-threaded.
 	 */
-	while (!list_empty(&cache->free_list)) {
-		block_t *b = list_get_instance(list_first(&cache->free_list),
-		    block_t, free_link);
-
-		list_remove(&b->free_link);
-		if (b->dirty) {
-			rc = write_blocks(devcon, b->pba, cache->blocks_cluster,
-			    b->data, b->size);
-			if (rc != EOK)
-				return rc;
-		}
+	for (size_t i = 0; i < CACHE_STRIPES; i++) {
+		cache_stripe_t *stripe = &cache->stripes[i];
+		link_t *link;
 
-		hash_table_remove_item(&cache->block_hash, &b->hash_link);
+		while ((link = list_first(&stripe->a1_list)) != NULL ||
+		    (link = list_first(&stripe->am_list)) != NULL) {
+			block_t *b = list_get_instance(link, block_t, free_link);
 
-		free(b->data);
-		free(b);
+			if (b->dirty) {
+				rc = write_blocks(devcon, b->pba,
+				    cache->blocks_cluster, b->data, b->size);
+				if (rc != EOK)
+					return rc;
+			}
+
+			list_remove(&b->free_link);
+			hash_table_remove_item(&stripe->block_hash,
+			    &b->hash_link);
+
+			free(b->data);
+			free(b);
+		}
+
+		hash_table_destroy(&stripe->block_hash);
 	}
 
-	hash_table_destroy(&cache->block_hash);
 	devcon->cache = NULL;
 	free(cache);
 
 	return EOK;
 }
 
+/** Get block cache statistics.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param stats		Place to store the statistics.
+ *
+ * @return		EOK on success or ENOENT if the device does not have
+ *			a block cache.
+ */
+errno_t block_cache_get_stats(service_id_t service_id,
+    block_cache_stats_t *stats)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	if (devcon == NULL || devcon->cache == NULL)
+		return ENOENT;
+
+	cache_t *cache = devcon->cache;
+
+	stats->hits = 0;
+	stats->misses = 0;
+	stats->evictions = 0;
+
+	for (size_t i = 0; i < CACHE_STRIPES; i++) {
+		cache_stripe_t *stripe = &cache->stripes[i];
+
+		fibril_mutex_lock(&stripe->lock);
+		stats->hits += stripe->hits;
+		stats->misses += stripe->misses;
+		stats->evictions += stripe->evictions;
+		fibril_mutex_unlock(&stripe->lock);
+	}
+
+	return EOK;
+}
+
+/** Fill in block cache statistics of a file system.
+ *
+ * Suitable as the cache_stats operation of libfs.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param st		File system statistics to update.
+ *
+ * @return		EOK on success or ENOENT if the device does not have
+ *			a block cache.
+ */
+errno_t block_cache_statfs(service_id_t service_id, vfs_statfs_t *st)
+{
+	block_cache_stats_t stats;
+	errno_t rc;
+
+	rc = block_cache_get_stats(service_id, &stats);
+	if (rc != EOK)
+		return rc;
+
+	st->f_chits = stats.hits;
+	st->f_cmisses = stats.misses;
+	st->f_cevicts = stats.evictions;
+	return EOK;
+}
+
 #define CACHE_LO_WATERMARK	10
 #define CACHE_HI_WATERMARK	20
-static bool cache_can_grow(cache_t *cache)
+
+/** Allocate a new block structure for the cache.
+ *
+ * @param cache		Cache.
+ * @param limit		Do not allocate if at least this many blocks are
+ *			cached already.
+ *
+ * @return		Block structure or NULL.
+ */
+static block_t *cache_block_alloc(cache_t *cache, unsigned limit)
+{
+	fibril_mutex_lock(&cache->lock);
+	if (cache->blocks_cached >= limit) {
+		fibril_mutex_unlock(&cache->lock);
+		return NULL;
+	}
+	cache->blocks_cached++;
+	fibril_mutex_unlock(&cache->lock);
+
+	block_t *b = malloc(sizeof(block_t));
+	if (b != NULL) {
+		b->data = malloc(cache->lblock_size);
+		if (b->data != NULL)
+			return b;
+
+		free(b);
+	}
+
+	fibril_mutex_lock(&cache->lock);
+	cache->blocks_cached--;
+	fibril_mutex_unlock(&cache->lock);
+	return NULL;
+}
+
+/** Free a block structure which is no longer in the cache. */
+static void cache_block_free(cache_t *cache, block_t *b)
+{
+	free(b->data);
+	free(b);
+
+	fibril_mutex_lock(&cache->lock);
+	cache->blocks_cached--;
+	fibril_mutex_unlock(&cache->lock);
+}
+
+static cache_stripe_t *cache_stripe(cache_t *cache, aoff64_t lba)
+{
+	return &cache->stripes[lba % CACHE_STRIPES];
+}
+
+/** Insert a block in the hash table of a stripe.
+ *
+ * If the block was recycled recently, it becomes hot. Should be called with
+ * the stripe lock held.
+ */
+static void stripe_insert(cache_stripe_t *stripe, block_t *b)
+{
+	for (unsigned i = 0; i < stripe->ghost_count; i++) {
+		if (stripe->ghost[i] == b->lba) {
+			b->hot = true;
+			break;
+		}
+	}
+
+	hash_table_insert(&stripe->block_hash, &b->hash_link);
+	stripe->blocks++;
+}
+
+/** Remove a block from the hash table of a stripe.
+ *
+ * The block is counted as evicted and, unless it is hot, its address is
+ * remembered. Should be called with the stripe lock held.
+ */
+static void stripe_evict(cache_stripe_t *stripe, block_t *b)
 {
-	if (cache->blocks_cached < CACHE_LO_WATERMARK)
-		return true;
-	if (!list_empty(&cache->free_list))
-		return false;
-	return true;
+	hash_table_remove_item(&stripe->block_hash, &b->hash_link);
+	stripe->blocks--;
+	stripe->evictions++;
+
+	if (!b->hot) {
+		stripe->ghost[stripe->ghost_next] = b->lba;
+		stripe->ghost_next = (stripe->ghost_next + 1) % CACHE_GHOSTS;
+		if (stripe->ghost_count < CACHE_GHOSTS)
+			stripe->ghost_count++;
+	}
+}
+
+/** Put an unreferenced block on the free list where it belongs.
+ *
+ * Should be called with the stripe lock held.
+ */
+static void stripe_free_append(cache_stripe_t *stripe, block_t *b)
+{
+	if (b->hot) {
+		list_append(&b->free_link, &stripe->am_list);
+	} else {
+		list_append(&b->free_link, &stripe->a1_list);
+		stripe->a1_count++;
+	}
+}
+
+/** Take a block off its free list.
+ *
+ * Should be called with the stripe lock held.
+ */
+static void stripe_free_remove(cache_stripe_t *stripe, block_t *b)
+{
+	list_remove(&b->free_link);
+	if (!b->hot)
+		stripe->a1_count--;
+}
+
+/** Find an unreferenced block to be recycled.
+ *
+ * Probationary blocks are preferred to hot blocks. The stripe of the
+ * requested block is searched first, the other stripes are skipped if their
+ * lock is not immediately available. Should be called with the lock of
+ * @a stripe held.
+ *
+ * @param cache		Cache.
+ * @param stripe	Stripe of the requested block.
+ * @param vstripe	Place to store the stripe of the returned block. If
+ *			it differs from @a stripe, it is left locked.
+ *
+ * @return		Block or NULL if there is no block to recycle.
+ */
+static block_t *cache_victim(cache_t *cache, cache_stripe_t *stripe,
+    cache_stripe_t **vstripe)
+{
+	size_t first = stripe - cache->stripes;
+
+	for (unsigned pass = 0; pass < 2; pass++) {
+		for (size_t i = 0; i < CACHE_STRIPES; i++) {
+			cache_stripe_t *s =
+			    &cache->stripes[(first + i) % CACHE_STRIPES];
+
+			if (s != stripe && !fibril_mutex_trylock(&s->lock))
+				continue;
+
+			link_t *link = list_first(pass == 0 ? &s->a1_list :
+			    &s->am_list);
+			if (link != NULL) {
+				*vstripe = s;
+				return list_get_instance(link, block_t,
+				    free_link);
+			}
+
+			if (s != stripe)
+				fibril_mutex_unlock(&s->lock);
+		}
+	}
+
+	return NULL;
 }
 
 static void block_initialize(block_t *b)
@@ -365,10 +693,172 @@ static void block_initialize(block_t *b)
 	b->write_failures = 0;
 	b->dirty = false;
 	b->toxic = false;
+	b->hot = false;
 	fibril_rwlock_initialize(&b->contents_lock);
 	link_initialize(&b->free_link);
 }
 
+/** Track sequential access to the cache.
+ *
+ * Should be called with the cache lock held.
+ *
+ * @param cache		Cache.
+ * @param ba		Block address (logical) being accessed.
+ *
+ * @return		Number of blocks in the current sequential run.
+ */
+static unsigned cache_seq_update(cache_t *cache, aoff64_t ba)
+{
+	if (ba == cache->seq_next)
+		cache->seq_len++;
+	else if (ba + 1 != cache->seq_next)
+		cache->seq_len = 0;
+
+	cache->seq_next = ba + 1;
+	return cache->seq_len;
+}
+
+/** Get a block structure for readahead.
+ *
+ * Grows the cache up to the high watermark, then recycles clean
+ * probationary blocks of the stripe. Hot blocks are never recycled and
+ * dirty blocks are never written back to make room for readahead. Should be
+ * called with the stripe lock held.
+ *
+ * @param cache		Cache.
+ * @param stripe	Stripe the block will be inserted in.
+ *
+ * @return		Block structure or NULL.
+ */
+static block_t *cache_readahead_block(cache_t *cache, cache_stripe_t *stripe)
+{
+	block_t *b = cache_block_alloc(cache, CACHE_HI_WATERMARK);
+	if (b != NULL)
+		return b;
+
+	list_foreach(stripe->a1_list, free_link, block_t, fb) {
+		if (!fibril_mutex_trylock(&fb->lock))
+			continue;
+
+		bool dirty = fb->dirty;
+		fibril_mutex_unlock(&fb->lock);
+
+		if (!dirty) {
+			stripe_free_remove(stripe, fb);
+			stripe_evict(stripe, fb);
+			return fb;
+		}
+	}
+
+	return NULL;
+}
+
+/** Prepare blocks to be read ahead of a sequential reader.
+ *
+ * The blocks are inserted in the cache, locked and referenced, so that they
+ * can be read from the device together with the block that was requested.
+ * Stripes which cannot be locked immediately end the readahead. Should be
+ * called with the lock of the stripe of the requested block held.
+ *
+ * @param devcon	Device connection.
+ * @param stripe	Stripe of the requested block.
+ * @param ba		Block address (logical) of the requested block.
+ * @param want		Number of blocks to read ahead.
+ * @param ra		Array for storing the prepared blocks.
+ *
+ * @return		Number of prepared blocks.
+ */
+static size_t cache_readahead_prepare(devcon_t *devcon, cache_stripe_t *stripe,
+    aoff64_t ba, size_t want, block_t **ra)
+{
+	cache_t *cache = devcon->cache;
+	size_t cnt;
+
+	for (cnt = 0; cnt < want; cnt++) {
+		aoff64_t lba = ba + cnt + 1;
+		cache_stripe_t *s = cache_stripe(cache, lba);
+
+		if (ba_ltop(devcon, lba) + cache->blocks_cluster >=
+		    devcon->pblocks)
+			break;
+		if (s != stripe && !fibril_mutex_trylock(&s->lock))
+			break;
+
+		block_t *b = NULL;
+		if (hash_table_find(&s->block_hash, &lba) == NULL)
+			b = cache_readahead_block(cache, s);
+
+		if (b != NULL) {
+			block_initialize(b);
+			b->service_id = devcon->service_id;
+			b->size = cache->lblock_size;
+			b->lba = lba;
+			b->pba = ba_ltop(devcon, lba);
+			stripe_insert(s, b);
+
+			fibril_mutex_lock(&b->lock);
+			ra[cnt] = b;
+		}
+
+		if (s != stripe)
+			fibril_mutex_unlock(&s->lock);
+		if (b == NULL)
+			break;
+	}
+
+	return cnt;
+}
+
+/** Read a block together with the blocks following it.
+ *
+ * All blocks are expected to be locked by the caller. The readahead blocks
+ * are unlocked on return. If the blocks cannot be read at once, they are
+ * read one by one so that an error is attributed to the right block.
+ *
+ * @param devcon	Device connection.
+ * @param b		Requested block.
+ * @param ra		Readahead blocks.
+ * @param cnt		Number of readahead blocks.
+ *
+ * @return		EOK on success or an error code if the requested block
+ *			could not be read.
+ */
+static errno_t read_blocks_ahead(devcon_t *devcon, block_t *b, block_t **ra,
+    size_t cnt)
+{
+	cache_t *cache = devcon->cache;
+	size_t bsize = cache->lblock_size;
+	errno_t rc = ENOMEM;
+
+	void *buf = malloc((cnt + 1) * bsize);
+	if (buf != NULL) {
+		rc = read_blocks(devcon, b->pba,
+		    (cnt + 1) * cache->blocks_cluster, buf, (cnt + 1) * bsize);
+		if (rc == EOK) {
+			memcpy(b->data, buf, bsize);
+			for (size_t i = 0; i < cnt; i++)
+				memcpy(ra[i]->data, buf + (i + 1) * bsize, bsize);
+		}
+
+		free(buf);
+	}
+
+	if (rc != EOK) {
+		rc = read_blocks(devcon, b->pba, cache->blocks_cluster,
+		    b->data, bsize);
+		for (size_t i = 0; i < cnt; i++) {
+			if (read_blocks(devcon, ra[i]->pba, cache->blocks_cluster,
+			    ra[i]->data, bsize) != EOK)
+				ra[i]->toxic = true;
+		}
+	}
+
+	for (size_t i = 0; i < cnt; i++)
+		fibril_mutex_unlock(&ra[i]->lock);
+
+	return rc;
+}
+
 /** Instantiate a block in memory and get a reference to it.
  *
  * @param block			Pointer to where the function will store the
@@ -385,9 +875,13 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 {
 	devcon_t *devcon;
 	cache_t *cache;
+	cache_stripe_t *stripe;
+	cache_stripe_t *vstripe;
 	block_t *b;
-	link_t *link;
 	aoff64_t p_ba;
+	block_t *ra[READAHEAD_MAX];
+	size_t ra_cnt = 0;
+	size_t ra_want;
 	errno_t rc;
 
 	devcon = devcon_search(service_id);
@@ -408,72 +902,73 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 		return EIO;
 	}
 
+	fibril_mutex_lock(&cache->lock);
+	ra_want = min(cache_seq_update(cache, ba), READAHEAD_MAX);
+	fibril_mutex_unlock(&cache->lock);
+
+	stripe = cache_stripe(cache, ba);
+
 retry:
 	rc = EOK;
 	b = NULL;
 
-	fibril_mutex_lock(&cache->lock);
-	ht_link_t *hlink = hash_table_find(&cache->block_hash, &ba);
+	fibril_mutex_lock(&stripe->lock);
+
+	ht_link_t *hlink = hash_table_find(&stripe->block_hash, &ba);
 	if (hlink) {
-	found:
 		/*
 		 * We found the block in the cache.
 		 */
 		b = hash_table_get_inst(hlink, block_t, hash_link);
 		fibril_mutex_lock(&b->lock);
 		if (b->refcnt++ == 0)
-			list_remove(&b->free_link);
+			stripe_free_remove(stripe, b);
 		if (b->toxic)
 			rc = EIO;
 		fibril_mutex_unlock(&b->lock);
-		fibril_mutex_unlock(&cache->lock);
+		stripe->hits++;
+		fibril_mutex_unlock(&stripe->lock);
 	} else {
 		/*
-		 * The block was not found in the cache.
+		 * The block was not found in the cache. Below the low
+		 * watermark, we grow the cache by allocating new blocks.
+		 * Otherwise we try to recycle a block and only grow the cache
+		 * if there is none to recycle.
 		 */
-		if (cache_can_grow(cache)) {
-			/*
-			 * We can grow the cache by allocating new blocks.
-			 * Should the allocation fail, we fail over and try to
-			 * recycle a block from the cache.
-			 */
-			b = malloc(sizeof(block_t));
-			if (!b)
-				goto recycle;
-			b->data = malloc(cache->lblock_size);
-			if (!b->data) {
-				free(b);
-				b = NULL;
-				goto recycle;
-			}
-			cache->blocks_cached++;
-		} else {
-			/*
-			 * Try to recycle a block from the free list.
-			 */
-		recycle:
-			if (list_empty(&cache->free_list)) {
-				fibril_mutex_unlock(&cache->lock);
+		bool recycled = false;
+
+		b = cache_block_alloc(cache, CACHE_LO_WATERMARK);
+		if (!b) {
+			b = cache_victim(cache, stripe, &vstripe);
+			recycled = (b != NULL);
+		}
+		if (!b) {
+			/* There is nothing to recycle, the cache has to grow. */
+			b = cache_block_alloc(cache, UINT_MAX);
+			if (!b) {
+				fibril_mutex_unlock(&stripe->lock);
 				rc = ENOMEM;
 				goto out;
 			}
-			link = list_first(&cache->free_list);
-			b = list_get_instance(link, block_t, free_link);
+		}
 
+		if (recycled) {
 			fibril_mutex_lock(&b->lock);
 			if (b->dirty) {
 				/*
 				 * The block needs to be written back to the
 				 * device before it changes identity. Do this
-				 * while not holding the cache lock so that
+				 * while not holding the stripe locks so that
 				 * concurrency is not impeded. Also move the
-				 * block to the end of the free list so that we
+				 * block to the end of its free list so that we
 				 * do not slow down other instances of
 				 * block_get() draining the free list.
 				 */
-				list_remove(&b->free_link);
-				list_append(&b->free_link, &cache->free_list);
-				fibril_mutex_unlock(&cache->lock);
+				stripe_free_remove(vstripe, b);
+				stripe_free_append(vstripe, b);
+				if (vstripe != stripe)
+					fibril_mutex_unlock(&vstripe->lock);
+				fibril_mutex_unlock(&stripe->lock);
 				rc = write_blocks(devcon, b->pba,
 				    cache->blocks_cluster, b->data, b->size);
 				if (rc != EOK) {
@@ -496,30 +991,14 @@ retry:
 				} else
 					b->write_failures = 0;
 
+				/*
+				 * The block is clean now. Start over, as
+				 * somebody else may have instantiated the
+				 * block of interest in the meantime.
+				 */
 				b->dirty = false;
-				if (!fibril_mutex_trylock(&cache->lock)) {
-					/*
-					 * Somebody is probably racing with us.
-					 * Unlock the block and retry.
-					 */
-					fibril_mutex_unlock(&b->lock);
-					goto retry;
-				}
-				hlink = hash_table_find(&cache->block_hash, &ba);
-				if (hlink) {
-					/*
-					 * Someone else must have already
-					 * instantiated the block while we were
-					 * not holding the cache lock.
-					 * Leave the recycled block on the
-					 * freelist and continue as if we
-					 * found the block of interest during
-					 * the first try.
-					 */
-					fibril_mutex_unlock(&b->lock);
-					goto found;
-				}
-
+				fibril_mutex_unlock(&b->lock);
+				goto retry;
 			}
 			fibril_mutex_unlock(&b->lock);
 
@@ -527,8 +1006,10 @@ retry:
 			 * Unlink the block from the free list and the hash
 			 * table.
 			 */
-			list_remove(&b->free_link);
-			hash_table_remove_item(&cache->block_hash, &b->hash_link);
+			stripe_free_remove(vstripe, b);
+			stripe_evict(vstripe, b);
+			if (vstripe != stripe)
+				fibril_mutex_unlock(&vstripe->lock);
 		}
 
 		block_initialize(b);
@@ -536,29 +1017,48 @@ retry:
 		b->size = cache->lblock_size;
 		b->lba = ba;
 		b->pba = ba_ltop(devcon, b->lba);
-		hash_table_insert(&cache->block_hash, &b->hash_link);
+		stripe_insert(stripe, b);
+		stripe->misses++;
+
+		/*
+		 * If the block continues a sequential run, instantiate
+		 * the blocks which follow, so that they can be read by the
+		 * same request.
+		 */
+		if (!(flags & BLOCK_FLAGS_NOREAD))
+			ra_cnt = cache_readahead_prepare(devcon, stripe, ba,
+			    ra_want, ra);
 
 		/*
-		 * Lock the block before releasing the cache lock. Thus we don't
-		 * kill concurrent operations on the cache while doing I/O on
-		 * the block.
+		 * Lock the block before releasing the stripe lock. Thus we
+		 * don't kill concurrent operations on the cache while doing
+		 * I/O on the block.
 		 */
 		fibril_mutex_lock(&b->lock);
-		fibril_mutex_unlock(&cache->lock);
+		fibril_mutex_unlock(&stripe->lock);
 
 		if (!(flags & BLOCK_FLAGS_NOREAD)) {
 			/*
 			 * The block contains old or no data. We need to read
 			 * the new contents from the device.
 			 */
-			rc = read_blocks(devcon, b->pba, cache->blocks_cluster,
-			    b->data, cache->lblock_size);
+			if (ra_cnt > 0) {
+				rc = read_blocks_ahead(devcon, b, ra, ra_cnt);
+			} else {
+				rc = read_blocks(devcon, b->pba,
+				    cache->blocks_cluster, b->data,
+				    cache->lblock_size);
+			}
 			if (rc != EOK)
 				b->toxic = true;
 		} else
 			rc = EOK;
 
 		fibril_mutex_unlock(&b->lock);
+
+		/* Readahead blocks stay in the cache unreferenced. */
+		for (size_t i = 0; i < ra_cnt; i++)
+			(void) block_put(ra[i]);
 	}
 out:
 	if ((rc != EOK) && b) {
@@ -582,6 +1082,7 @@ errno_t block_put(block_t *block)
 {
 	devcon_t *devcon = devcon_search(block->service_id);
 	cache_t *cache;
+	cache_stripe_t *stripe;
 	unsigned blocks_cached;
 	enum cache_mode mode;
 	errno_t rc = EOK;
@@ -591,6 +1092,7 @@ errno_t block_put(block_t *block)
 	assert(block->refcnt >= 1);
 
 	cache = devcon->cache;
+	stripe = cache_stripe(cache, block->lba);
 
 retry:
 	fibril_mutex_lock(&cache->lock);
@@ -600,10 +1102,10 @@ retry:
 
 	/*
 	 * Determine whether to sync the block. Syncing the block is best done
-	 * when not holding the cache lock as it does not impede concurrency.
+	 * when not holding the stripe lock as it does not impede concurrency.
 	 * Since the situation may have changed when we unlocked the cache, the
 	 * blocks_cached and mode variables are mere hints. We will recheck the
-	 * conditions later when the cache lock is held again.
+	 * conditions later when the stripe lock is held again.
 	 */
 	fibril_mutex_lock(&block->lock);
 	if (block->toxic)
@@ -618,7 +1120,7 @@ retry:
 	}
 	fibril_mutex_unlock(&block->lock);
 
-	fibril_mutex_lock(&cache->lock);
+	fibril_mutex_lock(&stripe->lock);
 	fibril_mutex_lock(&block->lock);
 	if (!--block->refcnt) {
 		/*
@@ -626,8 +1128,11 @@ retry:
 		 * block or put it on the free list. In case of an I/O error,
 		 * free the block.
 		 */
-		if ((cache->blocks_cached > CACHE_HI_WATERMARK) ||
-		    (rc != EOK)) {
+		fibril_mutex_lock(&cache->lock);
+		blocks_cached = cache->blocks_cached;
+		fibril_mutex_unlock(&cache->lock);
+
+		if ((blocks_cached > CACHE_HI_WATERMARK) || (rc != EOK)) {
 			/*
 			 * Currently there are too many cached blocks or there
 			 * was an I/O error when writing the block back to the
@@ -636,14 +1141,14 @@ retry:
 			if (block->dirty) {
 				/*
 				 * We cannot sync the block while holding the
-				 * cache lock. Release everything and retry.
+				 * stripe lock. Release everything and retry.
 				 */
 				block->refcnt++;
 
 				if (block->write_failures < MAX_WRITE_RETRIES) {
 					block->write_failures++;
 					fibril_mutex_unlock(&block->lock);
-					fibril_mutex_unlock(&cache->lock);
+					fibril_mutex_unlock(&stripe->lock);
 					goto retry;
 				} else {
 					printf("Too many errors writing block %"
@@ -655,12 +1160,10 @@ retry:
 			/*
 			 * Take the block out of the cache and free it.
 			 */
-			hash_table_remove_item(&cache->block_hash, &block->hash_link);
+			stripe_evict(stripe, block);
 			fibril_mutex_unlock(&block->lock);
-			free(block->data);
-			free(block);
-			cache->blocks_cached--;
-			fibril_mutex_unlock(&cache->lock);
+			fibril_mutex_unlock(&stripe->lock);
+			cache_block_free(cache, block);
 			return rc;
 		}
 		/*
@@ -668,22 +1171,197 @@ retry:
 		 */
 		if (cache->mode != CACHE_MODE_WB && block->dirty) {
 			/*
-			 * We cannot sync the block while holding the cache
+			 * We cannot sync the block while holding the stripe
 			 * lock. Release everything and retry.
 			 */
 			block->refcnt++;
 			fibril_mutex_unlock(&block->lock);
-			fibril_mutex_unlock(&cache->lock);
+			fibril_mutex_unlock(&stripe->lock);
 			goto retry;
 		}
-		list_append(&block->free_link, &cache->free_list);
+		stripe_free_append(stripe, block);
+
+		if (block->dirty) {
+			fibril_mutex_lock(&cache->lock);
+			if (++cache->dirty_hint == FLUSH_BATCH)
+				fibril_condvar_signal(&cache->flush_cv);
+			fibril_mutex_unlock(&cache->lock);
+		}
 	}
 	fibril_mutex_unlock(&block->lock);
-	fibril_mutex_unlock(&cache->lock);
+	fibril_mutex_unlock(&stripe->lock);
 
 	return rc;
 }
 
+static int block_pba_cmp(const void *a, const void *b)
+{
+	const block_t *ba = *(const block_t **) a;
+	const block_t *bb = *(const block_t **) b;
+
+	if (ba->pba < bb->pba)
+		return -1;
+	if (ba->pba > bb->pba)
+		return 1;
+	return 0;
+}
+
+/** Write back a run of blocks with adjacent physical addresses.
+ *
+ * The blocks are written with a single request if a bounce buffer
+ * can be allocated.
+ *
+ * @param devcon	Device connection.
+ * @param blocks	Blocks sorted by their physical address.
+ * @param cnt		Number of blocks.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t flush_run(devcon_t *devcon, block_t **blocks, size_t cnt)
+{
+	cache_t *cache = devcon->cache;
+	size_t bsize = cache->lblock_size;
+	void *buf = NULL;
+	errno_t rc;
+
+	if (cnt > 1)
+		buf = malloc(cnt * bsize);
+
+	if (buf != NULL) {
+		for (size_t i = 0; i < cnt; i++)
+			memcpy(buf + i * bsize, blocks[i]->data, bsize);
+
+		rc = write_blocks(devcon, blocks[0]->pba,
+		    cnt * cache->blocks_cluster, buf, cnt * bsize);
+		free(buf);
+		return rc;
+	}
+
+	for (size_t i = 0; i < cnt; i++) {
+		rc = write_blocks(devcon, blocks[i]->pba,
+		    cache->blocks_cluster, blocks[i]->data, bsize);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return EOK;
+}
+
+/** Take dirty blocks off a free list for writing back.
+ *
+ * A reference to the blocks is taken so that they cannot be recycled while
+ * being written back. The dirty flag is cleared now, so that modifications
+ * made during the write are not lost. Should be called with the stripe lock
+ * held.
+ *
+ * @param stripe	Stripe.
+ * @param list		Free list of the stripe.
+ * @param blocks	Array for storing the blocks.
+ * @param max		Maximum number of blocks to take.
+ *
+ * @return		Number of blocks taken.
+ */
+static size_t stripe_take_dirty(cache_stripe_t *stripe, list_t *list,
+    block_t **blocks, size_t max)
+{
+	size_t cnt = 0;
+
+	list_foreach_safe(*list, cur, next) {
+		if (cnt == max)
+			break;
+
+		block_t *b = list_get_instance(cur, block_t, free_link);
+
+		fibril_mutex_lock(&b->lock);
+		if (b->dirty && !b->toxic &&
+		    b->write_failures < MAX_WRITE_RETRIES) {
+			stripe_free_remove(stripe, b);
+			b->refcnt++;
+			b->dirty = false;
+			blocks[cnt++] = b;
+		}
+		fibril_mutex_unlock(&b->lock);
+	}
+
+	return cnt;
+}
+
+/** Write-behind flusher.
+ *
+ * Periodically, or when enough dirty blocks have been released, writes back
+ * the dirty blocks on the free lists. Blocks that are adjacent on the device
+ * are coalesced into a single write.
+ *
+ * @param arg		Device connection.
+ *
+ * @return		EOK.
+ */
+static errno_t cache_flusher(void *arg)
+{
+	devcon_t *devcon = (devcon_t *) arg;
+	cache_t *cache = devcon->cache;
+	block_t *blocks[FLUSH_MAX];
+
+	fibril_mutex_lock(&cache->lock);
+
+	while (!cache->flusher_stop) {
+		if (cache->dirty_hint < FLUSH_BATCH) {
+			(void) fibril_condvar_wait_timeout(&cache->flush_cv,
+			    &cache->lock, FLUSH_INTERVAL);
+			if (cache->flusher_stop)
+				break;
+		}
+
+		cache->dirty_hint = 0;
+		fibril_mutex_unlock(&cache->lock);
+
+		size_t cnt = 0;
+		for (size_t i = 0; i < CACHE_STRIPES && cnt < FLUSH_MAX; i++) {
+			cache_stripe_t *stripe = &cache->stripes[i];
+
+			fibril_mutex_lock(&stripe->lock);
+			cnt += stripe_take_dirty(stripe, &stripe->a1_list,
+			    &blocks[cnt], FLUSH_MAX - cnt);
+			cnt += stripe_take_dirty(stripe, &stripe->am_list,
+			    &blocks[cnt], FLUSH_MAX - cnt);
+			fibril_mutex_unlock(&stripe->lock);
+		}
+
+		qsort(blocks, cnt, sizeof(block_t *), block_pba_cmp);
+
+		size_t first = 0;
+		while (first < cnt) {
+			size_t last = first + 1;
+			while (last < cnt && blocks[last]->pba ==
+			    blocks[last - 1]->pba + cache->blocks_cluster)
+				last++;
+
+			if (flush_run(devcon, &blocks[first], last - first) != EOK) {
+				/* Leave the blocks dirty for another try. */
+				for (size_t i = first; i < last; i++) {
+					fibril_mutex_lock(&blocks[i]->lock);
+					blocks[i]->dirty = true;
+					blocks[i]->write_failures++;
+					fibril_mutex_unlock(&blocks[i]->lock);
+				}
+			}
+
+			first = last;
+		}
+
+		for (size_t i = 0; i < cnt; i++)
+			(void) block_put(blocks[i]);
+
+		fibril_mutex_lock(&cache->lock);
+	}
+
+	cache->flusher_running = false;
+	fibril_condvar_broadcast(&cache->flush_cv);
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
 /** Read sequential data from a block device.
  *
  * @param service_id	Service ID of the block device.
@@ -838,6 +1516,26 @@ errno_t block_get_nblocks(service_id_t service_id, aoff64_t *nblocks)
 	return bd_get_num_blocks(devcon->bd, nblocks);
 }
 
+/** Transfer blocks through a shared request ring.
+ *
+ * The ring needs a shared memory area and a service thread in the caller,
+ * which also turns on fibril multithreading. It is therefore only set up
+ * on request. Transfers which do not fit into a ring slot still use plain
+ * IPC.
+ *
+ * @param service_id	Service ID of the block device.
+ *
+ * @return		EOK on success, ENOTSUP if the device does not
+ *			support request rings or an error code.
+ */
+errno_t block_ring_init(service_id_t service_id)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	assert(devcon);
+
+	return bd_ring_setup(devcon->bd, BD_RING_SLOTS, BD_RING_SLOT_SIZE);
+}
+
 /** Read bytes directly from the device (bypass cache)
  *
  * @param service_id	Service ID of the block device.
@@ -45,6 +45,7 @@
 #include <adt/hash_table.h>
 #include <adt/list.h>
 #include <loc.h>
+#include <vfs/vfs.h>
 
 /*
  * Flags that can be used with block_get().
@@ -71,6 +72,8 @@ typedef struct block {
 	bool dirty;
 	/** If true, the blcok does not contain valid data. */
 	bool toxic;
+	/** If true, the block is used frequently and should stay cached. */
+	bool hot;
 	/** Readers / Writer lock protecting the contents of the block. */
 	fibril_rwlock_t contents_lock;
 	/** Service ID of service providing the block device. */
@@ -83,7 +86,7 @@ typedef struct block {
 	size_t size;
 	/** Number of write failures. */
 	int write_failures;
-	/** Link for placing the block into the free block list. */
+	/** Link for placing the block into a free block list. */
 	link_t free_link;
 	/** Link for placing the block into the block hash table. */
 	ht_link_t hash_link;
@@ -99,6 +102,16 @@ enum cache_mode {
 	CACHE_MODE_WB
 };
 
+/** Block cache statistics */
+typedef struct {
+	/** Number of blocks found in the cache */
+	uint64_t hits;
+	/** Number of blocks which had to be instantiated */
+	uint64_t misses;
+	/** Number of blocks removed from the cache */
+	uint64_t evictions;
+} block_cache_stats_t;
+
 extern errno_t block_init(service_id_t);
 extern void block_fini(service_id_t);
 
@@ -107,6 +120,8 @@ extern void *block_bb_get(service_id_t);
 
 extern errno_t block_cache_init(service_id_t, size_t, unsigned, enum cache_mode);
 extern errno_t block_cache_fini(service_id_t);
+extern errno_t block_cache_get_stats(service_id_t, block_cache_stats_t *);
+extern errno_t block_cache_statfs(service_id_t, vfs_statfs_t *);
 
 extern errno_t block_get(block_t **, service_id_t, aoff64_t, int);
 extern errno_t block_put(block_t *);
@@ -116,6 +131,7 @@ extern errno_t block_seqread(service_id_t, void *, size_t *, size_t *, aoff64_t
 
 extern errno_t block_get_bsize(service_id_t, size_t *);
 extern errno_t block_get_nblocks(service_id_t, aoff64_t *);
+extern errno_t block_ring_init(service_id_t);
 extern errno_t block_read_toc(service_id_t, uint8_t, void *, size_t);
 extern errno_t block_read_direct(service_id_t, aoff64_t, size_t, void *);
 extern errno_t block_read_bytes_direct(service_id_t, aoff64_t, size_t, void *);
@@ -123,6 +123,19 @@
 
 static fibril_rmutex_t message_mutex;
 
+/** Mutex protecting the send queue. */
+static fibril_rmutex_t send_queue_mutex;
+
+/** Requests deferred until the thread waits for IPC.
+ *
+ * When other fibrils are ready to run, a new request is not sent right away,
+ * but queued. The queue is submitted together with the next IPC wait in one
+ * SYS_IPC_BATCH, so that several fibrils with pending exchanges share a single
+ * kernel entry.
+ */
+static ipc_batch_call_t send_queue[IPC_BATCH_MAX];
+static size_t send_queue_count;
+
 /** Naming service session */
 async_sess_t session_ns;
 
@@ -174,6 +187,8 @@ void __async_client_init(void)
 {
 	if (fibril_rmutex_initialize(&message_mutex) != EOK)
 		abort();
+	if (fibril_rmutex_initialize(&send_queue_mutex) != EOK)
+		abort();
 
 	session_ns.iface = 0;
 	session_ns.mgmt = EXCHANGE_ATOMIC;
@@ -192,6 +207,9 @@ void __async_client_init(void)
 
 void __async_client_fini(void)
 {
+	async_send_flush();
+
+	fibril_rmutex_destroy(&send_queue_mutex);
 	fibril_rmutex_destroy(&message_mutex);
 }
 
@@ -232,6 +250,137 @@ void async_reply_received(ipc_call_t *data)
 	fibril_rmutex_unlock(&message_mutex);
 }
 
+/** Complete submitted requests which the kernel refused to send.
+ *
+ * The waiting fibrils get the error code as if it were the answer.
+ *
+ * @param calls Submitted requests.
+ * @param count Number of requests in @a calls.
+ *
+ */
+void async_send_queue_done(ipc_batch_call_t *calls, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		amsg_t *msg = (amsg_t *) calls[i].label;
+		if ((calls[i].rc == EOK) || (!msg))
+			continue;
+
+		fibril_rmutex_lock(&message_mutex);
+
+		msg->retval = calls[i].rc;
+		msg->done = true;
+
+		if (msg->forget)
+			amsg_destroy(msg);
+		else
+			fibril_notify(&msg->received);
+
+		fibril_rmutex_unlock(&message_mutex);
+	}
+}
+
+/** Take over all deferred requests.
+ *
+ * The caller becomes responsible for submitting the requests and for
+ * calling async_send_queue_done() afterwards. This is only used by
+ * single-threaded tasks, which cannot send anything in the meantime.
+ *
+ * @param calls Storage for up to IPC_BATCH_MAX requests.
+ *
+ * @return Number of requests stored in @a calls.
+ *
+ */
+size_t async_send_queue_take(ipc_batch_call_t *calls)
+{
+	fibril_rmutex_lock(&send_queue_mutex);
+
+	size_t count = send_queue_count;
+	memcpy(calls, send_queue, count * sizeof(ipc_batch_call_t));
+	send_queue_count = 0;
+
+	fibril_rmutex_unlock(&send_queue_mutex);
+	return count;
+}
+
+/** Submit the send queue. Must be called with send_queue_mutex held. */
+static void async_send_queue_submit(void)
+{
+	if (send_queue_count == 0)
+		return;
+
+	size_t nresults = 0;
+	(void) ipc_batch(send_queue, send_queue_count, NULL, &nresults,
+	    SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+
+	async_send_queue_done(send_queue, send_queue_count);
+	send_queue_count = 0;
+}
+
+/** Send all deferred requests right away. */
+void async_send_flush(void)
+{
+	if (send_queue_count == 0)
+		return;
+
+	fibril_rmutex_lock(&send_queue_mutex);
+	async_send_queue_submit();
+	fibril_rmutex_unlock(&send_queue_mutex);
+}
+
+/** Send an asynchronous request, deferring it if other fibrils are ready.
+ *
+ * Requests are never reordered, so once one has been deferred, all
+ * later ones go through the send queue as well until it is submitted.
+ *
+ * @param phone   Phone for sending the request.
+ * @param imethod Service-defined interface and method.
+ * @param arg1    Service-defined payload argument.
+ * @param arg2    Service-defined payload argument.
+ * @param arg3    Service-defined payload argument.
+ * @param arg4    Service-defined payload argument.
+ * @param arg5    Service-defined payload argument.
+ * @param msg     Message to be notified about the answer or NULL.
+ *
+ * @return EOK if the request was sent or queued, an error code if it could
+ *         not be sent right away.
+ *
+ */
+static errno_t async_call_async(cap_phone_handle_t phone, sysarg_t imethod,
+    sysarg_t arg1, sysarg_t arg2, sysarg_t arg3, sysarg_t arg4, sysarg_t arg5,
+    amsg_t *msg)
+{
+	bool defer = fibril_ready_pending();
+
+	fibril_rmutex_lock(&send_queue_mutex);
+
+	if ((send_queue_count == 0) && (!defer)) {
+		fibril_rmutex_unlock(&send_queue_mutex);
+
+		if ((arg4 == 0) && (arg5 == 0))
+			return ipc_call_async_3(phone, imethod, arg1, arg2, arg3,
+			    msg);
+
+		return ipc_call_async_5(phone, imethod, arg1, arg2, arg3, arg4,
+		    arg5, msg);
+	}
+
+	ipc_batch_call_t *req = &send_queue[send_queue_count++];
+	req->phone = phone;
+	req->args[0] = imethod;
+	req->args[1] = arg1;
+	req->args[2] = arg2;
+	req->args[3] = arg3;
+	req->args[4] = arg4;
+	req->args[5] = arg5;
+	req->label = (sysarg_t) msg;
+
+	if ((!defer) || (send_queue_count == IPC_BATCH_MAX))
+		async_send_queue_submit();
+
+	fibril_rmutex_unlock(&send_queue_mutex);
+	return EOK;
+}
+
 /** Send message and return id of the sent message.
  *
  * The return value can be used as input for async_wait() to wait for
@@ -260,8 +409,8 @@ static aid_t async_send_fast(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1
 
 	msg->dataptr = dataptr;
 
-	errno_t rc = ipc_call_async_4(exch->phone, imethod, arg1, arg2, arg3,
-	    arg4, msg);
+	errno_t rc = async_call_async(exch->phone, imethod, arg1, arg2, arg3,
+	    arg4, 0, msg);
 	if (rc != EOK) {
 		msg->retval = rc;
 		msg->done = true;
@@ -301,7 +450,7 @@ static aid_t async_send_slow(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1
 
 	msg->dataptr = dataptr;
 
-	errno_t rc = ipc_call_async_5(exch->phone, imethod, arg1, arg2, arg3,
+	errno_t rc = async_call_async(exch->phone, imethod, arg1, arg2, arg3,
 	    arg4, arg5, msg);
 	if (rc != EOK) {
 		msg->retval = rc;
@@ -808,42 +957,44 @@ errno_t async_req_5_5(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
 void async_msg_0(async_exch_t *exch, sysarg_t imethod)
 {
 	if (exch != NULL)
-		ipc_call_async_0(exch->phone, imethod, NULL);
+		async_call_async(exch->phone, imethod, 0, 0, 0, 0, 0, NULL);
 }
 
 void async_msg_1(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1)
 {
 	if (exch != NULL)
-		ipc_call_async_1(exch->phone, imethod, arg1, NULL);
+		async_call_async(exch->phone, imethod, arg1, 0, 0, 0, 0, NULL);
 }
 
 void async_msg_2(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
     sysarg_t arg2)
 {
 	if (exch != NULL)
-		ipc_call_async_2(exch->phone, imethod, arg1, arg2, NULL);
+		async_call_async(exch->phone, imethod, arg1, arg2, 0, 0, 0,
+		    NULL);
 }
 
 void async_msg_3(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
     sysarg_t arg2, sysarg_t arg3)
 {
 	if (exch != NULL)
-		ipc_call_async_3(exch->phone, imethod, arg1, arg2, arg3, NULL);
+		async_call_async(exch->phone, imethod, arg1, arg2, arg3, 0, 0,
+		    NULL);
 }
 
 void async_msg_4(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
     sysarg_t arg2, sysarg_t arg3, sysarg_t arg4)
 {
 	if (exch != NULL)
-		ipc_call_async_4(exch->phone, imethod, arg1, arg2, arg3, arg4,
-		    NULL);
+		async_call_async(exch->phone, imethod, arg1, arg2, arg3, arg4,
+		    0, NULL);
 }
 
 void async_msg_5(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
     sysarg_t arg2, sysarg_t arg3, sysarg_t arg4, sysarg_t arg5)
 {
 	if (exch != NULL)
-		ipc_call_async_5(exch->phone, imethod, arg1, arg2, arg3, arg4,
+		async_call_async(exch->phone, imethod, arg1, arg2, arg3, arg4,
 		    arg5, NULL);
 }
 
@@ -863,8 +1014,8 @@ static errno_t async_connect_me_to_internal(cap_phone_handle_t phone,
 
 	msg->dataptr = &result;
 
-	errno_t rc = ipc_call_async_4(phone, IPC_M_CONNECT_ME_TO,
-	    (sysarg_t) iface, arg2, arg3, flags, msg);
+	errno_t rc = async_call_async(phone, IPC_M_CONNECT_ME_TO,
+	    (sysarg_t) iface, arg2, arg3, flags, 0, msg);
 	if (rc != EOK) {
 		msg->retval = rc;
 		msg->done = true;
@@ -1053,6 +1204,9 @@ static void async_hangup_internal(cap_phone_handle_t phone)
 {
 	errno_t rc;
 
+	/* Do not let deferred requests overtake the hangup. */
+	async_send_flush();
+
 	rc = ipc_hangup(phone);
 	assert(rc == EOK);
 	(void) rc;
@@ -1293,6 +1447,31 @@ errno_t async_share_out_start(async_exch_t *exch, void *src, unsigned int flags)
 	    (sysarg_t) flags);
 }
 
+/** Wrapper for IPC_M_WAITQ_SHARE_IN calls using the async framework.
+ *
+ * @param exch    Exchange for sending the message.
+ * @param arg     User defined argument.
+ * @param whandle Storage for the capability of the received wait queue.
+ *
+ * @return Zero on success or an error code from errno.h.
+ *
+ */
+errno_t async_waitq_share_in_start(async_exch_t *exch, sysarg_t arg,
+    cap_waitq_handle_t *whandle)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	sysarg_t _whandle;
+	errno_t rc = async_req_1_5(exch, IPC_M_WAITQ_SHARE_IN, arg, NULL, NULL,
+	    NULL, NULL, &_whandle);
+	if (rc != EOK)
+		return rc;
+
+	*whandle = (cap_waitq_handle_t) _whandle;
+	return EOK;
+}
+
 /** Start IPC_M_DATA_READ using the async framework.
  *
  * @param exch    Exchange for sending the message.
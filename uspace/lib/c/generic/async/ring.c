@@ -0,0 +1,756 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Shared-memory request rings.
+ *
+ * A ring lets a client submit a stream of requests to a server without
+ * sending an IPC message per request. The client shares out an area which
+ * holds a submission queue, an array of request descriptors and a payload
+ * buffer for every descriptor (a slot). The server shares in two wait
+ * queues which the parties use as doorbells: the submission doorbell wakes
+ * up the server thread servicing the ring and the completion doorbell
+ * wakes up the client thread which dispatches completions to the waiting
+ * fibrils.
+ *
+ * A doorbell is only rung when its recipient has announced it is about to
+ * go to sleep, so a busy ring does not enter the kernel at all. The wait
+ * queues count wakeups, which makes it safe for the recipient to recheck
+ * the ring after announcing itself idle.
+ *
+ * The doorbell threads are plain threads which interact with fibrils,
+ * therefore creating or accepting a ring switches the fibril framework
+ * into multithreaded mode.
+ */
+
+#include <async.h>
+#include <async_ring.h>
+#include <as.h>
+#include <align.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <libc.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <abi/synch.h>
+#include <abi/syscall.h>
+#include "../private/fibril.h"
+#include "../private/thread.h"
+
+/** Slot descriptor states */
+typedef enum {
+	/** Not in use or being prepared by the client */
+	RING_SLOT_FREE,
+	/** Submitted by the client */
+	RING_SLOT_SUBMITTED,
+	/** Completed by the server */
+	RING_SLOT_DONE,
+	/** Completion dispatched to the waiting client fibril */
+	RING_SLOT_COLLECTED
+} ring_slot_state_t;
+
+/** Slot descriptor (in the shared area) */
+typedef struct {
+	sysarg_t args[ASYNC_RING_ARGS];
+	size_t size;
+	errno_t retval;
+	atomic_uint state;
+} ring_desc_t;
+
+/** Ring header (in the shared area) */
+typedef struct {
+	/** One of the parties has shut the ring down */
+	atomic_bool closed;
+	/** Server thread is going to sleep on the submission doorbell */
+	atomic_bool server_idle;
+	/** Client thread is going to sleep on the completion doorbell */
+	atomic_bool client_idle;
+	/** Number of submitted requests */
+	atomic_uint sq_tail;
+} ring_hdr_t;
+
+struct async_ring {
+	/** Shared area */
+	void *area;
+	ring_hdr_t *hdr;
+	/** Submission queue (slot indices) */
+	uint32_t *sq;
+	ring_desc_t *desc;
+	uint8_t *payload;
+
+	size_t nslots;
+	size_t slot_size;
+
+	/** Submission doorbell */
+	cap_waitq_handle_t sq_wq;
+	/** Completion doorbell */
+	cap_waitq_handle_t cq_wq;
+
+	/** Local side is shutting the ring down */
+	atomic_bool closing;
+	/** Owner and doorbell thread references */
+	atomic_uint refcnt;
+	/** Doorbell thread has been started */
+	bool thread_started;
+	/** Doorbell thread has stopped servicing the ring */
+	atomic_bool stopped;
+	/** Signalled when the doorbell thread stops */
+	fibril_event_t stopped_ev;
+
+	/*
+	 * Client side
+	 */
+
+	/** Protects the free slot stack and the submission queue tail */
+	fibril_mutex_t lock;
+	fibril_condvar_t free_cv;
+	size_t *free;
+	size_t nfree;
+	/** Completion events, one per slot */
+	fibril_event_t *done;
+
+	/*
+	 * Server side
+	 */
+
+	async_ring_handler_t handler;
+	void *arg;
+	/** Number of consumed requests */
+	unsigned int sq_head;
+};
+
+static errno_t ring_waitq_create(cap_waitq_handle_t *wq)
+{
+	return (errno_t) __SYSCALL1(SYS_WAITQ_CREATE, (sysarg_t) wq);
+}
+
+static void ring_waitq_destroy(cap_waitq_handle_t wq)
+{
+	if (wq != CAP_NIL)
+		(void) __SYSCALL1(SYS_WAITQ_DESTROY, (sysarg_t) wq);
+}
+
+static void ring_waitq_sleep(cap_waitq_handle_t wq)
+{
+	(void) __SYSCALL3(SYS_WAITQ_SLEEP, (sysarg_t) wq, SYNCH_NO_TIMEOUT,
+	    SYNCH_FLAGS_NONE);
+}
+
+static void ring_waitq_wakeup(cap_waitq_handle_t wq)
+{
+	(void) __SYSCALL1(SYS_WAITQ_WAKEUP, (sysarg_t) wq);
+}
+
+/** Ring the doorbell if its recipient is going to sleep. */
+static void ring_kick(atomic_bool *idle, cap_waitq_handle_t wq)
+{
+	if (atomic_exchange(idle, false))
+		ring_waitq_wakeup(wq);
+}
+
+/** Sleep on a doorbell unless there is work pending.
+ *
+ * @param ring    Ring.
+ * @param idle    Idle flag of the calling side.
+ * @param wq      Doorbell of the calling side.
+ * @param pending Predicate telling whether there is work pending.
+ *
+ */
+static void ring_idle(async_ring_t *ring, atomic_bool *idle,
+    cap_waitq_handle_t wq, bool (*pending)(async_ring_t *))
+{
+	atomic_store(idle, true);
+
+	/*
+	 * If the peer has already cleared the flag, it has rung (or is
+	 * about to ring) the doorbell and the sleep consumes that wakeup.
+	 */
+	if (pending(ring) && atomic_exchange(idle, false))
+		return;
+
+	ring_waitq_sleep(wq);
+}
+
+/** Compute the layout of the shared area.
+ *
+ * @return Size of the shared area.
+ *
+ */
+static size_t ring_layout(size_t nslots, size_t slot_size, size_t *sq_off,
+    size_t *desc_off, size_t *payload_off)
+{
+	size_t off = sizeof(ring_hdr_t);
+
+	*sq_off = ALIGN_UP(off, alignof(uint32_t));
+	off = *sq_off + nslots * sizeof(uint32_t);
+
+	*desc_off = ALIGN_UP(off, alignof(ring_desc_t));
+	off = *desc_off + nslots * sizeof(ring_desc_t);
+
+	*payload_off = ALIGN_UP(off, PAGE_SIZE);
+	return ALIGN_UP(*payload_off + nslots * slot_size, PAGE_SIZE);
+}
+
+static bool ring_params_valid(size_t nslots, size_t slot_size)
+{
+	return nslots > 0 && nslots <= ASYNC_RING_SLOTS_MAX &&
+	    slot_size > 0 && slot_size <= ASYNC_RING_SLOT_SIZE_MAX;
+}
+
+static async_ring_t *ring_alloc(size_t nslots, size_t slot_size)
+{
+	async_ring_t *ring = calloc(1, sizeof(async_ring_t));
+	if (ring == NULL)
+		return NULL;
+
+	ring->area = AS_MAP_FAILED;
+	ring->nslots = nslots;
+	ring->slot_size = slot_size;
+	ring->sq_wq = CAP_NIL;
+	ring->cq_wq = CAP_NIL;
+	atomic_store(&ring->closing, false);
+	atomic_store(&ring->refcnt, 1);
+	atomic_store(&ring->stopped, false);
+	fibril_mutex_initialize(&ring->lock);
+	fibril_condvar_initialize(&ring->free_cv);
+
+	return ring;
+}
+
+static void ring_map(async_ring_t *ring, void *area)
+{
+	size_t sq_off, desc_off, payload_off;
+	(void) ring_layout(ring->nslots, ring->slot_size, &sq_off, &desc_off,
+	    &payload_off);
+
+	ring->area = area;
+	ring->hdr = area;
+	ring->sq = (uint32_t *) ((uint8_t *) area + sq_off);
+	ring->desc = (ring_desc_t *) ((uint8_t *) area + desc_off);
+	ring->payload = (uint8_t *) area + payload_off;
+}
+
+static void ring_free(async_ring_t *ring)
+{
+	if (ring->area != AS_MAP_FAILED)
+		as_area_destroy(ring->area);
+
+	ring_waitq_destroy(ring->sq_wq);
+	ring_waitq_destroy(ring->cq_wq);
+
+	free(ring->free);
+	free(ring->done);
+	free(ring);
+}
+
+static void ring_release(async_ring_t *ring)
+{
+	if (atomic_fetch_sub(&ring->refcnt, 1) == 1)
+		ring_free(ring);
+}
+
+/** Announce that the doorbell thread no longer touches the ring. */
+static void ring_thread_stopped(async_ring_t *ring)
+{
+	atomic_store(&ring->stopped, true);
+	fibril_notify(&ring->stopped_ev);
+	ring_release(ring);
+}
+
+static bool ring_closed(async_ring_t *ring)
+{
+	return atomic_load(&ring->closing) || atomic_load(&ring->hdr->closed);
+}
+
+static bool ring_server_pending(async_ring_t *ring)
+{
+	return ring_closed(ring) ||
+	    atomic_load_explicit(&ring->hdr->sq_tail, memory_order_acquire) !=
+	    ring->sq_head;
+}
+
+/** Service all submitted requests. */
+static void ring_server_process(async_ring_t *ring)
+{
+	unsigned int tail = atomic_load_explicit(&ring->hdr->sq_tail,
+	    memory_order_acquire);
+
+	/*
+	 * The client cannot have submitted more requests than there are
+	 * slots. Shut a ring with a corrupted tail down rather than
+	 * spinning through stale submissions.
+	 */
+	if ((unsigned int) (tail - ring->sq_head) > ring->nslots) {
+		atomic_store(&ring->closing, true);
+		return;
+	}
+
+	while (ring->sq_head != tail) {
+		size_t slot = ring->sq[ring->sq_head % ring->nslots];
+		ring->sq_head++;
+
+		/* The client is not trusted to submit sane requests. */
+		if (slot >= ring->nslots)
+			continue;
+
+		ring_desc_t *desc = &ring->desc[slot];
+		if (atomic_load_explicit(&desc->state, memory_order_acquire) !=
+		    RING_SLOT_SUBMITTED)
+			continue;
+
+		sysarg_t args[ASYNC_RING_ARGS];
+		memcpy(args, desc->args, sizeof(args));
+		size_t size = min(desc->size, ring->slot_size);
+
+		errno_t rc = ring->handler(ring->arg, args,
+		    ring->payload + slot * ring->slot_size, &size,
+		    ring->slot_size);
+
+		memcpy(desc->args, args, sizeof(args));
+		desc->size = min(size, ring->slot_size);
+		desc->retval = rc;
+		atomic_store_explicit(&desc->state, RING_SLOT_DONE,
+		    memory_order_release);
+
+		ring_kick(&ring->hdr->client_idle, ring->cq_wq);
+	}
+}
+
+static errno_t ring_server_thread(void *arg)
+{
+	async_ring_t *ring = arg;
+
+	while (true) {
+		ring_server_process(ring);
+		if (ring_closed(ring))
+			break;
+
+		ring_idle(ring, &ring->hdr->server_idle, ring->sq_wq,
+		    ring_server_pending);
+	}
+
+	/* Let the client notice the ring is gone. */
+	atomic_store(&ring->hdr->closed, true);
+	ring_waitq_wakeup(ring->cq_wq);
+
+	ring_thread_stopped(ring);
+	return EOK;
+}
+
+static bool ring_client_pending(async_ring_t *ring)
+{
+	if (ring_closed(ring))
+		return true;
+
+	for (size_t i = 0; i < ring->nslots; i++) {
+		if (atomic_load_explicit(&ring->desc[i].state,
+		    memory_order_relaxed) == RING_SLOT_DONE)
+			return true;
+	}
+
+	return false;
+}
+
+/** Dispatch completed requests to the waiting fibrils. */
+static void ring_client_collect(async_ring_t *ring)
+{
+	for (size_t i = 0; i < ring->nslots; i++) {
+		unsigned int state = RING_SLOT_DONE;
+		if (atomic_compare_exchange_strong(&ring->desc[i].state, &state,
+		    RING_SLOT_COLLECTED))
+			fibril_notify(&ring->done[i]);
+	}
+}
+
+static errno_t ring_client_thread(void *arg)
+{
+	async_ring_t *ring = arg;
+
+	while (true) {
+		ring_client_collect(ring);
+		if (ring_closed(ring))
+			break;
+
+		ring_idle(ring, &ring->hdr->client_idle, ring->cq_wq,
+		    ring_client_pending);
+	}
+
+	/* Release fibrils still waiting for their requests. */
+	for (size_t i = 0; i < ring->nslots; i++)
+		fibril_notify(&ring->done[i]);
+
+	ring_thread_stopped(ring);
+	return EOK;
+}
+
+static errno_t ring_start_thread(async_ring_t *ring, errno_t (*func)(void *),
+    const char *name)
+{
+	fibril_enable_multithreaded();
+
+	atomic_fetch_add(&ring->refcnt, 1);
+	errno_t rc = thread_create(func, ring, name);
+	if (rc != EOK)
+		atomic_fetch_sub(&ring->refcnt, 1);
+	else
+		ring->thread_started = true;
+
+	return rc;
+}
+
+/** Create a request ring.
+ *
+ * Asks the server to accept a ring using @a imethod. The server is expected
+ * to pass the call to async_ring_accept().
+ *
+ * @param exch      Exchange for sending the setup messages.
+ * @param imethod   Interface and method of the setup call.
+ * @param nslots    Number of request slots.
+ * @param slot_size Size of the payload buffer of each slot.
+ * @param rring     Place to store the new ring.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t async_ring_create(async_exch_t *exch, sysarg_t imethod, size_t nslots,
+    size_t slot_size, async_ring_t **rring)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	if (!ring_params_valid(nslots, slot_size))
+		return EINVAL;
+
+	async_ring_t *ring = ring_alloc(nslots, slot_size);
+	if (ring == NULL)
+		return ENOMEM;
+
+	ring->free = calloc(nslots, sizeof(size_t));
+	ring->done = calloc(nslots, sizeof(fibril_event_t));
+	if (ring->free == NULL || ring->done == NULL) {
+		ring_free(ring);
+		return ENOMEM;
+	}
+
+	for (size_t i = 0; i < nslots; i++)
+		ring->free[i] = nslots - i - 1;
+	ring->nfree = nslots;
+
+	size_t sq_off, desc_off, payload_off;
+	size_t area_size = ring_layout(nslots, slot_size, &sq_off, &desc_off,
+	    &payload_off);
+
+	void *area = as_area_create(AS_AREA_ANY, area_size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED) {
+		ring_free(ring);
+		return ENOMEM;
+	}
+
+	ring_map(ring, area);
+
+	ipc_call_t answer;
+	aid_t req = async_send_2(exch, imethod, nslots, slot_size, &answer);
+
+	errno_t rc = async_share_out_start(exch, area,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE);
+	if (rc == EOK)
+		rc = async_waitq_share_in_start(exch, 0, &ring->sq_wq);
+	if (rc == EOK)
+		rc = async_waitq_share_in_start(exch, 1, &ring->cq_wq);
+
+	if (rc != EOK) {
+		async_forget(req);
+		ring_free(ring);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK) {
+		ring_free(ring);
+		return retval;
+	}
+
+	rc = ring_start_thread(ring, ring_client_thread, "ring_client");
+	if (rc != EOK) {
+		async_ring_destroy(ring);
+		return rc;
+	}
+
+	*rring = ring;
+	return EOK;
+}
+
+/** Accept a request ring.
+ *
+ * Receives the shared area and hands out the doorbells requested
+ * by async_ring_create(), then starts servicing the ring. The setup
+ * call is answered.
+ *
+ * @param icall   Ring setup call.
+ * @param handler Request handler.
+ * @param arg     Argument passed to @a handler.
+ * @param rring   Place to store the new ring.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t async_ring_accept(ipc_call_t *icall, async_ring_handler_t handler,
+    void *arg, async_ring_t **rring)
+{
+	size_t nslots = ipc_get_arg1(icall);
+	size_t slot_size = ipc_get_arg2(icall);
+
+	ipc_call_t call;
+	size_t size;
+	unsigned int flags;
+
+	if (!ring_params_valid(nslots, slot_size)) {
+		async_answer_0(icall, EINVAL);
+		return EINVAL;
+	}
+
+	async_ring_t *ring = ring_alloc(nslots, slot_size);
+	if (ring == NULL) {
+		async_answer_0(icall, ENOMEM);
+		return ENOMEM;
+	}
+
+	ring->handler = handler;
+	ring->arg = arg;
+
+	size_t sq_off, desc_off, payload_off;
+	size_t area_size = ring_layout(nslots, slot_size, &sq_off, &desc_off,
+	    &payload_off);
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		ring_free(ring);
+		return EINVAL;
+	}
+
+	if (size != area_size ||
+	    (flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		ring_free(ring);
+		return EINVAL;
+	}
+
+	void *area;
+	errno_t rc = async_share_out_finalize(&call, &area);
+	if (rc != EOK || area == AS_MAP_FAILED) {
+		async_answer_0(icall, ENOMEM);
+		ring_free(ring);
+		return ENOMEM;
+	}
+
+	ring_map(ring, area);
+
+	rc = ring_waitq_create(&ring->sq_wq);
+	if (rc == EOK)
+		rc = ring_waitq_create(&ring->cq_wq);
+
+	for (unsigned int i = 0; i < 2; i++) {
+		sysarg_t which;
+		if (!async_waitq_share_in_receive(&call, &which) || which > 1) {
+			async_answer_0(&call, EINVAL);
+			rc = EINVAL;
+			continue;
+		}
+
+		if (rc != EOK) {
+			async_answer_0(&call, rc);
+			continue;
+		}
+
+		rc = async_waitq_share_in_finalize(&call,
+		    which == 0 ? ring->sq_wq : ring->cq_wq);
+	}
+
+	if (rc == EOK)
+		rc = ring_start_thread(ring, ring_server_thread, "ring_server");
+
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		ring_free(ring);
+		return rc;
+	}
+
+	async_answer_0(icall, EOK);
+
+	*rring = ring;
+	return EOK;
+}
+
+/** Destroy a ring.
+ *
+ * Shuts the ring down on both sides. Requests in flight on the client
+ * side fail with EHANGUP. Blocks the calling fibril until the local
+ * doorbell thread has stopped, so that once this returns no request
+ * handler is running and none will be called anymore.
+ *
+ * @param ring Ring.
+ *
+ */
+void async_ring_destroy(async_ring_t *ring)
+{
+	atomic_store(&ring->closing, true);
+	atomic_store(&ring->hdr->closed, true);
+
+	ring_waitq_wakeup(ring->sq_wq);
+	ring_waitq_wakeup(ring->cq_wq);
+
+	if (ring->thread_started) {
+		while (!atomic_load(&ring->stopped))
+			fibril_wait_for(&ring->stopped_ev);
+	}
+
+	ring_release(ring);
+}
+
+/** Get the size of the payload buffer of a ring slot. */
+size_t async_ring_slot_size(async_ring_t *ring)
+{
+	return ring->slot_size;
+}
+
+/** Allocate a ring slot.
+ *
+ * Blocks the calling fibril until a slot is available.
+ *
+ * @param ring  Ring.
+ * @param rslot Place to store the slot index.
+ *
+ * @return Payload buffer of the slot.
+ *
+ */
+void *async_ring_slot_get(async_ring_t *ring, size_t *rslot)
+{
+	fibril_mutex_lock(&ring->lock);
+
+	while (ring->nfree == 0)
+		fibril_condvar_wait(&ring->free_cv, &ring->lock);
+
+	size_t slot = ring->free[--ring->nfree];
+
+	fibril_mutex_unlock(&ring->lock);
+
+	*rslot = slot;
+	return ring->payload + slot * ring->slot_size;
+}
+
+/** Return a ring slot allocated by async_ring_slot_get(). */
+void async_ring_slot_put(async_ring_t *ring, size_t slot)
+{
+	assert(slot < ring->nslots);
+
+	fibril_mutex_lock(&ring->lock);
+	ring->free[ring->nfree++] = slot;
+	fibril_condvar_signal(&ring->free_cv);
+	fibril_mutex_unlock(&ring->lock);
+}
+
+/** Submit a request through a ring and wait for its completion.
+ *
+ * @param ring Ring.
+ * @param slot Slot holding the request payload.
+ * @param args Request arguments, overwritten by the returned arguments.
+ * @param size On entry the payload size, on return the payload size
+ *             reported by the server. Can be NULL.
+ *
+ * @return Return value of the request or EHANGUP if the ring has been
+ *         shut down.
+ *
+ */
+errno_t async_ring_call(async_ring_t *ring, size_t slot, sysarg_t *args,
+    size_t *size)
+{
+	assert(slot < ring->nslots);
+
+	ring_desc_t *desc = &ring->desc[slot];
+
+	memcpy(desc->args, args, sizeof(desc->args));
+	desc->size = (size != NULL) ? min(*size, ring->slot_size) : 0;
+	desc->retval = EOK;
+	atomic_store_explicit(&desc->state, RING_SLOT_SUBMITTED,
+	    memory_order_relaxed);
+
+	fibril_mutex_lock(&ring->lock);
+
+	unsigned int tail = atomic_load_explicit(&ring->hdr->sq_tail,
+	    memory_order_relaxed);
+	ring->sq[tail % ring->nslots] = slot;
+	atomic_store_explicit(&ring->hdr->sq_tail, tail + 1,
+	    memory_order_release);
+
+	fibril_mutex_unlock(&ring->lock);
+
+	ring_kick(&ring->hdr->server_idle, ring->sq_wq);
+
+	/*
+	 * Stale notifications left over from earlier uses of the slot
+	 * are harmless, the state is always rechecked.
+	 */
+	while (true) {
+		unsigned int state = atomic_load_explicit(&desc->state,
+		    memory_order_acquire);
+		if (state == RING_SLOT_DONE || state == RING_SLOT_COLLECTED)
+			break;
+
+		if (ring_closed(ring)) {
+			atomic_store(&desc->state, RING_SLOT_FREE);
+			return EHANGUP;
+		}
+
+		fibril_wait_for(&ring->done[slot]);
+	}
+
+	memcpy(args, desc->args, sizeof(desc->args));
+	if (size != NULL)
+		*size = min(desc->size, ring->slot_size);
+
+	errno_t rc = desc->retval;
+	atomic_store_explicit(&desc->state, RING_SLOT_FREE,
+	    memory_order_relaxed);
+	return rc;
+}
+
+/** @}
+ */
@@ -1112,6 +1112,9 @@ static errno_t async_forward_fast(ipc_call_t *call, async_exch_t *exch,
 	if (exch == NULL)
 		return ENOENT;
 
+	/* The forwarded call must not overtake deferred requests. */
+	async_send_flush();
+
 	return ipc_forward_fast(chandle, exch->phone, imethod, arg1, arg2,
 	    mode);
 }
@@ -1129,6 +1132,9 @@ static errno_t async_forward_slow(ipc_call_t *call, async_exch_t *exch,
 	if (exch == NULL)
 		return ENOENT;
 
+	/* The forwarded call must not overtake deferred requests. */
+	async_send_flush();
+
 	return ipc_forward_slow(chandle, exch->phone, imethod, arg1, arg2, arg3,
 	    arg4, arg5, mode);
 }
@@ -1308,6 +1314,52 @@ errno_t async_share_out_finalize(ipc_call_t *call, void **dst)
 	    (sysarg_t) dst);
 }
 
+/** Wrapper for receiving the IPC_M_WAITQ_SHARE_IN calls using the async
+ * framework.
+ *
+ * So far, this wrapper is to be used from within a connection fibril.
+ *
+ * @param call Storage for the data of the IPC_M_WAITQ_SHARE_IN call.
+ * @param arg  Storage for the user defined argument. Can be NULL.
+ *
+ * @return True on success, false on failure.
+ *
+ */
+bool async_waitq_share_in_receive(ipc_call_t *call, sysarg_t *arg)
+{
+	assert(call);
+
+	async_get_call(call);
+
+	if (ipc_get_imethod(call) != IPC_M_WAITQ_SHARE_IN)
+		return false;
+
+	if (arg)
+		*arg = ipc_get_arg1(call);
+	return true;
+}
+
+/** Wrapper for answering the IPC_M_WAITQ_SHARE_IN calls using the async
+ * framework.
+ *
+ * @param call    IPC_M_WAITQ_SHARE_IN call to answer.
+ * @param whandle Capability of the wait queue to share with the caller.
+ *
+ * @return Zero on success or a value from @ref errno.h on failure.
+ *
+ */
+errno_t async_waitq_share_in_finalize(ipc_call_t *call,
+    cap_waitq_handle_t whandle)
+{
+	assert(call);
+
+	cap_call_handle_t chandle = call->cap_handle;
+	assert(chandle != CAP_NIL);
+	call->cap_handle = CAP_NIL;
+
+	return ipc_answer_1(chandle, EOK, cap_handle_raw(whandle));
+}
+
 /** Wrapper for receiving the IPC_M_DATA_READ calls using the async framework.
  *
  * This wrapper only makes it more comfortable to receive IPC_M_DATA_READ
@@ -1385,6 +1437,8 @@ static errno_t async_data_read_forward_fast(async_exch_t *exch, sysarg_t imethod
 		return EINVAL;
 	}
 
+	async_send_flush();
+
 	errno_t retval = ipc_forward_fast(call.cap_handle, exch->phone, 0, 0, 0,
 	    IPC_FF_ROUTE_FROM_ME);
 	if (retval != EOK) {
@@ -1630,6 +1684,8 @@ static errno_t async_data_write_forward_fast(async_exch_t *exch,
 		return EINVAL;
 	}
 
+	async_send_flush();
+
 	errno_t retval = ipc_forward_fast(call.cap_handle, exch->phone, 0, 0, 0,
 	    IPC_FF_ROUTE_FROM_ME);
 	if (retval != EOK) {
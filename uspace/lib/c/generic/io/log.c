@@ -34,10 +34,14 @@
 #include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
+#include <stdalign.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <async.h>
+#include <align.h>
 #include <io/log.h>
 #include <ipc/logger.h>
 #include <str.h>
@@ -66,6 +70,49 @@ static async_sess_t *logger_session;
 /** Maximum length of a single log message (in bytes). */
 #define MESSAGE_BUFFER_SIZE 4096
 
+/** Size of a buffer for messages waiting to be sent to the logger. */
+#define BATCH_BUFFER_SIZE 16384
+
+/** Maximum number of logs with mirrored levels (cf. logger's per-client limit). */
+#define MAX_MIRRORED_LOGS 100
+
+/** Logging level of a log as reported by the logger. */
+typedef struct {
+	log_t log;
+	log_level_t level;
+} log_level_mirror_t;
+
+/** Protects level mirrors. */
+static FIBRIL_MUTEX_INITIALIZE(levels_guard);
+
+/** Levels of logs created by this task. */
+static log_level_mirror_t levels[MAX_MIRRORED_LOGS];
+static size_t levels_count;
+
+/** Whether the logger notifies us about level changes. */
+static bool levels_mirrored;
+
+/** Highest level recorded by any of our logs.
+ *
+ * Messages above this level are dropped right away.
+ */
+static atomic_uint max_level = LVL_LIMIT;
+
+/** Protects message buffers and the formatting buffer. */
+static FIBRIL_MUTEX_INITIALIZE(batch_guard);
+static FIBRIL_CONDVAR_INITIALIZE(batch_cv);
+
+/** Serializes sending of batches to keep messages in order. */
+static FIBRIL_MUTEX_INITIALIZE(flush_guard);
+
+/** Buffer being filled with messages and the one being sent. */
+static char *batch_buffers[2];
+static size_t batch_fill;
+static size_t batch_used;
+
+/** Buffer for message formatting. */
+static char *message_buffer;
+
 /** Send formatted message to the logger service.
  *
  * @param session Initialized IPC session with the logger.
@@ -108,6 +155,287 @@ static errno_t logger_message(async_sess_t *session, log_t log, log_level_t leve
 	return reg_msg_rc;
 }
 
+/** Send a buffer of messages to the logger service.
+ *
+ * @param session Initialized IPC session with the logger.
+ * @param buffer Buffer with logger_batch_msg_t records.
+ * @param size Size of the buffer.
+ * @return Error code of the conversion or EOK on success.
+ */
+static errno_t logger_messages(async_sess_t *session, const void *buffer,
+    size_t size)
+{
+	async_exch_t *exchange = async_exchange_begin(session);
+	if (exchange == NULL)
+		return ENOMEM;
+
+	aid_t reg_msg = async_send_0(exchange, LOGGER_WRITER_MESSAGES, NULL);
+	errno_t rc = async_data_write_start(exchange, buffer, size);
+	errno_t reg_msg_rc;
+	async_wait_for(reg_msg, &reg_msg_rc);
+
+	async_exchange_end(exchange);
+
+	if (rc != EOK)
+		return rc;
+
+	return reg_msg_rc;
+}
+
+/** Get the level up to which the logger records messages to a log.
+ *
+ * @param log Log id.
+ * @param level Place to store the level.
+ * @return Error code of the conversion or EOK on success.
+ */
+static errno_t logger_get_level(log_t log, log_level_t *level)
+{
+	async_exch_t *exchange = async_exchange_begin(logger_session);
+	if (exchange == NULL)
+		return ENOMEM;
+
+	sysarg_t lvl;
+	errno_t rc = async_req_1_1(exchange, LOGGER_WRITER_GET_LEVEL, log,
+	    &lvl);
+
+	async_exchange_end(exchange);
+
+	if (rc != EOK)
+		return rc;
+
+	*level = (log_level_t) lvl;
+	return EOK;
+}
+
+/** Recompute the highest level recorded by any of our logs.
+ *
+ * Must be called with levels_guard held.
+ */
+static void levels_update_max(void)
+{
+	unsigned max = 0;
+
+	if (!levels_mirrored) {
+		max = LVL_LIMIT;
+	} else {
+		for (size_t i = 0; i < levels_count; i++) {
+			if (levels[i].level > max)
+				max = levels[i].level;
+		}
+	}
+
+	atomic_store(&max_level, max);
+}
+
+/** Remember the level of a newly created log. */
+static void levels_add(log_t log, log_level_t level)
+{
+	fibril_mutex_lock(&levels_guard);
+
+	for (size_t i = 0; i < levels_count; i++) {
+		if (levels[i].log == log) {
+			fibril_mutex_unlock(&levels_guard);
+			return;
+		}
+	}
+
+	if (levels_count < MAX_MIRRORED_LOGS) {
+		levels[levels_count].log = log;
+		levels[levels_count].level = level;
+		levels_count++;
+	} else {
+		/* Cannot mirror any more logs, leave filtering to the logger. */
+		levels_mirrored = false;
+	}
+
+	levels_update_max();
+	fibril_mutex_unlock(&levels_guard);
+}
+
+/** Refresh mirrored levels of all our logs. */
+static void levels_refresh(void)
+{
+	fibril_mutex_lock(&levels_guard);
+
+	for (size_t i = 0; i < levels_count; i++) {
+		log_level_t level;
+		if (logger_get_level(levels[i].log, &level) == EOK)
+			levels[i].level = level;
+		else
+			levels[i].level = LVL_LIMIT;
+	}
+
+	levels_update_max();
+	fibril_mutex_unlock(&levels_guard);
+}
+
+/** Check whether a message would be recorded by the logger.
+ *
+ * @param log Log to use.
+ * @param level Verbosity level of the message.
+ * @return True if the message should be sent to the logger.
+ */
+static bool shall_log_message(log_t log, log_level_t level)
+{
+	if (level > atomic_load_explicit(&max_level, memory_order_relaxed))
+		return false;
+
+	if (log == LOG_DEFAULT)
+		log = default_log_id;
+
+	bool result = true;
+
+	fibril_mutex_lock(&levels_guard);
+	if (levels_mirrored) {
+		for (size_t i = 0; i < levels_count; i++) {
+			if (levels[i].log == log) {
+				result = level <= levels[i].level;
+				break;
+			}
+		}
+	}
+	fibril_mutex_unlock(&levels_guard);
+
+	return result;
+}
+
+static void logger_cb_conn(ipc_call_t *icall, void *arg)
+{
+	while (true) {
+		ipc_call_t call;
+		async_get_call(&call);
+
+		if (!ipc_get_imethod(&call)) {
+			async_answer_0(&call, EOK);
+			return;
+		}
+
+		switch (ipc_get_imethod(&call)) {
+		case LOGGER_EVENT_LEVEL_CHANGE:
+			async_answer_0(&call, EOK);
+			levels_refresh();
+			break;
+		default:
+			async_answer_0(&call, ENOTSUP);
+		}
+	}
+}
+
+/** Ask the logger to notify us about level changes. */
+static errno_t logger_callback_create(void)
+{
+	async_exch_t *exchange = async_exchange_begin(logger_session);
+	if (exchange == NULL)
+		return ENOMEM;
+
+	aid_t req = async_send_0(exchange, LOGGER_WRITER_CALLBACK_CREATE, NULL);
+
+	port_id_t port;
+	errno_t rc = async_create_callback_port(exchange, INTERFACE_LOGGER_CB,
+	    0, 0, logger_cb_conn, NULL, &port);
+
+	async_exchange_end(exchange);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	return retval;
+}
+
+/** Append a message to the batch buffer.
+ *
+ * @param log Log to use.
+ * @param level Verbosity level of the message.
+ * @param message The message.
+ * @return True on success, false if the buffer is full.
+ */
+static bool batch_append(log_t log, log_level_t level, const char *message)
+{
+	size_t size = str_size(message);
+	size_t rsize = ALIGN_UP(sizeof(logger_batch_msg_t) + size,
+	    alignof(logger_batch_msg_t));
+
+	if (batch_used + rsize > BATCH_BUFFER_SIZE)
+		return false;
+
+	logger_batch_msg_t *hdr =
+	    (logger_batch_msg_t *) &batch_buffers[batch_fill][batch_used];
+	hdr->log = log;
+	hdr->level = level;
+	hdr->size = size;
+	memcpy(hdr + 1, message, size);
+
+	batch_used += rsize;
+	return true;
+}
+
+/** Send all buffered messages to the logger.
+ *
+ * Messages of the calling fibril logged before this call are delivered to
+ * the logger when it returns.
+ */
+void log_flush(void)
+{
+	if (logger_session == NULL)
+		return;
+
+	fibril_mutex_lock(&flush_guard);
+
+	fibril_mutex_lock(&batch_guard);
+	char *buffer = batch_buffers[batch_fill];
+	size_t size = batch_used;
+	batch_fill = 1 - batch_fill;
+	batch_used = 0;
+	fibril_mutex_unlock(&batch_guard);
+
+	if (size > 0)
+		(void) logger_messages(logger_session, buffer, size);
+
+	fibril_mutex_unlock(&flush_guard);
+}
+
+/** Send all buffered messages to the logger and make it write them out.
+ *
+ * Use on crash paths to make sure the messages reach the storage.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t log_sync(void)
+{
+	if (logger_session == NULL)
+		return ENOENT;
+
+	log_flush();
+
+	async_exch_t *exchange = async_exchange_begin(logger_session);
+	if (exchange == NULL)
+		return ENOMEM;
+
+	errno_t rc = async_req_0_0(exchange, LOGGER_WRITER_SYNC);
+	async_exchange_end(exchange);
+
+	return rc;
+}
+
+/** Fibril sending buffered messages to the logger in the background. */
+static errno_t log_flush_fibril(void *arg)
+{
+	while (true) {
+		fibril_mutex_lock(&batch_guard);
+		while (batch_used == 0)
+			fibril_condvar_wait(&batch_cv, &batch_guard);
+		fibril_mutex_unlock(&batch_guard);
+
+		log_flush();
+	}
+
+	return EOK;
+}
+
 /** Get name of the log level.
  *
  * @param level The log level.
@@ -172,6 +500,30 @@ errno_t log_init(const char *prog_name)
 	if (logger_session == NULL)
 		return rc;
 
+	/*
+	 * Without the level change notifications or the background fibril
+	 * we can still work, just less efficiently.
+	 */
+	levels_mirrored = (logger_callback_create() == EOK);
+
+	batch_buffers[0] = malloc(BATCH_BUFFER_SIZE);
+	batch_buffers[1] = malloc(BATCH_BUFFER_SIZE);
+	message_buffer = malloc(MESSAGE_BUFFER_SIZE);
+	fid_t fid = fibril_create(log_flush_fibril, NULL);
+	if (batch_buffers[0] == NULL || batch_buffers[1] == NULL ||
+	    message_buffer == NULL || fid == 0) {
+		free(batch_buffers[0]);
+		free(batch_buffers[1]);
+		free(message_buffer);
+		batch_buffers[0] = batch_buffers[1] = NULL;
+		message_buffer = NULL;
+		if (fid != 0)
+			fibril_destroy(fid);
+	} else {
+		fibril_add_ready(fid);
+		atexit(log_flush);
+	}
+
 	default_log_id = log_create(prog_name, LOG_NO_PARENT);
 
 	return EOK;
@@ -207,6 +559,7 @@ log_t log_create(const char *name, log_t parent)
 	if ((rc != EOK) || (reg_msg_rc != EOK))
 		return parent;
 
+	levels_add(ipc_get_arg1(&answer), ipc_get_arg2(&answer));
 	return ipc_get_arg1(&answer);
 }
 
@@ -229,6 +582,10 @@ void log_msg(log_t ctx, log_level_t level, const char *fmt, ...)
 }
 
 /** Write an entry to the log (va_list variant).
+ *
+ * Messages are buffered and sent to the logger by a background fibril.
+ * Errors are delivered before this function returns, fatal errors are also
+ * written to storage.
  *
  * @param ctx Log to use (use LOG_DEFAULT if you have no idea what it means).
  * @param level Severity level of the message.
@@ -239,13 +596,45 @@ void log_msgv(log_t ctx, log_level_t level, const char *fmt, va_list args)
 {
 	assert(level < LVL_LIMIT);
 
-	char *message_buffer = malloc(MESSAGE_BUFFER_SIZE);
-	if (message_buffer == NULL)
+	if (!shall_log_message(ctx, level))
+		return;
+
+	if (ctx == LOG_DEFAULT)
+		ctx = default_log_id;
+
+	if (message_buffer == NULL) {
+		/* Buffering not available, send the message right away. */
+		char *buffer = malloc(MESSAGE_BUFFER_SIZE);
+		if (buffer == NULL)
+			return;
+
+		vsnprintf(buffer, MESSAGE_BUFFER_SIZE, fmt, args);
+		logger_message(logger_session, ctx, level, buffer);
+		free(buffer);
 		return;
+	}
+
+	fibril_mutex_lock(&batch_guard);
 
 	vsnprintf(message_buffer, MESSAGE_BUFFER_SIZE, fmt, args);
-	logger_message(logger_session, ctx, level, message_buffer);
-	free(message_buffer);
+
+	// FIXME: remove when all USB drivers use libc logging explicitly
+	str_rtrim(message_buffer, '\n');
+
+	while (!batch_append(ctx, level, message_buffer)) {
+		/* Buffer is full, flush it ourselves. */
+		fibril_mutex_unlock(&batch_guard);
+		log_flush();
+		fibril_mutex_lock(&batch_guard);
+	}
+
+	fibril_condvar_signal(&batch_cv);
+	fibril_mutex_unlock(&batch_guard);
+
+	if (level == LVL_FATAL)
+		(void) log_sync();
+	else if (level <= LVL_ERROR)
+		log_flush();
 }
 
 /** @}
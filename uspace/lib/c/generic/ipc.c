@@ -176,6 +176,35 @@ errno_t ipc_wait(ipc_call_t *call, sysarg_t usec, unsigned int flags)
 	return __SYSCALL3(SYS_IPC_WAIT, (sysarg_t) call, usec, flags);
 }
 
+/** Send several asynchronous calls and receive several calls or answers.
+ *
+ * The requests are sent in order and the outcome of each one is stored in
+ * its rc field. Then the caller waits for the first call or answer according
+ * to @a usec and @a flags and any further ones that are already pending are
+ * collected as well, until @a results is full.
+ *
+ * @param calls     Requests to send.
+ * @param ncalls    Number of requests, at most IPC_BATCH_MAX.
+ * @param results   Storage for the received calls or answers.
+ * @param nresults  On input the capacity of @a results, at most
+ *                  IPC_BATCH_MAX. On output the number of entries received.
+ * @param usec      Timeout of the first wait.
+ * @param flags     Flags of the first wait.
+ *
+ * @return EOK if at least one entry was received or none was requested.
+ * @return Error code of the first wait otherwise.
+ *
+ */
+errno_t ipc_batch(ipc_batch_call_t *calls, size_t ncalls, ipc_call_t *results,
+    size_t *nresults, sysarg_t usec, unsigned int flags)
+{
+	for (size_t i = 0; i < ncalls; i++)
+		calls[i].rc = EINVAL;
+
+	return (errno_t) __SYSCALL6(SYS_IPC_BATCH, (sysarg_t) calls, ncalls,
+	    (sysarg_t) results, (sysarg_t) nresults, usec, flags);
+}
+
 /** Hang up a phone.
  *
  * @param phandle  Handle of the phone to be hung up.
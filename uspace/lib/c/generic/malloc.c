@@ -79,6 +79,24 @@
  */
 #define SHRINK_GRANULARITY  (64 * PAGE_SIZE)
 
+/** Largest request served from the thread caches. */
+#define CACHE_MAX_SIZE  1024
+
+/** Number of size classes of a thread cache. */
+#define CACHE_CLASSES  (CACHE_MAX_SIZE / BASE_ALIGN)
+
+/** Maximum number of blocks in a size class of a thread cache. */
+#define CACHE_BIN_MAX  32
+
+/** Number of blocks taken from the heap when a cache bin runs empty. */
+#define CACHE_REFILL  8
+
+/** Maximum total gross size of the blocks held by a thread cache. */
+#define CACHE_MAX_BYTES  (64 * 1024)
+
+/** Size class serving a request of the given size. */
+#define CACHE_CLASS(size)  (ALIGN_UP((size), BASE_ALIGN) / BASE_ALIGN - 1)
+
 /** Overhead of each heap block. */
 #define STRUCT_OVERHEAD \
 	(sizeof(heap_block_head_t) + sizeof(heap_block_foot_t))
@@ -169,6 +187,9 @@ typedef struct {
 	/* Indication of a free block */
 	bool free;
 
+	/* Indication of a used block held by a thread cache */
+	bool cached;
+
 	/** Heap area this block belongs to */
 	heap_area_t *area;
 
@@ -199,6 +220,36 @@ static heap_block_head_t *next_fit = NULL;
 /** Futex for thread-safe heap manipulation */
 static fibril_rmutex_t malloc_mutex;
 
+/** Thread cache bin */
+typedef struct {
+	/** Cached blocks (linked through their first word) */
+	void *first;
+
+	/** Number of cached blocks */
+	unsigned int count;
+} cache_bin_t;
+
+/** Thread cache
+ *
+ * Small blocks released by a thread are kept in its cache, segregated
+ * by size class, and handed out again without taking the heap lock.
+ * As far as the heap is concerned, the cached blocks remain allocated,
+ * so they do not change the heap layout. The cache is passed along
+ * from fibril to fibril running on the thread, see _fibril_switch_to().
+ *
+ */
+struct malloc_cache {
+	cache_bin_t bins[CACHE_CLASSES];
+
+	/** Total gross size of the cached blocks */
+	size_t bytes;
+};
+
+typedef struct malloc_cache malloc_cache_t;
+
+/** Thread caches can be used (the heap and the initial TCB exist) */
+static bool caches_enabled = false;
+
 #define malloc_assert(expr) safe_assert(expr)
 
 /*
@@ -239,6 +290,7 @@ static void block_init(void *addr, size_t size, bool free, heap_area_t *area)
 
 	head->size = size;
 	head->free = free;
+	head->cached = false;
 	head->area = area;
 	head->magic = HEAP_BLOCK_HEAD_MAGIC;
 
@@ -499,6 +551,8 @@ void __malloc_init(void)
 
 	if (!area_create(PAGE_SIZE))
 		abort();
+
+	caches_enabled = true;
 }
 
 void __malloc_fini(void)
@@ -777,6 +831,244 @@ static void *malloc_internal(size_t size, size_t align)
 	return heap_grow_and_alloc(gross_size, falign);
 }
 
+/** Free a memory block
+ *
+ * Should be called only inside the critical section.
+ *
+ * @param head Header of the block.
+ *
+ */
+static void free_internal(heap_block_head_t *head)
+{
+	block_check(head);
+	malloc_assert(!head->free);
+	malloc_assert(!head->cached);
+
+	heap_area_t *area = head->area;
+
+	area_check(area);
+	malloc_assert((void *) head >= (void *) AREA_FIRST_BLOCK_HEAD(area));
+	malloc_assert((void *) head < area->end);
+
+	/* Mark the block itself as free. */
+	head->free = true;
+
+	/* Look at the next block. If it is free, merge the two. */
+	heap_block_head_t *next_head =
+	    (heap_block_head_t *) (((void *) head) + head->size);
+
+	if ((void *) next_head < area->end) {
+		block_check(next_head);
+		if (next_head->free)
+			block_init(head, head->size + next_head->size, true, area);
+	}
+
+	/* Look at the previous block. If it is free, merge the two. */
+	if ((void *) head > (void *) AREA_FIRST_BLOCK_HEAD(area)) {
+		heap_block_foot_t *prev_foot =
+		    (heap_block_foot_t *) (((void *) head) - sizeof(heap_block_foot_t));
+
+		heap_block_head_t *prev_head =
+		    (heap_block_head_t *) (((void *) head) - prev_foot->size);
+
+		block_check(prev_head);
+
+		if (prev_head->free)
+			block_init(prev_head, prev_head->size + head->size, true,
+			    area);
+	}
+
+	heap_shrink(area);
+}
+
+/** Put a block into a thread cache bin.
+ *
+ * @param cache Thread cache.
+ * @param bin   Bin of the block size class.
+ * @param addr  Address of the block.
+ *
+ */
+static void cache_push(malloc_cache_t *cache, cache_bin_t *bin, void *addr)
+{
+	heap_block_head_t *head =
+	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
+
+	head->cached = true;
+	*((void **) addr) = bin->first;
+	bin->first = addr;
+	bin->count++;
+	cache->bytes += head->size;
+}
+
+/** Take a block from a non-empty thread cache bin.
+ *
+ * @param cache Thread cache.
+ * @param bin   Bin to take the block from.
+ *
+ * @return Address of the block.
+ *
+ */
+static void *cache_pop(malloc_cache_t *cache, cache_bin_t *bin)
+{
+	void *addr = bin->first;
+	heap_block_head_t *head =
+	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
+
+	block_check(head);
+	malloc_assert(head->cached);
+
+	bin->first = *((void **) addr);
+	bin->count--;
+	cache->bytes -= head->size;
+	head->cached = false;
+
+	return addr;
+}
+
+/** Return blocks from a thread cache bin to the heap.
+ *
+ * Should be called only inside the critical section.
+ *
+ * @param cache Thread cache.
+ * @param bin   Bin to drain.
+ * @param count Number of blocks to return.
+ *
+ */
+static void cache_drain(malloc_cache_t *cache, cache_bin_t *bin,
+    unsigned int count)
+{
+	while (count-- > 0 && bin->first != NULL) {
+		void *addr = cache_pop(cache, bin);
+		free_internal((heap_block_head_t *)
+		    (addr - sizeof(heap_block_head_t)));
+	}
+}
+
+/** Get the cache of the current thread.
+ *
+ * @param create Create the cache if the thread does not have one yet.
+ *
+ * @return Thread cache or NULL.
+ *
+ */
+static malloc_cache_t *cache_get(bool create)
+{
+	if (!caches_enabled)
+		return NULL;
+
+	fibril_t *self = fibril_self();
+
+	if ((self->malloc_cache == NULL) && (create)) {
+		heap_lock();
+		malloc_cache_t *cache =
+		    malloc_internal(sizeof(malloc_cache_t), BASE_ALIGN);
+		heap_unlock();
+
+		if (cache != NULL)
+			memset(cache, 0, sizeof(malloc_cache_t));
+
+		self->malloc_cache = cache;
+	}
+
+	return self->malloc_cache;
+}
+
+/** Allocate a small block from a thread cache.
+ *
+ * An empty bin is refilled from the heap by a batch of blocks, so that
+ * the heap lock is taken once per CACHE_REFILL allocations.
+ *
+ * @param cache Thread cache.
+ * @param size  Size of the block (at most CACHE_MAX_SIZE).
+ *
+ * @return Address of the allocated block or NULL on not enough memory.
+ *
+ */
+static void *cache_alloc(malloc_cache_t *cache, size_t size)
+{
+	size_t cls = CACHE_CLASS(max(size, 1));
+	cache_bin_t *bin = &cache->bins[cls];
+
+	if (bin->first == NULL) {
+		size_t csize = (cls + 1) * BASE_ALIGN;
+
+		heap_lock();
+
+		for (unsigned int i = 0; i < CACHE_REFILL; i++) {
+			void *addr = malloc_internal(csize, BASE_ALIGN);
+			if (addr == NULL)
+				break;
+
+			cache_push(cache, bin, addr);
+		}
+
+		heap_unlock();
+
+		if (bin->first == NULL)
+			return NULL;
+	}
+
+	return cache_pop(cache, bin);
+}
+
+/** Release a block to a thread cache.
+ *
+ * If the bin or the cache is full, half of the bin is returned
+ * to the heap together with the block.
+ *
+ * @param cache Thread cache.
+ * @param head  Header of the block.
+ *
+ * @return False if the block is too large to be cached.
+ *
+ */
+static bool cache_free(malloc_cache_t *cache, heap_block_head_t *head)
+{
+	size_t cls = NET_SIZE(head->size) / BASE_ALIGN - 1;
+	if (cls >= CACHE_CLASSES)
+		return false;
+
+	cache_bin_t *bin = &cache->bins[cls];
+
+	if ((bin->count >= CACHE_BIN_MAX) ||
+	    (cache->bytes + head->size > CACHE_MAX_BYTES)) {
+		heap_lock();
+		cache_drain(cache, bin, (bin->count + 1) / 2);
+		free_internal(head);
+		heap_unlock();
+		return true;
+	}
+
+	cache_push(cache, bin, ((void *) head) + sizeof(heap_block_head_t));
+	return true;
+}
+
+/** Release the cache of the current thread
+ *
+ * Called when the thread is about to exit.
+ *
+ */
+void __malloc_thread_fini(void)
+{
+	fibril_t *self = fibril_self();
+	malloc_cache_t *cache = self->malloc_cache;
+
+	if (cache == NULL)
+		return;
+
+	self->malloc_cache = NULL;
+
+	heap_lock();
+
+	for (unsigned int i = 0; i < CACHE_CLASSES; i++)
+		cache_drain(cache, &cache->bins[i], cache->bins[i].count);
+
+	free_internal((heap_block_head_t *)
+	    (((void *) cache) - sizeof(heap_block_head_t)));
+
+	heap_unlock();
+}
+
 /** Allocate memory
  *
  * @param size Number of bytes to allocate.
@@ -786,6 +1078,12 @@ static void *malloc_internal(size_t size, size_t align)
  */
 void *malloc(const size_t size)
 {
+	if (size <= CACHE_MAX_SIZE) {
+		malloc_cache_t *cache = cache_get(true);
+		if (cache != NULL)
+			return cache_alloc(cache, size);
+	}
+
 	heap_lock();
 	void *block = malloc_internal(size, BASE_ALIGN);
 	heap_unlock();
@@ -809,6 +1107,9 @@ void *memalign(const size_t align, const size_t size)
 	size_t palign =
 	    1 << (fnzb(max(sizeof(void *), align) - 1) + 1);
 
+	if (palign <= BASE_ALIGN)
+		return malloc(size);
+
 	heap_lock();
 	void *block = malloc_internal(size, palign);
 	heap_unlock();
@@ -842,6 +1143,7 @@ void *realloc(void *const addr, size_t size)
 
 	block_check(head);
 	malloc_assert(!head->free);
+	malloc_assert(!head->cached);
 
 	heap_area_t *area = head->area;
 
@@ -962,51 +1264,20 @@ void free(void *const addr)
 	if (addr == NULL)
 		return;
 
-	heap_lock();
-
 	/* Calculate the position of the header. */
 	heap_block_head_t *head =
 	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
 
 	block_check(head);
 	malloc_assert(!head->free);
+	malloc_assert(!head->cached);
 
-	heap_area_t *area = head->area;
-
-	area_check(area);
-	malloc_assert((void *) head >= (void *) AREA_FIRST_BLOCK_HEAD(area));
-	malloc_assert((void *) head < area->end);
-
-	/* Mark the block itself as free. */
-	head->free = true;
-
-	/* Look at the next block. If it is free, merge the two. */
-	heap_block_head_t *next_head =
-	    (heap_block_head_t *) (((void *) head) + head->size);
-
-	if ((void *) next_head < area->end) {
-		block_check(next_head);
-		if (next_head->free)
-			block_init(head, head->size + next_head->size, true, area);
-	}
-
-	/* Look at the previous block. If it is free, merge the two. */
-	if ((void *) head > (void *) AREA_FIRST_BLOCK_HEAD(area)) {
-		heap_block_foot_t *prev_foot =
-		    (heap_block_foot_t *) (((void *) head) - sizeof(heap_block_foot_t));
-
-		heap_block_head_t *prev_head =
-		    (heap_block_head_t *) (((void *) head) - prev_foot->size);
-
-		block_check(prev_head);
-
-		if (prev_head->free)
-			block_init(prev_head, prev_head->size + head->size, true,
-			    area);
-	}
-
-	heap_shrink(area);
+	malloc_cache_t *cache = cache_get(false);
+	if ((cache != NULL) && (cache_free(cache, head)))
+		return;
 
+	heap_lock();
+	free_internal(head);
 	heap_unlock();
 }
 
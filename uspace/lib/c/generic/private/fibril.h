@@ -60,6 +60,9 @@ struct fibril {
 
 	fibril_t *thread_ctx;
 
+	/* Per-thread malloc cache, passed along like thread_ctx. */
+	struct malloc_cache *malloc_cache;
+
 	bool is_running : 1;
 	bool is_writer : 1;
 	/* In some places, we use fibril structs that can't be freed. */
@@ -85,6 +88,12 @@ extern void fibril_notify(fibril_event_t *);
 
 extern errno_t fibril_ipc_wait(ipc_call_t *, const struct timespec *);
 extern void fibril_ipc_poke(void);
+extern bool fibril_ready_pending(void);
+
+/* Implemented by the async framework, which may defer its requests. */
+extern void async_send_flush(void);
+extern size_t async_send_queue_take(ipc_batch_call_t *);
+extern void async_send_queue_done(ipc_batch_call_t *, size_t);
 
 /**
  * "Restricted" fibril mutex.
@@ -46,6 +46,7 @@
 #include <mem.h>
 #include <str.h>
 #include <ipc/ipc.h>
+#include <macros.h>
 #include <libarch/faddr.h>
 
 #include "../private/thread.h"
@@ -237,24 +238,78 @@ static fibril_t *_fibril_trigger_internal(fibril_event_t *event, fibril_t *reaso
 	return f;
 }
 
-static errno_t _ipc_wait(ipc_call_t *call, const struct timespec *expires)
+static void _ipc_wait_timeout(const struct timespec *expires, sysarg_t *usec,
+    unsigned int *flags)
 {
+	*usec = SYNCH_NO_TIMEOUT;
+	*flags = SYNCH_FLAGS_NONE;
+
 	if (!expires)
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NONE);
+		return;
+
+	*flags = SYNCH_FLAGS_NON_BLOCKING;
 
 	if (expires->tv_sec == 0)
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+		return;
 
 	struct timespec now;
 	getuptime(&now);
 
 	if (ts_gteq(&now, expires))
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+		return;
+
+	*usec = NSEC2USEC(ts_sub_diff(expires, &now));
+	*flags = SYNCH_FLAGS_NONE;
+}
+
+/*
+ * Waits for IPC like ipc_wait(), but submits the requests deferred by the
+ * async framework in the same system call and, in a single-threaded task,
+ * also collects up to *count calls or answers that are already pending.
+ * On return, *count holds the number of entries stored in calls.
+ */
+static errno_t _ipc_wait(ipc_call_t *calls, size_t *count,
+    const struct timespec *expires, bool locked)
+{
+	sysarg_t usec;
+	unsigned int flags;
+	_ipc_wait_timeout(expires, &usec, &flags);
+
+	/*
+	 * Completing a request that could not be sent notifies its
+	 * waiter, which needs fibril_futex.
+	 */
+	ipc_batch_call_t reqs[IPC_BATCH_MAX];
+	size_t nreqs = 0;
+	if (!locked) {
+		if (multithreaded)
+			async_send_flush();
+		else
+			nreqs = async_send_queue_take(reqs);
+	}
+
+	errno_t rc;
+	if ((nreqs == 0) && (*count == 1)) {
+		rc = ipc_wait(&calls[0], usec, flags);
+	} else {
+		rc = ipc_batch(reqs, nreqs, calls, count, usec, flags);
+		if (nreqs > 0)
+			async_send_queue_done(reqs, nreqs);
+	}
+
+	/* A poke still has to produce an (empty) call. */
+	if ((rc == EOK) || (rc == ENOENT)) {
+		if (*count == 0)
+			*count = 1;
+	} else {
+		*count = 0;
+	}
 
-	return ipc_wait(call, NSEC2USEC(ts_sub_diff(expires, &now)),
-	    SYNCH_FLAGS_NONE);
+	return rc;
 }
 
+static void _ready_list_push(fibril_t *);
+
 /*
  * Waits until a ready fibril is added to the list, or an IPC message arrives.
  * Returns NULL on timeout and may also return NULL if returning from IPC
@@ -297,9 +352,21 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 	if (!multithreaded)
 		assert(list_empty(&ipc_buffer_list));
 
-	/* No fibril is ready, IPC wait it is. */
-	ipc_call_t call = { 0 };
-	rc = _ipc_wait(&call, expires);
+	/*
+	 * No fibril is ready, IPC wait it is.
+	 *
+	 * In a single-threaded task, we may collect more than one call at once,
+	 * because each one that nobody waits for yet can be stored in a buffer
+	 * bucket. With the ready list empty, there is one free bucket for each
+	 * token on the semaphore plus the one we are holding.
+	 */
+	ipc_call_t calls[IPC_BATCH_MAX];
+	calls[0] = (ipc_call_t) { 0 };
+	size_t count = 1;
+	if (!multithreaded)
+		count = min((size_t) IPC_BATCH_MAX, (size_t) ready_st_count + 1);
+
+	rc = _ipc_wait(calls, &count, expires, locked);
 
 	atomic_fetch_sub_explicit(&threads_in_ipc_wait, 1,
 	    memory_order_relaxed);
@@ -322,6 +389,10 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 	 * If there is no fibril waiting, we pop a buffer bucket and
 	 * put our call there. The token then returns when the bucket is
 	 * returned.
+	 *
+	 * Any further calls are handed out the same way, except that
+	 * the woken up fibrils are queued in the ready list and each
+	 * buffer bucket takes one more token.
 	 */
 
 	if (!locked)
@@ -329,20 +400,35 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 
 	futex_lock(&ipc_lists_futex);
 
-	_ipc_waiter_t *w = list_pop(&ipc_waiter_list, _ipc_waiter_t, link);
-	if (w) {
-		*w->call = call;
-		w->rc = rc;
-		/* We switch to the woken up fibril immediately if possible. */
-		f = _fibril_trigger_internal(&w->event, _EVENT_TRIGGERED);
-
-		/* Return token. */
-		_ready_up();
-	} else {
-		_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
-		assert(buf);
-		*buf = (_ipc_buffer_t) { .call = call, .rc = rc };
-		list_append(&buf->link, &ipc_buffer_list);
+	for (size_t i = 0; i < count; i++) {
+		_ipc_waiter_t *w = list_pop(&ipc_waiter_list, _ipc_waiter_t, link);
+		if (w) {
+			*w->call = calls[i];
+			w->rc = rc;
+			fibril_t *wf = _fibril_trigger_internal(&w->event,
+			    _EVENT_TRIGGERED);
+
+			if (i == 0) {
+				/* We switch to the woken up fibril immediately if possible. */
+				f = wf;
+
+				/* Return token. */
+				_ready_up();
+			} else {
+				_ready_list_push(wf);
+			}
+		} else {
+			_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
+			assert(buf);
+			*buf = (_ipc_buffer_t) { .call = calls[i], .rc = rc };
+			list_append(&buf->link, &ipc_buffer_list);
+
+			if (i > 0) {
+				assert(!multithreaded);
+				assert(ready_st_count > 0);
+				ready_st_count--;
+			}
+		}
 	}
 
 	futex_unlock(&ipc_lists_futex);
@@ -488,6 +574,10 @@ static void _fibril_switch_to(_switch_type_t type, fibril_t *dstf, bool locked)
 	dstf->thread_ctx = srcf->thread_ctx;
 	srcf->thread_ctx = NULL;
 
+	assert(dstf->malloc_cache == NULL);
+	dstf->malloc_cache = srcf->malloc_cache;
+	srcf->malloc_cache = NULL;
+
 	/* Just some bookkeeping to allow better debugging of futex locks. */
 	futex_give_to(&fibril_futex, dstf);
 
@@ -775,6 +865,9 @@ void fibril_yield(void)
 	if (fibril_self()->rmutex_locks > 0)
 		return;
 
+	/* Do not let a busy fibril hold back requests deferred by others. */
+	async_send_flush();
+
 	fibril_t *f = _ready_list_pop_nonblocking(false);
 	if (f)
 		_fibril_switch_to(SWITCH_FROM_YIELD, f, false);
@@ -910,6 +1003,23 @@ void fibril_sleep(sec_t sec)
 	fibril_wait_timeout(&event, &expires);
 }
 
+/**
+ * Check whether the current thread will run other fibrils before it
+ * waits for IPC again. This is only ever the case in a single-threaded
+ * task.
+ */
+bool fibril_ready_pending(void)
+{
+	if (multithreaded)
+		return false;
+
+	futex_lock(&fibril_futex);
+	bool pending = !list_empty(&ready_list);
+	futex_unlock(&fibril_futex);
+
+	return pending;
+}
+
 void fibril_ipc_poke(void)
 {
 	DPRINTF("Poking.\n");
@@ -45,6 +45,7 @@
 
 #include "../private/thread.h"
 #include "../private/fibril.h"
+#include "../private/malloc.h"
 
 /** Main thread function.
  *
@@ -72,6 +73,7 @@ static void __thread_main(void *arg)
 	 * free(uarg);
 	 */
 
+	__malloc_thread_fini();
 	fibril_teardown(fibril);
 	thread_exit(0);
 }
@@ -319,6 +319,11 @@ extern errno_t async_share_out_start(async_exch_t *, void *, unsigned int);
 extern bool async_share_out_receive(ipc_call_t *, size_t *, unsigned int *);
 extern errno_t async_share_out_finalize(ipc_call_t *, void **);
 
+extern errno_t async_waitq_share_in_start(async_exch_t *, sysarg_t,
+    cap_waitq_handle_t *);
+extern bool async_waitq_share_in_receive(ipc_call_t *, sysarg_t *);
+extern errno_t async_waitq_share_in_finalize(ipc_call_t *, cap_waitq_handle_t);
+
 extern errno_t async_data_read_forward_0_0(async_exch_t *, sysarg_t);
 extern errno_t async_data_read_forward_1_0(async_exch_t *, sysarg_t, sysarg_t);
 extern errno_t async_data_read_forward_2_0(async_exch_t *, sysarg_t, sysarg_t,
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Shared-memory request rings.
+ */
+
+#ifndef _LIBC_ASYNC_RING_H_
+#define _LIBC_ASYNC_RING_H_
+
+#include <async.h>
+#include <errno.h>
+#include <stddef.h>
+#include <types/common.h>
+
+/** Number of arguments carried by a ring request */
+#define ASYNC_RING_ARGS  4
+
+/** Maximum number of slots of a ring */
+#define ASYNC_RING_SLOTS_MAX  256
+
+/** Maximum size of the payload buffer of a ring slot */
+#define ASYNC_RING_SLOT_SIZE_MAX  (1024 * 1024)
+
+typedef struct async_ring async_ring_t;
+
+/** Ring request handler
+ *
+ * Called from the ring service thread for every request submitted
+ * by the client.
+ *
+ * @param arg     Argument passed to async_ring_accept().
+ * @param args    Request arguments. The handler may overwrite them
+ *                to return values to the client.
+ * @param buf     Payload buffer of the request slot.
+ * @param size    On entry the payload size specified by the client,
+ *                on return the payload size to report back.
+ * @param bufsize Size of the payload buffer.
+ *
+ * @return Return value passed back to the client.
+ *
+ */
+typedef errno_t (*async_ring_handler_t)(void *, sysarg_t *, void *, size_t *,
+    size_t);
+
+extern errno_t async_ring_create(async_exch_t *, sysarg_t, size_t, size_t,
+    async_ring_t **);
+extern errno_t async_ring_accept(ipc_call_t *, async_ring_handler_t, void *,
+    async_ring_t **);
+extern void async_ring_destroy(async_ring_t *);
+
+extern size_t async_ring_slot_size(async_ring_t *);
+extern void *async_ring_slot_get(async_ring_t *, size_t *);
+extern void async_ring_slot_put(async_ring_t *, size_t);
+extern errno_t async_ring_call(async_ring_t *, size_t, sysarg_t *, size_t *);
+
+#endif
+
+/** @}
+ */
@@ -46,6 +46,8 @@
 #include <abi/cap.h>
 
 extern errno_t ipc_wait(ipc_call_t *, sysarg_t, unsigned int);
+extern errno_t ipc_batch(ipc_batch_call_t *, size_t, ipc_call_t *, size_t *,
+    sysarg_t, unsigned int);
 extern void ipc_poke(void);
 
 /*
@@ -34,6 +34,7 @@
 #define _LIBC_IPC_LOGGER_H_
 
 #include <ipc/common.h>
+#include <stdint.h>
 
 typedef enum {
 	/** Set (global) default displayed logging level.
@@ -71,9 +72,51 @@ typedef enum {
 	 * Returns: error code
 	 * Followed by: string with the message.
 	 */
-	LOGGER_WRITER_MESSAGE
+	LOGGER_WRITER_MESSAGE,
+	/** Write several messages at once.
+	 *
+	 * Returns: error code
+	 * Followed by: buffer with logger_batch_msg_t records.
+	 */
+	LOGGER_WRITER_MESSAGES,
+	/** Get the level up to which messages to a log are recorded.
+	 *
+	 * Arguments: log id.
+	 * Returns: error code, log level
+	 */
+	LOGGER_WRITER_GET_LEVEL,
+	/** Create callback connection for level change events.
+	 *
+	 * Returns: error code
+	 * Followed by: callback port creation.
+	 */
+	LOGGER_WRITER_CALLBACK_CREATE,
+	/** Write all received messages to storage.
+	 *
+	 * Returns: error code
+	 */
+	LOGGER_WRITER_SYNC
 } logger_writer_request_t;
 
+typedef enum {
+	/** Logging levels have changed. */
+	LOGGER_EVENT_LEVEL_CHANGE = IPC_FIRST_USER_METHOD
+} logger_event_t;
+
+/** Header of a message sent with LOGGER_WRITER_MESSAGES.
+ *
+ * The header is followed by @c size bytes of the message text (without the
+ * terminating zero) and padding up to the alignment of the header.
+ */
+typedef struct {
+	/** Log id. */
+	sysarg_t log;
+	/** Message severity level (log_level_t). */
+	uint32_t level;
+	/** Size of the message text in bytes. */
+	uint32_t size;
+} logger_batch_msg_t;
+
 #endif
 
 /** @}
@@ -61,6 +61,8 @@ typedef struct {
 	unsigned int instance;
 	bool concurrent_read_write;
 	bool write_retains_size;
+	/** VFS may cache name lookups, i.e. all namespace changes go through VFS. */
+	bool lookup_cacheable;
 } vfs_info_t;
 
 /** Data returned by filesystem probe regarding a specific volume. */
@@ -69,6 +69,9 @@ typedef struct {
 	uint32_t f_bsize;    /* fundamental file system block size */
 	uint64_t f_blocks;   /* total data blocks in file system */
 	uint64_t f_bfree;    /* free blocks in fs */
+	uint64_t f_chits;    /* block cache hits */
+	uint64_t f_cmisses;  /* block cache misses */
+	uint64_t f_cevicts;  /* blocks evicted from the block cache */
 } vfs_statfs_t;
 
 /** List of file system types */
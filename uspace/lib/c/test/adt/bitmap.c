@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/bitmap.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(bitmap);
+
+enum {
+	bitmap_bits = 300
+};
+
+static uint8_t bits[(bitmap_bits + 7) / 8];
+
+/** Find zero and set bits across byte and word boundaries. */
+PCUT_TEST(find)
+{
+	bitmap_t bitmap;
+
+	bitmap_initialize(&bitmap, bitmap_bits, bits);
+	bitmap_clear_range(&bitmap, 0, bitmap_bits);
+
+	PCUT_ASSERT_INT_EQUALS(0, bitmap_find_zero(&bitmap, 0, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(bitmap_bits,
+	    bitmap_find_one(&bitmap, 0, bitmap_bits));
+
+	bitmap_set_range(&bitmap, 0, 200);
+	PCUT_ASSERT_INT_EQUALS(200, bitmap_find_zero(&bitmap, 0, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(200, bitmap_find_zero(&bitmap, 3, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(150, bitmap_find_zero(&bitmap, 0, 150));
+	PCUT_ASSERT_INT_EQUALS(70, bitmap_find_one(&bitmap, 70, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(bitmap_bits,
+	    bitmap_find_one(&bitmap, 200, bitmap_bits));
+
+	bitmap_clear_range(&bitmap, 131, 1);
+	PCUT_ASSERT_INT_EQUALS(131, bitmap_find_zero(&bitmap, 0, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(131, bitmap_find_zero(&bitmap, 131, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(200, bitmap_find_zero(&bitmap, 132, bitmap_bits));
+
+	bitmap_set_range(&bitmap, 299, 1);
+	PCUT_ASSERT_INT_EQUALS(299, bitmap_find_one(&bitmap, 200, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(299, bitmap_find_one(&bitmap, 299, bitmap_bits));
+}
+
+/** Count zero bits in ranges of various alignment. */
+PCUT_TEST(count_zeroes)
+{
+	bitmap_t bitmap;
+
+	bitmap_initialize(&bitmap, bitmap_bits, bits);
+	bitmap_clear_range(&bitmap, 0, bitmap_bits);
+
+	PCUT_ASSERT_INT_EQUALS(bitmap_bits,
+	    bitmap_count_zeroes(&bitmap, 0, bitmap_bits));
+
+	bitmap_set_range(&bitmap, 5, 190);
+	PCUT_ASSERT_INT_EQUALS(bitmap_bits - 190,
+	    bitmap_count_zeroes(&bitmap, 0, bitmap_bits));
+	PCUT_ASSERT_INT_EQUALS(0, bitmap_count_zeroes(&bitmap, 5, 190));
+	PCUT_ASSERT_INT_EQUALS(5, bitmap_count_zeroes(&bitmap, 0, 10));
+	PCUT_ASSERT_INT_EQUALS(7, bitmap_count_zeroes(&bitmap, 190, 12));
+	PCUT_ASSERT_INT_EQUALS(0, bitmap_count_zeroes(&bitmap, 64, 0));
+}
+
+PCUT_EXPORT(bitmap);
@@ -36,10 +36,13 @@
 #define LIBDEVICE_BD_H
 
 #include <async.h>
+#include <async_ring.h>
 #include <offset.h>
 
 typedef struct {
 	async_sess_t *sess;
+	/** Request ring or @c NULL if not set up */
+	async_ring_t *ring;
 } bd_t;
 
 extern errno_t bd_open(async_sess_t *, bd_t **);
@@ -51,6 +54,7 @@ extern errno_t bd_sync_cache(bd_t *, aoff64_t, size_t);
 extern errno_t bd_get_block_size(bd_t *, size_t *);
 extern errno_t bd_get_num_blocks(bd_t *, aoff64_t *);
 extern errno_t bd_eject(bd_t *);
+extern errno_t bd_ring_setup(bd_t *, size_t, size_t);
 
 #endif
 
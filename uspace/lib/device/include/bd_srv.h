@@ -37,6 +37,7 @@
 
 #include <adt/list.h>
 #include <async.h>
+#include <async_ring.h>
 #include <fibril_synch.h>
 #include <stdbool.h>
 #include <offset.h>
@@ -47,6 +48,8 @@ typedef struct bd_ops bd_ops_t;
 typedef struct {
 	bd_ops_t *ops;
 	void *sarg;
+	/** Operations may be called from a ring service thread */
+	bool thread_safe;
 } bd_srvs_t;
 
 /** Server structure (per client session) */
@@ -54,6 +57,8 @@ typedef struct {
 	bd_srvs_t *srvs;
 	async_sess_t *client_sess;
 	void *carg;
+	/** Request ring or @c NULL if not set up */
+	async_ring_t *ring;
 } bd_srv_t;
 
 struct bd_ops {
@@ -44,7 +44,9 @@ typedef enum {
 	BD_SYNC_CACHE,
 	BD_WRITE_BLOCKS,
 	BD_READ_TOC,
-	BD_EJECT
+	BD_EJECT,
+	BD_RING_SETUP,
+	BD_RING_QUERY
 } bd_request_t;
 
 #endif
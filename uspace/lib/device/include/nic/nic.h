@@ -75,6 +75,11 @@
 #define NIC_DEFECTIVE_BAD_TCP_CHECKSUM   0x0080
 #define NIC_DEFECTIVE_BAD_UDP_CHECKSUM   0x0100
 
+/** Device completes a partial TCP/UDP checksum on transmission */
+#define NIC_OFFLOAD_TX_CSUM  0x0001
+/** Device segments TCP over IPv4 (TSO) */
+#define NIC_OFFLOAD_TSO4     0x0002
+
 /**
  * The bitmap uses single bit for each of the 2^12 = 4096 possible VLAN tags.
  * This means its size is 4096/8 = 512 bytes.
@@ -83,6 +88,22 @@
 
 #define NIC_DEVICE_PRINT_FMT  "%x"
 
+/**
+ * Transmit offload requested for a single frame.
+ *
+ * All offsets are counted from the start of the frame.
+ */
+typedef struct nic_tx_offload {
+	/** Start of checksummed data, zero if no checksum is requested */
+	uint16_t csum_start;
+	/** Position of the checksum field relative to @c csum_start */
+	uint16_t csum_offset;
+	/** Maximum segment payload, zero if no segmentation is requested */
+	uint16_t gso_size;
+	/** Size of all headers preceding the payload */
+	uint16_t hdr_len;
+} nic_tx_offload_t;
+
 /**
  * Structure covering the MAC address.
  */
@@ -42,6 +42,7 @@
 #include <ipc/services.h>
 #include <loc.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <offset.h>
 
@@ -78,12 +79,87 @@ error:
 
 void bd_close(bd_t *bd)
 {
+	if (bd->ring != NULL)
+		async_ring_destroy(bd->ring);
+
 	/* XXX Synchronize with bd_cb_conn */
 	free(bd);
 }
 
+/** Set up a request ring for block transfers.
+ *
+ * Subsequent reads and writes which fit into a ring slot are submitted
+ * through the ring instead of being copied by IPC.
+ *
+ * @param bd        Block device
+ * @param nslots    Number of requests which can be in flight at once
+ * @param slot_size Maximum transfer size in bytes
+ *
+ * @return EOK on success, ENOTSUP if the server does not support rings
+ *         or an error code
+ */
+errno_t bd_ring_setup(bd_t *bd, size_t nslots, size_t slot_size)
+{
+	if (bd->ring != NULL)
+		return EBUSY;
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	/* Do not prepare the shared area for a server that will refuse it. */
+	errno_t rc = async_req_0_0(exch, BD_RING_QUERY);
+	if (rc != EOK) {
+		async_exchange_end(exch);
+		return ENOTSUP;
+	}
+
+	rc = async_ring_create(exch, BD_RING_SETUP, nslots, slot_size,
+	    &bd->ring);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+static errno_t bd_ring_read_blocks(bd_t *bd, aoff64_t ba, size_t cnt,
+    void *data, size_t size)
+{
+	sysarg_t args[ASYNC_RING_ARGS] = {
+		BD_READ_BLOCKS, LOWER32(ba), UPPER32(ba), cnt
+	};
+	size_t rsize = size;
+	size_t slot;
+
+	void *buf = async_ring_slot_get(bd->ring, &slot);
+	errno_t rc = async_ring_call(bd->ring, slot, args, &rsize);
+	if (rc == EOK && rsize > size)
+		rc = EIO;
+	if (rc == EOK)
+		memcpy(data, buf, rsize);
+
+	async_ring_slot_put(bd->ring, slot);
+	return rc;
+}
+
+static errno_t bd_ring_write_blocks(bd_t *bd, aoff64_t ba, size_t cnt,
+    const void *data, size_t size)
+{
+	sysarg_t args[ASYNC_RING_ARGS] = {
+		BD_WRITE_BLOCKS, LOWER32(ba), UPPER32(ba), cnt
+	};
+	size_t slot;
+
+	void *buf = async_ring_slot_get(bd->ring, &slot);
+	memcpy(buf, data, size);
+	errno_t rc = async_ring_call(bd->ring, slot, args, &size);
+
+	async_ring_slot_put(bd->ring, slot);
+	return rc;
+}
+
 errno_t bd_read_blocks(bd_t *bd, aoff64_t ba, size_t cnt, void *data, size_t size)
 {
+	if (bd->ring != NULL && size <= async_ring_slot_size(bd->ring))
+		return bd_ring_read_blocks(bd, ba, cnt, data, size);
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
@@ -132,6 +208,9 @@ errno_t bd_read_toc(bd_t *bd, uint8_t session, void *buf, size_t size)
 errno_t bd_write_blocks(bd_t *bd, aoff64_t ba, size_t cnt, const void *data,
     size_t size)
 {
+	if (bd->ring != NULL && size <= async_ring_slot_size(bd->ring))
+		return bd_ring_write_blocks(bd, ba, cnt, data, size);
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
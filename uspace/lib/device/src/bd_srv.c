@@ -218,6 +218,54 @@ static void bd_eject_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+/** Handle a request submitted through the ring.
+ *
+ * Called from the ring service thread.
+ */
+static errno_t bd_ring_handler(void *arg, sysarg_t *args, void *buf,
+    size_t *size, size_t bufsize)
+{
+	bd_srv_t *srv = (bd_srv_t *) arg;
+	aoff64_t ba;
+	size_t cnt;
+
+	ba = MERGE_LOUP32(args[1], args[2]);
+	cnt = args[3];
+
+	switch (args[0]) {
+	case BD_READ_BLOCKS:
+		if (srv->srvs->ops->read_blocks == NULL)
+			return ENOTSUP;
+		return srv->srvs->ops->read_blocks(srv, ba, cnt, buf, *size);
+	case BD_WRITE_BLOCKS:
+		if (srv->srvs->ops->write_blocks == NULL)
+			return ENOTSUP;
+		return srv->srvs->ops->write_blocks(srv, ba, cnt, buf, *size);
+	default:
+		return EINVAL;
+	}
+}
+
+static void bd_ring_setup_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	if (!srv->srvs->thread_safe) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	if (srv->ring != NULL) {
+		async_answer_0(call, EBUSY);
+		return;
+	}
+
+	(void) async_ring_accept(call, bd_ring_handler, srv, &srv->ring);
+}
+
+static void bd_ring_query_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	async_answer_0(call, srv->srvs->thread_safe ? EOK : ENOTSUP);
+}
+
 static bd_srv_t *bd_srv_create(bd_srvs_t *srvs)
 {
 	bd_srv_t *srv;
@@ -234,6 +282,7 @@ void bd_srvs_init(bd_srvs_t *srvs)
 {
 	srvs->ops = NULL;
 	srvs->sarg = NULL;
+	srvs->thread_safe = false;
 }
 
 errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
@@ -291,11 +340,20 @@ errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
 		case BD_EJECT:
 			bd_eject_srv(srv, &call);
 			break;
+		case BD_RING_SETUP:
+			bd_ring_setup_srv(srv, &call);
+			break;
+		case BD_RING_QUERY:
+			bd_ring_query_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
 	}
 
+	if (srv->ring != NULL)
+		async_ring_destroy(srv->ring);
+
 	rc = srvs->ops->close(srv);
 	free(srv);
 
@@ -266,13 +266,14 @@ errno_t display_window_destroy(display_window_t *window)
 	return rc;
 }
 
-/** Create graphics context for drawing into a window.
+/** Create IPC graphics context for drawing into a window.
  *
  * @param window Window
- * @param rgc Place to store pointer to new graphics context
+ * @param rgc Place to store pointer to new IPC graphics context
  * @return EOK on success or an error code
  */
-errno_t display_window_get_gc(display_window_t *window, gfx_context_t **rgc)
+static errno_t display_window_get_ipc_gc(display_window_t *window,
+    ipc_gc_t **rgc)
 {
 	async_sess_t *sess;
 	async_exch_t *exch;
@@ -294,6 +295,52 @@ errno_t display_window_get_gc(display_window_t *window, gfx_context_t **rgc)
 		return ENOMEM;
 	}
 
+	*rgc = gc;
+	return EOK;
+}
+
+/** Create graphics context for drawing into a window.
+ *
+ * @param window Window
+ * @param rgc Place to store pointer to new graphics context
+ * @return EOK on success or an error code
+ */
+errno_t display_window_get_gc(display_window_t *window, gfx_context_t **rgc)
+{
+	ipc_gc_t *gc;
+	errno_t rc;
+
+	rc = display_window_get_ipc_gc(window, &gc);
+	if (rc != EOK)
+		return rc;
+
+	*rgc = ipc_gc_get_ctx(gc);
+	return EOK;
+}
+
+/** Create graphics context with command batching for drawing into a window.
+ *
+ * Same as display_window_get_gc(), but clipping, color and fill commands
+ * are sent to the display server in batches. Their results only become
+ * visible after calling gfx_update().
+ *
+ * @param window Window
+ * @param rgc Place to store pointer to new graphics context
+ * @return EOK on success or an error code
+ */
+errno_t display_window_get_batch_gc(display_window_t *window,
+    gfx_context_t **rgc)
+{
+	ipc_gc_t *gc;
+	errno_t rc;
+
+	rc = display_window_get_ipc_gc(window, &gc);
+	if (rc != EOK)
+		return rc;
+
+	/* If batching cannot be enabled, fall back to unbatched operation */
+	(void) ipc_gc_set_batch(gc, true);
+
 	*rgc = ipc_gc_get_ctx(gc);
 	return EOK;
 }
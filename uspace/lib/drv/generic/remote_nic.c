@@ -117,6 +117,44 @@ errno_t nic_send_frame(async_sess_t *dev_sess, void *data, size_t size)
 	return retval;
 }
 
+/** Send frame from NIC with transmit offload
+ *
+ * The device completes the checksum and/or segments the frame as
+ * described by @a offload. The device must have the respective offload
+ * enabled (see nic_offload_set()).
+ *
+ * @param[in] dev_sess
+ * @param[in] data     Frame data
+ * @param[in] size     Frame size in bytes
+ * @param[in] offload  Requested transmit offload
+ *
+ * @return EOK If the operation was successfully completed
+ * @return ENOTSUP If the device does not support transmit offload
+ *
+ */
+errno_t nic_send_frame_offload(async_sess_t *dev_sess, void *data,
+    size_t size, const nic_tx_offload_t *offload)
+{
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_3(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
+	    NIC_SEND_MESSAGE,
+	    offload->csum_start | ((sysarg_t) offload->csum_offset << 16),
+	    offload->gso_size | ((sysarg_t) offload->hdr_len << 16), &answer);
+	errno_t retval = async_data_write_start(exch, data, size);
+
+	async_exchange_end(exch);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
 /** Create callback connection from NIC service
  *
  * @param[in] dev_sess
@@ -1244,7 +1282,7 @@ errno_t nic_offload_set(async_sess_t *dev_sess, uint32_t mask, uint32_t active)
 {
 	async_exch_t *exch = async_exchange_begin(dev_sess);
 	errno_t rc = async_req_3_0(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
-	    NIC_AUTONEG_RESTART, (sysarg_t) mask, (sysarg_t) active);
+	    NIC_OFFLOAD_SET, (sysarg_t) mask, (sysarg_t) active);
 	async_exchange_end(exch);
 
 	return rc;
@@ -1345,13 +1383,24 @@ static void remote_nic_send_frame(ddf_fun_t *dev, void *iface,
 	size_t size;
 	errno_t rc;
 
+	nic_tx_offload_t offload;
+	offload.csum_start = ipc_get_arg2(call) & 0xffff;
+	offload.csum_offset = (ipc_get_arg2(call) >> 16) & 0xffff;
+	offload.gso_size = ipc_get_arg3(call) & 0xffff;
+	offload.hdr_len = (ipc_get_arg3(call) >> 16) & 0xffff;
+
 	rc = async_data_write_accept(&data, false, 0, 0, 0, &size);
 	if (rc != EOK) {
 		async_answer_0(call, EINVAL);
 		return;
 	}
 
-	rc = nic_iface->send_frame(dev, data, size);
+	if (offload.csum_start == 0 && offload.gso_size == 0)
+		rc = nic_iface->send_frame(dev, data, size);
+	else if (nic_iface->send_frame_offload != NULL)
+		rc = nic_iface->send_frame_offload(dev, data, size, &offload);
+	else
+		rc = ENOTSUP;
 	async_answer_0(call, rc);
 	free(data);
 }
@@ -101,6 +101,8 @@ typedef struct nic_iface {
 
 	errno_t (*offload_probe)(ddf_fun_t *, uint32_t *, uint32_t *);
 	errno_t (*offload_set)(ddf_fun_t *, uint32_t, uint32_t);
+	errno_t (*send_frame_offload)(ddf_fun_t *, void *, size_t,
+	    const nic_tx_offload_t *);
 
 	errno_t (*poll_get_mode)(ddf_fun_t *, nic_poll_mode_t *,
 	    struct timespec *);
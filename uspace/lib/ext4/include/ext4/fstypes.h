@@ -34,11 +34,46 @@
 #ifndef LIBEXT4_FSTYPES_H_
 #define LIBEXT4_FSTYPES_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
+#include <fibril_synch.h>
 #include <libfs.h>
 #include <loc.h>
 #include "ext4/types.h"
 
+/**
+ * State of a directory in the directory cache.
+ */
+typedef enum {
+	/** Name index is being built */
+	EXT4_DIRCACHE_BUILDING,
+	/** Name index is complete */
+	EXT4_DIRCACHE_CACHED,
+	/** Directory could not be indexed, search it on disk */
+	EXT4_DIRCACHE_UNCACHED
+} ext4_dircache_state_t;
+
+/**
+ * In-memory name index of one directory.
+ */
+typedef struct ext4_dircache_dir {
+	link_t lru_link;
+	uint32_t index;         /* I-node number of the directory */
+	ext4_dircache_state_t state;
+	bool stale;             /* Directory changed while being indexed */
+	size_t size;            /* Entries of a directory too large to cache */
+	hash_table_t names;     /* Entries of the directory by name */
+} ext4_dircache_dir_t;
+
+/**
+ * Cache of directory name indices of a mounted partition.
+ */
+typedef struct ext4_dircache {
+	fibril_mutex_t lock;
+	list_t dirs;            /* Known directories, most recently used first */
+	size_t entries;         /* Number of names in all cached directories */
+} ext4_dircache_t;
+
 /**
  * Type for holding an instance of mounted partition.
  */
@@ -47,6 +82,7 @@ typedef struct ext4_instance {
 	service_id_t service_id;
 	ext4_filesystem_t *filesystem;
 	unsigned int open_nodes_count;
+	ext4_dircache_t dircache;
 } ext4_instance_t;
 
 /**
@@ -35,6 +35,7 @@
 #ifndef LIBEXT4_TYPES_H_
 #define LIBEXT4_TYPES_H_
 
+#include <adt/list.h>
 #include <block.h>
 
 /*
@@ -227,11 +228,21 @@ typedef struct ext4_superblock {
 	EXT4_FEATURE_RO_COMPAT_GDT_CSUM | \
 	EXT4_FEATURE_RO_COMPAT_EXTRA_ISIZE)
 
+/** Blocks reserved for future appends to an i-node */
+typedef struct {
+	link_t link;            /* Link to ext4_filesystem_t.prealloc */
+	uint32_t inode;         /* I-node the window is reserved for */
+	uint32_t start;         /* First block of the window */
+	uint32_t count;         /* Number of blocks left in the window */
+} ext4_prealloc_t;
+
 typedef struct ext4_filesystem {
 	service_id_t device;
 	ext4_superblock_t *superblock;
 	aoff64_t inode_block_limits[4];
 	aoff64_t inode_blocks_per_level[4];
+	list_t prealloc;        /* Preallocation windows, most recent first */
+	unsigned prealloc_windows; /* Number of preallocation windows */
 } ext4_filesystem_t;
 
 /** Size of buffer for volume name. To hold 16 latin-1 chars encoded as UTF-8
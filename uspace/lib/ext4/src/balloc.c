@@ -35,9 +35,11 @@
  * @brief Physical block allocator.
  */
 
+#include <adt/list.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include "ext4/balloc.h"
 #include "ext4/bitmap.h"
 #include "ext4/block_group.h"
@@ -46,6 +48,13 @@
 #include "ext4/superblock.h"
 #include "ext4/types.h"
 
+/** Smallest preallocation window reserved for a regular file (in blocks) */
+#define EXT4_BALLOC_PREALLOC_MIN  8
+/** Largest preallocation window reserved for a regular file (in blocks) */
+#define EXT4_BALLOC_PREALLOC_MAX  1024
+/** Maximum number of preallocation windows kept for a file system */
+#define EXT4_BALLOC_PREALLOC_WINDOWS  32
+
 /** Free block.
  *
  * @param inode_ref  Inode, where the block is allocated
@@ -312,7 +321,7 @@ static errno_t ext4_balloc_find_goal(ext4_inode_ref_t *inode_ref, uint32_t *goal
 		if (rc != EOK)
 			return rc;
 
-		if (goal != 0) {
+		if (*goal != 0) {
 			(*goal)++;
 			return EOK;
 		}
@@ -335,6 +344,377 @@ static errno_t ext4_balloc_find_goal(ext4_inode_ref_t *inode_ref, uint32_t *goal
 	return ext4_filesystem_put_block_group_ref(bg_ref);
 }
 
+/** Find preallocation window of an i-node.
+ *
+ * @param fs    Filesystem
+ * @param inode I-node number
+ *
+ * @return Window or NULL if the i-node has none
+ *
+ */
+static ext4_prealloc_t *ext4_balloc_prealloc_find(ext4_filesystem_t *fs,
+    uint32_t inode)
+{
+	list_foreach(fs->prealloc, link, ext4_prealloc_t, pa) {
+		if (pa->inode == inode)
+			return pa;
+	}
+
+	return NULL;
+}
+
+/** Find preallocation window containing a block.
+ *
+ * @param fs     Filesystem
+ * @param fblock Block address
+ *
+ * @return Window or NULL if the block is not reserved
+ *
+ */
+static ext4_prealloc_t *ext4_balloc_prealloc_lookup(ext4_filesystem_t *fs,
+    uint32_t fblock)
+{
+	list_foreach(fs->prealloc, link, ext4_prealloc_t, pa) {
+		if (fblock >= pa->start && fblock - pa->start < pa->count)
+			return pa;
+	}
+
+	return NULL;
+}
+
+/** Remove preallocation window.
+ *
+ * @param fs Filesystem
+ * @param pa Window to remove
+ *
+ */
+static void ext4_balloc_prealloc_release(ext4_filesystem_t *fs,
+    ext4_prealloc_t *pa)
+{
+	list_remove(&pa->link);
+	fs->prealloc_windows--;
+	free(pa);
+}
+
+/** Take a block from the preallocation window of an i-node.
+ *
+ * The block is only removed from the window, the caller still has to
+ * allocate it.
+ *
+ * @param inode_ref I-node to allocate block for
+ * @param fblock    Requested block address
+ *
+ * @return True if @a fblock was the next block of the window
+ *
+ */
+static bool ext4_balloc_prealloc_take(ext4_inode_ref_t *inode_ref,
+    uint32_t fblock)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	ext4_prealloc_t *pa = ext4_balloc_prealloc_find(fs, inode_ref->index);
+
+	if (pa == NULL || pa->start != fblock)
+		return false;
+
+	pa->start++;
+	pa->count--;
+
+	if (pa->count == 0) {
+		/* Window used up */
+		ext4_balloc_prealloc_release(fs, pa);
+	} else {
+		/* Keep recently used windows at the front */
+		list_remove(&pa->link);
+		list_prepend(&pa->link, &fs->prealloc);
+	}
+
+	return true;
+}
+
+/** Hide blocks reserved by preallocation windows from the allocator.
+ *
+ * Reserved blocks stay free in the bitmap. While the bitmap of a block
+ * group is searched, they are marked used so that they are not given to
+ * other i-nodes. A window is first cut short at a block which has been
+ * allocated meanwhile, so that ext4_balloc_prealloc_unmask() only clears
+ * bits set here.
+ *
+ * @param fs          Filesystem
+ * @param block_group Block group of the bitmap
+ * @param bitmap      Block bitmap of the group
+ *
+ */
+static void ext4_balloc_prealloc_mask(ext4_filesystem_t *fs,
+    uint32_t block_group, uint8_t *bitmap)
+{
+	ext4_superblock_t *sb = fs->superblock;
+	link_t *link = list_first(&fs->prealloc);
+
+	while (link != NULL) {
+		ext4_prealloc_t *pa = list_get_instance(link, ext4_prealloc_t,
+		    link);
+		link = list_next(link, &fs->prealloc);
+
+		if (ext4_filesystem_blockaddr2group(sb, pa->start) !=
+		    block_group)
+			continue;
+
+		uint32_t first =
+		    ext4_filesystem_blockaddr2_index_in_group(sb, pa->start);
+		uint32_t count = 0;
+		while (count < pa->count &&
+		    ext4_bitmap_is_free_bit(bitmap, first + count)) {
+			ext4_bitmap_set_bit(bitmap, first + count);
+			count++;
+		}
+
+		pa->count = count;
+		if (count == 0)
+			ext4_balloc_prealloc_release(fs, pa);
+	}
+}
+
+/** Undo ext4_balloc_prealloc_mask().
+ *
+ * @param fs          Filesystem
+ * @param block_group Block group of the bitmap
+ * @param bitmap      Block bitmap of the group
+ *
+ */
+static void ext4_balloc_prealloc_unmask(ext4_filesystem_t *fs,
+    uint32_t block_group, uint8_t *bitmap)
+{
+	ext4_superblock_t *sb = fs->superblock;
+
+	list_foreach(fs->prealloc, link, ext4_prealloc_t, pa) {
+		if (ext4_filesystem_blockaddr2group(sb, pa->start) !=
+		    block_group)
+			continue;
+
+		ext4_bitmap_free_bits(bitmap,
+		    ext4_filesystem_blockaddr2_index_in_group(sb, pa->start),
+		    pa->count);
+	}
+}
+
+/** Reserve preallocation window behind a newly allocated block.
+ *
+ * Files are mostly written sequentially, one block at a time. The run
+ * of free blocks following @a fblock is reserved for the i-node, so that
+ * its following blocks are allocated right behind it even when several
+ * files are written at once. The window grows with the file size, so
+ * large files end up in long extents.
+ *
+ * Reservations are kept in memory only. The blocks stay free on disk and
+ * are allocated one by one as the i-node takes them, so nothing leaks
+ * when the file system is not unmounted cleanly. When there are too many
+ * windows, the least recently used one is dropped.
+ *
+ * Only regular files without a window get one. Failing to reserve
+ * a window is not an error.
+ *
+ * @param inode_ref I-node the window is reserved for
+ * @param fblock    Block that has just been allocated to the i-node
+ *
+ */
+static void ext4_balloc_prealloc_reserve(ext4_inode_ref_t *inode_ref,
+    uint32_t fblock)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	ext4_superblock_t *sb = fs->superblock;
+
+	if (ext4_balloc_prealloc_find(fs, inode_ref->index) != NULL)
+		return;
+
+	if (!ext4_inode_is_type(sb, inode_ref->inode, EXT4_INODE_MODE_FILE))
+		return;
+
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
+	uint64_t want = ext4_inode_get_size(sb, inode_ref->inode) / block_size;
+	if (want < EXT4_BALLOC_PREALLOC_MIN)
+		want = EXT4_BALLOC_PREALLOC_MIN;
+	if (want > EXT4_BALLOC_PREALLOC_MAX)
+		want = EXT4_BALLOC_PREALLOC_MAX;
+
+	/* The window never crosses block group boundary */
+	uint32_t block_group = ext4_filesystem_blockaddr2group(sb, fblock);
+	uint32_t index_in_group =
+	    ext4_filesystem_blockaddr2_index_in_group(sb, fblock) + 1;
+	uint32_t blocks_in_group =
+	    ext4_superblock_get_blocks_in_group(sb, block_group);
+
+	if (index_in_group >= blocks_in_group)
+		return;
+
+	/* Load block group reference */
+	ext4_block_group_ref_t *bg_ref;
+	errno_t rc = ext4_filesystem_get_block_group_ref(fs, block_group,
+	    &bg_ref);
+	if (rc != EOK)
+		return;
+
+	/* Load block with bitmap */
+	uint32_t bitmap_block_addr =
+	    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
+	block_t *bitmap_block;
+	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr, 0);
+	if (rc != EOK) {
+		(void) ext4_filesystem_put_block_group_ref(bg_ref);
+		return;
+	}
+
+	/* Reserve free blocks following the allocated one */
+	uint32_t count = 0;
+	while (count < want && index_in_group + count < blocks_in_group &&
+	    ext4_bitmap_is_free_bit(bitmap_block->data,
+	    index_in_group + count) &&
+	    ext4_balloc_prealloc_lookup(fs, fblock + 1 + count) == NULL)
+		count++;
+
+	/* The bitmap has not been modified */
+	(void) block_put(bitmap_block);
+	(void) ext4_filesystem_put_block_group_ref(bg_ref);
+
+	if (count == 0)
+		return;
+
+	/* Not being able to keep track of a window is not an error */
+	ext4_prealloc_t *pa = malloc(sizeof(ext4_prealloc_t));
+	if (pa == NULL)
+		return;
+
+	pa->inode = inode_ref->index;
+	pa->start = fblock + 1;
+	pa->count = count;
+	list_prepend(&pa->link, &fs->prealloc);
+	fs->prealloc_windows++;
+
+	/* Drop the least recently used window */
+	if (fs->prealloc_windows > EXT4_BALLOC_PREALLOC_WINDOWS) {
+		ext4_balloc_prealloc_release(fs,
+		    list_get_instance(list_last(&fs->prealloc),
+		    ext4_prealloc_t, link));
+	}
+}
+
+/** Drop the preallocation window of an i-node.
+ *
+ * Called when the i-node is no longer written at the end of the window,
+ * is truncated or destroyed.
+ *
+ * @param inode_ref I-node to drop the window of
+ *
+ */
+void ext4_balloc_prealloc_discard(ext4_inode_ref_t *inode_ref)
+{
+	ext4_prealloc_t *pa = ext4_balloc_prealloc_find(inode_ref->fs,
+	    inode_ref->index);
+
+	if (pa != NULL)
+		ext4_balloc_prealloc_release(inode_ref->fs, pa);
+}
+
+/** Drop all preallocation windows of a file system.
+ *
+ * @param fs Filesystem
+ *
+ */
+void ext4_balloc_prealloc_discard_all(ext4_filesystem_t *fs)
+{
+	while (!list_empty(&fs->prealloc)) {
+		ext4_balloc_prealloc_release(fs,
+		    list_get_instance(list_first(&fs->prealloc),
+		    ext4_prealloc_t, link));
+	}
+}
+
+/** Try to allocate concrete block, ignoring preallocation windows.
+ *
+ * @param inode_ref Inode to allocate block for
+ * @param fblock    Block address to allocate
+ * @param free      Output value - if target block is free
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_balloc_try_alloc_block_internal(
+    ext4_inode_ref_t *inode_ref, uint32_t fblock, bool *free)
+{
+	errno_t rc;
+
+	ext4_filesystem_t *fs = inode_ref->fs;
+	ext4_superblock_t *sb = fs->superblock;
+
+	/* Compute indexes */
+	uint32_t block_group = ext4_filesystem_blockaddr2group(sb, fblock);
+	uint32_t index_in_group =
+	    ext4_filesystem_blockaddr2_index_in_group(sb, fblock);
+
+	/* Load block group reference */
+	ext4_block_group_ref_t *bg_ref;
+	rc = ext4_filesystem_get_block_group_ref(fs, block_group, &bg_ref);
+	if (rc != EOK)
+		return rc;
+
+	/* Load block with bitmap */
+	uint32_t bitmap_block_addr =
+	    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
+	block_t *bitmap_block;
+	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr, 0);
+	if (rc != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	/* Check if block is free */
+	*free = ext4_bitmap_is_free_bit(bitmap_block->data, index_in_group);
+
+	/* Allocate block if possible */
+	if (*free) {
+		ext4_bitmap_set_bit(bitmap_block->data, index_in_group);
+		bitmap_block->dirty = true;
+	}
+
+	/* Release block with bitmap */
+	rc = block_put(bitmap_block);
+	if (rc != EOK) {
+		/* Error in saving bitmap */
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	/* If block is not free, return */
+	if (!(*free))
+		goto terminate;
+
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
+
+	/* Update superblock free blocks count */
+	uint32_t sb_free_blocks = ext4_superblock_get_free_blocks_count(sb);
+	sb_free_blocks--;
+	ext4_superblock_set_free_blocks_count(sb, sb_free_blocks);
+
+	/* Update inode blocks count */
+	uint64_t ino_blocks =
+	    ext4_inode_get_blocks_count(sb, inode_ref->inode);
+	ino_blocks += block_size / EXT4_INODE_BLOCK_SIZE;
+	ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
+	inode_ref->dirty = true;
+
+	/* Update block group free blocks count */
+	uint32_t free_blocks =
+	    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
+	free_blocks--;
+	ext4_block_group_set_free_blocks_count(bg_ref->block_group,
+	    sb, free_blocks);
+	bg_ref->dirty = true;
+
+	return ext4_filesystem_put_block_group_ref(bg_ref);
+
+terminate:
+	return ext4_filesystem_put_block_group_ref(bg_ref);
+}
+
 /** Data block allocation algorithm.
  *
  * @param inode_ref Inode to allocate block for
@@ -359,6 +739,23 @@ errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
 	if (rc != EOK)
 		return rc;
 
+	/* Continue in the preallocated window if possible */
+	if (ext4_balloc_prealloc_take(inode_ref, goal)) {
+		bool free;
+		rc = ext4_balloc_try_alloc_block_internal(inode_ref, goal,
+		    &free);
+		if (rc != EOK)
+			return rc;
+
+		if (free) {
+			*fblock = goal;
+			return EOK;
+		}
+	}
+
+	/* The file is no longer written at the end of the window */
+	ext4_balloc_prealloc_discard(inode_ref);
+
 	ext4_superblock_t *sb = inode_ref->fs->superblock;
 
 	/* Load block group number for goal and relative index */
@@ -401,10 +798,16 @@ errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
 		return rc;
 	}
 
+	/* Do not hand out blocks reserved for other files */
+	ext4_balloc_prealloc_mask(inode_ref->fs, block_group,
+	    bitmap_block->data);
+
 	/* Check if goal is free */
 	if (ext4_bitmap_is_free_bit(bitmap_block->data, index_in_group)) {
 		ext4_bitmap_set_bit(bitmap_block->data, index_in_group);
 		bitmap_block->dirty = true;
+		ext4_balloc_prealloc_unmask(inode_ref->fs, block_group,
+		    bitmap_block->data);
 		rc = block_put(bitmap_block);
 		if (rc != EOK) {
 			ext4_filesystem_put_block_group_ref(bg_ref);
@@ -431,6 +834,8 @@ errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
 		if (ext4_bitmap_is_free_bit(bitmap_block->data, tmp_idx)) {
 			ext4_bitmap_set_bit(bitmap_block->data, tmp_idx);
 			bitmap_block->dirty = true;
+			ext4_balloc_prealloc_unmask(inode_ref->fs, block_group,
+			    bitmap_block->data);
 			rc = block_put(bitmap_block);
 			if (rc != EOK)
 				return rc;
@@ -448,6 +853,8 @@ errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
 	    index_in_group, &rel_block_idx, blocks_in_group);
 	if (rc == EOK) {
 		bitmap_block->dirty = true;
+		ext4_balloc_prealloc_unmask(inode_ref->fs, block_group,
+		    bitmap_block->data);
 		rc = block_put(bitmap_block);
 		if (rc != EOK)
 			return rc;
@@ -464,6 +871,8 @@ errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
 	    index_in_group, &rel_block_idx, blocks_in_group);
 	if (rc == EOK) {
 		bitmap_block->dirty = true;
+		ext4_balloc_prealloc_unmask(inode_ref->fs, block_group,
+		    bitmap_block->data);
 		rc = block_put(bitmap_block);
 		if (rc != EOK)
 			return rc;
@@ -476,6 +885,8 @@ errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
 	}
 
 	/* No free block found yet */
+	ext4_balloc_prealloc_unmask(inode_ref->fs, block_group,
+	    bitmap_block->data);
 	rc = block_put(bitmap_block);
 	if (rc != EOK) {
 		ext4_filesystem_put_block_group_ref(bg_ref);
@@ -518,6 +929,10 @@ goal_failed:
 			return rc;
 		}
 
+		/* Do not hand out blocks reserved for other files */
+		ext4_balloc_prealloc_mask(inode_ref->fs, bgid,
+		    bitmap_block->data);
+
 		/* Compute indexes */
 		first_in_group =
 		    ext4_balloc_get_first_data_block_in_group(sb, bg_ref);
@@ -536,6 +951,8 @@ goal_failed:
 		    index_in_group, &rel_block_idx, blocks_in_group);
 		if (rc == EOK) {
 			bitmap_block->dirty = true;
+			ext4_balloc_prealloc_unmask(inode_ref->fs, bgid,
+			    bitmap_block->data);
 			rc = block_put(bitmap_block);
 			if (rc != EOK) {
 				ext4_filesystem_put_block_group_ref(bg_ref);
@@ -554,6 +971,8 @@ goal_failed:
 		    index_in_group, &rel_block_idx, blocks_in_group);
 		if (rc == EOK) {
 			bitmap_block->dirty = true;
+			ext4_balloc_prealloc_unmask(inode_ref->fs, bgid,
+			    bitmap_block->data);
 			rc = block_put(bitmap_block);
 			if (rc != EOK) {
 				ext4_filesystem_put_block_group_ref(bg_ref);
@@ -567,6 +986,8 @@ goal_failed:
 			goto success;
 		}
 
+		ext4_balloc_prealloc_unmask(inode_ref->fs, bgid,
+		    bitmap_block->data);
 		rc = block_put(bitmap_block);
 		if (rc != EOK) {
 			ext4_filesystem_put_block_group_ref(bg_ref);
@@ -583,6 +1004,12 @@ goal_failed:
 		count--;
 	}
 
+	/* Blocks reserved for other files are better than none at all */
+	if (!list_empty(&inode_ref->fs->prealloc)) {
+		ext4_balloc_prealloc_discard_all(inode_ref->fs);
+		return ext4_balloc_alloc_block(inode_ref, fblock);
+	}
+
 	return ENOSPC;
 
 success:
@@ -609,9 +1036,14 @@ success:
 	bg_ref->dirty = true;
 
 	rc = ext4_filesystem_put_block_group_ref(bg_ref);
+	if (rc != EOK)
+		return rc;
 
 	*fblock = allocated_block;
-	return rc;
+
+	/* Reserve blocks for the following writes */
+	ext4_balloc_prealloc_reserve(inode_ref, allocated_block);
+	return EOK;
 }
 
 /** Try to allocate concrete block.
@@ -626,77 +1058,35 @@ success:
 errno_t ext4_balloc_try_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t fblock,
     bool *free)
 {
-	errno_t rc;
-
-	ext4_filesystem_t *fs = inode_ref->fs;
-	ext4_superblock_t *sb = fs->superblock;
-
-	/* Compute indexes */
-	uint32_t block_group = ext4_filesystem_blockaddr2group(sb, fblock);
-	uint32_t index_in_group =
-	    ext4_filesystem_blockaddr2_index_in_group(sb, fblock);
-
-	/* Load block group reference */
-	ext4_block_group_ref_t *bg_ref;
-	rc = ext4_filesystem_get_block_group_ref(fs, block_group, &bg_ref);
-	if (rc != EOK)
-		return rc;
+	/* Block may be reserved for this i-node */
+	bool reserved = ext4_balloc_prealloc_take(inode_ref, fblock);
+
+	if (!reserved) {
+		ext4_prealloc_t *pa = ext4_balloc_prealloc_lookup(inode_ref->fs,
+		    fblock);
+		if (pa != NULL && pa->inode != inode_ref->index) {
+			/* Reserved for another i-node */
+			*free = false;
+			return EOK;
+		}
 
-	/* Load block with bitmap */
-	uint32_t bitmap_block_addr =
-	    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
-	block_t *bitmap_block;
-	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr, 0);
-	if (rc != EOK) {
-		ext4_filesystem_put_block_group_ref(bg_ref);
-		return rc;
+		/* The file is no longer written at the end of the window */
+		ext4_balloc_prealloc_discard(inode_ref);
 	}
 
-	/* Check if block is free */
-	*free = ext4_bitmap_is_free_bit(bitmap_block->data, index_in_group);
-
-	/* Allocate block if possible */
-	if (*free) {
-		ext4_bitmap_set_bit(bitmap_block->data, index_in_group);
-		bitmap_block->dirty = true;
-	}
-
-	/* Release block with bitmap */
-	rc = block_put(bitmap_block);
-	if (rc != EOK) {
-		/* Error in saving bitmap */
-		ext4_filesystem_put_block_group_ref(bg_ref);
+	errno_t rc = ext4_balloc_try_alloc_block_internal(inode_ref, fblock,
+	    free);
+	if (rc != EOK || !(*free)) {
+		if (reserved)
+			ext4_balloc_prealloc_discard(inode_ref);
 		return rc;
 	}
 
-	/* If block is not free, return */
-	if (!(*free))
-		goto terminate;
-
-	uint32_t block_size = ext4_superblock_get_block_size(sb);
-
-	/* Update superblock free blocks count */
-	uint32_t sb_free_blocks = ext4_superblock_get_free_blocks_count(sb);
-	sb_free_blocks--;
-	ext4_superblock_set_free_blocks_count(sb, sb_free_blocks);
-
-	/* Update inode blocks count */
-	uint64_t ino_blocks =
-	    ext4_inode_get_blocks_count(sb, inode_ref->inode);
-	ino_blocks += block_size / EXT4_INODE_BLOCK_SIZE;
-	ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
-	inode_ref->dirty = true;
+	/* Reserve blocks for the following writes */
+	if (!reserved)
+		ext4_balloc_prealloc_reserve(inode_ref, fblock);
 
-	/* Update block group free blocks count */
-	uint32_t free_blocks =
-	    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
-	free_blocks--;
-	ext4_block_group_set_free_blocks_count(bg_ref->block_group,
-	    sb, free_blocks);
-	bg_ref->dirty = true;
-
-terminate:
-	return ext4_filesystem_put_block_group_ref(bg_ref);
+	return EOK;
 }
 
 /**
@@ -0,0 +1,529 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libext4
+ * @{
+ */
+/**
+ * @file  dircache.c
+ * @brief Directory name cache.
+ *
+ * Every name lookup would otherwise read and parse the directory blocks
+ * (or walk the HTree). A directory that is looked up gets an in-memory
+ * index of all its entries instead, built in a single pass over the
+ * directory and kept up to date by link and unlink. As the index is
+ * complete, it also answers lookups of names that do not exist.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <str.h>
+#include "ext4/dircache.h"
+#include "ext4/directory.h"
+
+/** Maximum number of names cached for all directories of a partition */
+#define EXT4_DIRCACHE_MAX_ENTRIES  (256 * 1024)
+
+/** Maximum number of directories cached for a partition */
+#define EXT4_DIRCACHE_MAX_DIRS  64
+
+/** Cached directory entry */
+typedef struct {
+	ht_link_t link;
+	uint32_t inode;
+	char name[];
+} ext4_dircache_entry_t;
+
+static size_t ext4_dircache_entry_key_hash(const void *key)
+{
+	return hash_string(key);
+}
+
+static size_t ext4_dircache_entry_hash(const ht_link_t *item)
+{
+	ext4_dircache_entry_t *entry =
+	    hash_table_get_inst(item, ext4_dircache_entry_t, link);
+
+	return hash_string(entry->name);
+}
+
+static bool ext4_dircache_entry_equal(const ht_link_t *item1,
+    const ht_link_t *item2)
+{
+	ext4_dircache_entry_t *entry1 =
+	    hash_table_get_inst(item1, ext4_dircache_entry_t, link);
+	ext4_dircache_entry_t *entry2 =
+	    hash_table_get_inst(item2, ext4_dircache_entry_t, link);
+
+	return str_cmp(entry1->name, entry2->name) == 0;
+}
+
+static bool ext4_dircache_entry_key_equal(const void *key, size_t hash,
+    const ht_link_t *item)
+{
+	ext4_dircache_entry_t *entry =
+	    hash_table_get_inst(item, ext4_dircache_entry_t, link);
+
+	return str_cmp(key, entry->name) == 0;
+}
+
+static void ext4_dircache_entry_remove_callback(ht_link_t *item)
+{
+	ext4_dircache_entry_t *entry =
+	    hash_table_get_inst(item, ext4_dircache_entry_t, link);
+
+	free(entry);
+}
+
+static const hash_table_ops_t ext4_dircache_entry_ops = {
+	.hash = ext4_dircache_entry_hash,
+	.key_hash = ext4_dircache_entry_key_hash,
+	.key_equal = ext4_dircache_entry_key_equal,
+	.equal = ext4_dircache_entry_equal,
+	.remove_callback = ext4_dircache_entry_remove_callback
+};
+
+/** Initialize directory cache.
+ *
+ * @param dc Directory cache
+ *
+ */
+void ext4_dircache_init(ext4_dircache_t *dc)
+{
+	fibril_mutex_initialize(&dc->lock);
+	list_initialize(&dc->dirs);
+	dc->entries = 0;
+}
+
+/** Destroy cached directory.
+ *
+ * @param dc  Directory cache
+ * @param dir Directory to destroy
+ *
+ */
+static void ext4_dircache_dir_destroy(ext4_dircache_t *dc,
+    ext4_dircache_dir_t *dir)
+{
+	if (dir->state == EXT4_DIRCACHE_CACHED) {
+		assert(dc->entries >= hash_table_size(&dir->names));
+		dc->entries -= hash_table_size(&dir->names);
+	}
+
+	if (dir->state != EXT4_DIRCACHE_UNCACHED)
+		hash_table_destroy(&dir->names);
+
+	list_remove(&dir->lru_link);
+	free(dir);
+}
+
+/** Finalize directory cache.
+ *
+ * @param dc Directory cache
+ *
+ */
+void ext4_dircache_fini(ext4_dircache_t *dc)
+{
+	fibril_mutex_lock(&dc->lock);
+
+	while (!list_empty(&dc->dirs)) {
+		ext4_dircache_dir_t *dir = list_get_instance(list_first(&dc->dirs),
+		    ext4_dircache_dir_t, lru_link);
+		assert(dir->state != EXT4_DIRCACHE_BUILDING);
+		ext4_dircache_dir_destroy(dc, dir);
+	}
+
+	fibril_mutex_unlock(&dc->lock);
+}
+
+/** Find directory in the cache.
+ *
+ * @param dc    Directory cache
+ * @param index I-node number of the directory
+ *
+ * @return Directory or NULL if not known to the cache
+ *
+ */
+static ext4_dircache_dir_t *ext4_dircache_find(ext4_dircache_t *dc,
+    uint32_t index)
+{
+	list_foreach(dc->dirs, lru_link, ext4_dircache_dir_t, dir) {
+		if (dir->index == index) {
+			/* Move to the front of the LRU list */
+			list_remove(&dir->lru_link);
+			list_prepend(&dir->lru_link, &dc->dirs);
+			return dir;
+		}
+	}
+
+	return NULL;
+}
+
+/** Add name to cached directory.
+ *
+ * @param dir   Cached directory
+ * @param name  Name of the entry (not necessarily NUL-terminated)
+ * @param size  Size of the name in bytes
+ * @param inode I-node number the entry refers to
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_dircache_dir_insert(ext4_dircache_dir_t *dir,
+    const char *name, size_t size, uint32_t inode)
+{
+	ext4_dircache_entry_t *entry =
+	    malloc(sizeof(ext4_dircache_entry_t) + size + 1);
+	if (entry == NULL)
+		return ENOMEM;
+
+	memcpy(entry->name, name, size);
+	entry->name[size] = '\0';
+	entry->inode = inode;
+
+	/* Names are unique within a directory, keep the first one */
+	if (!hash_table_insert_unique(&dir->names, &entry->link)) {
+		free(entry);
+		return EEXIST;
+	}
+
+	return EOK;
+}
+
+/** Read all entries of a directory into its name index.
+ *
+ * Called without the cache lock held. The index is not visible to
+ * anyone else while the directory is being built.
+ *
+ * @param dir       Directory being built
+ * @param inode_ref Directory i-node
+ * @param rsize     Output number of entries of the directory, if it
+ *                  turns out to be too large (EFBIG is returned)
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_dircache_scan(ext4_dircache_dir_t *dir,
+    ext4_inode_ref_t *inode_ref, size_t *rsize)
+{
+	ext4_superblock_t *sb = inode_ref->fs->superblock;
+	size_t size = 0;
+
+	ext4_directory_iterator_t it;
+	errno_t rc = ext4_directory_iterator_init(&it, inode_ref, 0);
+	if (rc != EOK)
+		return rc;
+
+	while (it.current != NULL) {
+		if (it.current->inode != 0) {
+			size++;
+
+			/* Only count the rest of a directory which is too large */
+			if (size > EXT4_DIRCACHE_MAX_ENTRIES) {
+				rc = EFBIG;
+			} else if (rc == EOK) {
+				uint16_t name_size =
+				    ext4_directory_entry_ll_get_name_length(sb,
+				    it.current);
+				rc = ext4_dircache_dir_insert(dir,
+				    (char *) it.current->name, name_size,
+				    ext4_directory_entry_ll_get_inode(it.current));
+				if (rc == EEXIST)
+					rc = EOK;
+				if (rc != EOK)
+					break;
+			}
+		}
+
+		errno_t rc2 = ext4_directory_iterator_next(&it);
+		if (rc2 != EOK) {
+			rc = rc2;
+			break;
+		}
+	}
+
+	errno_t rc2 = ext4_directory_iterator_fini(&it);
+	if (rc == EOK)
+		rc = rc2;
+
+	*rsize = size;
+	return rc;
+}
+
+/** Build name index of a directory.
+ *
+ * The directory is read with the cache lock released, so that lookups
+ * in other directories can proceed. Changes made to the directory in
+ * the meantime make the result stale and it is thrown away.
+ *
+ * Directories which cannot be indexed (too large or out of memory) are
+ * remembered as such, so that they are not read over and over again.
+ *
+ * Least recently used directories are evicted to make room for the
+ * new one.
+ *
+ * @param dc        Directory cache (locked)
+ * @param inode_ref Directory i-node
+ * @param rdir      Output pointer to the directory
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_dircache_build(ext4_dircache_t *dc,
+    ext4_inode_ref_t *inode_ref, ext4_dircache_dir_t **rdir)
+{
+	ext4_dircache_dir_t *dir = malloc(sizeof(ext4_dircache_dir_t));
+	if (dir == NULL)
+		return ENOMEM;
+
+	if (!hash_table_create(&dir->names, 0, 0, &ext4_dircache_entry_ops)) {
+		free(dir);
+		return ENOMEM;
+	}
+
+	link_initialize(&dir->lru_link);
+	dir->index = inode_ref->index;
+	dir->state = EXT4_DIRCACHE_BUILDING;
+	dir->stale = false;
+	dir->size = 0;
+
+	/* Let others know the directory is being built */
+	list_prepend(&dir->lru_link, &dc->dirs);
+
+	fibril_mutex_unlock(&dc->lock);
+	size_t size;
+	errno_t rc = ext4_dircache_scan(dir, inode_ref, &size);
+	fibril_mutex_lock(&dc->lock);
+
+	if (dir->stale) {
+		/* Modified or released while being read */
+		ext4_dircache_dir_destroy(dc, dir);
+		return ESTALE;
+	}
+
+	size_t entries;
+
+	if (rc == EFBIG || rc == ENOMEM) {
+		/* Remember not to try again */
+		hash_table_destroy(&dir->names);
+		dir->state = EXT4_DIRCACHE_UNCACHED;
+		dir->size = rc == EFBIG ? size : 0;
+		entries = 0;
+	} else if (rc != EOK) {
+		ext4_dircache_dir_destroy(dc, dir);
+		return rc;
+	} else {
+		dir->state = EXT4_DIRCACHE_CACHED;
+		entries = hash_table_size(&dir->names);
+	}
+
+	/* Make room for the new directory */
+	link_t *link = list_last(&dc->dirs);
+	while (link != NULL &&
+	    (dc->entries + entries > EXT4_DIRCACHE_MAX_ENTRIES ||
+	    list_count(&dc->dirs) > EXT4_DIRCACHE_MAX_DIRS)) {
+		ext4_dircache_dir_t *old = list_get_instance(link,
+		    ext4_dircache_dir_t, lru_link);
+		link = list_prev(link, &dc->dirs);
+
+		/* Others' indices under construction are theirs to release */
+		if (old != dir && old->state != EXT4_DIRCACHE_BUILDING)
+			ext4_dircache_dir_destroy(dc, old);
+	}
+
+	dc->entries += entries;
+
+	*rdir = dir;
+	return EOK;
+}
+
+/** Look up name in a directory.
+ *
+ * The name index of the directory is built on first use.
+ *
+ * @param dc        Directory cache
+ * @param inode_ref Directory i-node
+ * @param name      Name to look up
+ * @param inode     Output i-node number the entry refers to, zero if
+ *                  the directory does not contain @a name
+ *
+ * @return EOK if @a inode is valid, error code if the directory
+ *         is not cached and has to be searched on disk
+ *
+ */
+errno_t ext4_dircache_lookup(ext4_dircache_t *dc, ext4_inode_ref_t *inode_ref,
+    const char *name, uint32_t *inode)
+{
+	errno_t rc;
+
+	fibril_mutex_lock(&dc->lock);
+
+	ext4_dircache_dir_t *dir = ext4_dircache_find(dc, inode_ref->index);
+	if (dir == NULL) {
+		rc = ext4_dircache_build(dc, inode_ref, &dir);
+		if (rc != EOK) {
+			fibril_mutex_unlock(&dc->lock);
+			return rc;
+		}
+	}
+
+	if (dir->state != EXT4_DIRCACHE_CACHED) {
+		/* Being built by someone else or cannot be cached */
+		fibril_mutex_unlock(&dc->lock);
+		return ENOENT;
+	}
+
+	ht_link_t *link = hash_table_find(&dir->names, name);
+	if (link != NULL) {
+		ext4_dircache_entry_t *entry =
+		    hash_table_get_inst(link, ext4_dircache_entry_t, link);
+		*inode = entry->inode;
+	} else {
+		*inode = 0;
+	}
+
+	fibril_mutex_unlock(&dc->lock);
+	return EOK;
+}
+
+/** Record new directory entry.
+ *
+ * @param dc    Directory cache
+ * @param index I-node number of the directory
+ * @param name  Name of the new entry
+ * @param inode I-node number the entry refers to
+ *
+ */
+void ext4_dircache_add(ext4_dircache_t *dc, uint32_t index, const char *name,
+    uint32_t inode)
+{
+	fibril_mutex_lock(&dc->lock);
+
+	ext4_dircache_dir_t *dir = ext4_dircache_find(dc, index);
+	if (dir == NULL) {
+		fibril_mutex_unlock(&dc->lock);
+		return;
+	}
+
+	switch (dir->state) {
+	case EXT4_DIRCACHE_BUILDING:
+		dir->stale = true;
+		break;
+	case EXT4_DIRCACHE_CACHED:
+		if (ext4_dircache_dir_insert(dir, name, str_size(name),
+		    inode) == EOK) {
+			dc->entries++;
+		} else {
+			/* The index would be incomplete, forget it */
+			ext4_dircache_dir_destroy(dc, dir);
+		}
+		break;
+	case EXT4_DIRCACHE_UNCACHED:
+		/* A directory too large to cache still is */
+		if (dir->size != 0)
+			dir->size++;
+		else
+			ext4_dircache_dir_destroy(dc, dir);
+		break;
+	}
+
+	fibril_mutex_unlock(&dc->lock);
+}
+
+/** Record removal of a directory entry.
+ *
+ * @param dc    Directory cache
+ * @param index I-node number of the directory
+ * @param name  Name of the removed entry
+ *
+ */
+void ext4_dircache_remove(ext4_dircache_t *dc, uint32_t index,
+    const char *name)
+{
+	fibril_mutex_lock(&dc->lock);
+
+	ext4_dircache_dir_t *dir = ext4_dircache_find(dc, index);
+	if (dir == NULL) {
+		fibril_mutex_unlock(&dc->lock);
+		return;
+	}
+
+	size_t removed;
+
+	switch (dir->state) {
+	case EXT4_DIRCACHE_BUILDING:
+		dir->stale = true;
+		break;
+	case EXT4_DIRCACHE_CACHED:
+		removed = hash_table_remove(&dir->names, name);
+		assert(dc->entries >= removed);
+		dc->entries -= removed;
+		break;
+	case EXT4_DIRCACHE_UNCACHED:
+		/* Try again once the directory might fit */
+		if (dir->size > 0)
+			dir->size--;
+		if (dir->size <= EXT4_DIRCACHE_MAX_ENTRIES)
+			ext4_dircache_dir_destroy(dc, dir);
+		break;
+	}
+
+	fibril_mutex_unlock(&dc->lock);
+}
+
+/** Forget cached directory.
+ *
+ * Must be called when the directory i-node is released.
+ *
+ * @param dc    Directory cache
+ * @param index I-node number of the directory
+ *
+ */
+void ext4_dircache_drop(ext4_dircache_t *dc, uint32_t index)
+{
+	fibril_mutex_lock(&dc->lock);
+
+	ext4_dircache_dir_t *dir = ext4_dircache_find(dc, index);
+	if (dir != NULL) {
+		if (dir->state == EXT4_DIRCACHE_BUILDING)
+			dir->stale = true;
+		else
+			ext4_dircache_dir_destroy(dc, dir);
+	}
+
+	fibril_mutex_unlock(&dc->lock);
+}
+
+/**
+ * @}
+ */
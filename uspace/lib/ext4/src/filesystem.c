@@ -80,6 +80,8 @@ static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_
 	ext4_superblock_t *temp_superblock = NULL;
 
 	fs->device = service_id;
+	list_initialize(&fs->prealloc);
+	fs->prealloc_windows = 0;
 
 	/* Initialize block library (4096 is size of communication channel) */
 	rc = block_init(fs->device);
@@ -155,6 +157,9 @@ err:
  */
 static void ext4_filesystem_fini(ext4_filesystem_t *fs)
 {
+	/* Forget blocks reserved for files */
+	ext4_balloc_prealloc_discard_all(fs);
+
 	/* Release memory space for superblock */
 	free(fs->superblock);
 
@@ -1370,6 +1375,9 @@ errno_t ext4_filesystem_free_inode(ext4_inode_ref_t *inode_ref)
 {
 	ext4_filesystem_t *fs = inode_ref->fs;
 
+	/* The i-node number may be reused, do not pass on its window */
+	ext4_balloc_prealloc_discard(inode_ref);
+
 	/* For extents must be data block destroyed by other way */
 	if ((ext4_superblock_has_feature_incompatible(fs->superblock,
 	    EXT4_FEATURE_INCOMPAT_EXTENTS)) &&
@@ -1538,6 +1546,9 @@ errno_t ext4_filesystem_truncate_inode(ext4_inode_ref_t *inode_ref,
 	if (old_size < new_size)
 		return EINVAL;
 
+	/* The window no longer follows the end of the file */
+	ext4_balloc_prealloc_discard(inode_ref);
+
 	/* Compute how many blocks will be released */
 	aoff64_t size_diff = old_size - new_size;
 	uint32_t block_size  = ext4_superblock_get_block_size(sb);
@@ -46,6 +46,7 @@
 #include <str.h>
 #include <ipc/loc.h>
 #include "ext4/balloc.h"
+#include "ext4/dircache.h"
 #include "ext4/directory.h"
 #include "ext4/directory_index.h"
 #include "ext4/extent.h"
@@ -224,9 +225,22 @@ errno_t ext4_match(fs_node_t **rfn, fs_node_t *pfn, const char *component)
 	    EXT4_INODE_MODE_DIRECTORY))
 		return ENOTDIR;
 
-	/* Try to find entry */
+	/* Try the in-memory name index first */
+	uint32_t index;
+	errno_t rc = ext4_dircache_lookup(&eparent->instance->dircache,
+	    eparent->inode_ref, component, &index);
+	if (rc == EOK) {
+		if (index == 0) {
+			*rfn = NULL;
+			return EOK;
+		}
+
+		return ext4_node_get_core(rfn, eparent->instance, index);
+	}
+
+	/* Directory could not be cached, search it on disk */
 	ext4_directory_search_result_t result;
-	errno_t rc = ext4_directory_find_entry(&result, eparent->inode_ref,
+	rc = ext4_directory_find_entry(&result, eparent->inode_ref,
 	    component);
 	if (rc != EOK) {
 		if (rc == ENOENT) {
@@ -502,6 +516,9 @@ errno_t ext4_destroy_node(fs_node_t *fn)
 	ext4_node_t *enode = EXT4_NODE(fn);
 	ext4_inode_ref_t *inode_ref = enode->inode_ref;
 
+	/* The i-node number can be reused by another directory */
+	ext4_dircache_drop(&enode->instance->dircache, inode_ref->index);
+
 	/* Release data blocks */
 	rc = ext4_filesystem_truncate_inode(inode_ref, 0);
 	if (rc != EOK) {
@@ -551,6 +568,9 @@ errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 	if (rc != EOK)
 		return rc;
 
+	ext4_dircache_add(&parent->instance->dircache, parent->inode_ref->index,
+	    name, child->inode_ref->index);
+
 	/* Fill new dir -> add '.' and '..' entries */
 	if (ext4_inode_is_type(fs->superblock, child->inode_ref->inode,
 	    EXT4_INODE_MODE_DIRECTORY)) {
@@ -558,6 +578,8 @@ errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 		    child->inode_ref);
 		if (rc != EOK) {
 			ext4_directory_remove_entry(parent->inode_ref, name);
+			ext4_dircache_remove(&parent->instance->dircache,
+			    parent->inode_ref->index, name);
 			return rc;
 		}
 
@@ -565,6 +587,8 @@ errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 		    parent->inode_ref);
 		if (rc != EOK) {
 			ext4_directory_remove_entry(parent->inode_ref, name);
+			ext4_dircache_remove(&parent->instance->dircache,
+			    parent->inode_ref->index, name);
 			ext4_directory_remove_entry(child->inode_ref, ".");
 			return rc;
 		}
@@ -625,6 +649,9 @@ errno_t ext4_unlink(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 	if (rc != EOK)
 		return rc;
 
+	ext4_dircache_remove(&EXT4_NODE(pfn)->instance->dircache, parent->index,
+	    name);
+
 	/* Decrement links count */
 	ext4_inode_ref_t *child_inode_ref = EXT4_NODE(cfn)->inode_ref;
 
@@ -888,7 +915,8 @@ libfs_ops_t ext4_libfs_ops = {
 	.service_get = ext4_service_get,
 	.size_block = ext4_size_block,
 	.total_block_count = ext4_total_block_count,
-	.free_block_count = ext4_free_block_count
+	.free_block_count = ext4_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 /*
@@ -950,11 +978,13 @@ static errno_t ext4_mounted(service_id_t service_id, const char *opts,
 	link_initialize(&inst->link);
 	inst->service_id = service_id;
 	inst->open_nodes_count = 0;
+	ext4_dircache_init(&inst->dircache);
 
 	/* Initialize the filesystem */
 	aoff64_t rnsize;
 	errno_t rc = ext4_filesystem_open(inst, service_id, cmode, &rnsize, &fs);
 	if (rc != EOK) {
+		ext4_dircache_fini(&inst->dircache);
 		free(inst);
 		return rc;
 	}
@@ -1007,6 +1037,7 @@ static errno_t ext4_unmounted(service_id_t service_id)
 		fibril_mutex_unlock(&instance_list_mutex);
 	}
 
+	ext4_dircache_fini(&inst->dircache);
 	free(inst);
 	return EOK;
 }
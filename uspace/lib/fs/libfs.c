@@ -789,6 +789,10 @@ void libfs_statfs(libfs_ops_t *ops, fs_handle_t fs_handle, ipc_call_t *req)
 			goto error;
 	}
 
+	/* Cache statistics are informative only. */
+	if (ops->cache_stats != NULL)
+		(void) ops->cache_stats(service_id, &st);
+
 	ops->node_put(fn);
 	async_data_read_finalize(&call, &st, sizeof(vfs_statfs_t));
 	async_answer_0(req, EOK);
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libgfx
+ * @{
+ */
+/**
+ * @file Regions
+ */
+
+#ifndef _GFX_REGION_H
+#define _GFX_REGION_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <types/gfx/coord.h>
+#include <types/gfx/region.h>
+
+extern void gfx_region_init(gfx_region_t *);
+extern void gfx_region_fini(gfx_region_t *);
+extern void gfx_region_clear(gfx_region_t *);
+extern bool gfx_region_is_empty(gfx_region_t *);
+extern void gfx_region_bounds(gfx_region_t *, gfx_rect_t *);
+extern errno_t gfx_region_add_rect(gfx_region_t *, gfx_rect_t *);
+extern errno_t gfx_region_subtract_rect(gfx_region_t *, gfx_rect_t *);
+extern void gfx_region_clip(gfx_region_t *, gfx_rect_t *);
+extern errno_t gfx_region_copy(gfx_region_t *, gfx_region_t *);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libgfx
+ * @{
+ */
+/**
+ * @file Regions
+ *
+ * A region is kept as a list of disjoint rectangles. This makes it possible
+ * to track exactly which pixels need to be repainted (or are still visible)
+ * without resorting to a single bounding rectangle.
+ */
+
+#include <gfx/coord.h>
+#include <gfx/region.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/** Initialize region to be empty.
+ *
+ * @param region Region
+ */
+void gfx_region_init(gfx_region_t *region)
+{
+	region->rects = NULL;
+	region->count = 0;
+	region->size = 0;
+}
+
+/** Finalize region, freeing its memory.
+ *
+ * @param region Region
+ */
+void gfx_region_fini(gfx_region_t *region)
+{
+	free(region->rects);
+	gfx_region_init(region);
+}
+
+/** Make region empty.
+ *
+ * The allocated memory is retained for reuse.
+ *
+ * @param region Region
+ */
+void gfx_region_clear(gfx_region_t *region)
+{
+	region->count = 0;
+}
+
+/** Determine if region contains no pixels.
+ *
+ * @param region Region
+ * @return @c true iff region contains no pixels
+ */
+bool gfx_region_is_empty(gfx_region_t *region)
+{
+	return region->count == 0;
+}
+
+/** Get bounding rectangle of region.
+ *
+ * @param region Region
+ * @param bounds Place to store bounding rectangle (empty if region is empty)
+ */
+void gfx_region_bounds(gfx_region_t *region, gfx_rect_t *bounds)
+{
+	gfx_rect_t env;
+	size_t i;
+
+	env.p0.x = 0;
+	env.p0.y = 0;
+	env.p1.x = 0;
+	env.p1.y = 0;
+
+	for (i = 0; i < region->count; i++)
+		gfx_rect_envelope(&env, &region->rects[i], &env);
+
+	*bounds = env;
+}
+
+/** Make sure region can hold @a n more rectangles.
+ *
+ * @param region Region
+ * @param n Number of rectangles to make room for
+ * @return EOK on success or ENOMEM
+ */
+static errno_t gfx_region_reserve(gfx_region_t *region, size_t n)
+{
+	gfx_rect_t *nrects;
+	size_t nsize;
+
+	if (region->count + n <= region->size)
+		return EOK;
+
+	nsize = max(region->size * 2, region->count + n);
+	nsize = max(nsize, 4);
+
+	nrects = realloc(region->rects, nsize * sizeof(gfx_rect_t));
+	if (nrects == NULL)
+		return ENOMEM;
+
+	region->rects = nrects;
+	region->size = nsize;
+	return EOK;
+}
+
+/** Compute the part of rectangle @a a not covered by rectangle @a b.
+ *
+ * @param a Sorted rectangle
+ * @param b Sorted rectangle
+ * @param pieces Array of four rectangles to store disjoint pieces to
+ * @return Number of pieces
+ */
+static size_t gfx_rect_subtract(gfx_rect_t *a, gfx_rect_t *b,
+    gfx_rect_t *pieces)
+{
+	gfx_rect_t c;
+	size_t n = 0;
+
+	gfx_rect_clip(a, b, &c);
+	if (gfx_rect_is_empty(&c)) {
+		pieces[0] = *a;
+		return 1;
+	}
+
+	/* Band above the intersection */
+	if (a->p0.y < c.p0.y) {
+		pieces[n].p0 = a->p0;
+		pieces[n].p1.x = a->p1.x;
+		pieces[n].p1.y = c.p0.y;
+		++n;
+	}
+
+	/* Band below the intersection */
+	if (c.p1.y < a->p1.y) {
+		pieces[n].p0.x = a->p0.x;
+		pieces[n].p0.y = c.p1.y;
+		pieces[n].p1 = a->p1;
+		++n;
+	}
+
+	/* Left of the intersection */
+	if (a->p0.x < c.p0.x) {
+		pieces[n].p0.x = a->p0.x;
+		pieces[n].p0.y = c.p0.y;
+		pieces[n].p1.x = c.p0.x;
+		pieces[n].p1.y = c.p1.y;
+		++n;
+	}
+
+	/* Right of the intersection */
+	if (c.p1.x < a->p1.x) {
+		pieces[n].p0.x = c.p1.x;
+		pieces[n].p0.y = c.p0.y;
+		pieces[n].p1.x = a->p1.x;
+		pieces[n].p1.y = c.p1.y;
+		++n;
+	}
+
+	return n;
+}
+
+/** Append rectangle to region.
+ *
+ * The rectangle must not intersect the region. If it can be merged
+ * with a rectangle of the region sharing a whole edge, it is.
+ *
+ * @param region Region
+ * @param rect Sorted non-empty rectangle
+ * @return EOK on success or ENOMEM
+ */
+static errno_t gfx_region_append(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t *e;
+	size_t i;
+	errno_t rc;
+
+	for (i = 0; i < region->count; i++) {
+		e = &region->rects[i];
+
+		if (e->p0.y == rect->p0.y && e->p1.y == rect->p1.y &&
+		    (e->p1.x == rect->p0.x || rect->p1.x == e->p0.x)) {
+			e->p0.x = min(e->p0.x, rect->p0.x);
+			e->p1.x = max(e->p1.x, rect->p1.x);
+			return EOK;
+		}
+
+		if (e->p0.x == rect->p0.x && e->p1.x == rect->p1.x &&
+		    (e->p1.y == rect->p0.y || rect->p1.y == e->p0.y)) {
+			e->p0.y = min(e->p0.y, rect->p0.y);
+			e->p1.y = max(e->p1.y, rect->p1.y);
+			return EOK;
+		}
+	}
+
+	rc = gfx_region_reserve(region, 1);
+	if (rc != EOK)
+		return rc;
+
+	region->rects[region->count++] = *rect;
+	return EOK;
+}
+
+/** Add the part of a rectangle not covered by region rectangles.
+ *
+ * @param region Region
+ * @param rect Sorted non-empty rectangle
+ * @param first Index of the first region rectangle to check
+ * @param count Number of region rectangles to check
+ * @return EOK on success or ENOMEM
+ */
+static errno_t gfx_region_add_piece(gfx_region_t *region, gfx_rect_t *rect,
+    size_t first, size_t count)
+{
+	gfx_rect_t pieces[4];
+	gfx_rect_t e;
+	size_t n;
+	size_t i, j;
+	errno_t rc;
+
+	for (i = first; i < count; i++) {
+		e = region->rects[i];
+		if (!gfx_rect_is_incident(rect, &e))
+			continue;
+
+		if (gfx_rect_is_inside(rect, &e))
+			return EOK;
+
+		n = gfx_rect_subtract(rect, &e, pieces);
+		for (j = 0; j < n; j++) {
+			rc = gfx_region_add_piece(region, &pieces[j], i + 1,
+			    count);
+			if (rc != EOK)
+				return rc;
+		}
+
+		return EOK;
+	}
+
+	return gfx_region_append(region, rect);
+}
+
+/** Add rectangle to region.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @return EOK on success or ENOMEM. On failure the region may contain
+ *         only part of @a rect.
+ */
+errno_t gfx_region_add_rect(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t srect;
+
+	gfx_rect_points_sort(rect, &srect);
+	if (gfx_rect_is_empty(&srect))
+		return EOK;
+
+	return gfx_region_add_piece(region, &srect, 0, region->count);
+}
+
+/** Subtract rectangle from region.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @return EOK on success or ENOMEM. On failure the region is unchanged.
+ */
+errno_t gfx_region_subtract_rect(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t srect;
+	gfx_rect_t *nrects;
+	size_t ncount;
+	size_t nsize;
+	size_t i;
+
+	gfx_rect_points_sort(rect, &srect);
+	if (gfx_rect_is_empty(&srect))
+		return EOK;
+
+	/* Each intersected rectangle can be split into up to four pieces */
+	nsize = region->count;
+	for (i = 0; i < region->count; i++) {
+		if (gfx_rect_is_incident(&region->rects[i], &srect))
+			nsize += 3;
+	}
+
+	if (nsize == region->count)
+		return EOK;
+
+	nrects = calloc(nsize, sizeof(gfx_rect_t));
+	if (nrects == NULL)
+		return ENOMEM;
+
+	ncount = 0;
+	for (i = 0; i < region->count; i++) {
+		ncount += gfx_rect_subtract(&region->rects[i], &srect,
+		    &nrects[ncount]);
+	}
+
+	free(region->rects);
+	region->rects = nrects;
+	region->count = ncount;
+	region->size = nsize;
+	return EOK;
+}
+
+/** Clip region to a rectangle.
+ *
+ * @param region Region
+ * @param clip Clipping rectangle
+ */
+void gfx_region_clip(gfx_region_t *region, gfx_rect_t *clip)
+{
+	gfx_rect_t crect;
+	size_t ncount;
+	size_t i;
+
+	ncount = 0;
+	for (i = 0; i < region->count; i++) {
+		gfx_rect_clip(&region->rects[i], clip, &crect);
+		if (!gfx_rect_is_empty(&crect))
+			region->rects[ncount++] = crect;
+	}
+
+	region->count = ncount;
+}
+
+/** Copy region.
+ *
+ * @param src Source region
+ * @param dest Initialized destination region
+ * @return EOK on success or ENOMEM
+ */
+errno_t gfx_region_copy(gfx_region_t *src, gfx_region_t *dest)
+{
+	errno_t rc;
+
+	gfx_region_clear(dest);
+	rc = gfx_region_reserve(dest, src->count);
+	if (rc != EOK)
+		return rc;
+
+	if (src->count > 0) {
+		memcpy(dest->rects, src->rects,
+		    src->count * sizeof(gfx_rect_t));
+	}
+	dest->count = src->count;
+	return EOK;
+}
+
+/** @}
+ */
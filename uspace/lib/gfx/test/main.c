@@ -34,6 +34,7 @@ PCUT_IMPORT(bitmap);
 PCUT_IMPORT(color);
 PCUT_IMPORT(coord);
 PCUT_IMPORT(cursor);
+PCUT_IMPORT(region);
 PCUT_IMPORT(render);
 
 PCUT_MAIN();
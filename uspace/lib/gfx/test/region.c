@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gfx/coord.h>
+#include <gfx/region.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(region);
+
+static void set_rect(gfx_rect_t *rect, gfx_coord_t x0, gfx_coord_t y0,
+    gfx_coord_t x1, gfx_coord_t y1)
+{
+	rect->p0.x = x0;
+	rect->p0.y = y0;
+	rect->p1.x = x1;
+	rect->p1.y = y1;
+}
+
+/** Return number of pixels in region, verifying rectangles are disjoint */
+static gfx_coord_t region_area(gfx_region_t *region)
+{
+	gfx_coord2_t dims;
+	gfx_coord_t area = 0;
+	size_t i, j;
+
+	for (i = 0; i < region->count; i++) {
+		PCUT_ASSERT_FALSE(gfx_rect_is_empty(&region->rects[i]));
+		for (j = i + 1; j < region->count; j++) {
+			PCUT_ASSERT_FALSE(gfx_rect_is_incident(
+			    &region->rects[i], &region->rects[j]));
+		}
+
+		gfx_rect_dims(&region->rects[i], &dims);
+		area += dims.x * dims.y;
+	}
+
+	return area;
+}
+
+/** Determine if pixel is inside region */
+static bool region_has_pix(gfx_region_t *region, gfx_coord_t x,
+    gfx_coord_t y)
+{
+	gfx_coord2_t pos;
+	size_t i;
+
+	pos.x = x;
+	pos.y = y;
+
+	for (i = 0; i < region->count; i++) {
+		if (gfx_pix_inside_rect(&pos, &region->rects[i]))
+			return true;
+	}
+
+	return false;
+}
+
+/** Newly initialized region is empty */
+PCUT_TEST(init_fini)
+{
+	gfx_region_t region;
+
+	gfx_region_init(&region);
+	PCUT_ASSERT_TRUE(gfx_region_is_empty(&region));
+	gfx_region_fini(&region);
+}
+
+/** Adding an empty rectangle leaves region empty */
+PCUT_TEST(add_empty)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+	set_rect(&rect, 1, 2, 1, 5);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(gfx_region_is_empty(&region));
+	gfx_region_fini(&region);
+}
+
+/** Adding disjoint rectangles */
+PCUT_TEST(add_disjoint)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 20, 20, 25, 30);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(2, region.count);
+	PCUT_ASSERT_INT_EQUALS(150, region_area(&region));
+	PCUT_ASSERT_TRUE(region_has_pix(&region, 24, 29));
+	PCUT_ASSERT_FALSE(region_has_pix(&region, 15, 15));
+
+	gfx_region_fini(&region);
+}
+
+/** Adding overlapping rectangles only adds the uncovered part */
+PCUT_TEST(add_overlap)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 5, 5, 15, 15);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(175, region_area(&region));
+	PCUT_ASSERT_TRUE(region_has_pix(&region, 0, 0));
+	PCUT_ASSERT_TRUE(region_has_pix(&region, 14, 14));
+	PCUT_ASSERT_FALSE(region_has_pix(&region, 12, 2));
+
+	gfx_region_fini(&region);
+}
+
+/** Adding rectangle inside region does not change it */
+PCUT_TEST(add_inside)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 2, 3, 4, 5);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(1, region.count);
+	PCUT_ASSERT_INT_EQUALS(100, region_area(&region));
+
+	gfx_region_fini(&region);
+}
+
+/** Adjacent rectangles sharing an edge are merged */
+PCUT_TEST(add_adjacent)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 10, 0, 20, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(1, region.count);
+	PCUT_ASSERT_INT_EQUALS(0, region.rects[0].p0.x);
+	PCUT_ASSERT_INT_EQUALS(0, region.rects[0].p0.y);
+	PCUT_ASSERT_INT_EQUALS(20, region.rects[0].p1.x);
+	PCUT_ASSERT_INT_EQUALS(10, region.rects[0].p1.y);
+
+	gfx_region_fini(&region);
+}
+
+/** Subtracting rectangle from the middle leaves a hole */
+PCUT_TEST(subtract_hole)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 2, 2, 8, 8);
+	rc = gfx_region_subtract_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(4, region.count);
+	PCUT_ASSERT_INT_EQUALS(64, region_area(&region));
+	PCUT_ASSERT_TRUE(region_has_pix(&region, 1, 5));
+	PCUT_ASSERT_TRUE(region_has_pix(&region, 8, 5));
+	PCUT_ASSERT_FALSE(region_has_pix(&region, 5, 5));
+
+	gfx_region_fini(&region);
+}
+
+/** Subtracting covering rectangle empties region */
+PCUT_TEST(subtract_all)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 20, 0, 30, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, -1, -1, 31, 11);
+	rc = gfx_region_subtract_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_TRUE(gfx_region_is_empty(&region));
+
+	gfx_region_fini(&region);
+}
+
+/** Clipping region to a rectangle */
+PCUT_TEST(clip)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 20, 0, 30, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 5, 5, 15, 15);
+	gfx_region_clip(&region, &rect);
+
+	PCUT_ASSERT_INT_EQUALS(1, region.count);
+	PCUT_ASSERT_INT_EQUALS(25, region_area(&region));
+
+	gfx_region_fini(&region);
+}
+
+/** Bounding rectangle of region */
+PCUT_TEST(bounds)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	gfx_rect_t bounds;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	gfx_region_bounds(&region, &bounds);
+	PCUT_ASSERT_TRUE(gfx_rect_is_empty(&bounds));
+
+	set_rect(&rect, 1, 2, 3, 4);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 10, 20, 30, 40);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_region_bounds(&region, &bounds);
+	PCUT_ASSERT_INT_EQUALS(1, bounds.p0.x);
+	PCUT_ASSERT_INT_EQUALS(2, bounds.p0.y);
+	PCUT_ASSERT_INT_EQUALS(30, bounds.p1.x);
+	PCUT_ASSERT_INT_EQUALS(40, bounds.p1.y);
+
+	gfx_region_fini(&region);
+}
+
+/** Copying and clearing region */
+PCUT_TEST(copy_clear)
+{
+	gfx_region_t region;
+	gfx_region_t copy;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+	gfx_region_init(&copy);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 20, 0, 30, 10);
+	rc = gfx_region_add_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_region_copy(&region, &copy);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(2, copy.count);
+	PCUT_ASSERT_INT_EQUALS(200, region_area(&copy));
+
+	gfx_region_clear(&region);
+	PCUT_ASSERT_TRUE(gfx_region_is_empty(&region));
+	PCUT_ASSERT_FALSE(gfx_region_is_empty(&copy));
+
+	gfx_region_fini(&region);
+	gfx_region_fini(&copy);
+}
+
+PCUT_EXPORT(region);
@@ -39,6 +39,7 @@
 
 #include <adt/list.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <types/gfx/bitmap.h>
 #include <types/gfx/context.h>
@@ -46,6 +47,11 @@
 #include <types/gfx/typeface.h>
 #include <riff/chunk.h>
 
+/** Number of pages in glyph index */
+#define GFX_FONT_INDEX_PAGES 256
+/** Number of entries in glyph index page */
+#define GFX_FONT_INDEX_PAGE_SIZE 256
+
 /** Font
  *
  * This is private to libgfxfont.
@@ -69,6 +75,18 @@ struct gfx_font {
 	gfx_bitmap_t *bitmap;
 	/** Bitmap rectangle */
 	gfx_rect_t rect;
+	/** Glyph index is up to date */
+	bool index_valid;
+	/** Glyph index for the Basic Multilingual Plane.
+	 *
+	 * Maps the first character of a pattern to the chain of patterns
+	 * starting with that character (linked via @c inext), in the order
+	 * in which a linear search would test them. Pages are allocated
+	 * on demand.
+	 */
+	struct gfx_glyph_pattern **index[GFX_FONT_INDEX_PAGES];
+	/** Chain of patterns starting with a character outside of the BMP */
+	struct gfx_glyph_pattern *index_other;
 };
 
 /** Font info
@@ -88,6 +106,7 @@ struct gfx_font_info {
 	riff_rchunk_t fontck;
 };
 
+extern void gfx_font_index_invalidate(gfx_font_t *);
 extern errno_t gfx_font_splice_at_glyph(gfx_font_t *, gfx_glyph_t *,
     gfx_rect_t *);
 extern errno_t gfx_font_info_load(gfx_typeface_t *, riff_rchunk_t *);
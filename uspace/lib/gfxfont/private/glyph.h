@@ -72,6 +72,8 @@ struct gfx_glyph_pattern {
 	link_t lpatterns;
 	/** Pattern text */
 	char *text;
+	/** Next pattern with the same first character in font glyph index */
+	struct gfx_glyph_pattern *inext;
 };
 
 extern errno_t gfx_glyph_transfer(gfx_glyph_t *, gfx_coord_t, gfx_bitmap_t *,
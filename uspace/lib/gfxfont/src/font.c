@@ -42,6 +42,7 @@
 #include <gfx/glyph.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <str.h>
 #include "../private/font.h"
 #include "../private/glyph.h"
 #include "../private/tpf_file.h"
@@ -236,6 +237,7 @@ errno_t gfx_font_open(gfx_font_info_t *finfo, gfx_font_t **rfont)
 void gfx_font_close(gfx_font_t *font)
 {
 	gfx_glyph_t *glyph;
+	unsigned i;
 
 	glyph = gfx_font_first_glyph(font);
 	while (glyph != NULL) {
@@ -243,6 +245,9 @@ void gfx_font_close(gfx_font_t *font)
 		glyph = gfx_font_first_glyph(font);
 	}
 
+	for (i = 0; i < GFX_FONT_INDEX_PAGES; i++)
+		free(font->index[i]);
+
 	font->finfo->font = NULL;
 	free(font);
 }
@@ -333,7 +338,96 @@ gfx_glyph_t *gfx_font_prev_glyph(gfx_glyph_t *cur)
 	return list_get_instance(link, gfx_glyph_t, lglyphs);
 }
 
-/** Search for glyph that should be set for the beginning of a string.
+/** Invalidate font glyph index.
+ *
+ * Must be called whenever glyphs or glyph patterns change.
+ *
+ * @param font Font
+ */
+void gfx_font_index_invalidate(gfx_font_t *font)
+{
+	font->index_valid = false;
+}
+
+/** Build font glyph index.
+ *
+ * @param font Font
+ * @return EOK on success, ENOMEM if out of memory, ENOTSUP if
+ *         the font has patterns that cannot be indexed
+ */
+static errno_t gfx_font_index_build(gfx_font_t *font)
+{
+	gfx_glyph_pattern_t **page;
+	gfx_glyph_pattern_t **head;
+	gfx_glyph_pattern_t *pat;
+	gfx_glyph_t *glyph;
+	link_t *link;
+	char32_t c;
+	size_t off;
+	unsigned i;
+
+	for (i = 0; i < GFX_FONT_INDEX_PAGES; i++) {
+		if (font->index[i] != NULL) {
+			memset(font->index[i], 0, GFX_FONT_INDEX_PAGE_SIZE *
+			    sizeof(gfx_glyph_pattern_t *));
+		}
+	}
+
+	font->index_other = NULL;
+
+	/*
+	 * Walk glyphs and patterns backwards, prepending each pattern
+	 * to its chain. This way each chain lists patterns in the same
+	 * order as a linear search would visit them.
+	 */
+	glyph = gfx_font_last_glyph(font);
+	while (glyph != NULL) {
+		link = list_last(&glyph->patterns);
+		while (link != NULL) {
+			pat = list_get_instance(link, gfx_glyph_pattern_t,
+			    lpatterns);
+
+			off = 0;
+			c = str_decode(pat->text, &off, STR_NO_LIMIT);
+
+			/*
+			 * Empty pattern matches anything, invalid first
+			 * character might be part of a valid one in the text.
+			 */
+			if (c == 0 || (c == U_SPECIAL && pat->text[0] != '?'))
+				return ENOTSUP;
+
+			if (c < GFX_FONT_INDEX_PAGES * GFX_FONT_INDEX_PAGE_SIZE) {
+				page = font->index[c / GFX_FONT_INDEX_PAGE_SIZE];
+				if (page == NULL) {
+					page = calloc(GFX_FONT_INDEX_PAGE_SIZE,
+					    sizeof(gfx_glyph_pattern_t *));
+					if (page == NULL)
+						return ENOMEM;
+
+					font->index[c / GFX_FONT_INDEX_PAGE_SIZE] =
+					    page;
+				}
+
+				head = &page[c % GFX_FONT_INDEX_PAGE_SIZE];
+			} else {
+				head = &font->index_other;
+			}
+
+			pat->inext = *head;
+			*head = pat;
+
+			link = list_prev(link, &glyph->patterns);
+		}
+
+		glyph = gfx_font_prev_glyph(glyph);
+	}
+
+	font->index_valid = true;
+	return EOK;
+}
+
+/** Search for glyph by testing all glyphs one by one.
  *
  * @param font Font
  * @param str String whose beginning we would like to set
@@ -341,7 +435,7 @@ gfx_glyph_t *gfx_font_prev_glyph(gfx_glyph_t *cur)
  * @param rsize Place to store number of bytes to advance in the string
  * @return EOK on success, ENOENT if no matching glyph was found
  */
-errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
+static errno_t gfx_font_search_glyph_linear(gfx_font_t *font, const char *str,
     gfx_glyph_t **rglyph, size_t *rsize)
 {
 	gfx_glyph_t *glyph;
@@ -361,6 +455,58 @@ errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
 	return ENOENT;
 }
 
+/** Search for glyph that should be set for the beginning of a string.
+ *
+ * The glyph index is (re)built on demand, so that we only need to test
+ * the patterns starting with the same character as the string.
+ *
+ * @param font Font
+ * @param str String whose beginning we would like to set
+ * @param rglyph Place to store glyph that should be set
+ * @param rsize Place to store number of bytes to advance in the string
+ * @return EOK on success, ENOENT if no matching glyph was found
+ */
+errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
+    gfx_glyph_t **rglyph, size_t *rsize)
+{
+	gfx_glyph_pattern_t **page;
+	gfx_glyph_pattern_t *pat;
+	char32_t c;
+	size_t off;
+	errno_t rc;
+
+	if (!font->index_valid) {
+		rc = gfx_font_index_build(font);
+		if (rc != EOK) {
+			/* Cannot use index */
+			return gfx_font_search_glyph_linear(font, str, rglyph,
+			    rsize);
+		}
+	}
+
+	off = 0;
+	c = str_decode(str, &off, STR_NO_LIMIT);
+
+	if (c < GFX_FONT_INDEX_PAGES * GFX_FONT_INDEX_PAGE_SIZE) {
+		page = font->index[c / GFX_FONT_INDEX_PAGE_SIZE];
+		pat = page != NULL ? page[c % GFX_FONT_INDEX_PAGE_SIZE] : NULL;
+	} else {
+		pat = font->index_other;
+	}
+
+	while (pat != NULL) {
+		if (str_test_prefix(str, pat->text)) {
+			*rglyph = pat->glyph;
+			*rsize = str_size(pat->text);
+			return EOK;
+		}
+
+		pat = pat->inext;
+	}
+
+	return ENOENT;
+}
+
 /** Replace glyph graphic with empty space of specified width.
  *
  * This is used to resize a glyph in the font bitmap. This changes
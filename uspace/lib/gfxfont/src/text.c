@@ -277,15 +277,19 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 	if (rc != EOK)
 		return rc;
 
-	width = gfx_text_width(fmt->font, str);
-
-	if (fmt->abbreviate && width > fmt->width) {
-		/* Need to append ellipsis */
-		ellipsis = true;
-		rmargin = spos.x + fmt->width - gfx_text_width(fmt->font, "...");
-	} else {
-		ellipsis = false;
-		rmargin = spos.x + width;
+	/* Right margin only matters (and text width is only needed) if abbreviating */
+	ellipsis = false;
+	rmargin = 0;
+	if (fmt->abbreviate) {
+		width = gfx_text_width(fmt->font, str);
+		if (width > fmt->width) {
+			/* Need to append ellipsis */
+			ellipsis = true;
+			rmargin = spos.x + fmt->width -
+			    gfx_text_width(fmt->font, "...");
+		} else {
+			rmargin = spos.x + width;
+		}
 	}
 
 	cpos = spos;
@@ -419,6 +419,94 @@ PCUT_TEST(search_glyph)
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 }
 
+/** Test gfx_font_search_glyph() with several glyphs and patterns */
+PCUT_TEST(search_glyph_patterns)
+{
+	gfx_font_props_t props;
+	gfx_font_metrics_t metrics;
+	gfx_glyph_metrics_t gmetrics;
+	gfx_typeface_t *tface;
+	gfx_font_t *font;
+	gfx_context_t *gc;
+	gfx_glyph_t *glyph;
+	gfx_glyph_t *gf, *gfi, *gx;
+	size_t bytes;
+	test_gc_t tgc;
+	errno_t rc;
+
+	rc = gfx_context_new(&test_ops, (void *)&tgc, &gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_typeface_create(gc, &tface);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_font_props_init(&props);
+	gfx_font_metrics_init(&metrics);
+	rc = gfx_font_create(tface, &props, &metrics, &font);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_glyph_metrics_init(&gmetrics);
+
+	/* Ligature comes first so that it takes precedence */
+	rc = gfx_glyph_create(font, &gmetrics, &gfi);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(gfi, "fi");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_create(font, &gmetrics, &gf);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(gf, "f");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_create(font, &gmetrics, &gx);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(gx, "x");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(gx, "\u017e");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_font_search_glyph(font, "fish", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(gfi, glyph);
+	PCUT_ASSERT_INT_EQUALS(2, bytes);
+
+	rc = gfx_font_search_glyph(font, "fox", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(gf, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	rc = gfx_font_search_glyph(font, "xy", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(gx, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	rc = gfx_font_search_glyph(font, "\u017elu", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(gx, glyph);
+	PCUT_ASSERT_INT_EQUALS(2, bytes);
+
+	rc = gfx_font_search_glyph(font, "y", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	/* Changing patterns must be reflected in the search */
+	gfx_glyph_clear_pattern(gfi, "fi");
+
+	rc = gfx_font_search_glyph(font, "fish", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(gf, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	gfx_glyph_destroy(gf);
+
+	rc = gfx_font_search_glyph(font, "fish", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	gfx_font_close(font);
+	gfx_typeface_destroy(tface);
+	rc = gfx_context_delete(gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
 /** Test gfx_font_splice_at_glyph() */
 PCUT_TEST(splice_at_glyph)
 {
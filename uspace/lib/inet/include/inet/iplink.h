@@ -38,6 +38,12 @@
 #include <async.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
+#include <types/inet.h>
+
+/** Link accepts datagrams with partial transport checksum */
+#define IPLINK_OFFLOAD_CSUM  0x1
+/** Link accepts TCP super-segments and segments them */
+#define IPLINK_OFFLOAD_GSO   0x2
 
 struct iplink_ev_ops;
 
@@ -57,6 +63,8 @@ typedef struct {
 	void *data;
 	/** Size of @c data in bytes */
 	size_t size;
+	/** Transmit offload to perform on the packet */
+	inet_offload_t offload;
 } iplink_sdu_t;
 
 /** IPv6 link Service Data Unit */
@@ -89,6 +97,7 @@ extern errno_t iplink_send6(iplink_t *, iplink_sdu6_t *);
 extern errno_t iplink_addr_add(iplink_t *, inet_addr_t *);
 extern errno_t iplink_addr_remove(iplink_t *, inet_addr_t *);
 extern errno_t iplink_get_mtu(iplink_t *, size_t *);
+extern errno_t iplink_get_offload(iplink_t *, uint32_t *);
 extern errno_t iplink_get_mac48(iplink_t *, eth_addr_t *);
 extern errno_t iplink_set_mac48(iplink_t *, eth_addr_t *);
 extern void *iplink_get_userptr(iplink_t *);
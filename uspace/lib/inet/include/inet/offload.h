@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/**
+ * @file
+ * @brief Software implementation of transmit offload
+ */
+
+#ifndef LIBINET_INET_OFFLOAD_H
+#define LIBINET_INET_OFFLOAD_H
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <types/common.h>
+#include <types/inet.h>
+
+/** Callback receiving one finished packet.
+ *
+ * The packet buffer is only valid for the duration of the call.
+ */
+typedef errno_t (*inet_offload_emit_t)(void *, void *, size_t);
+
+extern sysarg_t inet_offload_encode(const inet_offload_t *);
+extern void inet_offload_decode(sysarg_t, inet_offload_t *);
+extern bool inet_offload_requested(const inet_offload_t *);
+extern errno_t inet_offload_l4(const inet_offload_t *, addr32_t, addr32_t,
+    uint8_t, void *, size_t, inet_offload_emit_t, void *);
+extern errno_t inet_offload_ip4(const inet_offload_t *, void *, size_t,
+    inet_offload_emit_t, void *);
+extern errno_t inet_offload_ip4_layout(const void *, size_t, size_t *,
+    size_t *, size_t *);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/**
+ * @file
+ * @brief Longest-prefix-match table
+ */
+
+#ifndef LIBINET_INET_RTABLE_H
+#define LIBINET_INET_RTABLE_H
+
+#include <adt/list.h>
+#include <errno.h>
+#include <inet/addr.h>
+
+/** Trie node (opaque) */
+typedef struct inet_rtable_node inet_rtable_node_t;
+
+/** Prefix table entry.
+ *
+ * Embedded in the object that is to be found by prefix. There may be
+ * multiple entries with the same prefix, lookup returns the one
+ * inserted first.
+ */
+typedef struct {
+	/** Link to list of entries with the same prefix */
+	link_t lnode;
+	/** Node holding the prefix */
+	inet_rtable_node_t *node;
+	/** Argument returned by lookup */
+	void *arg;
+} inet_rtable_entry_t;
+
+/** Longest-prefix-match table.
+ *
+ * Path-compressed binary trie, one for each address family. A lookup
+ * visits at most one node per distinct prefix length on the path, so
+ * its cost does not depend on the number of prefixes in the table.
+ */
+typedef struct {
+	/** Root of IPv4 trie */
+	inet_rtable_node_t *root4;
+	/** Root of IPv6 trie */
+	inet_rtable_node_t *root6;
+	/** Number of entries */
+	size_t count;
+} inet_rtable_t;
+
+#define INET_RTABLE_INITIALIZE(name) \
+	inet_rtable_t name = { \
+		.root4 = NULL, \
+		.root6 = NULL, \
+		.count = 0 \
+	}
+
+extern void inet_rtable_init(inet_rtable_t *);
+extern void inet_rtable_fini(inet_rtable_t *);
+extern errno_t inet_rtable_insert(inet_rtable_t *, const inet_naddr_t *,
+    inet_rtable_entry_t *, void *);
+extern void inet_rtable_remove(inet_rtable_t *, inet_rtable_entry_t *);
+extern void *inet_rtable_lookup(inet_rtable_t *, const inet_addr_t *);
+
+#endif
+
+/** @}
+ */
@@ -37,11 +37,20 @@
 
 #include <inet/addr.h>
 #include <ipc/loc.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #define INET_TTL_MAX 255
 
+/** Transmit offload requested for a datagram */
+typedef struct {
+	/** Transport checksum field only holds the pseudo-header sum */
+	bool csum_partial;
+	/** Split TCP payload into segments of this size (zero for none) */
+	uint16_t gso_size;
+} inet_offload_t;
+
 typedef struct {
 	/** Local IP link service ID (optional) */
 	service_id_t iplink;
@@ -50,6 +59,8 @@ typedef struct {
 	uint8_t tos;
 	void *data;
 	size_t size;
+	/** Transmit offload (ignored on receive) */
+	inet_offload_t offload;
 } inet_dgram_t;
 
 typedef struct {
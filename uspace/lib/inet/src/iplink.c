@@ -40,6 +40,7 @@
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink.h>
+#include <inet/offload.h>
 #include <ipc/iplink.h>
 #include <ipc/services.h>
 #include <loc.h>
@@ -90,8 +91,8 @@ errno_t iplink_send(iplink_t *iplink, iplink_sdu_t *sdu)
 	async_exch_t *exch = async_exchange_begin(iplink->sess);
 
 	ipc_call_t answer;
-	aid_t req = async_send_2(exch, IPLINK_SEND, (sysarg_t) sdu->src,
-	    (sysarg_t) sdu->dest, &answer);
+	aid_t req = async_send_3(exch, IPLINK_SEND, (sysarg_t) sdu->src,
+	    (sysarg_t) sdu->dest, inet_offload_encode(&sdu->offload), &answer);
 
 	errno_t rc = async_data_write_start(exch, sdu->data, sdu->size);
 
@@ -153,6 +154,28 @@ errno_t iplink_get_mtu(iplink_t *iplink, size_t *rmtu)
 	return EOK;
 }
 
+/** Get transmit offloads accepted by IP link.
+ *
+ * @param iplink   IP link
+ * @param roffload Place to store IPLINK_OFFLOAD_xxx flags
+ * @return EOK on success or an error code
+ */
+errno_t iplink_get_offload(iplink_t *iplink, uint32_t *roffload)
+{
+	async_exch_t *exch = async_exchange_begin(iplink->sess);
+
+	sysarg_t offload;
+	errno_t rc = async_req_0_1(exch, IPLINK_GET_OFFLOAD, &offload);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*roffload = offload;
+	return EOK;
+}
+
 errno_t iplink_get_mac48(iplink_t *iplink, eth_addr_t *mac)
 {
 	async_exch_t *exch = async_exchange_begin(iplink->sess);
@@ -41,6 +41,7 @@
 #include <stddef.h>
 #include <inet/addr.h>
 #include <inet/iplink_srv.h>
+#include <inet/offload.h>
 
 static void iplink_get_mtu_srv(iplink_srv_t *srv, ipc_call_t *call)
 {
@@ -49,6 +50,18 @@ static void iplink_get_mtu_srv(iplink_srv_t *srv, ipc_call_t *call)
 	async_answer_1(call, rc, mtu);
 }
 
+static void iplink_get_offload_srv(iplink_srv_t *srv, ipc_call_t *call)
+{
+	uint32_t offload = 0;
+	errno_t rc = EOK;
+
+	/* Links not implementing this do not support any offload */
+	if (srv->ops->get_offload != NULL)
+		rc = srv->ops->get_offload(srv, &offload);
+
+	async_answer_1(call, rc, offload);
+}
+
 static void iplink_get_mac48_srv(iplink_srv_t *srv, ipc_call_t *icall)
 {
 	eth_addr_t mac;
@@ -175,6 +188,7 @@ static void iplink_send_srv(iplink_srv_t *srv, ipc_call_t *icall)
 
 	sdu.src = ipc_get_arg1(icall);
 	sdu.dest = ipc_get_arg2(icall);
+	inet_offload_decode(ipc_get_arg3(icall), &sdu.offload);
 
 	errno_t rc = async_data_write_accept(&sdu.data, false, 0, 0, 0,
 	    &sdu.size);
@@ -297,6 +311,9 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_ADDR_REMOVE:
 			iplink_addr_remove_srv(srv, &call);
 			break;
+		case IPLINK_GET_OFFLOAD:
+			iplink_get_offload_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
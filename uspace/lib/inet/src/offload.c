@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/**
+ * @file
+ * @brief Software implementation of transmit offload
+ *
+ * A transport protocol may hand down a datagram whose checksum has not been
+ * completed and/or whose TCP payload exceeds one segment (a super-segment).
+ * If the link or the NIC cannot finish such a datagram, the functions here
+ * do it in software just before transmission.
+ */
+
+#include <errno.h>
+#include <inet/offload.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdlib.h>
+
+/** Partial checksum flag in encoded offload argument */
+#define OFFLOAD_CSUM_PARTIAL  0x1
+/** Shift of segment size in encoded offload argument */
+#define OFFLOAD_GSO_SHIFT     16
+
+#define OFFLOAD_PROTO_TCP  6
+#define OFFLOAD_PROTO_UDP  17
+
+/* Offsets of the fields we need to modify */
+#define IP4_TOT_LEN   2
+#define IP4_ID        4
+#define IP4_PROTO     9
+#define IP4_CHKSUM    10
+#define IP4_SRC       12
+#define IP4_DEST      16
+#define IP4_HDR_MIN   20
+
+#define TCP_SEQ       4
+#define TCP_DOFF      12
+#define TCP_FLAGS     13
+#define TCP_CHKSUM    16
+#define TCP_HDR_MIN   20
+
+#define TCP_FLAG_FIN  0x01
+#define TCP_FLAG_PSH  0x08
+
+#define UDP_CHKSUM    6
+#define UDP_HDR_SIZE  8
+
+static uint16_t offload_get16(const uint8_t *p)
+{
+	return ((uint16_t) p[0] << 8) | p[1];
+}
+
+static uint32_t offload_get32(const uint8_t *p)
+{
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+	    ((uint32_t) p[2] << 8) | p[3];
+}
+
+static void offload_put16(uint8_t *p, uint16_t val)
+{
+	p[0] = val >> 8;
+	p[1] = val & 0xff;
+}
+
+static void offload_put32(uint8_t *p, uint32_t val)
+{
+	p[0] = val >> 24;
+	p[1] = (val >> 16) & 0xff;
+	p[2] = (val >> 8) & 0xff;
+	p[3] = val & 0xff;
+}
+
+/** Compute Internet checksum.
+ *
+ * @param ivalue Result of checksum computed over preceding data or
+ *               0xffff to start a new checksum
+ * @param data   Data
+ * @param size   Size of @a data in bytes, odd size only allowed in the
+ *               last block
+ * @return Checksum (one's complement of the one's complement sum)
+ */
+static uint16_t offload_checksum(uint16_t ivalue, const uint8_t *data,
+    size_t size)
+{
+	uint32_t sum = (uint16_t) ~ivalue;
+	size_t i;
+
+	for (i = 0; i + 1 < size; i += 2)
+		sum += ((uint32_t) data[i] << 8) | data[i + 1];
+
+	if (i < size)
+		sum += (uint32_t) data[i] << 8;
+
+	while ((sum >> 16) != 0)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum;
+}
+
+/** Compute transport checksum of a segment and store it in the segment.
+ *
+ * @param seg   Transport segment
+ * @param size  Segment size in bytes
+ * @param src   Source address
+ * @param dest  Destination address
+ * @param proto Protocol
+ * @param csum_offs Offset of checksum field within the segment
+ */
+static void offload_l4_checksum(uint8_t *seg, size_t size, addr32_t src,
+    addr32_t dest, uint8_t proto, size_t csum_offs)
+{
+	uint8_t phdr[12];
+	uint16_t cs;
+
+	offload_put32(phdr, src);
+	offload_put32(phdr + 4, dest);
+	phdr[8] = 0;
+	phdr[9] = proto;
+	offload_put16(phdr + 10, size);
+
+	offload_put16(seg + csum_offs, 0);
+	cs = offload_checksum(0xffff, phdr, sizeof(phdr));
+	cs = offload_checksum(cs, seg, size);
+
+	/* Zero means no checksum in UDP */
+	if (proto == OFFLOAD_PROTO_UDP && cs == 0)
+		cs = 0xffff;
+
+	offload_put16(seg + csum_offs, cs);
+}
+
+/** Determine layout of transport header.
+ *
+ * @param proto     Transport protocol
+ * @param l4        Transport segment
+ * @param l4_size   Size of transport segment in bytes
+ * @param hdr_size  Place to store size of transport header
+ * @param csum_offs Place to store offset of checksum field
+ * @return EOK on success, EINVAL if the segment is malformed or the
+ *         protocol is not supported
+ */
+static errno_t offload_l4_layout(uint8_t proto, const uint8_t *l4,
+    size_t l4_size, size_t *hdr_size, size_t *csum_offs)
+{
+	switch (proto) {
+	case OFFLOAD_PROTO_TCP:
+		if (l4_size < TCP_HDR_MIN)
+			return EINVAL;
+		*hdr_size = (l4[TCP_DOFF] >> 4) * sizeof(uint32_t);
+		if (*hdr_size < TCP_HDR_MIN || *hdr_size > l4_size)
+			return EINVAL;
+		*csum_offs = TCP_CHKSUM;
+		break;
+	case OFFLOAD_PROTO_UDP:
+		if (l4_size < UDP_HDR_SIZE)
+			return EINVAL;
+		*hdr_size = UDP_HDR_SIZE;
+		*csum_offs = UDP_CHKSUM;
+		break;
+	default:
+		return EINVAL;
+	}
+
+	return EOK;
+}
+
+/** Determine length of IPv4 header.
+ *
+ * @param ip       IPv4 packet
+ * @param size     Size of packet in bytes
+ * @param hdr_size Place to store size of IPv4 header
+ * @return EOK on success, EINVAL if the packet is malformed
+ */
+static errno_t offload_ip4_hdr_size(const uint8_t *ip, size_t size,
+    size_t *hdr_size)
+{
+	if (size < IP4_HDR_MIN || (ip[0] >> 4) != 4)
+		return EINVAL;
+
+	*hdr_size = (ip[0] & 0xf) * sizeof(uint32_t);
+	if (*hdr_size < IP4_HDR_MIN || *hdr_size > size)
+		return EINVAL;
+
+	return EOK;
+}
+
+/** Finish packet in software.
+ *
+ * @param offload Requested offload
+ * @param data    Packet, may be modified
+ * @param size    Size of packet in bytes
+ * @param l4_offs Offset of transport header in @a data; if non-zero,
+ *                @a data starts with an IPv4 header
+ * @param src     Source address
+ * @param dest    Destination address
+ * @param proto   Transport protocol
+ * @param emit    Function called for each finished packet
+ * @param arg     Argument to @a emit
+ * @return EOK on success, EINVAL if the packet is malformed, ENOMEM if
+ *         out of memory or an error returned by @a emit
+ */
+static errno_t offload_finish(const inet_offload_t *offload, uint8_t *data,
+    size_t size, size_t l4_offs, addr32_t src, addr32_t dest, uint8_t proto,
+    inet_offload_emit_t emit, void *arg)
+{
+	uint8_t *l4 = data + l4_offs;
+	size_t l4_size = size - l4_offs;
+	size_t hdr_size;
+	size_t csum_offs;
+	errno_t rc;
+
+	rc = offload_l4_layout(proto, l4, l4_size, &hdr_size, &csum_offs);
+	if (rc != EOK)
+		return rc;
+
+	size_t payload = l4_size - hdr_size;
+
+	if (proto != OFFLOAD_PROTO_TCP || offload->gso_size == 0 ||
+	    payload <= offload->gso_size) {
+		/* No segmentation needed, just complete the checksum */
+		if (offload->csum_partial || offload->gso_size != 0) {
+			offload_l4_checksum(l4, l4_size, src, dest, proto,
+			    csum_offs);
+		}
+
+		return emit(arg, data, size);
+	}
+
+	size_t seg_hdrs = l4_offs + hdr_size;
+	uint8_t *seg = malloc(seg_hdrs + offload->gso_size);
+	if (seg == NULL)
+		return ENOMEM;
+
+	uint32_t seq = offload_get32(l4 + TCP_SEQ);
+	uint16_t ident = (l4_offs != 0) ? offload_get16(data + IP4_ID) : 0;
+	size_t offs = 0;
+
+	while (offs < payload) {
+		size_t xfer = min(offload->gso_size, payload - offs);
+		uint8_t *seg_l4 = seg + l4_offs;
+
+		memcpy(seg, data, seg_hdrs);
+		memcpy(seg + seg_hdrs, l4 + hdr_size + offs, xfer);
+
+		offload_put32(seg_l4 + TCP_SEQ, seq + offs);
+
+		/* FIN and PSH only belong to the last segment */
+		if (offs + xfer < payload)
+			seg_l4[TCP_FLAGS] &= ~(TCP_FLAG_FIN | TCP_FLAG_PSH);
+
+		offload_l4_checksum(seg_l4, hdr_size + xfer, src, dest, proto,
+		    csum_offs);
+
+		if (l4_offs != 0) {
+			/* Each segment is a separate IPv4 datagram */
+			offload_put16(seg + IP4_TOT_LEN, seg_hdrs + xfer);
+			offload_put16(seg + IP4_ID, ident);
+			offload_put16(seg + IP4_CHKSUM, 0);
+			offload_put16(seg + IP4_CHKSUM,
+			    offload_checksum(0xffff, seg, l4_offs));
+			++ident;
+		}
+
+		rc = emit(arg, seg, seg_hdrs + xfer);
+		if (rc != EOK)
+			break;
+
+		offs += xfer;
+	}
+
+	free(seg);
+	return rc;
+}
+
+/** Encode offload request as a single IPC argument.
+ *
+ * @param offload Offload request
+ * @return Encoded offload request
+ */
+sysarg_t inet_offload_encode(const inet_offload_t *offload)
+{
+	return (offload->csum_partial ? OFFLOAD_CSUM_PARTIAL : 0) |
+	    ((sysarg_t) offload->gso_size << OFFLOAD_GSO_SHIFT);
+}
+
+/** Decode offload request from an IPC argument.
+ *
+ * @param arg     Encoded offload request
+ * @param offload Place to store offload request
+ */
+void inet_offload_decode(sysarg_t arg, inet_offload_t *offload)
+{
+	offload->csum_partial = (arg & OFFLOAD_CSUM_PARTIAL) != 0;
+	offload->gso_size = (arg >> OFFLOAD_GSO_SHIFT) & 0xffff;
+}
+
+/** Determine whether any offload is requested.
+ *
+ * @param offload Offload request
+ * @return @c true if the datagram needs to be finished before transmission
+ */
+bool inet_offload_requested(const inet_offload_t *offload)
+{
+	return offload->csum_partial || offload->gso_size != 0;
+}
+
+/** Finish transport segment in software.
+ *
+ * Completes the checksum and splits a TCP super-segment into segments
+ * of at most @c gso_size bytes of payload.
+ *
+ * @param offload Requested offload
+ * @param src     Source IPv4 address
+ * @param dest    Destination IPv4 address
+ * @param proto   Transport protocol (TCP or UDP)
+ * @param data    Transport segment, may be modified
+ * @param size    Size of @a data in bytes
+ * @param emit    Function called for each finished segment
+ * @param arg     Argument to @a emit
+ * @return EOK on success or an error code
+ */
+errno_t inet_offload_l4(const inet_offload_t *offload, addr32_t src,
+    addr32_t dest, uint8_t proto, void *data, size_t size,
+    inet_offload_emit_t emit, void *arg)
+{
+	return offload_finish(offload, data, size, 0, src, dest, proto,
+	    emit, arg);
+}
+
+/** Finish IPv4 packet in software.
+ *
+ * Like inet_offload_l4(), but operates on a complete IPv4 packet. The IPv4
+ * header is replicated into each segment and its length, identification
+ * and checksum updated.
+ *
+ * @param offload Requested offload
+ * @param data    IPv4 packet, may be modified
+ * @param size    Size of @a data in bytes
+ * @param emit    Function called for each finished packet
+ * @param arg     Argument to @a emit
+ * @return EOK on success or an error code
+ */
+errno_t inet_offload_ip4(const inet_offload_t *offload, void *data,
+    size_t size, inet_offload_emit_t emit, void *arg)
+{
+	uint8_t *ip = data;
+	size_t hdr_size;
+	errno_t rc;
+
+	rc = offload_ip4_hdr_size(ip, size, &hdr_size);
+	if (rc != EOK)
+		return rc;
+
+	return offload_finish(offload, ip, size, hdr_size,
+	    offload_get32(ip + IP4_SRC), offload_get32(ip + IP4_DEST),
+	    ip[IP4_PROTO], emit, arg);
+}
+
+/** Describe IPv4 packet for offload to hardware.
+ *
+ * Determines the values a NIC needs to complete the checksum and to
+ * segment the packet. Offsets are relative to the start of the IPv4
+ * header.
+ *
+ * @param data      IPv4 packet
+ * @param size      Size of @a data in bytes
+ * @param csum_start Place to store offset where checksumming starts
+ * @param csum_offs Place to store offset of checksum field
+ * @param hdr_len   Place to store size of IPv4 and transport headers
+ * @return EOK on success, EINVAL if the packet is malformed or the
+ *         protocol is not supported
+ */
+errno_t inet_offload_ip4_layout(const void *data, size_t size,
+    size_t *csum_start, size_t *csum_offs, size_t *hdr_len)
+{
+	const uint8_t *ip = data;
+	size_t ip_hdr_size;
+	size_t l4_hdr_size;
+	errno_t rc;
+
+	rc = offload_ip4_hdr_size(ip, size, &ip_hdr_size);
+	if (rc != EOK)
+		return rc;
+
+	rc = offload_l4_layout(ip[IP4_PROTO], ip + ip_hdr_size,
+	    size - ip_hdr_size, &l4_hdr_size, csum_offs);
+	if (rc != EOK)
+		return rc;
+
+	*csum_start = ip_hdr_size;
+	*csum_offs += ip_hdr_size;
+	*hdr_len = ip_hdr_size + l4_hdr_size;
+	return EOK;
+}
+
+/** @}
+ */
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/**
+ * @file
+ * @brief Longest-prefix-match table
+ *
+ * Prefixes are kept in a path-compressed binary trie. Each node holds
+ * a prefix and has up to two children, selected by the first bit past
+ * the prefix. Nodes without entries only exist where two branches
+ * diverge, therefore the trie has at most twice as many nodes as there
+ * are distinct prefixes.
+ */
+
+#include <adt/list.h>
+#include <assert.h>
+#include <errno.h>
+#include <inet/addr.h>
+#include <inet/rtable.h>
+#include <mem.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Maximum key length in bytes */
+#define RTABLE_KEY_SIZE 16
+
+struct inet_rtable_node {
+	/** Parent node or @c NULL if this is the root */
+	inet_rtable_node_t *parent;
+	/** Children, indexed by the first bit past the prefix */
+	inet_rtable_node_t *child[2];
+	/** Prefix, bits past @c bits are zero */
+	uint8_t key[RTABLE_KEY_SIZE];
+	/** Prefix length in bits */
+	unsigned bits;
+	/** Entries with this prefix (inet_rtable_entry_t) */
+	list_t entries;
+};
+
+/** Get bit of key.
+ *
+ * @param key Key
+ * @param idx Bit index, zero being the most significant bit
+ * @return Value of the bit
+ */
+static unsigned rtable_bit(const uint8_t *key, unsigned idx)
+{
+	return (key[idx / 8] >> (7 - idx % 8)) & 1;
+}
+
+/** Determine length of common prefix of two keys.
+ *
+ * @param a    First key
+ * @param b    Second key
+ * @param bits Maximum number of bits to compare
+ * @return Number of leading bits which are equal, at most @a bits
+ */
+static unsigned rtable_common(const uint8_t *a, const uint8_t *b,
+    unsigned bits)
+{
+	unsigned i;
+	uint8_t diff;
+	unsigned n;
+
+	for (i = 0; i * 8 < bits; i++) {
+		diff = a[i] ^ b[i];
+		if (diff != 0) {
+			n = i * 8;
+			while ((diff & 0x80) == 0) {
+				diff <<= 1;
+				++n;
+			}
+
+			return n < bits ? n : bits;
+		}
+	}
+
+	return bits;
+}
+
+/** Convert address to key.
+ *
+ * @param rtable Prefix table
+ * @param ver    IP version
+ * @param addr   IPv4 address
+ * @param addr6  IPv6 address
+ * @param key    Place to store key
+ * @param rroot  Place to store pointer to root of the trie for the
+ *               address family
+ * @return Key length in bits or zero if address family is not supported
+ */
+static unsigned rtable_key(inet_rtable_t *rtable, ip_ver_t ver,
+    addr32_t addr, const addr128_t addr6, uint8_t *key,
+    inet_rtable_node_t ***rroot)
+{
+	switch (ver) {
+	case ip_v4:
+		key[0] = addr >> 24;
+		key[1] = (addr >> 16) & 0xff;
+		key[2] = (addr >> 8) & 0xff;
+		key[3] = addr & 0xff;
+		*rroot = &rtable->root4;
+		return 32;
+	case ip_v6:
+		memcpy(key, addr6, RTABLE_KEY_SIZE);
+		*rroot = &rtable->root6;
+		return 128;
+	default:
+		return 0;
+	}
+}
+
+/** Create trie node.
+ *
+ * @param key  Key
+ * @param bits Prefix length in bits, bits of @a key past it are ignored
+ * @return New node or @c NULL if out of memory
+ */
+static inet_rtable_node_t *rtable_node_new(const uint8_t *key, unsigned bits)
+{
+	inet_rtable_node_t *node;
+	unsigned i;
+
+	node = calloc(1, sizeof(inet_rtable_node_t));
+	if (node == NULL)
+		return NULL;
+
+	for (i = 0; i * 8 < bits; i++)
+		node->key[i] = key[i];
+
+	if (bits % 8 != 0)
+		node->key[bits / 8] &= 0xff << (8 - bits % 8);
+
+	node->bits = bits;
+	list_initialize(&node->entries);
+	return node;
+}
+
+/** Find or create node for prefix.
+ *
+ * @param root Root of the trie
+ * @param key  Key
+ * @param bits Prefix length in bits
+ * @return Node or @c NULL if out of memory
+ */
+static inet_rtable_node_t *rtable_node_get(inet_rtable_node_t **root,
+    const uint8_t *key, unsigned bits)
+{
+	inet_rtable_node_t *parent = NULL;
+	inet_rtable_node_t **np = root;
+	inet_rtable_node_t *node;
+	inet_rtable_node_t *nnode;
+	inet_rtable_node_t *glue;
+	unsigned common;
+
+	while (*np != NULL) {
+		node = *np;
+		common = rtable_common(key, node->key,
+		    bits < node->bits ? bits : node->bits);
+
+		if (common == node->bits) {
+			/* Node prefix is a prefix of the key */
+			if (bits == node->bits)
+				return node;
+
+			parent = node;
+			np = &node->child[rtable_bit(key, node->bits)];
+			continue;
+		}
+
+		nnode = rtable_node_new(key, bits);
+		if (nnode == NULL)
+			return NULL;
+
+		if (common == bits) {
+			/* New prefix is a prefix of node prefix */
+			nnode->child[rtable_bit(node->key, bits)] = node;
+			nnode->parent = parent;
+			node->parent = nnode;
+			*np = nnode;
+			return nnode;
+		}
+
+		/* Prefixes diverge, join them in a new node */
+		glue = rtable_node_new(key, common);
+		if (glue == NULL) {
+			free(nnode);
+			return NULL;
+		}
+
+		glue->child[rtable_bit(node->key, common)] = node;
+		glue->child[rtable_bit(key, common)] = nnode;
+		glue->parent = parent;
+		node->parent = glue;
+		nnode->parent = glue;
+		*np = glue;
+		return nnode;
+	}
+
+	nnode = rtable_node_new(key, bits);
+	if (nnode == NULL)
+		return NULL;
+
+	nnode->parent = parent;
+	*np = nnode;
+	return nnode;
+}
+
+/** Remove nodes which are no longer needed.
+ *
+ * Starting at @a node, remove nodes without entries which have less than
+ * two children.
+ *
+ * @param rtable Prefix table
+ * @param node   Node which may have become unneeded
+ */
+static void rtable_node_prune(inet_rtable_t *rtable, inet_rtable_node_t *node)
+{
+	inet_rtable_node_t *parent;
+	inet_rtable_node_t *child;
+	inet_rtable_node_t **np;
+
+	while (node != NULL && list_empty(&node->entries)) {
+		if (node->child[0] != NULL && node->child[1] != NULL)
+			break;
+
+		child = node->child[0] != NULL ? node->child[0] :
+		    node->child[1];
+		parent = node->parent;
+
+		if (parent == NULL)
+			np = rtable->root4 == node ? &rtable->root4 :
+			    &rtable->root6;
+		else
+			np = parent->child[0] == node ? &parent->child[0] :
+			    &parent->child[1];
+
+		assert(*np == node);
+		*np = child;
+		if (child != NULL)
+			child->parent = parent;
+
+		free(node);
+		node = parent;
+	}
+}
+
+/** Destroy trie.
+ *
+ * @param node Root of the trie or @c NULL
+ */
+static void rtable_node_destroy(inet_rtable_node_t *node)
+{
+	if (node == NULL)
+		return;
+
+	rtable_node_destroy(node->child[0]);
+	rtable_node_destroy(node->child[1]);
+	free(node);
+}
+
+/** Initialize prefix table.
+ *
+ * @param rtable Prefix table
+ */
+void inet_rtable_init(inet_rtable_t *rtable)
+{
+	rtable->root4 = NULL;
+	rtable->root6 = NULL;
+	rtable->count = 0;
+}
+
+/** Finalize prefix table.
+ *
+ * Entries still in the table are not touched, they are owned by the
+ * caller.
+ *
+ * @param rtable Prefix table
+ */
+void inet_rtable_fini(inet_rtable_t *rtable)
+{
+	rtable_node_destroy(rtable->root4);
+	rtable_node_destroy(rtable->root6);
+	inet_rtable_init(rtable);
+}
+
+/** Insert entry into prefix table.
+ *
+ * @param rtable Prefix table
+ * @param naddr  Network address (prefix)
+ * @param entry  Entry
+ * @param arg    Argument to be returned by lookup
+ * @return EOK on success, EINVAL if @a naddr is not valid, ENOMEM if
+ *         out of memory
+ */
+errno_t inet_rtable_insert(inet_rtable_t *rtable, const inet_naddr_t *naddr,
+    inet_rtable_entry_t *entry, void *arg)
+{
+	inet_rtable_node_t **root;
+	inet_rtable_node_t *node;
+	uint8_t key[RTABLE_KEY_SIZE];
+	unsigned maxbits;
+
+	maxbits = rtable_key(rtable, naddr->version, naddr->addr, naddr->addr6,
+	    key, &root);
+	if (maxbits == 0 || naddr->prefix > maxbits)
+		return EINVAL;
+
+	node = rtable_node_get(root, key, naddr->prefix);
+	if (node == NULL)
+		return ENOMEM;
+
+	link_initialize(&entry->lnode);
+	entry->node = node;
+	entry->arg = arg;
+	list_append(&entry->lnode, &node->entries);
+	++rtable->count;
+	return EOK;
+}
+
+/** Remove entry from prefix table.
+ *
+ * @param rtable Prefix table
+ * @param entry  Entry previously inserted into @a rtable
+ */
+void inet_rtable_remove(inet_rtable_t *rtable, inet_rtable_entry_t *entry)
+{
+	inet_rtable_node_t *node = entry->node;
+
+	assert(node != NULL);
+	list_remove(&entry->lnode);
+	entry->node = NULL;
+	--rtable->count;
+
+	rtable_node_prune(rtable, node);
+}
+
+/** Find entry with the longest prefix matching address.
+ *
+ * @param rtable Prefix table
+ * @param addr   Address
+ * @return Argument of the matching entry or @c NULL if there is none
+ */
+void *inet_rtable_lookup(inet_rtable_t *rtable, const inet_addr_t *addr)
+{
+	inet_rtable_node_t **root;
+	inet_rtable_node_t *node;
+	inet_rtable_node_t *best;
+	uint8_t key[RTABLE_KEY_SIZE];
+	unsigned maxbits;
+	inet_rtable_entry_t *entry;
+
+	maxbits = rtable_key(rtable, addr->version, addr->addr, addr->addr6,
+	    key, &root);
+	if (maxbits == 0)
+		return NULL;
+
+	best = NULL;
+	node = *root;
+	while (node != NULL && rtable_common(key, node->key, node->bits) ==
+	    node->bits) {
+		if (!list_empty(&node->entries))
+			best = node;
+
+		if (node->bits == maxbits)
+			break;
+
+		node = node->child[rtable_bit(key, node->bits)];
+	}
+
+	if (best == NULL)
+		return NULL;
+
+	entry = list_get_instance(list_first(&best->entries),
+	    inet_rtable_entry_t, lnode);
+	return entry->arg;
+}
+
+/** @}
+ */
@@ -32,5 +32,7 @@ PCUT_INIT;
 
 PCUT_IMPORT(addr);
 PCUT_IMPORT(eth_addr);
+PCUT_IMPORT(offload);
+PCUT_IMPORT(rtable);
 
 PCUT_MAIN();
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inet/offload.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(offload);
+
+#define TEST_SRC   0x0a000001
+#define TEST_DEST  0x0a000002
+
+#define MAX_SEGS 8
+
+/** Packets collected by test_emit() */
+typedef struct {
+	unsigned count;
+	uint8_t *pkt[MAX_SEGS];
+	size_t size[MAX_SEGS];
+} test_pkts_t;
+
+static errno_t test_emit(void *arg, void *data, size_t size)
+{
+	test_pkts_t *pkts = (test_pkts_t *) arg;
+
+	if (pkts->count >= MAX_SEGS)
+		return ELIMIT;
+
+	pkts->pkt[pkts->count] = malloc(size);
+	if (pkts->pkt[pkts->count] == NULL)
+		return ENOMEM;
+
+	memcpy(pkts->pkt[pkts->count], data, size);
+	pkts->size[pkts->count] = size;
+	++pkts->count;
+	return EOK;
+}
+
+static void test_pkts_free(test_pkts_t *pkts)
+{
+	unsigned i;
+
+	for (i = 0; i < pkts->count; i++)
+		free(pkts->pkt[i]);
+}
+
+static uint16_t test_get16(const uint8_t *p)
+{
+	return ((uint16_t) p[0] << 8) | p[1];
+}
+
+static uint32_t test_get32(const uint8_t *p)
+{
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+	    ((uint32_t) p[2] << 8) | p[3];
+}
+
+/** One's complement sum of data, folded to 16 bits */
+static uint32_t test_sum(uint32_t sum, const uint8_t *data, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < size; i += 2)
+		sum += test_get16(data + i);
+	if (i < size)
+		sum += (uint32_t) data[i] << 8;
+
+	while ((sum >> 16) != 0)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return sum;
+}
+
+/** Verify transport checksum of a segment */
+static bool test_l4_valid(const uint8_t *seg, size_t size, uint8_t proto)
+{
+	uint8_t phdr[12] = {
+		0x0a, 0, 0, 1, 0x0a, 0, 0, 2, 0, proto, size >> 8, size & 0xff
+	};
+
+	return test_sum(test_sum(0, phdr, sizeof(phdr)), seg, size) == 0xffff;
+}
+
+/** Build IPv4 packet with TCP segment carrying @a payload bytes */
+static uint8_t *test_tcp4(size_t payload, uint8_t flags, size_t *rsize)
+{
+	size_t size = 20 + 20 + payload;
+	uint8_t *p = calloc(1, size);
+	size_t i;
+
+	PCUT_ASSERT_NOT_NULL(p);
+
+	p[0] = 0x45;
+	p[2] = size >> 8;
+	p[3] = size & 0xff;
+	p[4] = 0x12;
+	p[5] = 0x34;
+	p[8] = 64;
+	p[9] = 6;
+	p[12] = 0x0a;
+	p[15] = 1;
+	p[16] = 0x0a;
+	p[19] = 2;
+
+	/* Sequence number 0xfffffff0 so that it wraps around */
+	p[24] = 0xff;
+	p[25] = 0xff;
+	p[26] = 0xff;
+	p[27] = 0xf0;
+	p[32] = 5 << 4;
+	p[33] = flags;
+
+	/* Checksum field holds garbage, it is to be computed */
+	p[36] = 0xde;
+	p[37] = 0xad;
+
+	for (i = 0; i < payload; i++)
+		p[40 + i] = i & 0xff;
+
+	*rsize = size;
+	return p;
+}
+
+/** Offload request survives encoding into IPC argument */
+PCUT_TEST(encode_decode)
+{
+	inet_offload_t a;
+	inet_offload_t b;
+
+	a.csum_partial = true;
+	a.gso_size = 1448;
+	inet_offload_decode(inet_offload_encode(&a), &b);
+	PCUT_ASSERT_TRUE(b.csum_partial);
+	PCUT_ASSERT_INT_EQUALS(1448, b.gso_size);
+	PCUT_ASSERT_TRUE(inet_offload_requested(&b));
+
+	a.csum_partial = false;
+	a.gso_size = 0;
+	inet_offload_decode(inet_offload_encode(&a), &b);
+	PCUT_ASSERT_FALSE(b.csum_partial);
+	PCUT_ASSERT_INT_EQUALS(0, b.gso_size);
+	PCUT_ASSERT_FALSE(inet_offload_requested(&b));
+}
+
+/** Checksum is completed if the segment need not be split */
+PCUT_TEST(csum_only)
+{
+	inet_offload_t offload;
+	test_pkts_t pkts;
+	uint8_t *p;
+	size_t size;
+	errno_t rc;
+
+	p = test_tcp4(1000, 0x18, &size);
+	offload.csum_partial = true;
+	offload.gso_size = 1000;
+	pkts.count = 0;
+
+	rc = inet_offload_ip4(&offload, p, size, test_emit, &pkts);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(1, pkts.count);
+	PCUT_ASSERT_INT_EQUALS(size, pkts.size[0]);
+	PCUT_ASSERT_TRUE(test_l4_valid(pkts.pkt[0] + 20, size - 20, 6));
+
+	test_pkts_free(&pkts);
+	free(p);
+}
+
+/** TCP super-segment in IPv4 packet is split into valid segments */
+PCUT_TEST(gso_ip4)
+{
+	inet_offload_t offload;
+	test_pkts_t pkts;
+	uint8_t *p;
+	uint8_t *seg;
+	size_t size;
+	unsigned i;
+	size_t j;
+	errno_t rc;
+
+	/* FIN and PSH set */
+	p = test_tcp4(2500, 0x19, &size);
+	offload.csum_partial = true;
+	offload.gso_size = 1000;
+	pkts.count = 0;
+
+	rc = inet_offload_ip4(&offload, p, size, test_emit, &pkts);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(3, pkts.count);
+
+	for (i = 0; i < pkts.count; i++) {
+		size_t payload = i < 2 ? 1000 : 500;
+
+		seg = pkts.pkt[i];
+		PCUT_ASSERT_INT_EQUALS(40 + payload, pkts.size[i]);
+
+		/* IPv4 header */
+		PCUT_ASSERT_INT_EQUALS(40 + payload, test_get16(seg + 2));
+		PCUT_ASSERT_INT_EQUALS(0x1234 + i, test_get16(seg + 4));
+		PCUT_ASSERT_INT_EQUALS(0xffff, test_sum(0, seg, 20));
+
+		/* TCP header */
+		PCUT_ASSERT_INT_EQUALS((uint32_t) (0xfffffff0 + i * 1000),
+		    test_get32(seg + 24));
+		PCUT_ASSERT_INT_EQUALS(i < 2 ? 0x10 : 0x19, seg[33]);
+		PCUT_ASSERT_TRUE(test_l4_valid(seg + 20, 20 + payload, 6));
+
+		/* Payload */
+		for (j = 0; j < payload; j++) {
+			PCUT_ASSERT_INT_EQUALS((i * 1000 + j) & 0xff,
+			    seg[40 + j]);
+		}
+	}
+
+	test_pkts_free(&pkts);
+	free(p);
+}
+
+/** TCP super-segment without IP header is split into valid segments */
+PCUT_TEST(gso_l4)
+{
+	inet_offload_t offload;
+	test_pkts_t pkts;
+	uint8_t *p;
+	size_t size;
+	unsigned i;
+	errno_t rc;
+
+	p = test_tcp4(3000, 0x10, &size);
+	offload.csum_partial = true;
+	offload.gso_size = 1460;
+	pkts.count = 0;
+
+	rc = inet_offload_l4(&offload, TEST_SRC, TEST_DEST, 6, p + 20,
+	    size - 20, test_emit, &pkts);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(3, pkts.count);
+
+	for (i = 0; i < pkts.count; i++) {
+		PCUT_ASSERT_INT_EQUALS(i < 2 ? 1480 : 100, pkts.size[i]);
+		PCUT_ASSERT_TRUE(test_l4_valid(pkts.pkt[i], pkts.size[i], 6));
+	}
+
+	test_pkts_free(&pkts);
+	free(p);
+}
+
+/** UDP datagram is never split, only its checksum is completed */
+PCUT_TEST(udp_no_gso)
+{
+	inet_offload_t offload;
+	test_pkts_t pkts;
+	uint8_t dgram[8 + 2000];
+	errno_t rc;
+
+	memset(dgram, 0x5a, sizeof(dgram));
+	dgram[4] = sizeof(dgram) >> 8;
+	dgram[5] = sizeof(dgram) & 0xff;
+
+	offload.csum_partial = true;
+	offload.gso_size = 1000;
+	pkts.count = 0;
+
+	rc = inet_offload_l4(&offload, TEST_SRC, TEST_DEST, 17, dgram,
+	    sizeof(dgram), test_emit, &pkts);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(1, pkts.count);
+	PCUT_ASSERT_INT_EQUALS(sizeof(dgram), pkts.size[0]);
+	PCUT_ASSERT_TRUE(test_l4_valid(pkts.pkt[0], pkts.size[0], 17));
+
+	test_pkts_free(&pkts);
+}
+
+/** Layout of IPv4 packet is described for hardware offload */
+PCUT_TEST(ip4_layout)
+{
+	size_t csum_start;
+	size_t csum_offs;
+	size_t hdr_len;
+	uint8_t *p;
+	size_t size;
+	errno_t rc;
+
+	p = test_tcp4(100, 0x10, &size);
+
+	rc = inet_offload_ip4_layout(p, size, &csum_start, &csum_offs,
+	    &hdr_len);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(20, csum_start);
+	PCUT_ASSERT_INT_EQUALS(36, csum_offs);
+	PCUT_ASSERT_INT_EQUALS(40, hdr_len);
+
+	/* UDP */
+	p[9] = 17;
+	rc = inet_offload_ip4_layout(p, size, &csum_start, &csum_offs,
+	    &hdr_len);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(20, csum_start);
+	PCUT_ASSERT_INT_EQUALS(26, csum_offs);
+	PCUT_ASSERT_INT_EQUALS(28, hdr_len);
+
+	/* Unsupported protocol */
+	p[9] = 1;
+	rc = inet_offload_ip4_layout(p, size, &csum_start, &csum_offs,
+	    &hdr_len);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	free(p);
+}
+
+/** Malformed packets are rejected */
+PCUT_TEST(malformed)
+{
+	inet_offload_t offload;
+	test_pkts_t pkts;
+	uint8_t *p;
+	size_t size;
+	errno_t rc;
+
+	p = test_tcp4(100, 0x10, &size);
+	offload.csum_partial = true;
+	offload.gso_size = 0;
+	pkts.count = 0;
+
+	/* Truncated TCP header */
+	rc = inet_offload_ip4(&offload, p, 30, test_emit, &pkts);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	/* Not IPv4 */
+	p[0] = 0x65;
+	rc = inet_offload_ip4(&offload, p, size, test_emit, &pkts);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	/* Unsupported protocol */
+	rc = inet_offload_l4(&offload, TEST_SRC, TEST_DEST, 1, p + 20,
+	    size - 20, test_emit, &pkts);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	PCUT_ASSERT_INT_EQUALS(0, pkts.count);
+	free(p);
+}
+
+PCUT_EXPORT(offload);
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <inet/rtable.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(rtable);
+
+#define TEST_PREFIXES 200
+#define TEST_LOOKUPS 2000
+
+/** Most specific prefix wins */
+PCUT_TEST(lpm_v4)
+{
+	inet_rtable_t rtable;
+	inet_rtable_entry_t e[4];
+	inet_naddr_t naddr;
+	inet_addr_t addr;
+	int v[4];
+	errno_t rc;
+
+	inet_rtable_init(&rtable);
+
+	inet_naddr(&naddr, 0, 0, 0, 0, 0);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[0], &v[0]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr(&naddr, 10, 0, 0, 0, 8);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[1], &v[1]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr(&naddr, 10, 1, 0, 0, 16);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[2], &v[2]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr(&naddr, 10, 1, 2, 3, 32);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[3], &v[3]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr(&addr, 192, 168, 0, 1);
+	PCUT_ASSERT_EQUALS(&v[0], inet_rtable_lookup(&rtable, &addr));
+	inet_addr(&addr, 10, 2, 0, 1);
+	PCUT_ASSERT_EQUALS(&v[1], inet_rtable_lookup(&rtable, &addr));
+	inet_addr(&addr, 10, 1, 2, 4);
+	PCUT_ASSERT_EQUALS(&v[2], inet_rtable_lookup(&rtable, &addr));
+	inet_addr(&addr, 10, 1, 2, 3);
+	PCUT_ASSERT_EQUALS(&v[3], inet_rtable_lookup(&rtable, &addr));
+
+	/* Removing more specific prefix uncovers the less specific one */
+	inet_rtable_remove(&rtable, &e[2]);
+	inet_addr(&addr, 10, 1, 2, 4);
+	PCUT_ASSERT_EQUALS(&v[1], inet_rtable_lookup(&rtable, &addr));
+	inet_addr(&addr, 10, 1, 2, 3);
+	PCUT_ASSERT_EQUALS(&v[3], inet_rtable_lookup(&rtable, &addr));
+
+	inet_rtable_remove(&rtable, &e[0]);
+	inet_addr(&addr, 192, 168, 0, 1);
+	PCUT_ASSERT_NULL(inet_rtable_lookup(&rtable, &addr));
+
+	inet_rtable_remove(&rtable, &e[1]);
+	inet_rtable_remove(&rtable, &e[3]);
+	PCUT_ASSERT_INT_EQUALS(0, rtable.count);
+	PCUT_ASSERT_NULL(rtable.root4);
+
+	inet_rtable_fini(&rtable);
+}
+
+/** IPv6 and IPv4 prefixes are kept apart */
+PCUT_TEST(lpm_v6)
+{
+	inet_rtable_t rtable;
+	inet_rtable_entry_t e[3];
+	inet_naddr_t naddr;
+	inet_addr_t addr;
+	int v[3];
+	errno_t rc;
+
+	inet_rtable_init(&rtable);
+
+	inet_naddr6(&naddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 0, 32);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[0], &v[0]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr6(&naddr, 0x2001, 0xdb8, 0x12, 0x3400, 0, 0, 0, 0, 55);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[1], &v[1]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr(&naddr, 0, 0, 0, 0, 0);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[2], &v[2]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr6(&addr, 0x2001, 0xdb8, 0x12, 0x3401, 0, 0, 0, 1);
+	PCUT_ASSERT_EQUALS(&v[1], inet_rtable_lookup(&rtable, &addr));
+	inet_addr6(&addr, 0x2001, 0xdb8, 0x12, 0x3600, 0, 0, 0, 1);
+	PCUT_ASSERT_EQUALS(&v[0], inet_rtable_lookup(&rtable, &addr));
+	inet_addr6(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+	PCUT_ASSERT_NULL(inet_rtable_lookup(&rtable, &addr));
+
+	inet_rtable_remove(&rtable, &e[0]);
+	inet_rtable_remove(&rtable, &e[1]);
+	inet_rtable_remove(&rtable, &e[2]);
+	inet_rtable_fini(&rtable);
+}
+
+/** Entry with the same prefix inserted first is returned */
+PCUT_TEST(same_prefix)
+{
+	inet_rtable_t rtable;
+	inet_rtable_entry_t e[2];
+	inet_naddr_t naddr;
+	inet_addr_t addr;
+	int v[2];
+	errno_t rc;
+
+	inet_rtable_init(&rtable);
+
+	inet_naddr(&naddr, 10, 0, 0, 0, 8);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[0], &v[0]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = inet_rtable_insert(&rtable, &naddr, &e[1], &v[1]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr(&addr, 10, 0, 0, 1);
+	PCUT_ASSERT_EQUALS(&v[0], inet_rtable_lookup(&rtable, &addr));
+
+	inet_rtable_remove(&rtable, &e[0]);
+	PCUT_ASSERT_EQUALS(&v[1], inet_rtable_lookup(&rtable, &addr));
+
+	inet_rtable_remove(&rtable, &e[1]);
+	PCUT_ASSERT_NULL(inet_rtable_lookup(&rtable, &addr));
+
+	/* Prefix longer than address is rejected */
+	naddr.prefix = 33;
+	rc = inet_rtable_insert(&rtable, &naddr, &e[0], &v[0]);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	inet_rtable_fini(&rtable);
+}
+
+/** Lookup agrees with linear search over random prefixes */
+PCUT_TEST(random)
+{
+	inet_rtable_t rtable;
+	inet_rtable_entry_t *e;
+	inet_naddr_t *naddr;
+	inet_naddr_t *best;
+	inet_naddr_t *found;
+	inet_addr_t addr;
+	unsigned i, j;
+	errno_t rc;
+
+	e = calloc(TEST_PREFIXES, sizeof(inet_rtable_entry_t));
+	PCUT_ASSERT_NOT_NULL(e);
+	naddr = calloc(TEST_PREFIXES, sizeof(inet_naddr_t));
+	PCUT_ASSERT_NOT_NULL(naddr);
+
+	srand(1);
+	inet_rtable_init(&rtable);
+
+	for (i = 0; i < TEST_PREFIXES; i++) {
+		/* Few distinct top bits so that prefixes nest */
+		inet_naddr(&naddr[i], 10 + rand() % 2, rand() % 4, rand() % 256,
+		    rand() % 256, 1 + rand() % 32);
+		rc = inet_rtable_insert(&rtable, &naddr[i], &e[i], &naddr[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	for (i = 0; i < TEST_LOOKUPS; i++) {
+		inet_addr(&addr, 10 + rand() % 2, rand() % 4, rand() % 256,
+		    rand() % 256);
+
+		best = NULL;
+		for (j = 0; j < TEST_PREFIXES; j++) {
+			if (inet_naddr_compare_mask(&naddr[j], &addr) &&
+			    (best == NULL || naddr[j].prefix > best->prefix))
+				best = &naddr[j];
+		}
+
+		/* Prefixes may repeat, compare only the prefix length */
+		found = inet_rtable_lookup(&rtable, &addr);
+		if (best == NULL) {
+			PCUT_ASSERT_NULL(found);
+		} else {
+			PCUT_ASSERT_NOT_NULL(found);
+			PCUT_ASSERT_INT_EQUALS(best->prefix, found->prefix);
+			PCUT_ASSERT_TRUE(inet_naddr_compare_mask(found, &addr));
+		}
+
+		/* Remove and re-insert a prefix to exercise pruning */
+		j = rand() % TEST_PREFIXES;
+		inet_rtable_remove(&rtable, &e[j]);
+		rc = inet_rtable_insert(&rtable, &naddr[j], &e[j], &naddr[j]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(TEST_PREFIXES, rtable.count);
+
+	for (i = 0; i < TEST_PREFIXES; i++)
+		inet_rtable_remove(&rtable, &e[i]);
+
+	PCUT_ASSERT_NULL(rtable.root4);
+	inet_rtable_fini(&rtable);
+	free(naddr);
+	free(e);
+}
+
+PCUT_EXPORT(rtable);
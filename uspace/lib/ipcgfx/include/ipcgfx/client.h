@@ -37,6 +37,7 @@
 #define _IPCGFX_CLIENT_H
 
 #include <async.h>
+#include <stdbool.h>
 #include <types/ipcgfx/client.h>
 #include <types/gfx/context.h>
 #include <types/gfx/ops/context.h>
@@ -46,6 +47,7 @@ extern gfx_context_ops_t ipc_gc_ops;
 extern errno_t ipc_gc_create(async_sess_t *, ipc_gc_t **);
 extern errno_t ipc_gc_delete(ipc_gc_t *);
 extern gfx_context_t *ipc_gc_get_ctx(ipc_gc_t *);
+extern errno_t ipc_gc_set_batch(ipc_gc_t *, bool);
 
 #endif
 
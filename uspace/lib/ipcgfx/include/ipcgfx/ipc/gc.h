@@ -36,6 +36,7 @@
 #define _IPCGFX_IPC_GC_H_
 
 #include <ipc/common.h>
+#include <stdint.h>
 
 typedef enum {
 	GC_SET_CLIP_RECT = IPC_FIRST_USER_METHOD,
@@ -48,8 +49,34 @@ typedef enum {
 	GC_BITMAP_DESTROY,
 	GC_BITMAP_RENDER,
 	GC_BITMAP_GET_ALLOC,
+	GC_BATCH_SETUP,
+	GC_BATCH_SUBMIT
 } gc_request_t;
 
+/** Size of command batch buffer in bytes */
+#define GC_BATCH_SIZE 16384
+
+/** Batched GC command type */
+typedef enum {
+	gc_bcmd_set_clip_rect,
+	gc_bcmd_set_clip_rect_null,
+	gc_bcmd_set_rgb_color,
+	gc_bcmd_fill_rect
+} gc_batch_cmd_type_t;
+
+/** Batched GC command.
+ *
+ * Commands are stored in a memory area shared by the client with the
+ * server (GC_BATCH_SETUP) and executed by the server in order upon
+ * GC_BATCH_SUBMIT.
+ */
+typedef struct {
+	/** Command type (gc_batch_cmd_type_t) */
+	uint32_t type;
+	/** Arguments (rectangle coordinates or RGB color components) */
+	int32_t arg[4];
+} gc_batch_cmd_t;
+
 #endif
 
 /** @}
@@ -39,6 +39,8 @@
 
 #include <async.h>
 #include <gfx/context.h>
+#include <ipcgfx/ipc/gc.h>
+#include <stddef.h>
 
 /** Actual structure of graphics context.
  *
@@ -49,6 +51,14 @@ struct ipc_gc {
 	gfx_context_t *gc;
 	/** Session with GFX server */
 	async_sess_t *sess;
+	/** Command batch buffer or @c NULL if not batching */
+	gc_batch_cmd_t *batch;
+	/** Number of commands in batch buffer */
+	size_t batch_cnt;
+	/** Maximum number of commands in batch buffer */
+	size_t batch_max;
+	/** Deferred error from batched commands */
+	errno_t batch_rc;
 };
 
 /** Bitmap in IPC GC */
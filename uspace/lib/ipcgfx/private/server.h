@@ -42,6 +42,8 @@
 #include <gfx/bitmap.h>
 #include <gfx/context.h>
 #include <gfx/coord.h>
+#include <ipcgfx/ipc/gc.h>
+#include <stddef.h>
 #include <stdbool.h>
 
 /** Server-side of IPC GC connection.
@@ -53,6 +55,10 @@ typedef struct {
 	list_t bitmaps;
 	/** Next bitmap ID to allocate */
 	sysarg_t next_bmp_id;
+	/** Command batch buffer shared by client or @c NULL */
+	gc_batch_cmd_t *batch;
+	/** Maximum number of commands in batch buffer */
+	size_t batch_max;
 } ipc_gc_srv_t;
 
 /** Bitmap in canvas GC */
@@ -33,6 +33,12 @@
  * @file GFX IPC backend
  *
  * This implements a graphics context via HelenOS IPC.
+ *
+ * Optionally, clipping, color and fill commands can be batched. They are
+ * then recorded in a memory area shared with the server and submitted
+ * all at once when the buffer is full, on gfx_update() or before any
+ * bitmap operation. Errors from batched commands are reported by
+ * gfx_update() or by a subsequent batched command.
  */
 
 #include <as.h>
@@ -44,6 +50,10 @@
 #include <stdlib.h>
 #include "../private/client.h"
 
+static errno_t ipc_gc_batch_submit(ipc_gc_t *, bool);
+static void ipc_gc_batch_flush(ipc_gc_t *);
+static errno_t ipc_gc_batch_cmd(ipc_gc_t *, gc_batch_cmd_type_t,
+    gc_batch_cmd_t **);
 static errno_t ipc_gc_set_clip_rect(void *, gfx_rect_t *);
 static errno_t ipc_gc_set_color(void *, gfx_color_t *);
 static errno_t ipc_gc_fill_rect(void *, gfx_rect_t *);
@@ -75,9 +85,24 @@ gfx_context_ops_t ipc_gc_ops = {
 static errno_t ipc_gc_set_clip_rect(void *arg, gfx_rect_t *rect)
 {
 	ipc_gc_t *ipcgc = (ipc_gc_t *) arg;
+	gc_batch_cmd_t *cmd;
 	async_exch_t *exch;
 	errno_t rc;
 
+	if (ipcgc->batch != NULL) {
+		if (rect == NULL) {
+			return ipc_gc_batch_cmd(ipcgc, gc_bcmd_set_clip_rect_null,
+			    &cmd);
+		}
+
+		rc = ipc_gc_batch_cmd(ipcgc, gc_bcmd_set_clip_rect, &cmd);
+		cmd->arg[0] = rect->p0.x;
+		cmd->arg[1] = rect->p0.y;
+		cmd->arg[2] = rect->p1.x;
+		cmd->arg[3] = rect->p1.y;
+		return rc;
+	}
+
 	exch = async_exchange_begin(ipcgc->sess);
 	if (rect != NULL) {
 		rc = async_req_4_0(exch, GC_SET_CLIP_RECT, rect->p0.x, rect->p0.y,
@@ -103,12 +128,21 @@ static errno_t ipc_gc_set_clip_rect(void *arg, gfx_rect_t *rect)
 static errno_t ipc_gc_set_color(void *arg, gfx_color_t *color)
 {
 	ipc_gc_t *ipcgc = (ipc_gc_t *) arg;
+	gc_batch_cmd_t *cmd;
 	async_exch_t *exch;
 	uint16_t r, g, b;
 	errno_t rc;
 
 	gfx_color_get_rgb_i16(color, &r, &g, &b);
 
+	if (ipcgc->batch != NULL) {
+		rc = ipc_gc_batch_cmd(ipcgc, gc_bcmd_set_rgb_color, &cmd);
+		cmd->arg[0] = r;
+		cmd->arg[1] = g;
+		cmd->arg[2] = b;
+		return rc;
+	}
+
 	exch = async_exchange_begin(ipcgc->sess);
 	rc = async_req_3_0(exch, GC_SET_RGB_COLOR, r, g, b);
 	async_exchange_end(exch);
@@ -126,9 +160,19 @@ static errno_t ipc_gc_set_color(void *arg, gfx_color_t *color)
 static errno_t ipc_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	ipc_gc_t *ipcgc = (ipc_gc_t *) arg;
+	gc_batch_cmd_t *cmd;
 	async_exch_t *exch;
 	errno_t rc;
 
+	if (ipcgc->batch != NULL) {
+		rc = ipc_gc_batch_cmd(ipcgc, gc_bcmd_fill_rect, &cmd);
+		cmd->arg[0] = rect->p0.x;
+		cmd->arg[1] = rect->p0.y;
+		cmd->arg[2] = rect->p1.x;
+		cmd->arg[3] = rect->p1.y;
+		return rc;
+	}
+
 	exch = async_exchange_begin(ipcgc->sess);
 	rc = async_req_4_0(exch, GC_FILL_RECT, rect->p0.x, rect->p0.y,
 	    rect->p1.x, rect->p1.y);
@@ -149,6 +193,10 @@ static errno_t ipc_gc_update(void *arg)
 	async_exch_t *exch;
 	errno_t rc;
 
+	/* Submit pending commands and update in a single request */
+	if (ipcgc->batch != NULL)
+		return ipc_gc_batch_submit(ipcgc, true);
+
 	exch = async_exchange_begin(ipcgc->sess);
 	rc = async_req_0_0(exch, GC_UPDATE);
 	async_exchange_end(exch);
@@ -344,6 +392,11 @@ error:
 errno_t ipc_gc_bitmap_create(void *arg, gfx_bitmap_params_t *params,
     gfx_bitmap_alloc_t *alloc, void **rbm)
 {
+	ipc_gc_t *ipcgc = (ipc_gc_t *) arg;
+
+	/* Execute pending commands first */
+	ipc_gc_batch_flush(ipcgc);
+
 	if ((params->flags & bmpf_direct_output) != 0) {
 		return ipc_gc_bitmap_create_direct_output(arg, params, alloc,
 		    rbm);
@@ -363,6 +416,9 @@ static errno_t ipc_gc_bitmap_destroy(void *bm)
 	async_exch_t *exch;
 	errno_t rc;
 
+	/* Execute pending commands first */
+	ipc_gc_batch_flush(ipcbm->ipcgc);
+
 	exch = async_exchange_begin(ipcbm->ipcgc->sess);
 	rc = async_req_1_0(exch, GC_BITMAP_DESTROY, ipcbm->bmp_id);
 	async_exchange_end(exch);
@@ -410,6 +466,9 @@ static errno_t ipc_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	/* Destination rectangle */
 	gfx_rect_translate(&offs, &srect, &drect);
 
+	/* Execute pending commands first */
+	ipc_gc_batch_flush(ipcbm->ipcgc);
+
 	exch = async_exchange_begin(ipcbm->ipcgc->sess);
 	req = async_send_3(exch, GC_BITMAP_RENDER, ipcbm->bmp_id, offs.x,
 	    offs.y, &answer);
@@ -495,6 +554,11 @@ errno_t ipc_gc_delete(ipc_gc_t *ipcgc)
 	if (rc != EOK)
 		return rc;
 
+	if (ipcgc->batch != NULL) {
+		(void) ipc_gc_batch_submit(ipcgc, false);
+		as_area_destroy(ipcgc->batch);
+	}
+
 	free(ipcgc);
 	return EOK;
 }
@@ -509,5 +573,133 @@ gfx_context_t *ipc_gc_get_ctx(ipc_gc_t *ipcgc)
 	return ipcgc->gc;
 }
 
+/** Enable or disable command batching in IPC GC.
+ *
+ * With batching enabled, clipping, color and fill commands are not sent
+ * to the server immediately. The caller must call gfx_update() to make
+ * sure the results of drawing are visible.
+ *
+ * @param ipcgc IPC GC
+ * @param enable @c true to enable batching, @c false to disable it
+ * @return EOK on success or an error code. When disabling batching,
+ *         this may be the error of a pending command.
+ */
+errno_t ipc_gc_set_batch(ipc_gc_t *ipcgc, bool enable)
+{
+	async_exch_t *exch;
+	gc_batch_cmd_t *batch;
+	ipc_call_t answer;
+	aid_t req;
+	errno_t rc;
+
+	if (!enable) {
+		if (ipcgc->batch == NULL)
+			return EOK;
+
+		rc = ipc_gc_batch_submit(ipcgc, false);
+		as_area_destroy(ipcgc->batch);
+		ipcgc->batch = NULL;
+		return rc;
+	}
+
+	if (ipcgc->batch != NULL)
+		return EOK;
+
+	batch = as_area_create(AS_AREA_ANY, GC_BATCH_SIZE, AS_AREA_READ |
+	    AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (batch == AS_MAP_FAILED)
+		return ENOMEM;
+
+	exch = async_exchange_begin(ipcgc->sess);
+	req = async_send_0(exch, GC_BATCH_SETUP, &answer);
+	rc = async_share_out_start(exch, batch, AS_AREA_READ |
+	    AS_AREA_CACHEABLE);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		as_area_destroy(batch);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK) {
+		as_area_destroy(batch);
+		return rc;
+	}
+
+	ipcgc->batch = batch;
+	ipcgc->batch_cnt = 0;
+	ipcgc->batch_rc = EOK;
+	ipcgc->batch_max = GC_BATCH_SIZE / sizeof(gc_batch_cmd_t);
+	return EOK;
+}
+
+/** Submit batched commands to the server.
+ *
+ * @param ipcgc IPC GC
+ * @param update @c true to also update the display after executing
+ *               the commands
+ * @return EOK on success or error code of the first failed command
+ *         (including deferred errors)
+ */
+static errno_t ipc_gc_batch_submit(ipc_gc_t *ipcgc, bool update)
+{
+	async_exch_t *exch;
+	errno_t rc = EOK;
+
+	if (ipcgc->batch_cnt > 0 || update) {
+		exch = async_exchange_begin(ipcgc->sess);
+		rc = async_req_2_0(exch, GC_BATCH_SUBMIT, ipcgc->batch_cnt,
+		    update ? 1 : 0);
+		async_exchange_end(exch);
+
+		ipcgc->batch_cnt = 0;
+	}
+
+	/* Report deferred error, if any */
+	if (rc == EOK)
+		rc = ipcgc->batch_rc;
+	ipcgc->batch_rc = EOK;
+	return rc;
+}
+
+/** Submit batched commands before a synchronous operation.
+ *
+ * Any error is deferred until the next submission.
+ *
+ * @param ipcgc IPC GC
+ */
+static void ipc_gc_batch_flush(ipc_gc_t *ipcgc)
+{
+	if (ipcgc->batch != NULL)
+		ipcgc->batch_rc = ipc_gc_batch_submit(ipcgc, false);
+}
+
+/** Allocate new command in batch buffer.
+ *
+ * If the batch buffer is full, it is submitted first. A slot for the
+ * command is always returned, even if submitting pending commands failed.
+ *
+ * @param ipcgc IPC GC
+ * @param type Command type
+ * @param rcmd Place to store pointer to the command
+ * @return EOK on success or error code of a previously batched command
+ */
+static errno_t ipc_gc_batch_cmd(ipc_gc_t *ipcgc, gc_batch_cmd_type_t type,
+    gc_batch_cmd_t **rcmd)
+{
+	gc_batch_cmd_t *cmd;
+	errno_t rc = EOK;
+
+	if (ipcgc->batch_cnt >= ipcgc->batch_max)
+		rc = ipc_gc_batch_submit(ipcgc, false);
+
+	cmd = &ipcgc->batch[ipcgc->batch_cnt++];
+	cmd->type = type;
+	*rcmd = cmd;
+	return rc;
+}
+
 /** @}
  */
@@ -114,6 +114,124 @@ static void gc_update_srv(ipc_gc_srv_t *srvgc, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+static void gc_batch_setup_srv(ipc_gc_srv_t *srvgc, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	size_t size;
+	unsigned int flags;
+	void *batch;
+	errno_t rc;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	/* Check size */
+	if (size != PAGES2SIZE(SIZE2PAGES(GC_BATCH_SIZE))) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	rc = async_share_out_finalize(&call, &batch);
+	if (rc != EOK || batch == AS_MAP_FAILED) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	/* Replace previous batch buffer, if any */
+	if (srvgc->batch != NULL)
+		as_area_destroy(srvgc->batch);
+
+	srvgc->batch = (gc_batch_cmd_t *) batch;
+	srvgc->batch_max = GC_BATCH_SIZE / sizeof(gc_batch_cmd_t);
+	async_answer_0(icall, EOK);
+}
+
+/** Execute one batched command.
+ *
+ * @param srvgc IPC GC server
+ * @param bcmd Batched command (in memory shared with the client)
+ * @return EOK on success or an error code
+ */
+static errno_t gc_batch_cmd_exec(ipc_gc_srv_t *srvgc, gc_batch_cmd_t *bcmd)
+{
+	gc_batch_cmd_t cmd;
+	gfx_color_t *color;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	/*
+	 * Make a private copy first. The client could be changing
+	 * the shared memory under our hands.
+	 */
+	cmd = *bcmd;
+
+	rect.p0.x = cmd.arg[0];
+	rect.p0.y = cmd.arg[1];
+	rect.p1.x = cmd.arg[2];
+	rect.p1.y = cmd.arg[3];
+
+	switch (cmd.type) {
+	case gc_bcmd_set_clip_rect:
+		return gfx_set_clip_rect(srvgc->gc, &rect);
+	case gc_bcmd_set_clip_rect_null:
+		return gfx_set_clip_rect(srvgc->gc, NULL);
+	case gc_bcmd_set_rgb_color:
+		rc = gfx_color_new_rgb_i16((uint16_t) cmd.arg[0],
+		    (uint16_t) cmd.arg[1], (uint16_t) cmd.arg[2], &color);
+		if (rc != EOK)
+			return ENOMEM;
+
+		rc = gfx_set_color(srvgc->gc, color);
+		gfx_color_delete(color);
+		return rc;
+	case gc_bcmd_fill_rect:
+		return gfx_fill_rect(srvgc->gc, &rect);
+	}
+
+	return EINVAL;
+}
+
+static void gc_batch_submit_srv(ipc_gc_srv_t *srvgc, ipc_call_t *call)
+{
+	size_t cnt;
+	bool update;
+	size_t i;
+	errno_t rc;
+	errno_t rc1;
+
+	cnt = ipc_get_arg1(call);
+	update = ipc_get_arg2(call) != 0;
+
+	/* Note that batch_max is zero if there is no batch buffer */
+	if (cnt > srvgc->batch_max) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	/*
+	 * Execute all commands, just like if they were sent one by one.
+	 * Report the first error.
+	 */
+	rc = EOK;
+	for (i = 0; i < cnt; i++) {
+		rc1 = gc_batch_cmd_exec(srvgc, &srvgc->batch[i]);
+		if (rc1 != EOK && rc == EOK)
+			rc = rc1;
+	}
+
+	if (update) {
+		rc1 = gfx_update(srvgc->gc);
+		if (rc1 != EOK && rc == EOK)
+			rc = rc1;
+	}
+
+	async_answer_0(call, rc);
+}
+
 static void gc_bitmap_create_srv(ipc_gc_srv_t *srvgc, ipc_call_t *icall)
 {
 	gfx_bitmap_params_t params;
@@ -371,6 +489,8 @@ errno_t gc_conn(ipc_call_t *icall, gfx_context_t *gc)
 	srvgc.gc = gc;
 	list_initialize(&srvgc.bitmaps);
 	srvgc.next_bmp_id = 1;
+	srvgc.batch = NULL;
+	srvgc.batch_max = 0;
 
 	while (true) {
 		ipc_call_t call;
@@ -411,6 +531,12 @@ errno_t gc_conn(ipc_call_t *icall, gfx_context_t *gc)
 		case GC_BITMAP_RENDER:
 			gc_bitmap_render_srv(&srvgc, &call);
 			break;
+		case GC_BATCH_SETUP:
+			gc_batch_setup_srv(&srvgc, &call);
+			break;
+		case GC_BATCH_SUBMIT:
+			gc_batch_submit_srv(&srvgc, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
@@ -437,6 +563,9 @@ errno_t gc_conn(ipc_call_t *icall, gfx_context_t *gc)
 		link = list_first(&srvgc.bitmaps);
 	}
 
+	if (srvgc.batch != NULL)
+		as_area_destroy(srvgc.batch);
+
 	return EOK;
 }
 
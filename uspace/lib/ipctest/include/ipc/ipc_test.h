@@ -45,7 +45,8 @@ typedef enum {
 	IPC_TEST_SHARE_IN_RW,
 	IPC_TEST_SET_RW_BUF_SIZE,
 	IPC_TEST_READ,
-	IPC_TEST_WRITE
+	IPC_TEST_WRITE,
+	IPC_TEST_RING_SETUP
 } ipc_test_request_t;
 
 #endif
@@ -36,10 +36,12 @@
 #define _LIBIPCTEST_H_
 
 #include <async.h>
+#include <async_ring.h>
 #include <errno.h>
 
 typedef struct {
 	async_sess_t *sess;
+	async_ring_t *ring;
 } ipc_test_t;
 
 extern errno_t ipc_test_create(ipc_test_t **);
@@ -52,6 +54,9 @@ extern errno_t ipc_test_share_in_rw(ipc_test_t *, size_t, void **);
 extern errno_t ipc_test_set_rw_buf_size(ipc_test_t *, size_t);
 extern errno_t ipc_test_read(ipc_test_t *, void *, size_t);
 extern errno_t ipc_test_write(ipc_test_t *, const void *, size_t);
+extern errno_t ipc_test_ring_setup(ipc_test_t *, size_t, size_t);
+extern errno_t ipc_test_ring_read(ipc_test_t *, void *, size_t);
+extern errno_t ipc_test_ring_write(ipc_test_t *, const void *, size_t);
 
 #endif
 
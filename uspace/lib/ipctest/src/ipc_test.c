@@ -38,6 +38,7 @@
 #include <ipc/services.h>
 #include <ipc/ipc_test.h>
 #include <loc.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <ipc_test.h>
 
@@ -87,6 +88,9 @@ void ipc_test_destroy(ipc_test_t *test)
 	if (test == NULL)
 		return;
 
+	if (test->ring != NULL)
+		async_ring_destroy(test->ring);
+
 	async_hangup(test->sess);
 	free(test);
 }
@@ -299,5 +303,85 @@ errno_t ipc_test_write(ipc_test_t *test, const void *data, size_t size)
 	return EOK;
 }
 
+/** Set up a request ring for the IPC test session.
+ *
+ * @param test      IPC test service
+ * @param nslots    Number of ring slots
+ * @param slot_size Size of the payload buffer of each slot
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_ring_setup(ipc_test_t *test, size_t nslots, size_t slot_size)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	if (test->ring != NULL)
+		return EBUSY;
+
+	exch = async_exchange_begin(test->sess);
+	rc = async_ring_create(exch, IPC_TEST_RING_SETUP, nslots, slot_size,
+	    &test->ring);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+/** Test ring read.
+ *
+ * @param test IPC test service with a ring set up
+ * @param dest Destination buffer
+ * @param size Number of bytes to read / size of destination buffer
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_ring_read(ipc_test_t *test, void *dest, size_t size)
+{
+	sysarg_t args[ASYNC_RING_ARGS] = { IPC_TEST_READ };
+	size_t rsize;
+	size_t slot;
+	void *buf;
+	errno_t rc;
+
+	if (size > async_ring_slot_size(test->ring))
+		return EINVAL;
+
+	buf = async_ring_slot_get(test->ring, &slot);
+	rsize = size;
+	rc = async_ring_call(test->ring, slot, args, &rsize);
+
+	/* Do not trust the server to stay within the destination buffer */
+	if (rc == EOK && rsize > size)
+		rc = EIO;
+	if (rc == EOK)
+		memcpy(dest, buf, rsize);
+
+	async_ring_slot_put(test->ring, slot);
+	return rc;
+}
+
+/** Test ring write.
+ *
+ * @param test IPC test service with a ring set up
+ * @param data Source buffer
+ * @param size Number of bytes to write
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_ring_write(ipc_test_t *test, const void *data, size_t size)
+{
+	sysarg_t args[ASYNC_RING_ARGS] = { IPC_TEST_WRITE };
+	size_t slot;
+	void *buf;
+	errno_t rc;
+
+	if (size > async_ring_slot_size(test->ring))
+		return EINVAL;
+
+	buf = async_ring_slot_get(test->ring, &slot);
+	memcpy(buf, data, size);
+	rc = async_ring_call(test->ring, slot, args, &size);
+
+	async_ring_slot_put(test->ring, slot);
+	return rc;
+}
+
 /** @}
  */
@@ -68,6 +68,8 @@ typedef struct {
 	link_t link;
 	void *data;
 	size_t size;
+	/** Data belongs to the driver and is not freed with the frame */
+	bool loaned;
 } nic_frame_t;
 
 typedef list_t nic_frame_list_t;
@@ -84,6 +86,18 @@ typedef list_t nic_frame_list_t;
  */
 typedef void (*send_frame_handler)(nic_t *, void *, size_t);
 
+/**
+ * Handler for transmitting a frame with checksum and/or segmentation
+ * offload. Same rules as for send_frame_handler apply.
+ *
+ * @param nic_data
+ * @param data		Pointer to frame data
+ * @param size		Size of frame data in bytes
+ * @param offload	Requested transmit offload
+ */
+typedef void (*send_frame_offload_handler)(nic_t *, void *, size_t,
+    const nic_tx_offload_t *);
+
 /**
  * The handler for transitions between driver states.
  * If the handler returns error code, the transition between
@@ -218,6 +232,8 @@ extern void nic_driver_implement(driver_ops_t *, ddf_dev_ops_t *,
 extern errno_t nic_get_resources(nic_t *, hw_res_list_parsed_t *);
 extern void nic_set_specific(nic_t *, void *);
 extern void nic_set_send_frame_handler(nic_t *, send_frame_handler);
+extern void nic_set_send_frame_offload_handler(nic_t *,
+    send_frame_offload_handler);
 extern void nic_set_state_change_handlers(nic_t *,
     state_change_handler, state_change_handler, state_change_handler);
 extern void nic_set_filtering_change_handlers(nic_t *,
@@ -254,6 +270,7 @@ extern void nic_report_collisions(nic_t *, unsigned);
 
 /* Frame / frame list allocation and deallocation */
 extern nic_frame_t *nic_alloc_frame(nic_t *, size_t);
+extern nic_frame_t *nic_alloc_loaned_frame(nic_t *, void *, size_t);
 extern nic_frame_list_t *nic_alloc_frame_list(void);
 extern void nic_frame_list_append(nic_frame_list_t *, nic_frame_t *);
 extern void nic_release_frame(nic_t *, nic_frame_t *);
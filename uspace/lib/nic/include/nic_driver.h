@@ -126,6 +126,12 @@ struct nic {
 	 * Called with the main_lock locked for reading.
 	 */
 	send_frame_handler send_frame;
+	/**
+	 * Function sending the data with transmit offload. Optional, used
+	 * by the nic_send_frame_offload_impl function.
+	 * Called with the main_lock locked for reading.
+	 */
+	send_frame_offload_handler send_frame_offload;
 	/**
 	 * Event handler called when device goes to the ACTIVE state.
 	 * The implementation is optional.
@@ -101,6 +101,8 @@ void nic_driver_implement(driver_ops_t *driver_ops, ddf_dev_ops_t *dev_ops,
 			iface->set_state = nic_set_state_impl;
 		if (!iface->send_frame)
 			iface->send_frame = nic_send_frame_impl;
+		if (!iface->send_frame_offload)
+			iface->send_frame_offload = nic_send_frame_offload_impl;
 		if (!iface->callback_create)
 			iface->callback_create = nic_callback_create_impl;
 		if (!iface->get_address)
@@ -160,6 +162,21 @@ void nic_set_send_frame_handler(nic_t *nic_data, send_frame_handler sffunc)
 	nic_data->send_frame = sffunc;
 }
 
+/**
+ * Setup handler for sending frames with transmit offload. Optional; drivers
+ * calling this should also implement the offload_probe and offload_set
+ * methods so that clients know which offloads they may request. This
+ * function can be called only in the add_device handler.
+ *
+ * @param nic_data
+ * @param sffunc	Function handling the send_frame_offload request
+ */
+void nic_set_send_frame_offload_handler(nic_t *nic_data,
+    send_frame_offload_handler sffunc)
+{
+	nic_data->send_frame_offload = sffunc;
+}
+
 /**
  * Setup event handlers for transitions between driver states.
  * This function can be called only in the add_device handler.
@@ -255,13 +272,11 @@ errno_t nic_get_resources(nic_t *nic_data, hw_res_list_parsed_t *resources)
 	return hw_res_get_list_parsed(parent_sess, resources, 0);
 }
 
-/** Allocate frame
+/** Get frame structure from the cache or allocate a new one
  *
- *  @param nic_data 	The NIC driver data
- *  @param size	        Frame size in bytes
- *  @return pointer to allocated frame if success, NULL otherwise
+ *  @return pointer to frame structure if success, NULL otherwise
  */
-nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
+static nic_frame_t *nic_alloc_frame_struct(void)
 {
 	nic_frame_t *frame;
 	fibril_mutex_lock(&nic_globals.lock);
@@ -280,6 +295,21 @@ nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
 		link_initialize(&frame->link);
 	}
 
+	return frame;
+}
+
+/** Allocate frame
+ *
+ *  @param nic_data 	The NIC driver data
+ *  @param size	        Frame size in bytes
+ *  @return pointer to allocated frame if success, NULL otherwise
+ */
+nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
+{
+	nic_frame_t *frame = nic_alloc_frame_struct();
+	if (!frame)
+		return NULL;
+
 	frame->data = malloc(size);
 	if (frame->data == NULL) {
 		free(frame);
@@ -287,6 +317,31 @@ nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
 	}
 
 	frame->size = size;
+	frame->loaned = false;
+	return frame;
+}
+
+/** Allocate frame referring to a driver's receive buffer
+ *
+ * The frame data is not copied, the buffer is only loaned to the frame
+ * and is not freed when the frame is released. Frames are delivered
+ * synchronously, so the driver can reuse the buffer as soon as
+ * nic_received_frame() or nic_received_frame_list() returns.
+ *
+ *  @param nic_data 	The NIC driver data
+ *  @param data		Frame data in the driver's buffer
+ *  @param size	        Frame size in bytes
+ *  @return pointer to allocated frame if success, NULL otherwise
+ */
+nic_frame_t *nic_alloc_loaned_frame(nic_t *nic_data, void *data, size_t size)
+{
+	nic_frame_t *frame = nic_alloc_frame_struct();
+	if (!frame)
+		return NULL;
+
+	frame->data = data;
+	frame->size = size;
+	frame->loaned = true;
 	return frame;
 }
 
@@ -301,7 +356,8 @@ void nic_release_frame(nic_t *nic_data, nic_frame_t *frame)
 		return;
 
 	if (frame->data != NULL) {
-		free(frame->data);
+		if (!frame->loaned)
+			free(frame->data);
 		frame->data = NULL;
 		frame->size = 0;
 	}
@@ -612,6 +668,7 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	nic_data->poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->default_poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->send_frame = NULL;
+	nic_data->send_frame_offload = NULL;
 	nic_data->on_activating = NULL;
 	nic_data->on_going_down = NULL;
 	nic_data->on_stopping = NULL;
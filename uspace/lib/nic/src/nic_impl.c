@@ -184,6 +184,39 @@ errno_t nic_send_frame_impl(ddf_fun_t *fun, void *data, size_t size)
 	return EOK;
 }
 
+/**
+ * Default implementation of the send_frame_offload method.
+ * Send messages to the network, letting the device complete the checksum
+ * and/or segment the frame.
+ *
+ * @param	fun
+ * @param	data	Frame data
+ * @param 	size	Frame size in bytes
+ * @param	offload	Requested transmit offload
+ *
+ * @return EOK		If the message was sent
+ * @return EBUSY	If the device is not in state when the frame can be sent.
+ * @return ENOTSUP	If the driver does not support transmit offload
+ */
+errno_t nic_send_frame_offload_impl(ddf_fun_t *fun, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+
+	if (nic_data->send_frame_offload == NULL)
+		return ENOTSUP;
+
+	fibril_rwlock_read_lock(&nic_data->main_lock);
+	if (nic_data->state != NIC_STATE_ACTIVE || nic_data->tx_busy) {
+		fibril_rwlock_read_unlock(&nic_data->main_lock);
+		return EBUSY;
+	}
+
+	nic_data->send_frame_offload(nic_data, data, size, offload);
+	fibril_rwlock_read_unlock(&nic_data->main_lock);
+	return EOK;
+}
+
 /**
  * Default implementation of the connect_client method.
  * Creates callback connection to the client.
@@ -172,16 +172,59 @@ void virtio_free_desc(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
 
 void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
+{
+	virtio_virtq_produce_available_batch(vdev, num, &descno, 1);
+}
+
+/** Put several descriptors into the available ring at once
+ *
+ * The available index is published and the device notified only once for
+ * the whole batch. The notification is skipped altogether if the device
+ * asked not to be notified.
+ *
+ * @param vdev[in]    VIRTIO device
+ * @param num[in]     Index of the virtqueue
+ * @param descno[in]  Array of descriptor heads to make available
+ * @param count[in]   Number of descriptors in @a descno
+ */
+void virtio_virtq_produce_available_batch(virtio_dev_t *vdev, uint16_t num,
+    const uint16_t *descno, unsigned count)
 {
 	virtq_t *q = &vdev->queues[num];
 
+	if (count == 0)
+		return;
+
 	fibril_mutex_lock(&q->lock);
 	uint16_t idx = pio_read_le16(&q->avail->idx);
-	pio_write_le16(&q->avail->ring[idx % q->queue_size], descno);
-	write_barrier();
-	pio_write_le16(&q->avail->idx, idx + 1);
+	for (unsigned i = 0; i < count; i++) {
+		pio_write_le16(&q->avail->ring[(uint16_t) (idx + i) %
+		    q->queue_size], descno[i]);
+	}
 	write_barrier();
-	pio_write_le16(q->notify, num);
+	pio_write_le16(&q->avail->idx, idx + count);
+	memory_barrier();
+	if (!(pio_read_le16(&q->used->flags) & VIRTQ_USED_F_NO_NOTIFY))
+		pio_write_le16(q->notify, num);
+	fibril_mutex_unlock(&q->lock);
+}
+
+/** Enable or disable interrupts for used buffers of a virtqueue
+ *
+ * This is only a hint for the device, the driver must still cope with
+ * interrupts arriving for the virtqueue.
+ *
+ * @param vdev[in]    VIRTIO device
+ * @param num[in]     Index of the virtqueue
+ * @param enable[in]  True to request interrupts, false to suppress them
+ */
+void virtio_virtq_set_interrupt(virtio_dev_t *vdev, uint16_t num, bool enable)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	fibril_mutex_lock(&q->lock);
+	pio_write_le16(&q->avail->flags,
+	    enable ? 0 : VIRTQ_AVAIL_F_NO_INTERRUPT);
 	fibril_mutex_unlock(&q->lock);
 }
 
@@ -191,12 +234,17 @@ bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
 	virtq_t *q = &vdev->queues[num];
 
 	fibril_mutex_lock(&q->lock);
-	uint16_t last_idx = q->used_last_idx % q->queue_size;
-	if (last_idx == (pio_read_le16(&q->used->idx) % q->queue_size)) {
+	/*
+	 * Compare the free-running indices, a full ring would look empty
+	 * modulo the queue size.
+	 */
+	if (q->used_last_idx == pio_read_le16(&q->used->idx)) {
 		fibril_mutex_unlock(&q->lock);
 		return false;
 	}
 
+	uint16_t last_idx = q->used_last_idx % q->queue_size;
+
 	*descno = (uint16_t) pio_read_le32(&q->used->ring[last_idx].id);
 	*len = pio_read_le32(&q->used->ring[last_idx].len);
 
@@ -299,8 +347,16 @@ void virtio_virtq_teardown(virtio_dev_t *vdev, uint16_t num)
 /**
  * Perform device initialization as described in section 3.1.1 of the
  * specification, steps 1 - 6.
+ *
+ * @param vdev[in]      VIRTIO device
+ * @param features[in]  Device-specific features the driver requires
+ * @param optional[in]  Device-specific features the driver can use if the
+ *                      device offers them
+ *
+ * The negotiated features are stored in @c vdev->features.
  */
-errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
+errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features,
+    uint32_t optional)
 {
 	virtio_pci_common_cfg_t *cfg = vdev->common_cfg;
 
@@ -329,6 +385,7 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 
 	if (features != (features & device_features))
 		return ENOTSUP;
+	features |= optional;
 	features &= device_features;
 
 	if (reserved_features != (reserved_features & device_reserved_features))
@@ -353,6 +410,7 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 	if (!(status & VIRTIO_DEV_STATUS_FEATURES_OK))
 		return ENOTSUP;
 
+	vdev->features = features;
 	return EOK;
 }
 
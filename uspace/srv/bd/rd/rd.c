@@ -177,6 +177,7 @@ static bool rd_init(void)
 
 	bd_srvs_init(&bd_srvs);
 	bd_srvs.ops = &rd_bd_ops;
+	bd_srvs.thread_safe = true;
 
 	async_set_fallback_port_handler(rd_client_conn, NULL);
 	ret = loc_server_register(NAME, &srv);
@@ -44,7 +44,184 @@
 #include <align.h>
 #include <assert.h>
 #include <fibril_synch.h>
+#include <macros.h>
 #include <mem.h>
+#include <stdlib.h>
+#include <adt/bitmap.h>
+#include <adt/list.h>
+
+/** Number of clusters described by one block of the Bitmap Table. */
+#define BMAP_BPB(bs)	(BPS(bs) * 8)
+
+/**
+ * In-memory summary of the Bitmap Table of one file system instance.
+ *
+ * The summary keeps the number of free clusters described by each block of
+ * the bitmap so that allocation can skip full blocks without reading them.
+ * It is built when the file system is mounted and kept up to date by every
+ * change made to the bitmap.
+ */
+typedef struct {
+	link_t link;
+	service_id_t service_id;
+
+	/** Number of bitmap blocks. */
+	size_t blocks;
+	/** Number of free clusters described by each bitmap block. */
+	uint16_t *free;
+	/** Total number of free clusters. */
+	uint32_t nfree;
+} exfat_bitmap_summary_t;
+
+/** Mutex protecting the summaries and serializing bitmap changes. */
+static FIBRIL_MUTEX_INITIALIZE(summary_lock);
+
+/** List of summaries of mounted instances. */
+static LIST_INITIALIZE(summary_list);
+
+/** Find the bitmap summary of a file system instance.
+ *
+ * Must be called with summary_lock held.
+ *
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		Summary or NULL if there is none.
+ */
+static exfat_bitmap_summary_t *exfat_bitmap_summary_find(service_id_t service_id)
+{
+	assert(fibril_mutex_is_locked(&summary_lock));
+
+	list_foreach(summary_list, link, exfat_bitmap_summary_t, sum) {
+		if (sum->service_id == service_id)
+			return sum;
+	}
+
+	return NULL;
+}
+
+/** Get the number of valid bits in a block of the Bitmap Table.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param blk		Bitmap block number.
+ *
+ * @return		Number of clusters described by the block.
+ */
+static size_t exfat_bitmap_block_bits(exfat_bs_t *bs, aoff64_t blk)
+{
+	return min(BMAP_BPB(bs), DATA_CNT(bs) - blk * BMAP_BPB(bs));
+}
+
+/** Build the bitmap summary of a file system instance.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t exfat_bitmap_summary_init(exfat_bs_t *bs, service_id_t service_id)
+{
+	exfat_bitmap_summary_t *sum;
+	fs_node_t *fn;
+	block_t *b;
+	bitmap_t bmap;
+	aoff64_t blk;
+	size_t nbits;
+	errno_t rc;
+
+	sum = calloc(1, sizeof(exfat_bitmap_summary_t));
+	if (sum == NULL)
+		return ENOMEM;
+
+	link_initialize(&sum->link);
+	sum->service_id = service_id;
+	sum->blocks = ROUND_UP(DATA_CNT(bs), BMAP_BPB(bs)) / BMAP_BPB(bs);
+	sum->free = calloc(sum->blocks, sizeof(uint16_t));
+	if (sum->free == NULL) {
+		free(sum);
+		return ENOMEM;
+	}
+
+	rc = exfat_bitmap_get(&fn, service_id);
+	if (rc != EOK)
+		goto error;
+
+	for (blk = 0; blk < sum->blocks; blk++) {
+		rc = exfat_block_get(&b, bs, EXFAT_NODE(fn), blk,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			goto error;
+		}
+
+		nbits = exfat_bitmap_block_bits(bs, blk);
+		bitmap_initialize(&bmap, nbits, b->data);
+		sum->free[blk] = bitmap_count_zeroes(&bmap, 0, nbits);
+		sum->nfree += sum->free[blk];
+
+		rc = block_put(b);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			goto error;
+		}
+	}
+
+	rc = exfat_node_put(fn);
+	if (rc != EOK)
+		goto error;
+
+	fibril_mutex_lock(&summary_lock);
+	list_append(&sum->link, &summary_list);
+	fibril_mutex_unlock(&summary_lock);
+
+	return EOK;
+error:
+	free(sum->free);
+	free(sum);
+	return rc;
+}
+
+/** Destroy the bitmap summary of a file system instance.
+ *
+ * @param service_id	Service ID of the file system.
+ */
+void exfat_bitmap_summary_fini(service_id_t service_id)
+{
+	exfat_bitmap_summary_t *sum;
+
+	fibril_mutex_lock(&summary_lock);
+	sum = exfat_bitmap_summary_find(service_id);
+	if (sum != NULL)
+		list_remove(&sum->link);
+	fibril_mutex_unlock(&summary_lock);
+
+	if (sum != NULL) {
+		free(sum->free);
+		free(sum);
+	}
+}
+
+/** Get the number of free clusters from the bitmap summary.
+ *
+ * @param service_id	Service ID of the file system.
+ * @param count		Place to store the number of free clusters.
+ *
+ * @return		EOK on success, ENOENT if the instance has no summary.
+ */
+errno_t exfat_bitmap_free_count(service_id_t service_id, uint64_t *count)
+{
+	exfat_bitmap_summary_t *sum;
+	errno_t rc = ENOENT;
+
+	fibril_mutex_lock(&summary_lock);
+	sum = exfat_bitmap_summary_find(service_id);
+	if (sum != NULL) {
+		*count = sum->nfree;
+		rc = EOK;
+	}
+	fibril_mutex_unlock(&summary_lock);
+
+	return rc;
+}
 
 errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t clst)
@@ -87,153 +264,413 @@ errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
 	return EOK;
 }
 
-errno_t exfat_bitmap_set_cluster(exfat_bs_t *bs, service_id_t service_id,
-    exfat_cluster_t clst)
+/** Set or clear a range of bits in the Bitmap Table.
+ *
+ * The bitmap summary is updated accordingly. Must be called with
+ * summary_lock held.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param firstc	First cluster of the range.
+ * @param count		Number of clusters in the range.
+ * @param set		True to mark the clusters used, false to mark
+ *			them free.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t exfat_bitmap_mark(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t firstc, exfat_cluster_t count, bool set)
 {
+	exfat_bitmap_summary_t *sum;
 	fs_node_t *fn;
-	block_t *b = NULL;
-	exfat_node_t *bitmapp;
-	uint8_t *bitmap;
+	block_t *b;
+	bitmap_t bmap;
+	uint32_t clst = firstc - EXFAT_CLST_FIRST;
+	uint32_t end = clst + count;
+	aoff64_t blk;
+	size_t first, n, zeroes;
 	errno_t rc;
 
-	clst -= EXFAT_CLST_FIRST;
+	assert(fibril_mutex_is_locked(&summary_lock));
+	assert(firstc >= EXFAT_CLST_FIRST && end <= DATA_CNT(bs));
+
+	sum = exfat_bitmap_summary_find(service_id);
 
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
-	bitmapp = EXFAT_NODE(fn);
 
-	aoff64_t offset = clst / 8;
-	rc = exfat_block_get(&b, bs, bitmapp, offset / BPS(bs), BLOCK_FLAGS_NONE);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
-	}
-	bitmap = (uint8_t *)b->data;
-	bitmap[offset % BPS(bs)] |= (1 << (clst % 8));
+	while (clst < end) {
+		blk = clst / BMAP_BPB(bs);
+		first = clst % BMAP_BPB(bs);
+		n = min(end - clst, BMAP_BPB(bs) - first);
 
-	b->dirty = true;
-	rc = block_put(b);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
+		rc = exfat_block_get(&b, bs, EXFAT_NODE(fn), blk,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			return rc;
+		}
+
+		bitmap_initialize(&bmap, exfat_bitmap_block_bits(bs, blk),
+		    b->data);
+		zeroes = bitmap_count_zeroes(&bmap, first, n);
+
+		if (set) {
+			bitmap_set_range(&bmap, first, n);
+			if (sum != NULL) {
+				sum->free[blk] -= zeroes;
+				sum->nfree -= zeroes;
+			}
+		} else {
+			bitmap_clear_range(&bmap, first, n);
+			if (sum != NULL) {
+				sum->free[blk] += n - zeroes;
+				sum->nfree += n - zeroes;
+			}
+		}
+
+		b->dirty = true;
+		rc = block_put(b);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			return rc;
+		}
+
+		clst += n;
 	}
 
 	return exfat_node_put(fn);
 }
 
-errno_t exfat_bitmap_clear_cluster(exfat_bs_t *bs, service_id_t service_id,
-    exfat_cluster_t clst)
+/** Check that a range of clusters is free.
+ *
+ * Must be called with summary_lock held.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param firstc	First cluster of the range.
+ * @param count		Number of clusters in the range.
+ *
+ * @return		EOK if all clusters are free, ENOSPC if some are
+ *			not or the range exceeds the volume, or another
+ *			error code.
+ */
+static errno_t exfat_bitmap_check_free(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t firstc, exfat_cluster_t count)
 {
+	exfat_bitmap_summary_t *sum;
 	fs_node_t *fn;
-	block_t *b = NULL;
-	exfat_node_t *bitmapp;
-	uint8_t *bitmap;
+	block_t *b;
+	bitmap_t bmap;
+	uint32_t clst = firstc - EXFAT_CLST_FIRST;
+	uint32_t end = clst + count;
+	aoff64_t blk;
+	size_t first, n, nbits, one;
 	errno_t rc;
 
-	clst -= EXFAT_CLST_FIRST;
+	assert(fibril_mutex_is_locked(&summary_lock));
+
+	if (firstc < EXFAT_CLST_FIRST || end < clst || end > DATA_CNT(bs))
+		return ENOSPC;
+
+	sum = exfat_bitmap_summary_find(service_id);
 
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
-	bitmapp = EXFAT_NODE(fn);
 
-	aoff64_t offset = clst / 8;
-	rc = exfat_block_get(&b, bs, bitmapp, offset / BPS(bs),
-	    BLOCK_FLAGS_NONE);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
-	}
-	bitmap = (uint8_t *)b->data;
-	bitmap[offset % BPS(bs)] &= ~(1 << (clst % 8));
+	while (clst < end) {
+		blk = clst / BMAP_BPB(bs);
+		first = clst % BMAP_BPB(bs);
+		nbits = exfat_bitmap_block_bits(bs, blk);
+		n = min(end - clst, nbits - first);
 
-	b->dirty = true;
-	rc = block_put(b);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
+		if (sum != NULL && sum->free[blk] < n) {
+			(void) exfat_node_put(fn);
+			return ENOSPC;
+		}
+
+		if (sum == NULL || sum->free[blk] < nbits) {
+			rc = exfat_block_get(&b, bs, EXFAT_NODE(fn), blk,
+			    BLOCK_FLAGS_NONE);
+			if (rc != EOK) {
+				(void) exfat_node_put(fn);
+				return rc;
+			}
+
+			bitmap_initialize(&bmap, nbits, b->data);
+			one = bitmap_find_one(&bmap, first, first + n);
+
+			rc = block_put(b);
+			if (rc != EOK) {
+				(void) exfat_node_put(fn);
+				return rc;
+			}
+
+			if (one != first + n) {
+				(void) exfat_node_put(fn);
+				return ENOSPC;
+			}
+		}
+
+		clst += n;
 	}
 
 	return exfat_node_put(fn);
 }
 
-errno_t exfat_bitmap_set_clusters(exfat_bs_t *bs, service_id_t service_id,
-    exfat_cluster_t firstc, exfat_cluster_t count)
+/** Find a free cluster.
+ *
+ * Blocks of the Bitmap Table which the summary reports as full are
+ * skipped without being read.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param startc	Cluster to start searching from.
+ * @param clst		Place to store the free cluster.
+ *
+ * @return		EOK on success, ENOSPC if there is no free cluster
+ *			at or after startc, or another error code.
+ */
+errno_t exfat_bitmap_find_free(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t startc, exfat_cluster_t *clst)
 {
+	exfat_bitmap_summary_t *sum;
+	fs_node_t *fn;
+	block_t *b;
+	bitmap_t bmap;
+	uint32_t c = startc - EXFAT_CLST_FIRST;
+	aoff64_t blk;
+	size_t nbits, zero;
 	errno_t rc;
-	exfat_cluster_t clst;
-	clst = firstc;
 
-	while (clst < firstc + count) {
-		rc = exfat_bitmap_set_cluster(bs, service_id, clst);
+	assert(startc >= EXFAT_CLST_FIRST);
+
+	fibril_mutex_lock(&summary_lock);
+	sum = exfat_bitmap_summary_find(service_id);
+
+	rc = exfat_bitmap_get(&fn, service_id);
+	if (rc != EOK)
+		goto out;
+
+	while (c < DATA_CNT(bs)) {
+		blk = c / BMAP_BPB(bs);
+		nbits = exfat_bitmap_block_bits(bs, blk);
+
+		if (sum != NULL && sum->free[blk] == 0) {
+			c = (blk + 1) * BMAP_BPB(bs);
+			continue;
+		}
+
+		rc = exfat_block_get(&b, bs, EXFAT_NODE(fn), blk,
+		    BLOCK_FLAGS_NONE);
 		if (rc != EOK) {
-			if (clst - firstc > 0)
-				(void) exfat_bitmap_clear_clusters(bs, service_id,
-				    firstc, clst - firstc);
-			return rc;
+			(void) exfat_node_put(fn);
+			goto out;
 		}
-		clst++;
+
+		bitmap_initialize(&bmap, nbits, b->data);
+		zero = bitmap_find_zero(&bmap, c % BMAP_BPB(bs), nbits);
+
+		rc = block_put(b);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			goto out;
+		}
+
+		if (zero != nbits) {
+			*clst = blk * BMAP_BPB(bs) + zero + EXFAT_CLST_FIRST;
+			rc = exfat_node_put(fn);
+			goto out;
+		}
+
+		c = (blk + 1) * BMAP_BPB(bs);
 	}
-	return EOK;
+
+	(void) exfat_node_put(fn);
+	rc = ENOSPC;
+out:
+	fibril_mutex_unlock(&summary_lock);
+	return rc;
+}
+
+errno_t exfat_bitmap_set_cluster(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t clst)
+{
+	return exfat_bitmap_set_clusters(bs, service_id, clst, 1);
+}
+
+errno_t exfat_bitmap_clear_cluster(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t clst)
+{
+	return exfat_bitmap_clear_clusters(bs, service_id, clst, 1);
+}
+
+errno_t exfat_bitmap_set_clusters(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t firstc, exfat_cluster_t count)
+{
+	errno_t rc;
+
+	fibril_mutex_lock(&summary_lock);
+	rc = exfat_bitmap_mark(bs, service_id, firstc, count, true);
+	if (rc != EOK)
+		(void) exfat_bitmap_mark(bs, service_id, firstc, count, false);
+	fibril_mutex_unlock(&summary_lock);
+
+	return rc;
 }
 
 errno_t exfat_bitmap_clear_clusters(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t firstc, exfat_cluster_t count)
 {
 	errno_t rc;
-	exfat_cluster_t clst;
-	clst = firstc;
 
-	while (clst < firstc + count) {
-		rc = exfat_bitmap_clear_cluster(bs, service_id, clst);
-		if (rc != EOK)
-			return rc;
-		clst++;
-	}
-	return EOK;
+	fibril_mutex_lock(&summary_lock);
+	rc = exfat_bitmap_mark(bs, service_id, firstc, count, false);
+	fibril_mutex_unlock(&summary_lock);
+
+	return rc;
 }
 
+/** Allocate a contiguous range of clusters.
+ *
+ * The first fitting range of free clusters is used. Blocks of the Bitmap
+ * Table which the summary reports as full or empty are not read.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param firstc	Place to store the first allocated cluster.
+ * @param count		Number of clusters to allocate.
+ *
+ * @return		EOK on success or an error code.
+ */
 errno_t exfat_bitmap_alloc_clusters(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t *firstc, exfat_cluster_t count)
 {
-	exfat_cluster_t startc, endc;
-	startc = EXFAT_CLST_FIRST;
-
-	while (startc < DATA_CNT(bs) + 2) {
-		endc = startc;
-		while (exfat_bitmap_is_free(bs, service_id, endc) == EOK) {
-			if ((endc - startc) + 1 == count) {
-				*firstc = startc;
-				return exfat_bitmap_set_clusters(bs, service_id, startc, count);
-			} else
-				endc++;
+	exfat_bitmap_summary_t *sum;
+	fs_node_t *fn;
+	block_t *b;
+	bitmap_t bmap;
+	aoff64_t blk, blocks;
+	uint32_t run_start = 0;
+	uint32_t run_len = 0;
+	size_t nbits, pos, one;
+	errno_t rc;
+
+	if (count == 0)
+		return EINVAL;
+
+	fibril_mutex_lock(&summary_lock);
+	sum = exfat_bitmap_summary_find(service_id);
+
+	rc = exfat_bitmap_get(&fn, service_id);
+	if (rc != EOK)
+		goto out;
+
+	blocks = ROUND_UP(DATA_CNT(bs), BMAP_BPB(bs)) / BMAP_BPB(bs);
+	for (blk = 0; blk < blocks; blk++) {
+		nbits = exfat_bitmap_block_bits(bs, blk);
+
+		if (sum != NULL && sum->free[blk] == 0) {
+			run_len = 0;
+			continue;
+		}
+
+		if (sum != NULL && sum->free[blk] == nbits) {
+			if (run_len == 0)
+				run_start = blk * BMAP_BPB(bs);
+			run_len += nbits;
+			if (run_len >= count)
+				goto found;
+			continue;
 		}
-		startc = endc + 1;
+
+		rc = exfat_block_get(&b, bs, EXFAT_NODE(fn), blk,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			goto out;
+		}
+
+		bitmap_initialize(&bmap, nbits, b->data);
+
+		/*
+		 * A run carried over from the previous block continues
+		 * at the start of this one.
+		 */
+		pos = 0;
+		while (pos < nbits) {
+			if (run_len == 0) {
+				pos = bitmap_find_zero(&bmap, pos, nbits);
+				if (pos == nbits)
+					break;
+				run_start = blk * BMAP_BPB(bs) + pos;
+			}
+
+			one = bitmap_find_one(&bmap, pos, nbits);
+			run_len += one - pos;
+			if (run_len >= count || one == nbits)
+				break;
+
+			run_len = 0;
+			pos = one;
+		}
+
+		rc = block_put(b);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			goto out;
+		}
+
+		if (run_len >= count)
+			goto found;
 	}
-	return ENOSPC;
+
+	(void) exfat_node_put(fn);
+	rc = ENOSPC;
+	goto out;
+
+found:
+	rc = exfat_node_put(fn);
+	if (rc != EOK)
+		goto out;
+
+	rc = exfat_bitmap_mark(bs, service_id, run_start + EXFAT_CLST_FIRST,
+	    count, true);
+	if (rc != EOK) {
+		(void) exfat_bitmap_mark(bs, service_id,
+		    run_start + EXFAT_CLST_FIRST, count, false);
+		goto out;
+	}
+
+	*firstc = run_start + EXFAT_CLST_FIRST;
+out:
+	fibril_mutex_unlock(&summary_lock);
+	return rc;
 }
 
 errno_t exfat_bitmap_append_clusters(exfat_bs_t *bs, exfat_node_t *nodep,
     exfat_cluster_t count)
 {
+	service_id_t service_id = nodep->idx->service_id;
+	exfat_cluster_t lastc;
+	errno_t rc;
+
 	if (nodep->firstc == 0) {
-		return exfat_bitmap_alloc_clusters(bs, nodep->idx->service_id,
+		return exfat_bitmap_alloc_clusters(bs, service_id,
 		    &nodep->firstc, count);
-	} else {
-		exfat_cluster_t lastc, clst;
-		lastc = nodep->firstc + ROUND_UP(nodep->size, BPC(bs)) / BPC(bs) - 1;
-
-		clst = lastc + 1;
-		while (exfat_bitmap_is_free(bs, nodep->idx->service_id, clst) == EOK) {
-			if (clst - lastc == count) {
-				return exfat_bitmap_set_clusters(bs, nodep->idx->service_id,
-				    lastc + 1, count);
-			} else
-				clst++;
-		}
-		return ENOSPC;
 	}
+
+	lastc = nodep->firstc + ROUND_UP(nodep->size, BPC(bs)) / BPC(bs) - 1;
+
+	fibril_mutex_lock(&summary_lock);
+	rc = exfat_bitmap_check_free(bs, service_id, lastc + 1, count);
+	if (rc == EOK)
+		rc = exfat_bitmap_mark(bs, service_id, lastc + 1, count, true);
+	fibril_mutex_unlock(&summary_lock);
+
+	return rc;
 }
 
 errno_t exfat_bitmap_free_clusters(exfat_bs_t *bs, exfat_node_t *nodep,
@@ -41,6 +41,12 @@
 struct exfat_node;
 struct exfat_bs;
 
+extern errno_t exfat_bitmap_summary_init(struct exfat_bs *, service_id_t);
+extern void exfat_bitmap_summary_fini(service_id_t);
+extern errno_t exfat_bitmap_free_count(service_id_t, uint64_t *);
+extern errno_t exfat_bitmap_find_free(struct exfat_bs *, service_id_t,
+    exfat_cluster_t, exfat_cluster_t *);
+
 extern errno_t exfat_bitmap_alloc_clusters(struct exfat_bs *, service_id_t,
     exfat_cluster_t *, exfat_cluster_t);
 extern errno_t exfat_bitmap_append_clusters(struct exfat_bs *, struct exfat_node *,
@@ -940,6 +940,10 @@ errno_t exfat_free_block_count(service_id_t service_id, uint64_t *count)
 	unsigned sector;
 	errno_t rc;
 
+	/* Use the bitmap summary of mounted instances. */
+	if (exfat_bitmap_free_count(service_id, count) == EOK)
+		return EOK;
+
 	rc = exfat_total_block_count(service_id, &block_count);
 	if (rc != EOK)
 		goto exit;
@@ -1009,7 +1013,8 @@ libfs_ops_t exfat_libfs_ops = {
 	.service_get = exfat_service_get,
 	.size_block = exfat_size_block,
 	.total_block_count = exfat_total_block_count,
-	.free_block_count = exfat_free_block_count
+	.free_block_count = exfat_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 static errno_t exfat_fs_open(service_id_t service_id, enum cache_mode cmode,
@@ -1299,6 +1304,12 @@ exfat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	if (rc != EOK)
 		return rc;
 
+	rc = exfat_bitmap_summary_init(block_bb_get(service_id), service_id);
+	if (rc != EOK) {
+		exfat_fs_close(service_id, rfn);
+		return rc;
+	}
+
 	*index = ridxp->index;
 	*size = EXFAT_NODE(rfn)->size;
 
@@ -1314,6 +1325,7 @@ static errno_t exfat_unmounted(service_id_t service_id)
 	if (rc != EOK)
 		return rc;
 
+	exfat_bitmap_summary_fini(service_id);
 	exfat_fs_close(service_id, rfn);
 	return EOK;
 }
@@ -50,6 +50,7 @@
 
 vfs_info_t ext4fs_vfs_info = {
 	.name = NAME,
+	.lookup_cacheable = true,
 	.instance = 0
 };
 
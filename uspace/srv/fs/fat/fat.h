@@ -221,6 +221,16 @@ typedef struct {
 	struct fat_node	*nodep;
 } fat_idx_t;
 
+/** Run of consecutive clusters in a node's cluster chain. */
+typedef struct {
+	/** Index of the first cluster of the run within the node. */
+	uint32_t	lcl;
+	/** First cluster of the run. */
+	fat_cluster_t	pcl;
+	/** Number of clusters in the run. */
+	uint32_t	len;
+} fat_extent_t;
+
 /** FAT in-core node. */
 typedef struct fat_node {
 	/** Back pointer to the FS node. */
@@ -249,10 +259,21 @@ typedef struct fat_node {
 	/* Node's last cluster in FAT. */
 	bool		lastc_cached_valid;
 	fat_cluster_t	lastc_cached_value;
-	/* Node's "current" cluster, i.e. where the last I/O took place. */
-	bool		currc_cached_valid;
-	aoff64_t	currc_cached_bn;
-	fat_cluster_t	currc_cached_value;
+	/*
+	 * Runs of consecutive clusters covering the beginning of the node's
+	 * cluster chain, sorted by the index within the node. Filled in as
+	 * the chain is walked so that the walk need not be repeated.
+	 */
+	fat_extent_t	*extents;
+	size_t		extents_count;
+	size_t		extents_size;
+	/*
+	 * Cluster where the last walk beyond the cached runs stopped, so that
+	 * sequential access past a full cache does not start over each time.
+	 */
+	bool		tailc_valid;
+	uint32_t	tailc_lcl;
+	fat_cluster_t	tailc_value;
 } fat_node_t;
 
 typedef struct {
@@ -52,6 +52,9 @@
 
 #define IS_ODD(number)	(number & 0x1)
 
+/** Maximum number of cached cluster runs per node. */
+#define FAT_EXTENTS_MAX	4096
+
 /**
  * The fat_alloc_lock mutex protects all copies of the File Allocation Table
  * during allocation of clusters. The lock does not have to be held durring
@@ -112,6 +115,181 @@ fat_cluster_walk(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc,
 	return EOK;
 }
 
+/** Record the next cluster of a node's cluster chain.
+ *
+ * The cluster is merged into the last cached run if it follows it.
+ * Clusters which do not immediately follow the cached part of the chain
+ * are ignored, as are all clusters once the cache is full.
+ *
+ * @param nodep		FAT node.
+ * @param lcl		Index of the cluster within the node.
+ * @param clst		Cluster number.
+ */
+static void fat_extent_add(fat_node_t *nodep, uint32_t lcl, fat_cluster_t clst)
+{
+	fat_extent_t *ext = NULL;
+	fat_extent_t *nexts;
+	size_t nsize;
+
+	if (nodep->extents_count > 0) {
+		ext = &nodep->extents[nodep->extents_count - 1];
+		if (ext->lcl + ext->len != lcl)
+			return;
+		if (ext->pcl + ext->len == clst) {
+			ext->len++;
+			return;
+		}
+	} else if (lcl != 0) {
+		return;
+	}
+
+	if (nodep->extents_count == nodep->extents_size) {
+		if (nodep->extents_size == FAT_EXTENTS_MAX)
+			return;
+
+		nsize = nodep->extents_size ? 2 * nodep->extents_size : 4;
+		nexts = realloc(nodep->extents, nsize * sizeof(fat_extent_t));
+		if (nexts == NULL)
+			return;
+
+		nodep->extents = nexts;
+		nodep->extents_size = nsize;
+	}
+
+	ext = &nodep->extents[nodep->extents_count++];
+	ext->lcl = lcl;
+	ext->pcl = clst;
+	ext->len = 1;
+}
+
+/** Find cluster of a node.
+ *
+ * Clusters within the cached runs are found by binary search. Otherwise
+ * the cluster chain is walked from the end of the cached runs, or from
+ * where the previous walk stopped if that is closer, and the clusters
+ * visited are added to the cache while it has room.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ * @param lcl		Index of the cluster within the node.
+ * @param clp		Output argument holding the cluster number.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t fat_extent_lookup(fat_bs_t *bs, fat_node_t *nodep, uint32_t lcl,
+    fat_cluster_t *clp)
+{
+	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	fat_cluster_t clst_bad = FAT_CLST_BAD(bs);
+	fat_extent_t *ext;
+	fat_cluster_t clst;
+	uint32_t cached = 0;
+	uint32_t i;
+	size_t lo, hi, mid;
+	errno_t rc;
+
+	if (nodep->extents_count > 0) {
+		ext = &nodep->extents[nodep->extents_count - 1];
+		cached = ext->lcl + ext->len;
+	}
+
+	if (lcl < cached) {
+		lo = 0;
+		hi = nodep->extents_count;
+		while (hi - lo > 1) {
+			mid = (lo + hi) / 2;
+			if (nodep->extents[mid].lcl <= lcl)
+				lo = mid;
+			else
+				hi = mid;
+		}
+
+		ext = &nodep->extents[lo];
+		*clp = ext->pcl + (lcl - ext->lcl);
+		return EOK;
+	}
+
+	/* Continue the walk where the cached runs end. */
+	if (cached == 0) {
+		i = 0;
+		clst = nodep->firstc;
+		fat_extent_add(nodep, i, clst);
+	} else {
+		i = cached - 1;
+		clst = ext->pcl + ext->len - 1;
+	}
+
+	/* Resume the previous walk if the cache could not keep up with it. */
+	if (nodep->tailc_valid && nodep->tailc_lcl > i &&
+	    nodep->tailc_lcl <= lcl) {
+		i = nodep->tailc_lcl;
+		clst = nodep->tailc_value;
+	}
+
+	while (i < lcl) {
+		/* read FAT1 */
+		rc = fat_get_cluster(bs, nodep->idx->service_id, FAT1, clst,
+		    &clst);
+		if (rc != EOK)
+			return rc;
+
+		assert(clst >= FAT_CLST_FIRST && clst < clst_last1);
+		assert(clst != clst_bad);
+		fat_extent_add(nodep, ++i, clst);
+	}
+
+	nodep->tailc_valid = true;
+	nodep->tailc_lcl = lcl;
+	nodep->tailc_value = clst;
+
+	*clp = clst;
+	return EOK;
+}
+
+/** Forget cached cluster runs that are no longer part of a node.
+ *
+ * @param nodep		FAT node.
+ * @param lcl		Last cluster which remains in the node or
+ *			FAT_CLST_RES0 if no cluster remains.
+ */
+static void fat_extents_chop(fat_node_t *nodep, fat_cluster_t lcl)
+{
+	fat_extent_t *ext;
+	size_t i;
+
+	/* The previous walk may have stopped in the chopped-off part. */
+	nodep->tailc_valid = false;
+
+	if (lcl == FAT_CLST_RES0) {
+		nodep->extents_count = 0;
+		return;
+	}
+
+	for (i = 0; i < nodep->extents_count; i++) {
+		ext = &nodep->extents[i];
+		if (lcl >= ext->pcl && lcl - ext->pcl < ext->len) {
+			ext->len = lcl - ext->pcl + 1;
+			nodep->extents_count = i + 1;
+			return;
+		}
+	}
+
+	/* The last cluster lies beyond the cached runs, nothing to do. */
+}
+
+/** Free cached cluster runs of a node.
+ *
+ * @param nodep		FAT node.
+ */
+void fat_extents_fini(fat_node_t *nodep)
+{
+	free(nodep->extents);
+	nodep->extents = NULL;
+	nodep->extents_count = 0;
+	nodep->extents_size = 0;
+	nodep->tailc_valid = false;
+}
+
 /** Read block from file located on a FAT file system.
  *
  * @param block		Pointer to a block pointer for storing result.
@@ -126,16 +304,16 @@ errno_t
 fat_block_get(block_t **block, struct fat_bs *bs, fat_node_t *nodep,
     aoff64_t bn, int flags)
 {
-	fat_cluster_t firstc = nodep->firstc;
-	fat_cluster_t currc = 0;
-	aoff64_t relbn = bn;
+	fat_cluster_t clst;
 	errno_t rc;
 
 	if (!nodep->size)
 		return ELIMIT;
 
-	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT)
-		goto fall_through;
+	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT) {
+		return _fat_block_get(block, bs, nodep->idx->service_id,
+		    nodep->firstc, NULL, bn, flags);
+	}
 
 	if (((((nodep->size - 1) / BPS(bs)) / SPC(bs)) == bn / SPC(bs)) &&
 	    nodep->lastc_cached_valid) {
@@ -147,29 +325,12 @@ fat_block_get(block_t **block, struct fat_bs *bs, fat_node_t *nodep,
 		    CLBN2PBN(bs, nodep->lastc_cached_value, bn), flags);
 	}
 
-	if (nodep->currc_cached_valid && bn >= nodep->currc_cached_bn) {
-		/*
-		 * We can start with the cluster cached by the previous call to
-		 * fat_block_get().
-		 */
-		firstc = nodep->currc_cached_value;
-		relbn -= (nodep->currc_cached_bn / SPC(bs)) * SPC(bs);
-	}
-
-fall_through:
-	rc = _fat_block_get(block, bs, nodep->idx->service_id, firstc,
-	    &currc, relbn, flags);
+	rc = fat_extent_lookup(bs, nodep, bn / SPC(bs), &clst);
 	if (rc != EOK)
 		return rc;
 
-	/*
-	 * Update the "current" cluster cache.
-	 */
-	nodep->currc_cached_valid = true;
-	nodep->currc_cached_bn = bn;
-	nodep->currc_cached_value = currc;
-
-	return rc;
+	return block_get(block, nodep->idx->service_id,
+	    CLBN2PBN(bs, clst, bn), flags);
 }
 
 /** Read block from file located on a FAT file system.
@@ -837,8 +998,7 @@ errno_t fat_chop_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t lcl)
 	 * Invalidate cached cluster numbers.
 	 */
 	nodep->lastc_cached_valid = false;
-	if (nodep->currc_cached_value != lcl)
-		nodep->currc_cached_valid = false;
+	fat_extents_chop(nodep, lcl);
 
 	if (lcl == FAT_CLST_RES0) {
 		/* The node will have zero size and no clusters allocated. */
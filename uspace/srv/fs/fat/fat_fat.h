@@ -112,6 +112,7 @@ extern errno_t fat_cluster_walk(struct fat_bs *, service_id_t, fat_cluster_t,
 
 extern errno_t fat_block_get(block_t **, struct fat_bs *, struct fat_node *,
     aoff64_t, int);
+extern void fat_extents_fini(struct fat_node *);
 extern errno_t _fat_block_get(block_t **, struct fat_bs *, service_id_t,
     fat_cluster_t, fat_cluster_t *, aoff64_t, int);
 
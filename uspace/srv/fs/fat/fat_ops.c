@@ -109,9 +109,12 @@ static void fat_node_initialize(fat_node_t *node)
 	node->dirty = false;
 	node->lastc_cached_valid = false;
 	node->lastc_cached_value = 0;
-	node->currc_cached_valid = false;
-	node->currc_cached_bn = 0;
-	node->currc_cached_value = 0;
+	node->extents = NULL;
+	node->extents_count = 0;
+	node->extents_size = 0;
+	node->tailc_valid = false;
+	node->tailc_lcl = 0;
+	node->tailc_value = 0;
 }
 
 static errno_t fat_node_sync(fat_node_t *node)
@@ -193,6 +196,7 @@ restart:
 				return rc;
 		}
 		nodep->idx->nodep = NULL;
+		fat_extents_fini(nodep);
 		free(nodep->bp);
 		free(nodep);
 
@@ -231,6 +235,7 @@ static errno_t fat_node_get_new(fat_node_t **nodepp)
 				idxp_tmp->nodep = NULL;
 				fibril_mutex_unlock(&nodep->lock);
 				fibril_mutex_unlock(&idxp_tmp->lock);
+				fat_extents_fini(nodep);
 				free(nodep->bp);
 				free(nodep);
 				return rc;
@@ -239,6 +244,7 @@ static errno_t fat_node_get_new(fat_node_t **nodepp)
 		idxp_tmp->nodep = NULL;
 		fibril_mutex_unlock(&nodep->lock);
 		fibril_mutex_unlock(&idxp_tmp->lock);
+		fat_extents_fini(nodep);
 		fn = FS_NODE(nodep);
 	} else {
 	skip_cache:
@@ -477,6 +483,7 @@ errno_t fat_node_put(fs_node_t *fn)
 	}
 	fibril_mutex_unlock(&nodep->lock);
 	if (destroy) {
+		fat_extents_fini(nodep);
 		free(nodep->bp);
 		free(nodep);
 	}
@@ -570,6 +577,7 @@ errno_t fat_destroy_node(fs_node_t *fn)
 	}
 
 	fat_idx_destroy(nodep->idx);
+	fat_extents_fini(nodep);
 	free(nodep->bp);
 	free(nodep);
 	return rc;
@@ -906,7 +914,8 @@ libfs_ops_t fat_libfs_ops = {
 	.service_get = fat_service_get,
 	.size_block = fat_size_block,
 	.total_block_count = fat_total_block_count,
-	.free_block_count = fat_free_block_count
+	.free_block_count = fat_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 static errno_t fat_fs_open(service_id_t service_id, enum cache_mode cmode,
@@ -1025,6 +1034,7 @@ static errno_t fat_fs_open(service_id_t service_id, enum cache_mode cmode,
 
 static void fat_fs_close(service_id_t service_id, fs_node_t *rfn)
 {
+	fat_extents_fini(FAT_NODE(rfn));
 	free(rfn->data);
 	free(rfn);
 	(void) block_cache_fini(service_id);
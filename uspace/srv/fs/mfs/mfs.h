@@ -116,6 +116,12 @@ struct mfs_sb_info {
 	 * is invoked.
 	 */
 	unsigned nfree_zones;
+	/*
+	 * Number of free bits in each block of the inode and zone
+	 * bitmaps, used to skip full bitmap blocks when allocating.
+	 */
+	uint32_t *ibmap_free;
+	uint32_t *zbmap_free;
 };
 
 /* Generic MinixFS inode */
@@ -228,6 +234,12 @@ mfs_count_free_zones(struct mfs_instance *inst, uint32_t *zones);
 extern errno_t
 mfs_count_free_inodes(struct mfs_instance *inst, uint32_t *inodes);
 
+extern errno_t
+mfs_bmap_summary_init(struct mfs_instance *inst);
+
+extern void
+mfs_bmap_summary_fini(struct mfs_sb_info *sbi);
+
 /* mfs_utils.c */
 extern uint16_t
 conv16(bool native, uint16_t n);
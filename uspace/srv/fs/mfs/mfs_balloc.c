@@ -31,6 +31,7 @@
  */
 
 #include <stdlib.h>
+#include <adt/bitmap.h>
 #include "mfs.h"
 
 static int
@@ -46,6 +47,20 @@ mfs_alloc_bit(struct mfs_instance *inst, uint32_t *idx, bmap_id_t bid);
 static errno_t
 mfs_count_free_bits(struct mfs_instance *inst, bmap_id_t bid, uint32_t *free);
 
+/** Get the summary of a bitmap
+ *
+ * @param sbi		Pointer to the superblock info structure.
+ * @param bid		BMAP_ZONE or BMAP_INODE.
+ *
+ * @return		Array holding the number of free bits in each
+ * 			block of the bitmap.
+ */
+static inline uint32_t *
+mfs_bmap_summary(struct mfs_sb_info *sbi, bmap_id_t bid)
+{
+	return bid == BMAP_ZONE ? sbi->zbmap_free : sbi->ibmap_free;
+}
+
 /**Allocate a new inode.
  *
  * @param inst		Pointer to the filesystem instance.
@@ -165,59 +180,154 @@ mfs_count_free_inodes(struct mfs_instance *inst, uint32_t *inodes)
 static errno_t
 mfs_count_free_bits(struct mfs_instance *inst, bmap_id_t bid, uint32_t *free)
 {
-	errno_t r;
-	unsigned start_block;
-	unsigned long nblocks;
-	unsigned long nbits;
+	struct mfs_sb_info *sbi = inst->sbi;
+	uint32_t *summary = mfs_bmap_summary(sbi, bid);
+	unsigned long nblocks = MFS_BMAP_SIZE_BLOCKS(sbi, bid);
 	unsigned long block;
-	unsigned long free_bits = 0;
+	uint32_t free_bits = 0;
+
+	for (block = 0; block < nblocks; ++block)
+		free_bits += summary[block];
+
+	*free = free_bits;
+	return EOK;
+}
+
+/** Count the zero bits at the beginning of a bitmap block
+ *
+ * @param data          Bitmap block data.
+ * @param nbits         Number of bits to examine.
+ * @param native        Whether the filesystem is in native byte order.
+ *
+ * @return              Number of zero bits.
+ */
+static uint32_t
+mfs_count_zero_bits(bitchunk_t *data, unsigned nbits, const bool native)
+{
+	const size_t chunk_bits = sizeof(bitchunk_t) * 8;
+	unsigned whole = nbits - nbits % chunk_bits;
 	bitchunk_t chunk;
-	size_t const bitchunk_bits = sizeof(bitchunk_t) * 8;
-	block_t *b;
+	bitmap_t bmap;
+	uint32_t zeroes;
+	unsigned bit;
+
+	/* Whole chunks can be counted regardless of their byte order */
+	bitmap_initialize(&bmap, whole, data);
+	zeroes = bitmap_count_zeroes(&bmap, 0, whole);
+
+	if (whole < nbits) {
+		chunk = conv32(native, data[whole / chunk_bits]);
+		for (bit = 0; bit < nbits % chunk_bits; ++bit) {
+			if (!(chunk & (1 << bit)))
+				zeroes++;
+		}
+	}
+
+	return zeroes;
+}
+
+/** Summarize a bitmap
+ *
+ * Count the free bits in each block of the bitmap.
+ *
+ * @param inst          Pointer to the instance structure.
+ * @param bid           Type of the bitmap (inode or zone).
+ * @param rsummary      Pointer to the memory location where the
+ *                      summary will be stored.
+ *
+ * @return              EOK on success or an error code.
+ */
+static errno_t
+mfs_bmap_summary_build(struct mfs_instance *inst, bmap_id_t bid,
+    uint32_t **rsummary)
+{
 	struct mfs_sb_info *sbi = inst->sbi;
+	unsigned start_block = MFS_BMAP_START_BLOCK(sbi, bid);
+	unsigned long nblocks = MFS_BMAP_SIZE_BLOCKS(sbi, bid);
+	unsigned bits_per_block = sbi->block_size * 8;
+	/* Bits up to and including the limit can be allocated */
+	unsigned long nbits = MFS_BMAP_SIZE_BITS(sbi, bid) + 1;
+	unsigned long block;
+	uint32_t *summary;
+	block_t *b;
+	errno_t r;
 
-	start_block = MFS_BMAP_START_BLOCK(sbi, bid);
-	nblocks = MFS_BMAP_SIZE_BLOCKS(sbi, bid);
-	nbits = MFS_BMAP_SIZE_BITS(sbi, bid);
+	summary = calloc(nblocks, sizeof(uint32_t));
+	if (!summary)
+		return ENOMEM;
 
-	for (block = 0; block < nblocks; ++block) {
+	for (block = 0; block < nblocks &&
+	    block * bits_per_block < nbits; ++block) {
 		r = block_get(&b, inst->service_id, block + start_block,
 		    BLOCK_FLAGS_NONE);
-		if (r != EOK)
+		if (r != EOK) {
+			free(summary);
 			return r;
-
-		size_t i;
-		bitchunk_t *data = (bitchunk_t *) b->data;
-
-		/*
-		 * Read the bitmap block, chunk per chunk,
-		 * counting the zero bits.
-		 */
-		for (i = 0; i < sbi->block_size / sizeof(bitchunk_t); ++i) {
-			chunk = conv32(sbi->native, data[i]);
-
-			size_t bit;
-			for (bit = 0; bit < bitchunk_bits && nbits > 0;
-			    ++bit, --nbits) {
-				if (!(chunk & (1 << bit)))
-					free_bits++;
-			}
-
-			if (nbits == 0)
-				break;
 		}
 
+		summary[block] = mfs_count_zero_bits(b->data,
+		    min(nbits - block * bits_per_block, bits_per_block),
+		    sbi->native);
+
 		r = block_put(b);
-		if (r != EOK)
+		if (r != EOK) {
+			free(summary);
 			return r;
+		}
 	}
 
-	*free = free_bits;
-	assert(nbits == 0);
+	*rsummary = summary;
+	return EOK;
+}
+
+/** Build the summaries of the inode and zone bitmaps
+ *
+ * @param inst          Pointer to the instance structure.
+ *
+ * @return              EOK on success or an error code.
+ */
+errno_t
+mfs_bmap_summary_init(struct mfs_instance *inst)
+{
+	struct mfs_sb_info *sbi = inst->sbi;
+	uint32_t zones;
+	errno_t r;
+
+	r = mfs_bmap_summary_build(inst, BMAP_INODE, &sbi->ibmap_free);
+	if (r != EOK)
+		return r;
+
+	r = mfs_bmap_summary_build(inst, BMAP_ZONE, &sbi->zbmap_free);
+	if (r != EOK) {
+		mfs_bmap_summary_fini(sbi);
+		return r;
+	}
+
+	/* The summary also gives us the number of free zones */
+	r = mfs_count_free_zones(inst, &zones);
+	if (r != EOK) {
+		mfs_bmap_summary_fini(sbi);
+		return r;
+	}
 
+	sbi->nfree_zones = zones;
+	sbi->nfree_zones_valid = true;
 	return EOK;
 }
 
+/** Free the summaries of the inode and zone bitmaps
+ *
+ * @param sbi           Pointer to the superblock info structure.
+ */
+void
+mfs_bmap_summary_fini(struct mfs_sb_info *sbi)
+{
+	free(sbi->ibmap_free);
+	free(sbi->zbmap_free);
+	sbi->ibmap_free = NULL;
+	sbi->zbmap_free = NULL;
+}
+
 /**Clear a bit in a bitmap.
  *
  * @param inst		Pointer to the filesystem instance.
@@ -257,10 +367,13 @@ mfs_free_bit(struct mfs_instance *inst, uint32_t idx, bmap_id_t bid)
 		}
 	}
 
+	bool counted = idx <= MFS_BMAP_SIZE_BITS(sbi, bid);
+
 	/* Compute the bitmap block */
-	uint32_t block = idx / (sbi->block_size * 8) + start_block;
+	uint32_t block = idx / (sbi->block_size * 8);
 
-	r = block_get(&b, inst->service_id, block, BLOCK_FLAGS_NONE);
+	r = block_get(&b, inst->service_id, block + start_block,
+	    BLOCK_FLAGS_NONE);
 	if (r != EOK)
 		goto out_err;
 
@@ -271,6 +384,8 @@ mfs_free_bit(struct mfs_instance *inst, uint32_t idx, bmap_id_t bid)
 	const size_t chunk_bits = sizeof(bitchunk_t) * 8;
 
 	chunk = conv32(sbi->native, ptr[idx / chunk_bits]);
+	if (counted && (chunk & (1 << (idx % chunk_bits))))
+		mfs_bmap_summary(sbi, bid)[block]++;
 	chunk &= ~(1 << (idx % chunk_bits));
 	ptr[idx / chunk_bits] = conv32(sbi->native, chunk);
 
@@ -302,10 +417,12 @@ mfs_alloc_bit(struct mfs_instance *inst, uint32_t *idx, bmap_id_t bid)
 	unsigned long nblocks;
 	unsigned *search, i, start_block;
 	unsigned bits_per_block;
+	uint32_t *summary;
 	errno_t r;
 	int freebit;
 
 	sbi = inst->sbi;
+	summary = mfs_bmap_summary(sbi, bid);
 
 	start_block = MFS_BMAP_START_BLOCK(sbi, bid);
 	limit = MFS_BMAP_SIZE_BITS(sbi, bid);
@@ -324,13 +441,19 @@ mfs_alloc_bit(struct mfs_instance *inst, uint32_t *idx, bmap_id_t bid)
 retry:
 
 	for (i = *search / bits_per_block; i < nblocks; ++i) {
+		if (summary[i] == 0) {
+			/* The summary says there is no free bit here */
+			continue;
+		}
+
 		r = block_get(&b, inst->service_id, i + start_block,
 		    BLOCK_FLAGS_NONE);
 
 		if (r != EOK)
 			goto out;
 
-		unsigned tmp = *search % bits_per_block;
+		unsigned tmp = (i == *search / bits_per_block) ?
+		    *search % bits_per_block : 0;
 
 		freebit = find_free_bit_and_set(b->data, sbi->block_size,
 		    sbi->native, tmp);
@@ -353,6 +476,7 @@ retry:
 		}
 
 		*search = *idx;
+		summary[i]--;
 		b->dirty = true;
 		r = block_put(b);
 		goto out;
@@ -378,28 +502,34 @@ find_free_bit_and_set(bitchunk_t *b, const int bsize,
 	int r = -1;
 	unsigned i, j;
 	bitchunk_t chunk;
+	bitmap_t bmap;
+	size_t zero;
 	const size_t chunk_bits = sizeof(bitchunk_t) * 8;
-
-	for (i = start_bit / chunk_bits;
-	    i < bsize / sizeof(bitchunk_t); ++i) {
-
-		if (!(~b[i])) {
-			/* No free bit in this chunk */
-			continue;
-		}
-
-		chunk = conv32(native, b[i]);
-
-		for (j = 0; j < chunk_bits; ++j) {
-			if (!(chunk & (1 << j))) {
-				r = i * chunk_bits + j;
-				chunk |= 1 << j;
-				b[i] = conv32(native, chunk);
-				goto found;
-			}
+	const size_t nbits = bsize * 8;
+
+	/*
+	 * Skip full chunks a word at a time. The byte holding the first
+	 * zero bit lies in the first chunk with a free bit regardless
+	 * of the byte order of the chunks.
+	 */
+	bitmap_initialize(&bmap, nbits, b);
+	zero = bitmap_find_zero(&bmap, start_bit / chunk_bits * chunk_bits,
+	    nbits);
+	if (zero == nbits)
+		return -1;
+
+	i = zero / chunk_bits;
+	chunk = conv32(native, b[i]);
+
+	for (j = 0; j < chunk_bits; ++j) {
+		if (!(chunk & (1 << j))) {
+			r = i * chunk_bits + j;
+			chunk |= 1 << j;
+			b[i] = conv32(native, chunk);
+			break;
 		}
 	}
-found:
+
 	return r;
 }
 
@@ -90,7 +90,8 @@ libfs_ops_t mfs_libfs_ops = {
 	.lnkcnt_get = mfs_lnkcnt_get,
 	.size_block = mfs_size_block,
 	.total_block_count = mfs_total_block_count,
-	.free_block_count = mfs_free_block_count
+	.free_block_count = mfs_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 /* Hash table interface for open nodes hash table */
@@ -211,6 +212,8 @@ static errno_t mfs_read_sb(service_id_t service_id, struct mfs_sb_info **rsbi)
 	sbi->zsearch = 0;
 	sbi->nfree_zones_valid = false;
 	sbi->nfree_zones = 0;
+	sbi->ibmap_free = NULL;
+	sbi->zbmap_free = NULL;
 
 	if (version == MFS_VERSION_V3) {
 		sbi->ninodes = conv32(native, sb3->s_ninodes);
@@ -337,6 +340,15 @@ mfs_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	instance->service_id = service_id;
 	instance->sbi = sbi;
 	instance->open_nodes_cnt = 0;
+
+	/* Summarize the bitmaps */
+	rc = mfs_bmap_summary_init(instance);
+	if (rc != EOK) {
+		block_cache_fini(service_id);
+		mfsdebug("bitmap summary initialization failed\n");
+		goto out_error;
+	}
+
 	rc = fs_instance_create(service_id, instance);
 	if (rc != EOK) {
 		block_cache_fini(service_id);
@@ -358,8 +370,10 @@ mfs_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 
 out_error:
 	block_fini(service_id);
-	if (sbi)
+	if (sbi) {
+		mfs_bmap_summary_fini(sbi);
 		free(sbi);
+	}
 	if (instance)
 		free(instance);
 	return rc;
@@ -384,6 +398,7 @@ mfs_unmounted(service_id_t service_id)
 
 	/* Remove and destroy the instance */
 	(void) fs_instance_destroy(service_id);
+	mfs_bmap_summary_fini(inst->sbi);
 	free(inst->sbi);
 	free(inst);
 	return EOK;
@@ -37,10 +37,14 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <adt/hash_table.h>
+#include <as.h>
 
 #define TMPFS_NODE(node)	((node) ? (tmpfs_node_t *)(node)->data : NULL)
 #define FS_NODE(node)		((node) ? (node)->bp : NULL)
 
+/** Size of a chunk of file contents */
+#define TMPFS_CHUNK_SIZE	PAGE_SIZE
+
 typedef enum {
 	TMPFS_NONE,
 	TMPFS_FILE,
@@ -64,7 +68,13 @@ typedef struct tmpfs_node {
 	tmpfs_dentry_type_t type;
 	unsigned lnkcnt;	/**< Link count. */
 	size_t size;		/**< File size if type is TMPFS_FILE. */
-	void *data;		/**< File content's if type is TMPFS_FILE. */
+	/**
+	 * File contents if type is TMPFS_FILE, in chunks of TMPFS_CHUNK_SIZE
+	 * bytes. Holes are NULL. The bytes past the end of the file are
+	 * always zero.
+	 */
+	void **chunks;
+	size_t chunks_max;	/**< Number of entries in chunks. */
 	list_t cs_list;		/**< Child's siblings list. */
 } tmpfs_node_t;
 
@@ -57,6 +57,64 @@
 /** Global counter for assigning node indices. Shared by all instances. */
 fs_index_t tmpfs_next_index = 1;
 
+/** Contents of holes in files. */
+static const uint8_t tmpfs_zero_chunk[TMPFS_CHUNK_SIZE];
+
+/** Free file chunks starting at the given index. */
+static void tmpfs_chunks_free(tmpfs_node_t *nodep, size_t first)
+{
+	for (size_t i = first; i < nodep->chunks_max; i++) {
+		free(nodep->chunks[i]);
+		nodep->chunks[i] = NULL;
+	}
+}
+
+/** Get a chunk of file contents for writing.
+ *
+ * If the chunk is a hole, it is allocated and zeroed. The chunk table
+ * grows geometrically, so that appending to a file takes amortized
+ * constant time.
+ *
+ * @param nodep		TMPFS file node.
+ * @param idx		Chunk index.
+ *
+ * @return		Chunk or NULL if out of memory.
+ */
+static uint8_t *tmpfs_chunk_get(tmpfs_node_t *nodep, size_t idx)
+{
+	if (idx >= nodep->chunks_max) {
+		size_t nmax = max(2 * nodep->chunks_max, idx + 1);
+		void **nchunks = realloc(nodep->chunks, nmax * sizeof(void *));
+		if (!nchunks)
+			return NULL;
+
+		memset(&nchunks[nodep->chunks_max], 0,
+		    (nmax - nodep->chunks_max) * sizeof(void *));
+		nodep->chunks = nchunks;
+		nodep->chunks_max = nmax;
+	}
+
+	if (!nodep->chunks[idx])
+		nodep->chunks[idx] = calloc(1, TMPFS_CHUNK_SIZE);
+
+	return nodep->chunks[idx];
+}
+
+/** Get a chunk of file contents for reading.
+ *
+ * @param nodep		TMPFS file node.
+ * @param idx		Chunk index.
+ *
+ * @return		Chunk, or zeroes if the chunk is a hole.
+ */
+static const uint8_t *tmpfs_chunk_peek(tmpfs_node_t *nodep, size_t idx)
+{
+	if (idx < nodep->chunks_max && nodep->chunks[idx])
+		return nodep->chunks[idx];
+
+	return tmpfs_zero_chunk;
+}
+
 /*
  * Implementation of the libfs interface.
  */
@@ -179,9 +237,10 @@ static void nodes_remove_callback(ht_link_t *item)
 		free(dentryp);
 	}
 
-	if (nodep->data) {
+	if (nodep->chunks) {
 		assert(nodep->type == TMPFS_FILE);
-		free(nodep->data);
+		tmpfs_chunks_free(nodep, 0);
+		free(nodep->chunks);
 	}
 	free(nodep->bp);
 	free(nodep);
@@ -204,7 +263,8 @@ static void tmpfs_node_initialize(tmpfs_node_t *nodep)
 	nodep->type = TMPFS_NONE;
 	nodep->lnkcnt = 0;
 	nodep->size = 0;
-	nodep->data = NULL;
+	nodep->chunks = NULL;
+	nodep->chunks_max = 0;
 	list_initialize(&nodep->cs_list);
 }
 
@@ -491,9 +551,38 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 
 	size_t bytes;
 	if (nodep->type == TMPFS_FILE) {
-		bytes = min(nodep->size - pos, size);
-		(void) async_data_read_finalize(&call, nodep->data + pos,
-		    bytes);
+		bytes = (pos < nodep->size) ? min(nodep->size - pos, size) : 0;
+
+		size_t first = pos / TMPFS_CHUNK_SIZE;
+		size_t offs = pos % TMPFS_CHUNK_SIZE;
+
+		if (offs + bytes <= TMPFS_CHUNK_SIZE) {
+			/*
+			 * The data lie in a single chunk, which is always the
+			 * case for page-aligned reads done by the VFS pager.
+			 * Read directly from the chunk.
+			 */
+			(void) async_data_read_finalize(&call,
+			    tmpfs_chunk_peek(nodep, first) + offs, bytes);
+		} else {
+			uint8_t *buf = malloc(bytes);
+			if (!buf) {
+				async_answer_0(&call, ENOMEM);
+				return ENOMEM;
+			}
+
+			for (size_t done = 0; done < bytes; ) {
+				size_t n = min(TMPFS_CHUNK_SIZE - offs, bytes - done);
+				memcpy(buf + done, tmpfs_chunk_peek(nodep, first) +
+				    offs, n);
+				done += n;
+				offs = 0;
+				first++;
+			}
+
+			(void) async_data_read_finalize(&call, buf, bytes);
+			free(buf);
+		}
 	} else {
 		tmpfs_dentry_t *dentryp;
 		link_t *lnk;
@@ -552,34 +641,58 @@ tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		return EINVAL;
 	}
 
-	/*
-	 * Check whether the file needs to grow.
-	 */
-	if (pos + size <= nodep->size) {
-		/* The file size is not changing. */
-		(void) async_data_write_finalize(&call, nodep->data + pos,
-		    size);
+	if (pos > SIZE_MAX - size) {
+		async_answer_0(&call, ENOMEM);
+		size = 0;
 		goto out;
 	}
-	size_t delta = (pos + size) - nodep->size;
+
 	/*
-	 * At this point, we are deliberately extremely straightforward and
-	 * simply realloc the contents of the file on every write that grows the
-	 * file. In the end, the situation might not be as bad as it may look:
-	 * our heap allocator can save us and just grow the block whenever
-	 * possible.
+	 * Make sure that all the affected chunks exist. If we run out of
+	 * memory, the chunks which were already allocated are harmless, as
+	 * they are zeroed.
 	 */
-	void *newdata = realloc(nodep->data, nodep->size + delta);
-	if (!newdata) {
-		async_answer_0(&call, ENOMEM);
-		size = 0;
-		goto out;
+	size_t first = pos / TMPFS_CHUNK_SIZE;
+	size_t offs = pos % TMPFS_CHUNK_SIZE;
+	size_t last = (size > 0) ? (pos + size - 1) / TMPFS_CHUNK_SIZE : first;
+
+	for (size_t i = first; i <= last; i++) {
+		if (!tmpfs_chunk_get(nodep, i)) {
+			async_answer_0(&call, ENOMEM);
+			size = 0;
+			goto out;
+		}
+	}
+
+	if (first == last) {
+		/* Write directly to the chunk. */
+		(void) async_data_write_finalize(&call,
+		    (uint8_t *) nodep->chunks[first] + offs, size);
+	} else {
+		uint8_t *buf = malloc(size);
+		if (!buf) {
+			async_answer_0(&call, ENOMEM);
+			size = 0;
+			goto out;
+		}
+
+		if (async_data_write_finalize(&call, buf, size) == EOK) {
+			for (size_t done = 0; done < size; ) {
+				size_t n = min(TMPFS_CHUNK_SIZE - offs,
+				    size - done);
+				memcpy((uint8_t *) nodep->chunks[first] + offs,
+				    buf + done, n);
+				done += n;
+				offs = 0;
+				first++;
+			}
+		}
+
+		free(buf);
 	}
-	/* Clear any newly allocated memory in order to emulate gaps. */
-	memset(newdata + nodep->size, 0, delta);
-	nodep->size += delta;
-	nodep->data = newdata;
-	(void) async_data_write_finalize(&call, nodep->data + pos, size);
+
+	if (pos + size > nodep->size)
+		nodep->size = pos + size;
 
 out:
 	*wbytes = size;
@@ -609,17 +722,31 @@ static errno_t tmpfs_truncate(service_id_t service_id, fs_index_t index,
 	if (size > SIZE_MAX)
 		return ENOMEM;
 
-	void *newdata = realloc(nodep->data, size);
-	if (!newdata && size)
-		return ENOMEM;
+	if (size < nodep->size) {
+		/*
+		 * Free the chunks past the new end of the file and clear
+		 * the rest of the last chunk, so that growing the file again
+		 * reveals zeroes.
+		 */
+		size_t keep = (size + TMPFS_CHUNK_SIZE - 1) / TMPFS_CHUNK_SIZE;
+		size_t offs = size % TMPFS_CHUNK_SIZE;
+
+		tmpfs_chunks_free(nodep, keep);
+		if (offs != 0 && keep <= nodep->chunks_max &&
+		    nodep->chunks[keep - 1]) {
+			memset((uint8_t *) nodep->chunks[keep - 1] + offs, 0,
+			    TMPFS_CHUNK_SIZE - offs);
+		}
 
-	if (size > nodep->size) {
-		size_t delta = size - nodep->size;
-		memset(newdata + nodep->size, 0, delta);
+		if (keep == 0) {
+			free(nodep->chunks);
+			nodep->chunks = NULL;
+			nodep->chunks_max = 0;
+		}
 	}
 
+	/* Growing the file only creates a hole. */
 	nodep->size = size;
-	nodep->data = newdata;
 	return EOK;
 }
 
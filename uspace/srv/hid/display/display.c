@@ -36,6 +36,7 @@
 #include <errno.h>
 #include <gfx/bitmap.h>
 #include <gfx/context.h>
+#include <gfx/region.h>
 #include <gfx/render.h>
 #include <io/log.h>
 #include <memgfx/memgc.h>
@@ -51,6 +52,9 @@
 #include "window.h"
 #include "wmclient.h"
 
+/** Maximum number of rectangles in backbuffer dirty region */
+#define DS_DIRTY_MAX_RECTS 32
+
 static gfx_context_t *ds_display_get_unbuf_gc(ds_display_t *);
 static void ds_display_invalidate_cb(void *, gfx_rect_t *);
 static void ds_display_update_cb(void *);
@@ -108,6 +112,7 @@ errno_t ds_display_create(gfx_context_t *gc, ds_display_flags_t flags,
 	fibril_condvar_initialize(&disp->ievent_cv);
 	list_initialize(&disp->seats);
 	list_initialize(&disp->windows);
+	gfx_region_init(&disp->dirty);
 	disp->flags = flags;
 	*rdisp = disp;
 	return EOK;
@@ -140,6 +145,7 @@ void ds_display_destroy(ds_display_t *disp)
 		disp->cursor[i] = NULL;
 	}
 
+	gfx_region_fini(&disp->dirty);
 	gfx_color_delete(disp->bg_color);
 	free(disp);
 }
@@ -873,11 +879,15 @@ static errno_t ds_display_alloc_backbuf(ds_display_t *disp)
 	if (rc != EOK)
 		goto error;
 
-	disp->dirty_rect.p0.x = 0;
-	disp->dirty_rect.p0.y = 0;
-	disp->dirty_rect.p1.x = 0;
-	disp->dirty_rect.p1.y = 0;
+	/*
+	 * Preallocate the dirty region so that collapsing it to a single
+	 * rectangle in the invalidate callback can never fail.
+	 */
+	rc = gfx_region_add_rect(&disp->dirty, &disp->rect);
+	if (rc != EOK)
+		goto error;
 
+	gfx_region_clear(&disp->dirty);
 	return EOK;
 error:
 	if (disp->backbuf != NULL) {
@@ -1193,6 +1203,7 @@ errno_t ds_display_paint_bg(ds_display_t *disp, gfx_rect_t *rect)
  */
 static errno_t ds_display_update(ds_display_t *disp)
 {
+	size_t i;
 	errno_t rc;
 
 	if (disp->backbuf == NULL) {
@@ -1200,24 +1211,27 @@ static errno_t ds_display_update(ds_display_t *disp)
 		return EOK;
 	}
 
-	rc = gfx_bitmap_render(disp->backbuf, &disp->dirty_rect, NULL);
-	if (rc != EOK)
-		return rc;
-
-	disp->dirty_rect.p0.x = 0;
-	disp->dirty_rect.p0.y = 0;
-	disp->dirty_rect.p1.x = 0;
-	disp->dirty_rect.p1.y = 0;
+	for (i = 0; i < disp->dirty.count; i++) {
+		rc = gfx_bitmap_render(disp->backbuf, &disp->dirty.rects[i],
+		    NULL);
+		if (rc != EOK)
+			return rc;
+	}
 
+	gfx_region_clear(&disp->dirty);
 	return EOK;
 }
 
-/** Paint display.
+/** Paint display bottom to top.
+ *
+ * Everything intersecting @a rect is painted, including parts of windows
+ * that are covered by other windows. This is used as a fallback when
+ * we run out of memory computing the visible parts of windows.
  *
  * @param display Display
  * @param rect Bounding rectangle or @c NULL to repaint entire display
  */
-errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
+static errno_t ds_display_paint_all(ds_display_t *disp, gfx_rect_t *rect)
 {
 	errno_t rc;
 	ds_window_t *wnd;
@@ -1261,10 +1275,172 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 	return ds_display_update(disp);
 }
 
+/** Paint display region.
+ *
+ * Windows are visited top to bottom and each window is painted only
+ * where it is not covered by windows above it, so every pixel of the
+ * region is composited exactly once. Background is painted only where
+ * no window is visible.
+ *
+ * @param display Display
+ * @param region Region to repaint
+ * @return EOK on success or an error code
+ */
+errno_t ds_display_paint_region(ds_display_t *disp, gfx_region_t *region)
+{
+	gfx_region_t remaining;
+	gfx_rect_t bounds;
+	gfx_rect_t drect;
+	gfx_rect_t crect;
+	ds_window_t *wnd;
+	ds_seat_t *seat;
+	size_t i;
+	errno_t rc;
+
+	gfx_region_init(&remaining);
+
+	rc = gfx_region_copy(region, &remaining);
+	if (rc != EOK)
+		goto fallback;
+
+	gfx_region_clip(&remaining, &disp->rect);
+
+	/* Paint visible parts of windows top to bottom */
+	wnd = ds_display_first_window(disp);
+	while (wnd != NULL && !gfx_region_is_empty(&remaining)) {
+		if (ds_window_is_visible(wnd)) {
+			gfx_rect_translate(&wnd->dpos, &wnd->rect, &drect);
+
+			for (i = 0; i < remaining.count; i++) {
+				gfx_rect_clip(&remaining.rects[i], &drect,
+				    &crect);
+				if (gfx_rect_is_empty(&crect))
+					continue;
+
+				rc = ds_window_paint(wnd, &crect);
+				if (rc != EOK)
+					goto error;
+			}
+
+			rc = gfx_region_subtract_rect(&remaining, &drect);
+			if (rc != EOK)
+				goto fallback;
+		}
+
+		wnd = ds_display_next_window(wnd);
+	}
+
+	/* Paint background where no window is visible */
+	for (i = 0; i < remaining.count; i++) {
+		rc = ds_display_paint_bg(disp, &remaining.rects[i]);
+		if (rc != EOK)
+			goto error;
+	}
+
+	gfx_region_fini(&remaining);
+
+	for (i = 0; i < region->count; i++) {
+		/* Paint window previews for windows being resized or moved */
+		wnd = ds_display_last_window(disp);
+		while (wnd != NULL) {
+			rc = ds_window_paint_preview(wnd, &region->rects[i]);
+			if (rc != EOK)
+				return rc;
+
+			wnd = ds_display_prev_window(wnd);
+		}
+
+		/* Paint pointers */
+		seat = ds_display_first_seat(disp);
+		while (seat != NULL) {
+			rc = ds_seat_paint_pointer(seat, &region->rects[i]);
+			if (rc != EOK)
+				return rc;
+
+			seat = ds_display_next_seat(seat);
+		}
+	}
+
+	return ds_display_update(disp);
+fallback:
+	gfx_region_fini(&remaining);
+	gfx_region_bounds(region, &bounds);
+	if (gfx_rect_is_empty(&bounds))
+		return EOK;
+
+	return ds_display_paint_all(disp, &bounds);
+error:
+	gfx_region_fini(&remaining);
+	return rc;
+}
+
+/** Paint display.
+ *
+ * @param display Display
+ * @param rect Bounding rectangle or @c NULL to repaint entire display
+ */
+errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
+{
+	gfx_region_t region;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	rc = gfx_region_add_rect(&region, rect != NULL ? rect : &disp->rect);
+	if (rc != EOK) {
+		gfx_region_fini(&region);
+		return ds_display_paint_all(disp, rect);
+	}
+
+	rc = ds_display_paint_region(disp, &region);
+	gfx_region_fini(&region);
+	return rc;
+}
+
+/** Paint display rectangles.
+ *
+ * Paint the union of several (possibly overlapping or empty) rectangles.
+ * This avoids repainting the area between them, as would happen
+ * if we painted their envelope.
+ *
+ * @param display Display
+ * @param rects Array of rectangles
+ * @param count Number of rectangles
+ * @return EOK on success or an error code
+ */
+errno_t ds_display_paint_rects(ds_display_t *disp, gfx_rect_t *rects,
+    size_t count)
+{
+	gfx_region_t region;
+	gfx_rect_t env;
+	size_t i;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	for (i = 0; i < count; i++) {
+		rc = gfx_region_add_rect(&region, &rects[i]);
+		if (rc != EOK)
+			goto fallback;
+	}
+
+	rc = ds_display_paint_region(disp, &region);
+	gfx_region_fini(&region);
+	return rc;
+fallback:
+	gfx_region_fini(&region);
+
+	env = rects[0];
+	for (i = 1; i < count; i++)
+		gfx_rect_envelope(&env, &rects[i], &env);
+
+	return ds_display_paint_all(disp, &env);
+}
+
 /** Display invalidate callback.
  *
  * Called by backbuffer memory GC when something is rendered into it.
- * Updates the display's dirty rectangle.
+ * Updates the display's dirty region.
  *
  * @param arg Argument (display cast as void *)
  * @param rect Rectangle to update
@@ -1272,10 +1448,23 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 static void ds_display_invalidate_cb(void *arg, gfx_rect_t *rect)
 {
 	ds_display_t *disp = (ds_display_t *) arg;
+	gfx_rect_t bounds;
 	gfx_rect_t env;
+	errno_t rc;
 
-	gfx_rect_envelope(&disp->dirty_rect, rect, &env);
-	disp->dirty_rect = env;
+	rc = gfx_region_add_rect(&disp->dirty, rect);
+	if (rc == EOK && disp->dirty.count <= DS_DIRTY_MAX_RECTS)
+		return;
+
+	/*
+	 * Too many rectangles to render separately (or out of memory).
+	 * Collapse dirty region to its bounding rectangle. This cannot
+	 * fail since the region already has memory for one rectangle.
+	 */
+	gfx_region_bounds(&disp->dirty, &bounds);
+	gfx_rect_envelope(&bounds, rect, &env);
+	gfx_region_clear(&disp->dirty);
+	(void) gfx_region_add_rect(&disp->dirty, &env);
 }
 
 /** Display update callback.
@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <gfx/context.h>
 #include <gfx/coord.h>
+#include <gfx/region.h>
 #include <io/kbd_event.h>
 #include "types/display/cfgclient.h"
 #include "types/display/client.h"
@@ -104,6 +105,8 @@ extern void ds_display_crop_max_rect(gfx_rect_t *, gfx_rect_t *);
 extern gfx_context_t *ds_display_get_gc(ds_display_t *);
 extern errno_t ds_display_paint_bg(ds_display_t *, gfx_rect_t *);
 extern errno_t ds_display_paint(ds_display_t *, gfx_rect_t *);
+extern errno_t ds_display_paint_region(ds_display_t *, gfx_region_t *);
+extern errno_t ds_display_paint_rects(ds_display_t *, gfx_rect_t *, size_t);
 
 #endif
 
@@ -439,34 +439,13 @@ void ds_seat_get_pointer_rect(ds_seat_t *seat, gfx_rect_t *rect)
  */
 static errno_t ds_seat_repaint_pointer(ds_seat_t *seat, gfx_rect_t *old_rect)
 {
-	gfx_rect_t new_rect;
-	gfx_rect_t envelope;
-	errno_t rc;
-
-	ds_seat_get_pointer_rect(seat, &new_rect);
+	gfx_rect_t rects[2];
 
-	if (gfx_rect_is_incident(old_rect, &new_rect)) {
-		/* Rectangles do not intersect. Repaint them separately. */
-		rc = ds_display_paint(seat->display, &new_rect);
-		if (rc != EOK)
-			return rc;
+	rects[0] = *old_rect;
+	ds_seat_get_pointer_rect(seat, &rects[1]);
 
-		rc = ds_display_paint(seat->display, old_rect);
-		if (rc != EOK)
-			return rc;
-	} else {
-		/*
-		 * Rectangles intersect. As an optimization, repaint them
-		 * in a single operation.
-		 */
-		gfx_rect_envelope(old_rect, &new_rect, &envelope);
-
-		rc = ds_display_paint(seat->display, &envelope);
-		if (rc != EOK)
-			return rc;
-	}
-
-	return EOK;
+	/* Repaint the union of both rectangles in a single operation */
+	return ds_display_paint_rects(seat->display, rects, 2);
 }
 
 /** Post pointing device event to the seat
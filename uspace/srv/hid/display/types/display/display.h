@@ -41,6 +41,7 @@
 #include <fibril_synch.h>
 #include <gfx/color.h>
 #include <gfx/coord.h>
+#include <types/gfx/region.h>
 #include <io/input.h>
 #include <memgfx/memgc.h>
 #include <types/display/cursor.h>
@@ -129,8 +130,8 @@ typedef struct ds_display {
 	/** Frontbuffer (clone) GC */
 	ds_clonegc_t *fbgc;
 
-	/** Backbuffer dirty rectangle */
-	gfx_rect_t dirty_rect;
+	/** Backbuffer dirty region */
+	gfx_region_t dirty;
 
 	/** Display flags */
 	ds_display_flags_t flags;
@@ -397,11 +397,8 @@ errno_t ds_window_paint_preview(ds_window_t *wnd, gfx_rect_t *rect)
  */
 static errno_t ds_window_repaint_preview(ds_window_t *wnd, gfx_rect_t *old_rect)
 {
-	errno_t rc;
-	gfx_rect_t prect;
-	gfx_rect_t envelope;
-	bool oldr;
-	bool newr;
+	gfx_rect_t rects[2];
+	size_t count;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "ds_window_repaint_preview");
 
@@ -409,38 +406,14 @@ static errno_t ds_window_repaint_preview(ds_window_t *wnd, gfx_rect_t *old_rect)
 	 * Get current preview rectangle. If the window is not being resized/moved,
 	 * we should get an empty rectangle.
 	 */
-	ds_window_get_preview_rect(wnd, &prect);
+	ds_window_get_preview_rect(wnd, &rects[0]);
+	count = 1;
 
-	oldr = (old_rect != NULL) && !gfx_rect_is_empty(old_rect);
-	newr = !gfx_rect_is_empty(&prect);
-
-	if (oldr && newr && gfx_rect_is_incident(old_rect, &prect)) {
-		/*
-		 * As an optimization, repaint both rectangles in a single
-		 * operation.
-		 */
-
-		gfx_rect_envelope(old_rect, &prect, &envelope);
-
-		rc = ds_display_paint(wnd->display, &envelope);
-		if (rc != EOK)
-			return rc;
-	} else {
-		/* Repaint each rectangle separately */
-		if (oldr) {
-			rc = ds_display_paint(wnd->display, old_rect);
-			if (rc != EOK)
-				return rc;
-		}
+	if (old_rect != NULL)
+		rects[count++] = *old_rect;
 
-		if (newr) {
-			rc = ds_display_paint(wnd->display, &prect);
-			if (rc != EOK)
-				return rc;
-		}
-	}
-
-	return EOK;
+	/* Repaint the union of both rectangles in a single operation */
+	return ds_display_paint_rects(wnd->display, rects, count);
 }
 
 /** Start moving a window by mouse drag.
@@ -475,7 +448,7 @@ static void ds_window_finish_move(ds_window_t *wnd, gfx_coord2_t *pos)
 {
 	gfx_coord2_t dmove;
 	gfx_coord2_t nwpos;
-	gfx_rect_t old_rect;
+	gfx_rect_t rects[3];
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ds_window_finish_move (%d, %d)",
 	    (int) pos->x, (int) pos->y);
@@ -485,13 +458,16 @@ static void ds_window_finish_move(ds_window_t *wnd, gfx_coord2_t *pos)
 	gfx_coord2_subtract(pos, &wnd->orig_pos, &dmove);
 	gfx_coord2_add(&wnd->dpos, &dmove, &nwpos);
 
-	ds_window_get_preview_rect(wnd, &old_rect);
+	/* Old window area, preview area and new window area */
+	gfx_rect_translate(&wnd->dpos, &wnd->rect, &rects[0]);
+	ds_window_get_preview_rect(wnd, &rects[1]);
+	gfx_rect_translate(&nwpos, &wnd->rect, &rects[2]);
 
 	wnd->dpos = nwpos;
 	wnd->state = dsw_idle;
 	wnd->orig_pos_id = 0;
 
-	(void) ds_display_paint(wnd->display, NULL);
+	(void) ds_display_paint_rects(wnd->display, rects, 3);
 }
 
 /** Update window position when moving by mouse drag.
@@ -790,8 +766,14 @@ void ds_window_move_req(ds_window_t *wnd, gfx_coord2_t *pos, sysarg_t pos_id)
  */
 void ds_window_move(ds_window_t *wnd, gfx_coord2_t *dpos)
 {
+	gfx_rect_t rects[2];
+
+	/* Repaint old and new window area */
+	gfx_rect_translate(&wnd->dpos, &wnd->rect, &rects[0]);
+	gfx_rect_translate(dpos, &wnd->rect, &rects[1]);
+
 	wnd->dpos = *dpos;
-	(void) ds_display_paint(wnd->display, NULL);
+	(void) ds_display_paint_rects(wnd->display, rects, 2);
 }
 
 /** Get window position.
@@ -59,6 +59,8 @@ static errno_t handle_log_level_change(sysarg_t new_level)
 
 	log_unlock(log);
 
+	logger_level_change_event();
+
 	return EOK;
 }
 
@@ -82,6 +84,8 @@ void logger_connection_handler_control(ipc_call_t *icall)
 		switch (ipc_get_imethod(&call)) {
 		case LOGGER_CONTROL_SET_DEFAULT_LEVEL:
 			rc = set_default_logging_level(ipc_get_arg1(&call));
+			if (rc == EOK)
+				logger_level_change_event();
 			async_answer_0(&call, rc);
 			break;
 		case LOGGER_CONTROL_SET_LOG_LEVEL:
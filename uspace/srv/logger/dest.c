@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup logger
+ * @{
+ */
+
+/** @file Log destinations (files).
+ *
+ * Messages are collected in a per-destination buffer which is written out
+ * when it fills up, periodically by a background fibril, immediately for
+ * errors and on explicit sync requests. Files exceeding DEST_ROTATE_SIZE
+ * are rotated, keeping DEST_ROTATE_KEEP older generations.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fibril.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <vfs/vfs.h>
+#include "logger.h"
+
+static FIBRIL_MUTEX_INITIALIZE(dest_list_guard);
+static LIST_INITIALIZE(dest_list);
+
+errno_t create_dest(const char *name, logger_dest_t **dest)
+{
+	logger_dest_t *result = calloc(1, sizeof(logger_dest_t));
+	if (result == NULL)
+		return ENOMEM;
+	if (asprintf(&result->filename, "/log/%s.txt", name) < 0) {
+		free(result);
+		return ENOMEM;
+	}
+	result->buffer = malloc(DEST_BUFFER_SIZE);
+	if (result->buffer == NULL) {
+		free(result->filename);
+		free(result);
+		return ENOMEM;
+	}
+	result->logfile = NULL;
+	fibril_mutex_initialize(&result->guard);
+	link_initialize(&result->link);
+
+	fibril_mutex_lock(&dest_list_guard);
+	list_append(&result->link, &dest_list);
+	fibril_mutex_unlock(&dest_list_guard);
+
+	*dest = result;
+	return EOK;
+}
+
+/** Open the log file of a destination if it is not open yet.
+ *
+ * Precondition: dest is locked.
+ */
+static void dest_open(logger_dest_t *dest)
+{
+	assert(fibril_mutex_is_locked(&dest->guard));
+
+	if (dest->logfile != NULL)
+		return;
+
+	dest->logfile = fopen(dest->filename, "a");
+	if (dest->logfile == NULL)
+		return;
+
+	dest->size = 0;
+	if (fseek(dest->logfile, 0, SEEK_END) == 0) {
+		long pos = ftell(dest->logfile);
+		if (pos > 0)
+			dest->size = pos;
+	}
+}
+
+/** Rename the log file to <name>.1, shifting older generations.
+ *
+ * Precondition: dest is locked.
+ */
+static void dest_rotate(logger_dest_t *dest)
+{
+	assert(fibril_mutex_is_locked(&dest->guard));
+
+	if (dest->logfile != NULL) {
+		fclose(dest->logfile);
+		dest->logfile = NULL;
+	}
+
+	char *old_name = NULL;
+	char *new_name = NULL;
+
+	for (unsigned i = DEST_ROTATE_KEEP; i > 0; i--) {
+		if (i > 1) {
+			if (asprintf(&old_name, "%s.%u", dest->filename,
+			    i - 1) < 0)
+				break;
+		} else {
+			old_name = str_dup(dest->filename);
+			if (old_name == NULL)
+				break;
+		}
+
+		if (asprintf(&new_name, "%s.%u", dest->filename, i) < 0) {
+			free(old_name);
+			break;
+		}
+
+		/* Older generations need not exist. */
+		(void) rename(old_name, new_name);
+
+		free(old_name);
+		free(new_name);
+	}
+
+	dest_open(dest);
+}
+
+/** Write buffered messages to the log file.
+ *
+ * Precondition: dest is locked.
+ *
+ * @param dest Destination to flush.
+ */
+static void dest_flush_locked(logger_dest_t *dest)
+{
+	assert(fibril_mutex_is_locked(&dest->guard));
+
+	if (dest->used == 0)
+		return;
+
+	dest_open(dest);
+
+	if (dest->logfile != NULL && dest->size > 0 &&
+	    dest->size + dest->used > DEST_ROTATE_SIZE)
+		dest_rotate(dest);
+
+	if (dest->logfile != NULL) {
+		fwrite(dest->buffer, 1, dest->used, dest->logfile);
+		fflush(dest->logfile);
+		dest->size += dest->used;
+	}
+
+	/* If the file cannot be opened, the messages are lost. */
+	dest->used = 0;
+}
+
+void dest_write(logger_dest_t *dest, const char *full_name,
+    log_level_t level, const char *message)
+{
+	const char *level_name = log_level_str(level);
+	size_t len = str_size(full_name) + str_size(level_name) +
+	    str_size(message) + 6;
+
+	fibril_mutex_lock(&dest->guard);
+
+	if (dest->used + len + 1 > DEST_BUFFER_SIZE)
+		dest_flush_locked(dest);
+
+	if (len + 1 > DEST_BUFFER_SIZE) {
+		/* Too long to be buffered. */
+		dest_open(dest);
+		if (dest->logfile != NULL) {
+			fprintf(dest->logfile, "[%s] %s: %s\n",
+			    full_name, level_name, message);
+			fflush(dest->logfile);
+			dest->size += len;
+		}
+	} else {
+		snprintf(dest->buffer + dest->used,
+		    DEST_BUFFER_SIZE - dest->used, "[%s] %s: %s\n",
+		    full_name, level_name, message);
+		dest->used += len;
+
+		/* Make sure errors are on disk should the system go down. */
+		if (level <= LVL_ERROR)
+			dest_flush_locked(dest);
+	}
+
+	fibril_mutex_unlock(&dest->guard);
+}
+
+void destroy_dest(logger_dest_t *dest)
+{
+	fibril_mutex_lock(&dest_list_guard);
+	list_remove(&dest->link);
+	fibril_mutex_unlock(&dest_list_guard);
+
+	fibril_mutex_lock(&dest->guard);
+	dest_flush_locked(dest);
+	/*
+	 * Due to lazy file opening, it is possible that no file was
+	 * actually opened.
+	 */
+	if (dest->logfile != NULL)
+		fclose(dest->logfile);
+	fibril_mutex_unlock(&dest->guard);
+
+	free(dest->buffer);
+	free(dest->filename);
+	free(dest);
+}
+
+/** Write out buffered messages of all destinations.
+ *
+ * @param sync Also make sure the log files are written to the storage.
+ */
+void dests_flush(bool sync)
+{
+	fibril_mutex_lock(&dest_list_guard);
+
+	list_foreach(dest_list, link, logger_dest_t, dest) {
+		fibril_mutex_lock(&dest->guard);
+		dest_flush_locked(dest);
+		if (sync && dest->logfile != NULL)
+			(void) vfs_sync(fileno(dest->logfile));
+		fibril_mutex_unlock(&dest->guard);
+	}
+
+	fibril_mutex_unlock(&dest_list_guard);
+}
+
+static errno_t dests_flush_fibril(void *arg)
+{
+	while (true) {
+		fibril_usleep(DEST_FLUSH_INTERVAL);
+		dests_flush(false);
+	}
+
+	return EOK;
+}
+
+/** Start periodic flushing of log destinations.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t dests_init(void)
+{
+	fid_t fid = fibril_create(dests_flush_fibril, NULL);
+	if (fid == 0)
+		return ENOMEM;
+
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+/**
+ * @}
+ */
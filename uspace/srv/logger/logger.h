@@ -54,10 +54,25 @@
 
 typedef struct logger_log logger_log_t;
 
+/** Size of the buffer of messages not yet written to a log file. */
+#define DEST_BUFFER_SIZE 8192
+/** Interval of writing buffered messages out (in microseconds). */
+#define DEST_FLUSH_INTERVAL 500000
+/** Log files are rotated when they grow over this size. */
+#define DEST_ROTATE_SIZE (512 * 1024)
+/** Number of rotated log files to keep. */
+#define DEST_ROTATE_KEEP 2
+
 typedef struct {
+	link_t link;
 	fibril_mutex_t guard;
 	char *filename;
 	FILE *logfile;
+	/** Size of the log file. */
+	size_t size;
+	/** Messages not yet written to the log file. */
+	char *buffer;
+	size_t used;
 } logger_dest_t;
 
 struct logger_log {
@@ -85,10 +100,17 @@ logger_log_t *find_log_by_name_and_lock(const char *name);
 logger_log_t *find_or_create_log_and_lock(const char *, sysarg_t);
 logger_log_t *find_log_by_id_and_lock(sysarg_t);
 bool shall_log_message(logger_log_t *, log_level_t);
+log_level_t get_log_level(logger_log_t *);
 void log_unlock(logger_log_t *);
 void write_to_log(logger_log_t *, log_level_t, const char *);
 void log_release(logger_log_t *);
 
+errno_t create_dest(const char *, logger_dest_t **);
+void destroy_dest(logger_dest_t *);
+void dest_write(logger_dest_t *, const char *, log_level_t, const char *);
+void dests_flush(bool);
+errno_t dests_init(void);
+
 void registered_logs_init(logger_registered_logs_t *);
 bool register_log(logger_registered_logs_t *, logger_log_t *);
 void unregister_logs(logger_registered_logs_t *);
@@ -98,6 +120,7 @@ errno_t set_default_logging_level(log_level_t);
 
 void logger_connection_handler_control(ipc_call_t *);
 void logger_connection_handler_writer(ipc_call_t *);
+void logger_level_change_event(void);
 
 void parse_initial_settings(void);
 void parse_level_settings(char *);
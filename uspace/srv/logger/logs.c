@@ -50,21 +50,6 @@ static logger_log_t *find_log_by_name_and_parent_no_list_lock(const char *name,
 	return NULL;
 }
 
-static errno_t create_dest(const char *name, logger_dest_t **dest)
-{
-	logger_dest_t *result = malloc(sizeof(logger_dest_t));
-	if (result == NULL)
-		return ENOMEM;
-	if (asprintf(&result->filename, "/log/%s.txt", name) < 0) {
-		free(result);
-		return ENOMEM;
-	}
-	result->logfile = NULL;
-	fibril_mutex_initialize(&result->guard);
-	*dest = result;
-	return EOK;
-}
-
 static logger_log_t *create_log_no_locking(const char *name, logger_log_t *parent)
 {
 	logger_log_t *result = calloc(1, sizeof(logger_log_t));
@@ -192,6 +177,14 @@ bool shall_log_message(logger_log_t *log, log_level_t level)
 	return result;
 }
 
+log_level_t get_log_level(logger_log_t *log)
+{
+	fibril_mutex_lock(&log_list_guard);
+	log_level_t result = get_actual_log_level(log);
+	fibril_mutex_unlock(&log_list_guard);
+	return result;
+}
+
 void log_unlock(logger_log_t *log)
 {
 	assert(fibril_mutex_is_locked(&log->guard));
@@ -261,15 +254,7 @@ void log_release(logger_log_t *log)
 	fibril_mutex_unlock(&log->guard);
 
 	if (log->parent == NULL) {
-		/*
-		 * Due to lazy file opening in write_to_log(),
-		 * it is possible that no file was actually opened.
-		 */
-		if (log->dest->logfile != NULL) {
-			fclose(log->dest->logfile);
-		}
-		free(log->dest->filename);
-		free(log->dest);
+		destroy_dest(log->dest);
 	} else {
 		fibril_mutex_lock(&log->parent->guard);
 		log_release(log->parent);
@@ -287,18 +272,7 @@ void write_to_log(logger_log_t *log, log_level_t level, const char *message)
 {
 	assert(fibril_mutex_is_locked(&log->guard));
 	assert(log->dest != NULL);
-	fibril_mutex_lock(&log->dest->guard);
-	if (log->dest->logfile == NULL)
-		log->dest->logfile = fopen(log->dest->filename, "a");
-
-	if (log->dest->logfile != NULL) {
-		fprintf(log->dest->logfile, "[%s] %s: %s\n",
-		    log->full_name, log_level_str(level),
-		    (const char *) message);
-		fflush(log->dest->logfile);
-	}
-
-	fibril_mutex_unlock(&log->dest->guard);
+	dest_write(log->dest, log->full_name, level, message);
 }
 
 void registered_logs_init(logger_registered_logs_t *logs)
@@ -34,6 +34,7 @@
 /** @file
  */
 
+#include <align.h>
 #include <ipc/services.h>
 #include <ipc/logger.h>
 #include <io/log.h>
@@ -43,10 +44,21 @@
 #include <async.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdalign.h>
 #include <stdlib.h>
+#include <str.h>
 #include <str_error.h>
 #include "logger.h"
 
+/** Callback session of a writer client. */
+typedef struct {
+	link_t link;
+	async_sess_t *sess;
+} logger_cb_sess_t;
+
+static FIBRIL_MUTEX_INITIALIZE(cb_sess_guard);
+static LIST_INITIALIZE(cb_sess_list);
+
 static logger_log_t *handle_create_log(sysarg_t parent)
 {
 	void *name;
@@ -91,9 +103,102 @@ leave:
 	return rc;
 }
 
+static errno_t handle_receive_messages(void)
+{
+	void *buffer = NULL;
+	size_t size;
+	errno_t rc = async_data_write_accept(&buffer, false, 0, 0, 0, &size);
+	if (rc != EOK)
+		return rc;
+
+	size_t pos = 0;
+	while (pos + sizeof(logger_batch_msg_t) <= size) {
+		logger_batch_msg_t *hdr =
+		    (logger_batch_msg_t *) ((uint8_t *) buffer + pos);
+		if (hdr->size > size - pos - sizeof(logger_batch_msg_t)) {
+			rc = EINVAL;
+			break;
+		}
+
+		char *message = str_ndup((char *) (hdr + 1), hdr->size);
+		if (message == NULL) {
+			rc = ENOMEM;
+			break;
+		}
+
+		logger_log_t *log = find_log_by_id_and_lock(hdr->log);
+		if (log != NULL) {
+			if (hdr->level < LVL_LIMIT &&
+			    shall_log_message(log, hdr->level)) {
+				KLOG_PRINTF(hdr->level, "[%s] %s: %s",
+				    log->full_name, log_level_str(hdr->level),
+				    message);
+				write_to_log(log, hdr->level, message);
+			}
+			log_unlock(log);
+		}
+
+		free(message);
+		pos += ALIGN_UP(sizeof(logger_batch_msg_t) + hdr->size,
+		    alignof(logger_batch_msg_t));
+	}
+
+	free(buffer);
+	return rc;
+}
+
+static errno_t handle_get_level(sysarg_t log_id, log_level_t *level)
+{
+	logger_log_t *log = find_log_by_id_and_lock(log_id);
+	if (log == NULL) {
+		*level = LVL_LIMIT;
+		return ENOENT;
+	}
+
+	*level = get_log_level(log);
+	log_unlock(log);
+
+	return EOK;
+}
+
+static logger_cb_sess_t *handle_callback_create(void)
+{
+	logger_cb_sess_t *cb_sess = calloc(1, sizeof(logger_cb_sess_t));
+	if (cb_sess == NULL)
+		return NULL;
+
+	cb_sess->sess = async_callback_receive(EXCHANGE_SERIALIZE);
+	if (cb_sess->sess == NULL) {
+		free(cb_sess);
+		return NULL;
+	}
+
+	fibril_mutex_lock(&cb_sess_guard);
+	list_append(&cb_sess->link, &cb_sess_list);
+	fibril_mutex_unlock(&cb_sess_guard);
+
+	return cb_sess;
+}
+
+/** Notify writer clients that logging levels have changed. */
+void logger_level_change_event(void)
+{
+	fibril_mutex_lock(&cb_sess_guard);
+
+	list_foreach(cb_sess_list, link, logger_cb_sess_t, cb_sess) {
+		async_exch_t *exch = async_exchange_begin(cb_sess->sess);
+		async_msg_0(exch, LOGGER_EVENT_LEVEL_CHANGE);
+		async_exchange_end(exch);
+	}
+
+	fibril_mutex_unlock(&cb_sess_guard);
+}
+
 void logger_connection_handler_writer(ipc_call_t *icall)
 {
 	logger_log_t *log;
+	logger_cb_sess_t *cb_sess = NULL;
+	log_level_t level;
 	errno_t rc;
 
 	/* Acknowledge the connection. */
@@ -125,20 +230,49 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 				async_answer_0(&call, ELIMIT);
 				break;
 			}
+			level = get_log_level(log);
 			log_unlock(log);
-			async_answer_1(&call, EOK, (sysarg_t) log);
+			async_answer_2(&call, EOK, (sysarg_t) log, level);
 			break;
 		case LOGGER_WRITER_MESSAGE:
 			rc = handle_receive_message(ipc_get_arg1(&call),
 			    ipc_get_arg2(&call));
 			async_answer_0(&call, rc);
 			break;
+		case LOGGER_WRITER_MESSAGES:
+			rc = handle_receive_messages();
+			async_answer_0(&call, rc);
+			break;
+		case LOGGER_WRITER_GET_LEVEL:
+			rc = handle_get_level(ipc_get_arg1(&call), &level);
+			async_answer_1(&call, rc, level);
+			break;
+		case LOGGER_WRITER_CALLBACK_CREATE:
+			if (cb_sess != NULL) {
+				async_answer_0(&call, EEXIST);
+				break;
+			}
+			cb_sess = handle_callback_create();
+			async_answer_0(&call, cb_sess != NULL ? EOK : ENOMEM);
+			break;
+		case LOGGER_WRITER_SYNC:
+			dests_flush(true);
+			async_answer_0(&call, EOK);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
 		}
 	}
 
+	if (cb_sess != NULL) {
+		fibril_mutex_lock(&cb_sess_guard);
+		list_remove(&cb_sess->link);
+		fibril_mutex_unlock(&cb_sess_guard);
+		async_hangup(cb_sess->sess);
+		free(cb_sess);
+	}
+
 	unregister_logs(&registered_logs);
 	logger_log("writer: client terminated.\n");
 }
@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
+#include <inet/offload.h>
 #include <io/log.h>
 #include <loc.h>
 #include <stdio.h>
@@ -58,6 +59,7 @@ static errno_t ethip_close(iplink_srv_t *srv);
 static errno_t ethip_send(iplink_srv_t *srv, iplink_sdu_t *sdu);
 static errno_t ethip_send6(iplink_srv_t *srv, iplink_sdu6_t *sdu);
 static errno_t ethip_get_mtu(iplink_srv_t *srv, size_t *mtu);
+static errno_t ethip_get_offload(iplink_srv_t *srv, uint32_t *offload);
 static errno_t ethip_get_mac48(iplink_srv_t *srv, eth_addr_t *mac);
 static errno_t ethip_set_mac48(iplink_srv_t *srv, eth_addr_t *mac);
 static errno_t ethip_addr_add(iplink_srv_t *srv, inet_addr_t *addr);
@@ -71,6 +73,7 @@ static iplink_ops_t ethip_iplink_ops = {
 	.send = ethip_send,
 	.send6 = ethip_send6,
 	.get_mtu = ethip_get_mtu,
+	.get_offload = ethip_get_offload,
 	.get_mac48 = ethip_get_mac48,
 	.set_mac48 = ethip_set_mac48,
 	.addr_add = ethip_addr_add,
@@ -172,6 +175,95 @@ static errno_t ethip_close(iplink_srv_t *srv)
 	return EOK;
 }
 
+/** Software offload state for ethip_send_offload_emit() */
+typedef struct {
+	ethip_nic_t *nic;
+	eth_frame_t *frame;
+} ethip_offload_t;
+
+/** Send one IPv4 packet finished by software offload. */
+static errno_t ethip_send_offload_emit(void *arg, void *data, size_t size)
+{
+	ethip_offload_t *ofl = (ethip_offload_t *) arg;
+	void *fdata;
+	size_t fsize;
+
+	ofl->frame->data = data;
+	ofl->frame->size = size;
+
+	errno_t rc = eth_pdu_encode(ofl->frame, &fdata, &fsize);
+	if (rc != EOK)
+		return rc;
+
+	rc = ethip_nic_send(ofl->nic, fdata, fsize);
+	free(fdata);
+
+	return rc;
+}
+
+/** Describe offload of IPv4 packet in terms of the Ethernet frame.
+ *
+ * @param frame   Ethernet frame carrying IPv4 packet
+ * @param offload Offload requested for the packet
+ * @param txo     Place to store NIC transmit offload
+ * @return EOK on success, EINVAL if the packet cannot be offloaded
+ */
+static errno_t ethip_tx_offload(eth_frame_t *frame, inet_offload_t *offload,
+    nic_tx_offload_t *txo)
+{
+	size_t csum_start;
+	size_t csum_offs;
+	size_t hdr_len;
+	errno_t rc;
+
+	rc = inet_offload_ip4_layout(frame->data, frame->size, &csum_start,
+	    &csum_offs, &hdr_len);
+	if (rc != EOK)
+		return rc;
+
+	txo->csum_start = sizeof(eth_header_t) + csum_start;
+	txo->csum_offset = csum_offs - csum_start;
+	txo->gso_size = offload->gso_size;
+	txo->hdr_len = sizeof(eth_header_t) + hdr_len;
+	return EOK;
+}
+
+/** Send IPv4 packet with transmit offload.
+ *
+ * The NIC performs the offload if it can, otherwise it is done in
+ * software.
+ */
+static errno_t ethip_send_offload(ethip_nic_t *nic, eth_frame_t *frame,
+    inet_offload_t *offload)
+{
+	nic_tx_offload_t txo;
+	uint32_t needed = NIC_OFFLOAD_TX_CSUM;
+
+	if (offload->gso_size != 0)
+		needed |= NIC_OFFLOAD_TSO4;
+
+	if ((nic->offload & needed) == needed &&
+	    ethip_tx_offload(frame, offload, &txo) == EOK) {
+		void *data;
+		size_t size;
+		errno_t rc = eth_pdu_encode(frame, &data, &size);
+		if (rc != EOK)
+			return rc;
+
+		rc = ethip_nic_send_offload(nic, data, size, &txo);
+		free(data);
+
+		return rc;
+	}
+
+	ethip_offload_t ofl;
+	ofl.nic = nic;
+	ofl.frame = frame;
+
+	return inet_offload_ip4(offload, frame->data, frame->size,
+	    ethip_send_offload_emit, &ofl);
+}
+
 static errno_t ethip_send(iplink_srv_t *srv, iplink_sdu_t *sdu)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_send()");
@@ -191,6 +283,9 @@ static errno_t ethip_send(iplink_srv_t *srv, iplink_sdu_t *sdu)
 	frame.data = sdu->data;
 	frame.size = sdu->size;
 
+	if (inet_offload_requested(&sdu->offload))
+		return ethip_send_offload(nic, &frame, &sdu->offload);
+
 	void *data;
 	size_t size;
 	rc = eth_pdu_encode(&frame, &data, &size);
@@ -278,6 +373,15 @@ static errno_t ethip_get_mtu(iplink_srv_t *srv, size_t *mtu)
 	return EOK;
 }
 
+static errno_t ethip_get_offload(iplink_srv_t *srv, uint32_t *offload)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_get_offload()");
+
+	/* What the NIC cannot do is done in software by ethip_send_offload() */
+	*offload = IPLINK_OFFLOAD_CSUM | IPLINK_OFFLOAD_GSO;
+	return EOK;
+}
+
 static errno_t ethip_get_mac48(iplink_srv_t *srv, eth_addr_t *mac)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_get_mac48()");
@@ -63,6 +63,9 @@ typedef struct ethip_nic {
 	/** MAC address */
 	eth_addr_t mac_addr;
 
+	/** Transmit offloads enabled on the NIC (NIC_OFFLOAD_xxx) */
+	uint32_t offload;
+
 	/**
 	 * List of IP addresses configured on this link
 	 * (of the type ethip_link_addr_t)
@@ -195,6 +195,20 @@ static errno_t ethip_nic_open(service_id_t sid)
 
 	eth_addr_decode(nic_address.address, &nic->mac_addr);
 
+	/*
+	 * Let the NIC finish checksums and segment TCP if it can. Whatever
+	 * it cannot do is done in software before sending the frame.
+	 */
+	uint32_t supported;
+	uint32_t active;
+	rc = nic_offload_probe(nic->sess, &supported, &active);
+	if (rc == EOK) {
+		supported &= NIC_OFFLOAD_TX_CSUM | NIC_OFFLOAD_TSO4;
+		rc = nic_offload_set(nic->sess, supported, supported);
+		if (rc == EOK)
+			nic->offload = supported;
+	}
+
 	rc = nic_set_state(nic->sess, NIC_STATE_ACTIVE);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Error activating NIC '%s'.",
@@ -360,6 +374,18 @@ errno_t ethip_nic_send(ethip_nic_t *nic, void *data, size_t size)
 	return rc;
 }
 
+errno_t ethip_nic_send_offload(ethip_nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	errno_t rc;
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_send_offload(size=%zu, "
+	    "gso_size=%u)", size, (unsigned) offload->gso_size);
+	rc = nic_send_frame_offload(nic->sess, data, size, offload);
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "nic_send_frame_offload -> %s",
+	    str_error_name(rc));
+	return rc;
+}
+
 /** Setup accepted multicast addresses
  *
  * Currently the set of accepted multicast addresses is
@@ -38,6 +38,7 @@
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
+#include <inet/rtable.h>
 #include <io/log.h>
 #include <ipc/loc.h>
 #include <sif.h>
@@ -48,11 +49,16 @@
 #include "inetsrv.h"
 #include "inet_link.h"
 #include "ndp.h"
+#include "rcache.h"
 
 static inet_addrobj_t *inet_addrobj_find_by_name_locked(const char *, inet_link_t *);
 
 static FIBRIL_MUTEX_INITIALIZE(addr_list_lock);
 static LIST_INITIALIZE(addr_list);
+/** Networks of address objects, for finding by network (using mask) */
+static INET_RTABLE_INITIALIZE(addr_net_rtable);
+/** Addresses of address objects, for finding by local address */
+static INET_RTABLE_INITIALIZE(addr_host_rtable);
 static sysarg_t addr_id = 0;
 
 inet_addrobj_t *inet_addrobj_new(void)
@@ -83,6 +89,13 @@ void inet_addrobj_delete(inet_addrobj_t *addr)
 errno_t inet_addrobj_add(inet_addrobj_t *addr)
 {
 	inet_addrobj_t *aobj;
+	inet_addr_t host;
+	inet_naddr_t hnaddr;
+	errno_t rc;
+
+	/* Local address as a network with full-length prefix */
+	inet_naddr_addr(&addr->naddr, &host);
+	inet_addr_naddr(&host, host.version == ip_v4 ? 32 : 128, &hnaddr);
 
 	fibril_mutex_lock(&addr_list_lock);
 	aobj = inet_addrobj_find_by_name_locked(addr->name, addr->ilink);
@@ -92,9 +105,25 @@ errno_t inet_addrobj_add(inet_addrobj_t *addr)
 		return EEXIST;
 	}
 
+	rc = inet_rtable_insert(&addr_net_rtable, &addr->naddr,
+	    &addr->net_entry, addr);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&addr_list_lock);
+		return rc;
+	}
+
+	rc = inet_rtable_insert(&addr_host_rtable, &hnaddr,
+	    &addr->addr_entry, addr);
+	if (rc != EOK) {
+		inet_rtable_remove(&addr_net_rtable, &addr->net_entry);
+		fibril_mutex_unlock(&addr_list_lock);
+		return rc;
+	}
+
 	list_append(&addr->addr_list, &addr_list);
 	fibril_mutex_unlock(&addr_list_lock);
 
+	inet_rcache_invalidate();
 	return EOK;
 }
 
@@ -102,45 +131,45 @@ void inet_addrobj_remove(inet_addrobj_t *addr)
 {
 	fibril_mutex_lock(&addr_list_lock);
 	list_remove(&addr->addr_list);
+	inet_rtable_remove(&addr_net_rtable, &addr->net_entry);
+	inet_rtable_remove(&addr_host_rtable, &addr->addr_entry);
 	fibril_mutex_unlock(&addr_list_lock);
+
+	inet_rcache_invalidate();
 }
 
 /** Find address object matching address @a addr.
  *
  * @param addr Address
- * @oaram find iaf_net to find network (using mask),
- *             iaf_addr to find local address (exact match)
+ * @oaram find iaf_net to find network (using mask, the most specific
+ *             network wins), iaf_addr to find local address (exact match)
  *
  */
 inet_addrobj_t *inet_addrobj_find(inet_addr_t *addr, inet_addrobj_find_t find)
 {
+	inet_addrobj_t *naddr = NULL;
+
 	fibril_mutex_lock(&addr_list_lock);
 
-	list_foreach(addr_list, addr_list, inet_addrobj_t, naddr) {
-		switch (find) {
-		case iaf_net:
-			if (inet_naddr_compare_mask(&naddr->naddr, addr)) {
-				fibril_mutex_unlock(&addr_list_lock);
-				log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: found %p",
-				    naddr);
-				return naddr;
-			}
-			break;
-		case iaf_addr:
-			if (inet_naddr_compare(&naddr->naddr, addr)) {
-				fibril_mutex_unlock(&addr_list_lock);
-				log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: found %p",
-				    naddr);
-				return naddr;
-			}
-			break;
-		}
+	switch (find) {
+	case iaf_net:
+		naddr = inet_rtable_lookup(&addr_net_rtable, addr);
+		break;
+	case iaf_addr:
+		naddr = inet_rtable_lookup(&addr_host_rtable, addr);
+		break;
 	}
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: Not found");
 	fibril_mutex_unlock(&addr_list_lock);
 
-	return NULL;
+	if (naddr != NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: found %p",
+		    naddr);
+	} else {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_addrobj_find: Not found");
+	}
+
+	return naddr;
 }
 
 /** Find address object on a link, with a specific name.
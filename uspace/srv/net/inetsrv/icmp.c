@@ -108,6 +108,8 @@ static errno_t icmp_recv_echo_request(inet_dgram_t *dgram)
 	rdgram.src = dgram->dest;
 	rdgram.dest = dgram->src;
 	rdgram.tos = ICMP_TOS;
+	rdgram.offload.csum_partial = false;
+	rdgram.offload.gso_size = 0;
 	rdgram.data = reply;
 	rdgram.size = size;
 
@@ -166,6 +168,8 @@ errno_t icmp_ping_send(uint16_t ident, inetping_sdu_t *sdu)
 	dgram.dest = sdu->dest;
 	dgram.iplink = 0;
 	dgram.tos = ICMP_TOS;
+	dgram.offload.csum_partial = false;
+	dgram.offload.gso_size = 0;
 	dgram.data = rdata;
 	dgram.size = rsize;
 
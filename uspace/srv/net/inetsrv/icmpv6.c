@@ -81,6 +81,8 @@ static errno_t icmpv6_recv_echo_request(inet_dgram_t *dgram)
 	rdgram.dest = dgram->src;
 	rdgram.iplink = 0;
 	rdgram.tos = 0;
+	rdgram.offload.csum_partial = false;
+	rdgram.offload.gso_size = 0;
 	rdgram.data = reply;
 	rdgram.size = size;
 
@@ -179,6 +181,8 @@ errno_t icmpv6_ping_send(uint16_t ident, inetping_sdu_t *sdu)
 	dgram.dest = sdu->dest;
 	dgram.iplink = 0;
 	dgram.tos = 0;
+	dgram.offload.csum_partial = false;
+	dgram.offload.gso_size = 0;
 	dgram.data = rdata;
 	dgram.size = rsize;
 
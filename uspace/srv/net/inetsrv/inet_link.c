@@ -34,11 +34,13 @@
  * @brief
  */
 
+#include <align.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/dhcp.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink.h>
+#include <inet/offload.h>
 #include <io/log.h>
 #include <loc.h>
 #include <stdbool.h>
@@ -48,6 +50,7 @@
 #include "addrobj.h"
 #include "inetsrv.h"
 #include "inet_link.h"
+#include "inet_std.h"
 #include "pdu.h"
 
 static bool first_link = true;
@@ -211,6 +214,11 @@ static errno_t inet_link_open_locked(service_id_t sid)
 		goto error;
 	}
 
+	/* Assume no offload if the link cannot tell */
+	rc = iplink_get_offload(ilink->iplink, &ilink->offload);
+	if (rc != EOK)
+		ilink->offload = 0;
+
 	/*
 	 * Get the MAC address of the link. If the link has a MAC
 	 * address, we assume that it supports NDP.
@@ -324,6 +332,32 @@ errno_t inet_link_open(service_id_t sid)
 	return rc;
 }
 
+/** Software offload state for inet_link_send_offload_emit() */
+typedef struct {
+	inet_link_t *ilink;
+	addr32_t lsrc;
+	addr32_t ldest;
+	inet_dgram_t *dgram;
+	uint8_t proto;
+	uint8_t ttl;
+	int df;
+} inet_link_offload_t;
+
+/** Send one datagram finished by software offload. */
+static errno_t inet_link_send_offload_emit(void *arg, void *data, size_t size)
+{
+	inet_link_offload_t *ofl = (inet_link_offload_t *) arg;
+	inet_dgram_t dgram = *ofl->dgram;
+
+	dgram.data = data;
+	dgram.size = size;
+	dgram.offload.csum_partial = false;
+	dgram.offload.gso_size = 0;
+
+	return inet_link_send_dgram(ofl->ilink, ofl->lsrc, ofl->ldest, &dgram,
+	    ofl->proto, ofl->ttl, ofl->df);
+}
+
 /** Send IPv4 datagram over Internet link
  *
  * @param ilink Internet link
@@ -334,6 +368,10 @@ errno_t inet_link_open(service_id_t sid)
  * @param ttl   Time-to-live
  * @param df    Do-not-Fragment flag
  *
+ * If the datagram requests transmit offload (partial checksum or
+ * segmentation) and the link accepts it, the datagram is passed to the link
+ * in one piece. Otherwise the offload is performed here in software.
+ *
  * @return EOK on success
  * @return ENOMEM when not enough memory to create the datagram
  * @return ENOTSUP if networking mode is not supported
@@ -361,6 +399,40 @@ errno_t inet_link_send_dgram(inet_link_t *ilink, addr32_t lsrc, addr32_t ldest,
 
 	sdu.src = lsrc;
 	sdu.dest = ldest;
+	sdu.offload.csum_partial = false;
+	sdu.offload.gso_size = 0;
+
+	size_t mtu = ilink->def_mtu;
+
+	if (inet_offload_requested(&dgram->offload)) {
+		uint32_t needed = IPLINK_OFFLOAD_CSUM;
+		if (dgram->offload.gso_size != 0)
+			needed |= IPLINK_OFFLOAD_GSO;
+
+		if ((ilink->offload & needed) != needed) {
+			inet_link_offload_t ofl;
+
+			ofl.ilink = ilink;
+			ofl.lsrc = lsrc;
+			ofl.ldest = ldest;
+			ofl.dgram = dgram;
+			ofl.proto = proto;
+			ofl.ttl = ttl;
+			ofl.df = df;
+
+			return inet_offload_l4(&dgram->offload, src_v4, dest_v4,
+			    proto, dgram->data, dgram->size,
+			    inet_link_send_offload_emit, &ofl);
+		}
+
+		/* The link segments the datagram, it must not be fragmented */
+		if (sizeof(ip_header_t) + dgram->size > UINT16_MAX)
+			return ELIMIT;
+
+		mtu = sizeof(ip_header_t) +
+		    ALIGN_UP(dgram->size, FRAG_OFFS_UNIT);
+		sdu.offload = dgram->offload;
+	}
 
 	inet_packet_t packet;
 
@@ -386,7 +458,7 @@ errno_t inet_link_send_dgram(inet_link_t *ilink, addr32_t lsrc, addr32_t ldest,
 		/* Encode one fragment */
 
 		size_t roffs;
-		rc = inet_pdu_encode(&packet, src_v4, dest_v4, offs, ilink->def_mtu,
+		rc = inet_pdu_encode(&packet, src_v4, dest_v4, offs, mtu,
 		    &sdu.data, &sdu.size, &roffs);
 		if (rc != EOK)
 			return rc;
@@ -427,6 +499,10 @@ errno_t inet_link_send_dgram6(inet_link_t *ilink, eth_addr_t *ldest,
 	if (dest_ver != ip_v6)
 		return EINVAL;
 
+	/* Transmit offload is only implemented for IPv4 */
+	if (inet_offload_requested(&dgram->offload))
+		return ENOTSUP;
+
 	iplink_sdu6_t sdu6;
 	sdu6.dest = *ldest;
 
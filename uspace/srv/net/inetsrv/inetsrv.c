@@ -39,6 +39,7 @@
 #include <errno.h>
 #include <str_error.h>
 #include <fibril_synch.h>
+#include <inet/offload.h>
 #include <io/log.h>
 #include <ipc/inet.h>
 #include <ipc/services.h>
@@ -57,6 +58,7 @@
 #include "inetcfg.h"
 #include "inetping.h"
 #include "inet_link.h"
+#include "rcache.h"
 #include "reass.h"
 #include "sroute.h"
 
@@ -158,10 +160,14 @@ static errno_t inet_find_dir(inet_addr_t *src, inet_addr_t *dest, uint8_t tos,
     inet_dir_t *dir)
 {
 	inet_sroute_t *sr;
+	uint64_t gen;
 
 	/* XXX Handle case where source address is specified */
 	(void) src;
 
+	if (inet_rcache_lookup(dest, dir, &gen))
+		return EOK;
+
 	dir->aobj = inet_addrobj_find(dest, iaf_net);
 	if (dir->aobj != NULL) {
 		dir->ldest = *dest;
@@ -181,6 +187,7 @@ static errno_t inet_find_dir(inet_addr_t *src, inet_addr_t *dest, uint8_t tos,
 		return ENOENT;
 	}
 
+	inet_rcache_insert(dest, dir, gen);
 	return EOK;
 }
 
@@ -316,6 +323,7 @@ static void inet_send_srv(inet_client_t *client, ipc_call_t *icall)
 
 	uint8_t ttl = ipc_get_arg3(icall);
 	int df = ipc_get_arg4(icall);
+	inet_offload_decode(ipc_get_arg5(icall), &dgram.offload);
 
 	ipc_call_t call;
 	size_t size;
@@ -42,6 +42,7 @@
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink.h>
+#include <inet/rtable.h>
 #include <ipc/loc.h>
 #include <sif.h>
 #include <stddef.h>
@@ -110,6 +111,8 @@ typedef struct {
 	async_sess_t *sess;
 	iplink_t *iplink;
 	size_t def_mtu;
+	/** Transmit offloads accepted by the link (IPLINK_OFFLOAD_xxx) */
+	uint32_t offload;
 	eth_addr_t mac;
 	bool mac_valid;
 } inet_link_t;
@@ -124,6 +127,10 @@ typedef struct {
 typedef struct {
 	/** Link to list of addresses */
 	link_t addr_list;
+	/** Entry in table of networks */
+	inet_rtable_entry_t net_entry;
+	/** Entry in table of local addresses */
+	inet_rtable_entry_t addr_entry;
 	/** Address object ID */
 	sysarg_t id;
 	/** Network address */
@@ -139,6 +146,8 @@ typedef struct {
 /** Static route configuration */
 typedef struct {
 	link_t sroute_list;
+	/** Entry in table of static routes */
+	inet_rtable_entry_t rtable_entry;
 	/** ID */
 	sysarg_t id;
 	/** Destination network */
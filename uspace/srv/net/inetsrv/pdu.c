@@ -479,6 +479,8 @@ errno_t ndp_pdu_encode(ndp_packet_t *ndp, inet_dgram_t *dgram)
 	inet_addr_set6(ndp->sender_proto_addr, &dgram->src);
 	inet_addr_set6(ndp->target_proto_addr, &dgram->dest);
 	dgram->tos = 0;
+	dgram->offload.csum_partial = false;
+	dgram->offload.gso_size = 0;
 	dgram->size = sizeof(icmpv6_message_t) + sizeof(ndp_message_t);
 
 	dgram->data = calloc(1, dgram->size);
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup inet
+ * @{
+ */
+/**
+ * @file
+ * @brief Route cache
+ *
+ * Remembers the direction (next hop) for recently used destinations so
+ * that routing a packet does not need to consult the address objects and
+ * static routes. The cache is direct-mapped and all entries are
+ * invalidated at once by bumping the generation number whenever the
+ * address objects or static routes change.
+ */
+
+#include <fibril_synch.h>
+#include <inet/addr.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "inetsrv.h"
+#include "rcache.h"
+
+/** Number of cache entries (must be a power of two) */
+#define RCACHE_SIZE 256
+
+/** Route cache entry */
+typedef struct {
+	/** Generation in which the entry was filled in */
+	uint64_t gen;
+	/** Destination address */
+	inet_addr_t dest;
+	/** Direction to @c dest */
+	inet_dir_t dir;
+} inet_rcache_entry_t;
+
+static FIBRIL_MUTEX_INITIALIZE(rcache_lock);
+static inet_rcache_entry_t rcache[RCACHE_SIZE];
+/** Current generation, entries from other generations are not valid */
+static uint64_t rcache_gen = 1;
+
+/** Compute cache index for destination address. */
+static size_t inet_rcache_index(inet_addr_t *dest)
+{
+	uint32_t hash;
+	size_t i;
+
+	switch (dest->version) {
+	case ip_v4:
+		hash = dest->addr;
+		break;
+	case ip_v6:
+		hash = 0;
+		for (i = 0; i < sizeof(addr128_t); i++)
+			hash = (hash << 5) - hash + dest->addr6[i];
+		break;
+	default:
+		hash = 0;
+		break;
+	}
+
+	/* Fibonacci hashing */
+	hash *= 2654435761U;
+	return (hash >> 24) & (RCACHE_SIZE - 1);
+}
+
+/** Look up direction to destination in route cache.
+ *
+ * @param dest Destination address
+ * @param dir  Place to store direction on success
+ * @param rgen Place to store current generation, to be passed to
+ *             inet_rcache_insert() on a miss
+ * @return @c true if found, @c false otherwise
+ */
+bool inet_rcache_lookup(inet_addr_t *dest, inet_dir_t *dir, uint64_t *rgen)
+{
+	inet_rcache_entry_t *entry = &rcache[inet_rcache_index(dest)];
+	bool found = false;
+
+	fibril_mutex_lock(&rcache_lock);
+
+	if (entry->gen == rcache_gen && inet_addr_compare(&entry->dest, dest)) {
+		*dir = entry->dir;
+		found = true;
+	}
+
+	*rgen = rcache_gen;
+	fibril_mutex_unlock(&rcache_lock);
+
+	return found;
+}
+
+/** Insert direction to destination into route cache.
+ *
+ * If the cache was invalidated since @a gen was obtained, the direction
+ * may be stale and is not inserted.
+ *
+ * @param dest Destination address
+ * @param dir  Direction to @a dest
+ * @param gen  Generation returned by inet_rcache_lookup()
+ */
+void inet_rcache_insert(inet_addr_t *dest, inet_dir_t *dir, uint64_t gen)
+{
+	inet_rcache_entry_t *entry = &rcache[inet_rcache_index(dest)];
+
+	fibril_mutex_lock(&rcache_lock);
+
+	if (gen == rcache_gen) {
+		entry->gen = gen;
+		entry->dest = *dest;
+		entry->dir = *dir;
+	}
+
+	fibril_mutex_unlock(&rcache_lock);
+}
+
+/** Invalidate all entries in the route cache.
+ *
+ * Must be called whenever address objects or static routes change.
+ */
+void inet_rcache_invalidate(void)
+{
+	fibril_mutex_lock(&rcache_lock);
+	++rcache_gen;
+	fibril_mutex_unlock(&rcache_lock);
+}
+
+/** @}
+ */
@@ -37,6 +37,7 @@
 #include <bitops.h>
 #include <errno.h>
 #include <fibril_synch.h>
+#include <inet/rtable.h>
 #include <io/log.h>
 #include <ipc/loc.h>
 #include <sif.h>
@@ -46,9 +47,12 @@
 #include "sroute.h"
 #include "inetsrv.h"
 #include "inet_link.h"
+#include "rcache.h"
 
 static FIBRIL_MUTEX_INITIALIZE(sroute_list_lock);
 static LIST_INITIALIZE(sroute_list);
+/** Destinations of static routes */
+static INET_RTABLE_INITIALIZE(sroute_rtable);
 static sysarg_t sroute_id = 0;
 
 inet_sroute_t *inet_sroute_new(void)
@@ -76,59 +80,56 @@ void inet_sroute_delete(inet_sroute_t *sroute)
 	free(sroute);
 }
 
-void inet_sroute_add(inet_sroute_t *sroute)
+errno_t inet_sroute_add(inet_sroute_t *sroute)
 {
+	errno_t rc;
+
 	fibril_mutex_lock(&sroute_list_lock);
+
+	rc = inet_rtable_insert(&sroute_rtable, &sroute->dest,
+	    &sroute->rtable_entry, sroute);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&sroute_list_lock);
+		return rc;
+	}
+
 	list_append(&sroute->sroute_list, &sroute_list);
 	fibril_mutex_unlock(&sroute_list_lock);
+
+	inet_rcache_invalidate();
+	return EOK;
 }
 
 void inet_sroute_remove(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
 	list_remove(&sroute->sroute_list);
+	inet_rtable_remove(&sroute_rtable, &sroute->rtable_entry);
 	fibril_mutex_unlock(&sroute_list_lock);
+
+	inet_rcache_invalidate();
 }
 
 /** Find static route object matching address @a addr.
+ *
+ * Of the matching routes, the most specific one is returned.
  *
  * @param addr	Address
  */
 inet_sroute_t *inet_sroute_find(inet_addr_t *addr)
 {
-	ip_ver_t addr_ver = inet_addr_get(addr, NULL, NULL);
-
-	inet_sroute_t *best = NULL;
-	uint8_t best_bits = 0;
+	inet_sroute_t *best;
 
 	fibril_mutex_lock(&sroute_list_lock);
+	best = inet_rtable_lookup(&sroute_rtable, addr);
+	fibril_mutex_unlock(&sroute_list_lock);
 
-	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
-		uint8_t dest_bits;
-		ip_ver_t dest_ver = inet_naddr_get(&sroute->dest, NULL, NULL,
-		    &dest_bits);
-
-		/* Skip comparison with different address family */
-		if (addr_ver != dest_ver)
-			continue;
-
-		/* Look for the most specific route */
-		if ((best != NULL) && (best_bits >= dest_bits))
-			continue;
-
-		if (inet_naddr_compare_mask(&sroute->dest, addr)) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found candidate %p",
-			    sroute);
-
-			best = sroute;
-			best_bits = dest_bits;
-		}
-	}
-
-	if (best == NULL)
+	if (best != NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found %p",
+		    best);
+	} else {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
-
-	fibril_mutex_unlock(&sroute_list_lock);
+	}
 
 	return best;
 }
@@ -271,7 +272,12 @@ static errno_t inet_sroute_load(sif_node_t *nroute)
 		return ENOMEM;
 	}
 
-	inet_sroute_add(sroute);
+	rc = inet_sroute_add(sroute);
+	if (rc != EOK) {
+		inet_sroute_delete(sroute);
+		return rc;
+	}
+
 	return EOK;
 }
 
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup tcp
+ * @{
+ */
+
+/**
+ * @file TCP congestion control
+ *
+ * Slow start, fast retransmit and fast recovery are implemented here
+ * according to RFC 5681 and RFC 6582 (NewReno). The way the congestion
+ * window grows and shrinks is delegated to a congestion control algorithm,
+ * currently NewReno (the default) or CUBIC (RFC 9438).
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <io/log.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdint.h>
+#include <str.h>
+#include <time.h>
+
+#include "cc.h"
+#include "seq_no.h"
+#include "tcp_type.h"
+
+/** Upper limit on the congestion window */
+#define TCP_CWND_MAX (1024 * 1024 * 1024)
+
+/** CUBIC multiplicative decrease factor (beta = 0.7) */
+#define CUBIC_BETA_NUM 7
+#define CUBIC_BETA_DEN 10
+
+/** Limit on |t - K| in ms so that the cube fits in 64 bits */
+#define CUBIC_T_MAX (1 << 20)
+
+static void tcp_newreno_init(tcp_conn_t *);
+static void tcp_newreno_ack(tcp_conn_t *, uint32_t);
+static void tcp_newreno_loss(tcp_conn_t *);
+static void tcp_cubic_init(tcp_conn_t *);
+static void tcp_cubic_ack(tcp_conn_t *, uint32_t);
+static void tcp_cubic_loss(tcp_conn_t *);
+
+static tcp_cc_ops_t tcp_cc_newreno = {
+	.name = "newreno",
+	.init = tcp_newreno_init,
+	.ack = tcp_newreno_ack,
+	.loss = tcp_newreno_loss
+};
+
+static tcp_cc_ops_t tcp_cc_cubic = {
+	.name = "cubic",
+	.init = tcp_cubic_init,
+	.ack = tcp_cubic_ack,
+	.loss = tcp_cubic_loss
+};
+
+static tcp_cc_ops_t *tcp_cc_algs[] = {
+	&tcp_cc_newreno,
+	&tcp_cc_cubic,
+	NULL
+};
+
+/** Algorithm used for new connections */
+static tcp_cc_ops_t *tcp_cc_default = &tcp_cc_newreno;
+
+/** Select congestion control algorithm for new connections.
+ *
+ * @param name	Algorithm name
+ * @return	EOK on success, ENOENT if there is no such algorithm
+ */
+errno_t tcp_cc_set_default(const char *name)
+{
+	tcp_cc_ops_t **alg;
+
+	for (alg = tcp_cc_algs; *alg != NULL; alg++) {
+		if (str_cmp((*alg)->name, name) == 0) {
+			tcp_cc_default = *alg;
+			return EOK;
+		}
+	}
+
+	return ENOENT;
+}
+
+/** Number of bytes in flight (sent, but not yet acknowledged). */
+static uint32_t tcp_cc_flight(tcp_conn_t *conn)
+{
+	return conn->snd_nxt - conn->snd_una;
+}
+
+/** Increase congestion window.
+ *
+ * @param cc	Congestion control state
+ * @param inc	Number of bytes to add
+ */
+static void tcp_cc_grow(tcp_cc_t *cc, uint32_t inc)
+{
+	cc->cwnd = min((uint64_t) cc->cwnd + inc, TCP_CWND_MAX);
+}
+
+/** Initialize congestion control state of a new connection.
+ *
+ * @param conn	Connection
+ */
+void tcp_cc_init(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	cc->ops = tcp_cc_default;
+	tcp_cc_set_smss(conn, TCP_MSS);
+
+	cc->ssthresh = UINT32_MAX;
+	cc->ca_acked = 0;
+	cc->dupacks = 0;
+	cc->in_recovery = false;
+	cc->recover = conn->iss;
+
+	cc->ops->init(conn);
+}
+
+/** Set sender maximum segment size.
+ *
+ * Also sets the initial window accordingly, this must only be called
+ * before any data is sent.
+ *
+ * @param conn	Connection
+ * @param smss	Sender maximum segment size
+ */
+void tcp_cc_set_smss(tcp_conn_t *conn, uint32_t smss)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	assert(smss > 0);
+	cc->smss = smss;
+
+	/* Initial window (RFC 5681 section 3.1) */
+	if (cc->smss > 2190)
+		cc->cwnd = 2 * cc->smss;
+	else if (cc->smss > 1095)
+		cc->cwnd = 3 * cc->smss;
+	else
+		cc->cwnd = 4 * cc->smss;
+}
+
+/** Determine how much more data the congestion window allows to send.
+ *
+ * @param conn	Connection
+ * @return	Number of bytes
+ */
+uint32_t tcp_cc_avail(tcp_conn_t *conn)
+{
+	uint32_t flight = tcp_cc_flight(conn);
+
+	if (flight >= conn->cc.cwnd)
+		return 0;
+
+	return conn->cc.cwnd - flight;
+}
+
+/** New data has been acknowledged.
+ *
+ * @param conn	Connection
+ * @param acked	Number of newly acknowledged bytes
+ * @return	@c true if the ACK is partial and the first unacknowledged
+ *		segment should be retransmitted
+ */
+bool tcp_cc_ack(tcp_conn_t *conn, uint32_t acked)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	cc->dupacks = 0;
+
+	if (!cc->in_recovery) {
+		/*
+		 * Do not grow the window while the receive window is what
+		 * limits us, cwnd would lose any relation to the path.
+		 */
+		if (cc->cwnd < 2 * (uint64_t) conn->snd_wnd)
+			cc->ops->ack(conn, acked);
+		return false;
+	}
+
+	if (seq_no_recover_acked(conn)) {
+		/* Full acknowledgement, leave fast recovery */
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Fast recovery done.",
+		    conn->name);
+		cc->in_recovery = false;
+		cc->cwnd = min(cc->ssthresh,
+		    max(tcp_cc_flight(conn), cc->smss) + cc->smss);
+		cc->ca_acked = 0;
+		return false;
+	}
+
+	/*
+	 * Partial acknowledgement. Deflate the window by the amount of data
+	 * acknowledged and add back one segment (RFC 6582 section 3.2).
+	 */
+	cc->cwnd -= min(acked, cc->cwnd);
+	if (acked >= cc->smss)
+		cc->cwnd += cc->smss;
+	cc->cwnd = max(cc->cwnd, cc->smss);
+	return true;
+}
+
+/** Duplicate ACK has been received.
+ *
+ * @param conn	Connection
+ * @return	@c true if the first unacknowledged segment should be
+ *		retransmitted now (fast retransmit)
+ */
+bool tcp_cc_dup_ack(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	++cc->dupacks;
+
+	if (cc->in_recovery) {
+		/* Another segment has left the network, inflate window */
+		tcp_cc_grow(cc, cc->smss);
+		return false;
+	}
+
+	if (cc->dupacks != TCP_DUPACK_THRESH)
+		return false;
+
+	/* Losses from a window we already recovered from do not count */
+	if (!seq_no_recover_passed(conn))
+		return false;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Fast retransmit, cwnd=%" PRIu32,
+	    conn->name, cc->cwnd);
+
+	cc->recover = conn->snd_nxt;
+	cc->ops->loss(conn);
+	cc->cwnd = cc->ssthresh + TCP_DUPACK_THRESH * cc->smss;
+	cc->in_recovery = true;
+	return true;
+}
+
+/** Retransmission timer has expired.
+ *
+ * @param conn	Connection
+ * @param first	@c true if this is the first timeout for the segment
+ */
+void tcp_cc_timeout(tcp_conn_t *conn, bool first)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	/* Repeated timeouts of the same segment keep ssthresh unchanged */
+	if (first)
+		cc->ops->loss(conn);
+
+	/* Loss window */
+	cc->cwnd = cc->smss;
+	cc->ca_acked = 0;
+	cc->dupacks = 0;
+	cc->in_recovery = false;
+	cc->recover = conn->snd_nxt;
+}
+
+/** Slow start, grow by at most one segment per ACK. */
+static void tcp_cc_slow_start(tcp_cc_t *cc, uint32_t acked)
+{
+	tcp_cc_grow(cc, min(acked, cc->smss));
+}
+
+static void tcp_newreno_init(tcp_conn_t *conn)
+{
+	/* NewReno keeps no state besides cwnd and ssthresh */
+}
+
+static void tcp_newreno_ack(tcp_conn_t *conn, uint32_t acked)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	if (cc->cwnd < cc->ssthresh) {
+		tcp_cc_slow_start(cc, acked);
+		return;
+	}
+
+	/* Congestion avoidance, one segment per window of data acked */
+	cc->ca_acked += acked;
+	if (cc->ca_acked >= cc->cwnd) {
+		cc->ca_acked -= cc->cwnd;
+		tcp_cc_grow(cc, cc->smss);
+	}
+}
+
+static void tcp_newreno_loss(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	cc->ssthresh = max(tcp_cc_flight(conn) / 2, 2 * cc->smss);
+}
+
+/** Integer cube root.
+ *
+ * @param x	Argument
+ * @return	Largest y such that y^3 <= x
+ */
+static uint64_t tcp_cubic_cbrt(uint64_t x)
+{
+	uint64_t y = 0;
+	uint64_t b;
+	int s;
+
+	for (s = 63; s >= 0; s -= 3) {
+		y <<= 1;
+		b = 3 * y * (y + 1) + 1;
+		if ((x >> s) >= b) {
+			x -= b << s;
+			y++;
+		}
+	}
+
+	return y;
+}
+
+static void tcp_cubic_init(tcp_conn_t *conn)
+{
+	memset(&conn->cc.cubic, 0, sizeof(tcp_cubic_t));
+}
+
+/** Start a new congestion avoidance epoch.
+ *
+ * @param cc	Congestion control state
+ * @param now	Current time
+ */
+static void tcp_cubic_epoch_start(tcp_cc_t *cc, struct timespec *now)
+{
+	tcp_cubic_t *cubic = &cc->cubic;
+
+	cubic->epoch_valid = true;
+	cubic->epoch = *now;
+	cubic->w_est = cc->cwnd;
+	cubic->est_acked = 0;
+
+	if (cubic->w_max <= cc->cwnd) {
+		cubic->w_max = cc->cwnd;
+		cubic->k = 0;
+		return;
+	}
+
+	/* K = cbrt((W_max - cwnd) / C) with C = 0.4 segments/s^3, in ms */
+	cubic->k = tcp_cubic_cbrt((uint64_t) (cubic->w_max - cc->cwnd) *
+	    2500000000ULL / cc->smss);
+}
+
+static void tcp_cubic_ack(tcp_conn_t *conn, uint32_t acked)
+{
+	tcp_cc_t *cc = &conn->cc;
+	tcp_cubic_t *cubic = &cc->cubic;
+	struct timespec now;
+	uint64_t t;
+	uint64_t offs;
+	uint64_t delta;
+	uint64_t target;
+	uint64_t est_thresh;
+
+	if (cc->cwnd < cc->ssthresh) {
+		tcp_cc_slow_start(cc, acked);
+		return;
+	}
+
+	getuptime(&now);
+	if (!cubic->epoch_valid)
+		tcp_cubic_epoch_start(cc, &now);
+
+	/* Time since start of the epoch plus one RTT, in ms */
+	t = (NSEC2USEC(ts_sub_diff(&now, &cubic->epoch)) +
+	    conn->retransmit.srtt) / 1000;
+
+	/* W_cubic(t) = C * (t - K)^3 + W_max */
+	offs = t > cubic->k ? t - cubic->k : cubic->k - t;
+	offs = min(offs, CUBIC_T_MAX);
+	delta = offs * offs * offs / 1000000 * cc->smss * 4 / 10000;
+	if (t > cubic->k)
+		target = cubic->w_max + delta;
+	else
+		target = cubic->w_max > delta ? cubic->w_max - delta : 0;
+
+	/*
+	 * Reno-friendly estimate grows by 3 * (1 - beta) / (1 + beta),
+	 * i.e. about 9/17 segment per window of data acked.
+	 */
+	est_thresh = (uint64_t) cc->cwnd * 17 / 9;
+	cubic->est_acked += acked;
+	if (cubic->est_acked >= est_thresh) {
+		cubic->est_acked -= est_thresh;
+		cubic->w_est += cc->smss;
+	}
+
+	if (cubic->w_est > target)
+		target = cubic->w_est;
+
+	/* Do not grow by more than half the window per round trip */
+	target = min(target, (uint64_t) cc->cwnd * 3 / 2);
+
+	if (target > cc->cwnd)
+		tcp_cc_grow(cc, (target - cc->cwnd) * acked / cc->cwnd);
+}
+
+static void tcp_cubic_loss(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+	tcp_cubic_t *cubic = &cc->cubic;
+
+	cubic->epoch_valid = false;
+
+	/* Fast convergence, release bandwidth to newer flows */
+	if (cc->cwnd < cubic->w_last_max) {
+		cubic->w_last_max = cc->cwnd;
+		cubic->w_max = (uint64_t) cc->cwnd *
+		    (CUBIC_BETA_DEN + CUBIC_BETA_NUM) / (2 * CUBIC_BETA_DEN);
+	} else {
+		cubic->w_last_max = cc->cwnd;
+		cubic->w_max = cc->cwnd;
+	}
+
+	cc->ssthresh = max((uint64_t) cc->cwnd * CUBIC_BETA_NUM /
+	    CUBIC_BETA_DEN, 2 * cc->smss);
+}
+
+/**
+ * @}
+ */
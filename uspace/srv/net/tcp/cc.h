@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup tcp
+ * @{
+ */
+/** @file TCP congestion control
+ */
+
+#ifndef CC_H
+#define CC_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tcp_type.h"
+
+/** Maximum segment size we send and receive.
+ *
+ * XXX This should be derived from the path MTU.
+ */
+#define TCP_MSS 1460
+
+/** Maximum text size of a segment the network stack splits for us.
+ *
+ * Such segment must fit into an IPv4 datagram with maximum-sized headers.
+ */
+#define TCP_GSO_MAX (UINT16_MAX - 20 - 60)
+
+/** Maximum segment size to assume if the peer does not announce any */
+#define TCP_MSS_DEFAULT 536
+
+/** Smallest peer maximum segment size we accept
+ *
+ * Smaller announced values are raised to this one so that the option
+ * overhead cannot leave no room for data.
+ */
+#define TCP_MSS_MIN 88
+
+/** Number of duplicate ACKs that trigger fast retransmit */
+#define TCP_DUPACK_THRESH 3
+
+extern errno_t tcp_cc_set_default(const char *);
+extern void tcp_cc_init(tcp_conn_t *);
+extern void tcp_cc_set_smss(tcp_conn_t *, uint32_t);
+extern uint32_t tcp_cc_avail(tcp_conn_t *);
+extern bool tcp_cc_ack(tcp_conn_t *, uint32_t);
+extern bool tcp_cc_dup_ack(tcp_conn_t *);
+extern void tcp_cc_timeout(tcp_conn_t *, bool);
+
+#endif
+
+/** @}
+ */
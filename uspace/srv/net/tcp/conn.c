@@ -39,12 +39,15 @@
 #include <inet/endpoint.h>
 #include <io/log.h>
 #include <macros.h>
+#include <mem.h>
 #include <nettl/amap.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
 #include "iqueue.h"
+#include "ncsim.h"
 #include "pdu.h"
 #include "rqueue.h"
 #include "segment.h"
@@ -53,8 +56,8 @@
 #include "tqueue.h"
 #include "ucall.h"
 
-#define RCV_BUF_SIZE 4096/*2*/
-#define SND_BUF_SIZE 4096
+#define RCV_BUF_SIZE (128 * 1024)
+#define SND_BUF_SIZE (64 * 1024)
 
 #define MAX_SEGMENT_LIFETIME	(15*1000*1000) //(2*60*1000*1000)
 #define TIME_WAIT_TIMEOUT	(2*MAX_SEGMENT_LIFETIME)
@@ -133,6 +136,7 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 	/* Allocate receive buffer */
 	fibril_condvar_initialize(&conn->rcv_buf_cv);
 	conn->rcv_buf_size = RCV_BUF_SIZE;
+	conn->rcv_buf_start = 0;
 	conn->rcv_buf_used = 0;
 	conn->rcv_buf_fin = false;
 
@@ -152,6 +156,12 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 	/* Set up receive window. */
 	conn->rcv_wnd = conn->rcv_buf_size;
 
+	/* Smallest window scale that allows announcing the whole buffer */
+	conn->rcv_wscale = 0;
+	while ((conn->rcv_buf_size >> conn->rcv_wscale) > UINT16_MAX &&
+	    conn->rcv_wscale < TCP_WSCALE_MAX)
+		++conn->rcv_wscale;
+
 	/* Initialize incoming segment queue */
 	tcp_iqueue_init(&conn->incoming, conn);
 
@@ -163,6 +173,9 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 
 	tqueue_inited = true;
 
+	/* Initialize congestion control */
+	tcp_cc_init(conn);
+
 	/* Connection state change signalling */
 	fibril_condvar_initialize(&conn->cstate_cv);
 
@@ -383,6 +396,7 @@ void tcp_conn_sync(tcp_conn_t *conn)
 	conn->iss = 1;
 	conn->snd_nxt = conn->iss;
 	conn->snd_una = conn->iss;
+	conn->cc.recover = conn->iss;
 	conn->ap = ap_active;
 
 	tcp_tqueue_ctrl_seg(conn, CTL_SYN);
@@ -511,6 +525,63 @@ bool tcp_conn_got_syn(tcp_conn_t *conn)
 	assert(false);
 }
 
+/** Process options in SYN received from the peer.
+ *
+ * We offer all options we support in our SYN and accept all offered by
+ * the peer, so an option is in use iff it is present in the peer's SYN.
+ *
+ * @param conn		Connection
+ * @param seg		Segment with SYN
+ */
+static void tcp_conn_syn_opts(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	tcp_seg_opts_t *opts = &seg->opts;
+	uint32_t smss;
+
+	conn->ws_ok = opts->has_wscale;
+	if (conn->ws_ok) {
+		conn->snd_wscale = opts->wscale;
+	} else {
+		conn->snd_wscale = 0;
+		conn->rcv_wscale = 0;
+	}
+
+	conn->sack_ok = opts->sack_perm;
+	conn->ts_ok = opts->has_ts;
+	if (conn->ts_ok)
+		conn->ts_recent = opts->ts_val;
+
+	smss = opts->has_mss ? opts->mss : TCP_MSS_DEFAULT;
+	smss = max(min(smss, TCP_MSS), TCP_MSS_MIN);
+
+	/* Timestamps take up room in every segment */
+	if (conn->ts_ok)
+		smss -= 2 + OPT_TIMESTAMP_LEN;
+
+	tcp_cc_set_smss(conn, smss);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: SMSS=%" PRIu32 " wscale=%s(%u,%u) "
+	    "sack=%s ts=%s", conn->name, smss, conn->ws_ok ? "yes" : "no",
+	    conn->snd_wscale, conn->rcv_wscale, conn->sack_ok ? "yes" : "no",
+	    conn->ts_ok ? "yes" : "no");
+}
+
+/** Determine send window from segment.
+ *
+ * The window in SYN segments is never scaled (RFC 7323 section 2.2).
+ *
+ * @param conn		Connection
+ * @param seg		Segment
+ * @return		Window size in bytes
+ */
+static uint32_t tcp_conn_seg_wnd(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	if ((seg->ctrl & CTL_SYN) != 0)
+		return seg->wnd;
+
+	return seg->wnd << conn->snd_wscale;
+}
+
 /** Segment arrived in Listen state.
  *
  * @param conn		Connection
@@ -550,6 +621,9 @@ static void tcp_conn_sa_listen(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->iss = 1;
 	conn->snd_nxt = conn->iss;
 	conn->snd_una = conn->iss;
+	conn->cc.recover = conn->iss;
+
+	tcp_conn_syn_opts(conn, seg);
 
 	/*
 	 * Surprisingly the spec does not deal with initial window setting.
@@ -615,6 +689,8 @@ static void tcp_conn_sa_syn_sent(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->rcv_nxt = seg->seq + 1;
 	conn->irs = seg->seq;
 
+	tcp_conn_syn_opts(conn, seg);
+
 	if ((seg->ctrl & CTL_ACK) != 0) {
 		conn->snd_una = seg->ack;
 
@@ -662,9 +738,20 @@ static void tcp_conn_sa_syn_sent(tcp_conn_t *conn, tcp_segment_t *seg)
 static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 {
 	tcp_segment_t *pseg;
+	size_t rcv_buf_used;
+	bool out_of_order;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_sa_seq(%p, %p)", conn, seg);
 
+	/* Discard old duplicates recognized by their timestamp */
+	if (seq_no_paws_reject(conn, seg)) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "PAWS: replying ACK to old "
+		    "segment.");
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+		tcp_segment_delete(seg);
+		return;
+	}
+
 	/* Discard unacceptable segments ("old duplicates") */
 	if (!seq_no_segment_acceptable(conn, seg)) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "Replying ACK to unacceptable segment.");
@@ -673,6 +760,22 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 		return;
 	}
 
+	/* Remember timestamp to echo back */
+	if (seq_no_ts_recent_valid(conn, seg))
+		conn->ts_recent = seg->opts.ts_val;
+
+	/*
+	 * A segment beyond RCV.NXT means something has been lost. Reply
+	 * with an immediate duplicate ACK so that the sender can perform
+	 * fast retransmit.
+	 */
+	out_of_order = !seq_no_segment_ready(conn, seg) &&
+	    tcp_segment_text_size(seg) > 0;
+
+	/* Report this segment in the first SACK block */
+	if (out_of_order)
+		conn->rcv_sack_seq = seg->seq;
+
 	/* Queue for processing */
 	tcp_iqueue_insert_seg(&conn->incoming, seg);
 
@@ -682,8 +785,19 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 	 *
 	 * XXX Need to return ACK for unacceptable segments
 	 */
+	rcv_buf_used = conn->rcv_buf_used;
 	while (tcp_iqueue_get_ready_seg(&conn->incoming, &pseg) == EOK)
 		tcp_conn_seg_process(conn, pseg);
+
+	/*
+	 * Acknowledge all text received above with a single ACK. When
+	 * a retransmission fills a hole, the sender thus sees one
+	 * cumulative ACK instead of a partial ACK for every segment
+	 * that was waiting in the incoming queue.
+	 */
+	if ((out_of_order || conn->rcv_buf_used != rcv_buf_used) &&
+	    conn->cstate != st_closed)
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
 }
 
 /** Process segment RST field.
@@ -802,6 +916,17 @@ static cproc_t tcp_conn_seg_proc_ack_sr(tcp_conn_t *conn, tcp_segment_t *seg)
 	return cp_continue;
 }
 
+/** Process SACK option of incoming segment.
+ *
+ * @param conn		Connection
+ * @param seg		Segment
+ */
+static void tcp_conn_seg_proc_sack(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	if (conn->sack_ok && seg->opts.sack_cnt > 0)
+		tcp_tqueue_sack_received(conn, &seg->opts);
+}
+
 /** Process segment ACK field in Established state.
  *
  * @param conn		Connection
@@ -827,15 +952,32 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 			tcp_segment_delete(seg);
 			return cp_done;
 		} else {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "Ignoring duplicate ACK.");
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "Duplicate ACK.");
+
+			/*
+			 * Only a pure ACK for outstanding data that does not
+			 * update the window signals a lost segment.
+			 */
+			if (seg->ack == conn->snd_una && seg->len == 0 &&
+			    tcp_conn_seg_wnd(conn, seg) == conn->snd_wnd &&
+			    conn->snd_nxt != conn->snd_una) {
+				tcp_conn_seg_proc_sack(conn, seg);
+				tcp_tqueue_dup_ack(conn);
+			}
 		}
 	} else {
+		/* Measure round-trip time using the echoed timestamp */
+		if (conn->ts_ok && seg->opts.has_ts && seg->opts.ts_ecr != 0)
+			tcp_tqueue_ts_rtt(conn, seg->opts.ts_ecr);
+
 		/* Update SND.UNA */
 		conn->snd_una = seg->ack;
+
+		tcp_conn_seg_proc_sack(conn, seg);
 	}
 
 	if (seq_no_new_wnd_update(conn, seg)) {
-		conn->snd_wnd = seg->wnd;
+		conn->snd_wnd = tcp_conn_seg_wnd(conn, seg);
 		conn->snd_wl1 = seg->seq;
 		conn->snd_wl2 = seg->ack;
 
@@ -1059,9 +1201,17 @@ static cproc_t tcp_conn_seg_proc_text(tcp_conn_t *conn, tcp_segment_t *seg)
 	text_size = tcp_segment_text_size(seg);
 	xfer_size = min(text_size, conn->rcv_buf_size - conn->rcv_buf_used);
 
+	/* Move unread data to the beginning of the buffer if needed */
+	if (conn->rcv_buf_start + conn->rcv_buf_used + xfer_size >
+	    conn->rcv_buf_size) {
+		memmove(conn->rcv_buf, conn->rcv_buf + conn->rcv_buf_start,
+		    conn->rcv_buf_used);
+		conn->rcv_buf_start = 0;
+	}
+
 	/* Copy data to receive buffer */
-	tcp_segment_text_copy(seg, conn->rcv_buf + conn->rcv_buf_used,
-	    xfer_size);
+	tcp_segment_text_copy(seg, conn->rcv_buf + conn->rcv_buf_start +
+	    conn->rcv_buf_used, xfer_size);
 	conn->rcv_buf_used += xfer_size;
 
 	/* Signal to the receive function that new data has arrived */
@@ -1076,12 +1226,14 @@ static cproc_t tcp_conn_seg_proc_text(tcp_conn_t *conn, tcp_segment_t *seg)
 	/* Advance RCV.NXT */
 	conn->rcv_nxt += xfer_size;
 
-	/* Update receive window. XXX Not an efficient strategy. */
+	/*
+	 * Keep the right edge of the receive window in place, the window
+	 * is opened again by tcp_conn_rcv_wnd_update() as the user
+	 * reads the data.
+	 */
 	conn->rcv_wnd -= xfer_size;
 
-	/* Send ACK */
-	if (xfer_size > 0)
-		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+	/* ACK is sent by tcp_conn_sa_queue() once all ready text is in */
 
 	if (xfer_size < seg->len) {
 		/* Trim part of segment which we just received */
@@ -1098,6 +1250,34 @@ static cproc_t tcp_conn_seg_proc_text(tcp_conn_t *conn, tcp_segment_t *seg)
 	return cp_continue;
 }
 
+/** Open receive window after data has been removed from receive buffer.
+ *
+ * To avoid silly window syndrome (RFC 1122 section 4.2.3.3) the right
+ * edge of the window only moves once it can advance by at least
+ * min(half of the buffer, one segment).
+ *
+ * @param conn		Connection
+ * @return		@c true if the window has opened and should be
+ *			announced to the peer
+ */
+bool tcp_conn_rcv_wnd_update(tcp_conn_t *conn)
+{
+	size_t space;
+
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	space = conn->rcv_buf_size - conn->rcv_buf_used;
+	if (space <= conn->rcv_wnd)
+		return false;
+
+	if (space - conn->rcv_wnd < min(conn->rcv_buf_size / 2,
+	    (size_t) TCP_MSS))
+		return false;
+
+	conn->rcv_wnd = space;
+	return true;
+}
+
 /** Process segment FIN field.
  *
  * @param conn		Connection
@@ -1410,17 +1590,14 @@ static void tcp_transmit_segment(inet_ep2_t *epp, tcp_segment_t *seg)
 	tcp_segment_dump(seg);
 
 	if (tcp_conn_lb == tcp_lb_segment) {
-		/* Loop back segment */
-#if 0
-		tcp_ncsim_bounce_seg(sp, seg);
-#endif
-
-		/* Reverse the identification */
-		tcp_ep2_flipped(epp, &rident);
-
-		/* Insert segment back into rqueue */
+		/* Loop back segment through network condition simulator */
 		dseg = tcp_segment_dup(seg);
-		tcp_rqueue_insert_seg(&rident, dseg);
+		if (dseg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_WARN, "Not enough memory. Segment dropped.");
+			return;
+		}
+
+		tcp_ncsim_bounce_seg(epp, dseg);
 		return;
 	}
 
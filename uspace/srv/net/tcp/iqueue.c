@@ -186,6 +186,97 @@ errno_t tcp_iqueue_get_ready_seg(tcp_iqueue_t *iqueue, tcp_segment_t **seg)
 	return EOK;
 }
 
+/** Determine whether sequence number lies within a SACK block. */
+static bool tcp_sack_block_has(tcp_sack_block_t *blk, uint32_t sn)
+{
+	return sn - blk->start < blk->end - blk->start;
+}
+
+/** Describe out-of-order data in incoming queue with SACK blocks.
+ *
+ * The block containing the most recently received segment comes first,
+ * as required by RFC 2018, the rest follow in sequence number order.
+ *
+ * @param iqueue	Incoming queue
+ * @param blocks	Array to fill in
+ * @param max		Maximum number of blocks, at most TCP_SACK_BLOCKS_MAX
+ * @return		Number of blocks filled in
+ */
+unsigned tcp_iqueue_sack_blocks(tcp_iqueue_t *iqueue, tcp_sack_block_t *blocks,
+    unsigned max)
+{
+	tcp_conn_t *conn = iqueue->conn;
+	tcp_sack_block_t other[TCP_SACK_BLOCKS_MAX];
+	tcp_sack_block_t blk;
+	tcp_segment_t *seg;
+	link_t *link;
+	unsigned nother;
+	unsigned cnt;
+	bool have_blk;
+	bool have_first;
+	uint32_t off;
+
+	assert(max <= TCP_SACK_BLOCKS_MAX);
+	if (max == 0)
+		return 0;
+
+	nother = 0;
+	have_blk = false;
+	have_first = false;
+
+	/*
+	 * The list is sorted by sequence number, merge adjacent and
+	 * overlapping segments into blocks. Adding the sentinel
+	 * iteration (seg == NULL) lets us emit the last block.
+	 */
+	link = list_first(&iqueue->list);
+	while (true) {
+		seg = NULL;
+		if (link != NULL) {
+			seg = list_get_instance(link, tcp_iqueue_entry_t,
+			    link)->seg;
+			link = list_next(link, &iqueue->list);
+
+			/* Only segments with data strictly beyond RCV.NXT */
+			off = seg->seq - conn->rcv_nxt;
+			if (seg->len == 0 || off == 0 || off >= conn->rcv_wnd)
+				continue;
+
+			if (have_blk && seg->seq - blk.start <=
+			    blk.end - blk.start) {
+				/* Extend current block */
+				if (seg->seq + seg->len - blk.start >
+				    blk.end - blk.start)
+					blk.end = seg->seq + seg->len;
+				continue;
+			}
+		}
+
+		if (have_blk) {
+			if (!have_first &&
+			    tcp_sack_block_has(&blk, conn->rcv_sack_seq)) {
+				blocks[0] = blk;
+				have_first = true;
+			} else if (nother < max) {
+				other[nother++] = blk;
+			}
+		}
+
+		if (seg == NULL)
+			break;
+
+		blk.start = seg->seq;
+		blk.end = seg->seq + seg->len;
+		have_blk = true;
+	}
+
+	cnt = have_first ? 1 : 0;
+	for (unsigned i = 0; i < nother && cnt < max; i++)
+		blocks[cnt++] = other[i];
+
+	return cnt;
+}
+
 /**
  * @}
  */
@@ -33,9 +33,14 @@
 /**
  * @file Network condition simulator
  *
- * Simulate network conditions for testing the reliability implementation:
- *    - variable latency
+ * Simulate network conditions for testing the reliability implementation
+ * and for benchmarking congestion control:
+ *    - variable latency (fixed delay plus random jitter, which can
+ *      cause segments to be reordered)
  *    - frame drop
+ *
+ * The simulator is used when segments are looped back internally
+ * (tcp_lb_segment). By default it does not alter the traffic at all.
  */
 
 #include <adt/list.h>
@@ -43,14 +48,47 @@
 #include <errno.h>
 #include <inet/endpoint.h>
 #include <io/log.h>
+#include <macros.h>
 #include <stdlib.h>
+#include <str.h>
 #include <fibril.h>
+#include <time.h>
 #include "conn.h"
 #include "ncsim.h"
 #include "rqueue.h"
 #include "segment.h"
 #include "tcp_type.h"
 
+/** Network conditions */
+typedef struct {
+	/** Scenario name */
+	const char *name;
+	/** Fixed one-way delay */
+	usec_t delay;
+	/** Maximum additional random delay */
+	usec_t jitter;
+	/** Probability of dropping a segment in 1/1000 */
+	unsigned loss;
+} tcp_ncsim_scenario_t;
+
+static tcp_ncsim_scenario_t ncsim_scenarios[] = {
+	{ "none", 0, 0, 0 },
+	{ "lan", 500, 200, 0 },
+	{ "wan", MSEC2USEC(40), MSEC2USEC(2), 1 },
+	{ "lossy", MSEC2USEC(20), MSEC2USEC(2), 20 },
+	{ "reorder", MSEC2USEC(10), MSEC2USEC(20), 0 },
+	{ "sat", MSEC2USEC(300), MSEC2USEC(10), 5 },
+	{ NULL, 0, 0, 0 }
+};
+
+/** Current network conditions */
+static tcp_ncsim_scenario_t *ncsim_cur = &ncsim_scenarios[0];
+
+/** Number of segments passed to the simulator */
+static unsigned long ncsim_segs;
+/** Number of segments dropped by the simulator */
+static unsigned long ncsim_dropped;
+
 static list_t sim_queue;
 static fibril_mutex_t sim_queue_lock;
 static fibril_condvar_t sim_queue_cv;
@@ -63,6 +101,36 @@ void tcp_ncsim_init(void)
 	fibril_condvar_initialize(&sim_queue_cv);
 }
 
+/** Select simulated network conditions.
+ *
+ * @param name	Scenario name (none, lan, wan, lossy, reorder, sat)
+ * @return	EOK on success, ENOENT if there is no such scenario
+ */
+errno_t tcp_ncsim_set_scenario(const char *name)
+{
+	tcp_ncsim_scenario_t *sc;
+
+	for (sc = ncsim_scenarios; sc->name != NULL; sc++) {
+		if (str_cmp(sc->name, name) == 0) {
+			ncsim_cur = sc;
+			return EOK;
+		}
+	}
+
+	return ENOENT;
+}
+
+/** Get simulator statistics.
+ *
+ * @param segs		Place to store number of segments passed to simulator
+ * @param dropped	Place to store number of dropped segments
+ */
+void tcp_ncsim_get_stats(unsigned long *segs, unsigned long *dropped)
+{
+	*segs = ncsim_segs;
+	*dropped = ncsim_dropped;
+}
+
 /** Bounce segment through simulator into receive queue.
  *
  * @param epp	Endpoint pair, oriented for transmission
@@ -73,49 +141,59 @@ void tcp_ncsim_bounce_seg(inet_ep2_t *epp, tcp_segment_t *seg)
 	tcp_squeue_entry_t *sqe;
 	tcp_squeue_entry_t *old_qe;
 	inet_ep2_t rident;
+	usec_t delay;
 	link_t *link;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_ncsim_bounce_seg()");
-	tcp_ep2_flipped(epp, &rident);
-	tcp_rqueue_insert_seg(&rident, seg);
-	return;
 
-	if (0 /* rand() % 4 == 3 */) {
+	++ncsim_segs;
+
+	if (ncsim_cur->loss > 0 && (unsigned) rand() % 1000 < ncsim_cur->loss) {
 		/* Drop segment */
-		log_msg(LOG_DEFAULT, LVL_ERROR, "NCSim dropping segment");
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "NCSim dropping segment");
+		++ncsim_dropped;
 		tcp_segment_delete(seg);
 		return;
 	}
 
+	delay = ncsim_cur->delay;
+	if (ncsim_cur->jitter > 0)
+		delay += rand() % ncsim_cur->jitter;
+
+	if (delay == 0) {
+		tcp_ep2_flipped(epp, &rident);
+		tcp_rqueue_insert_seg(&rident, seg);
+		return;
+	}
+
 	sqe = calloc(1, sizeof(tcp_squeue_entry_t));
 	if (sqe == NULL) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed allocating SQE.");
+		tcp_segment_delete(seg);
 		return;
 	}
 
-	sqe->delay = rand() % (1000 * 1000);
+	getuptime(&sqe->due);
+	ts_add_diff(&sqe->due, USEC2NSEC(delay));
 	sqe->epp = *epp;
 	sqe->seg = seg;
 
 	fibril_mutex_lock(&sim_queue_lock);
 
-	link = list_first(&sim_queue);
-	while (link != NULL && sqe->delay > 0) {
+	/* Keep the queue sorted by delivery time */
+	link = list_last(&sim_queue);
+	while (link != NULL) {
 		old_qe = list_get_instance(link, tcp_squeue_entry_t, link);
-		if (sqe->delay < old_qe->delay)
+		if (!ts_gt(&old_qe->due, &sqe->due))
 			break;
 
-		sqe->delay -= old_qe->delay;
-
-		link = link->next;
-		if (link == &sim_queue.head)
-			link = NULL;
+		link = list_prev(link, &sim_queue);
 	}
 
 	if (link != NULL)
 		list_insert_after(&sqe->link, link);
 	else
-		list_append(&sqe->link, &sim_queue);
+		list_prepend(&sqe->link, &sim_queue);
 
 	fibril_condvar_broadcast(&sim_queue_cv);
 	fibril_mutex_unlock(&sim_queue_lock);
@@ -127,7 +205,7 @@ static errno_t tcp_ncsim_fibril(void *arg)
 	link_t *link;
 	tcp_squeue_entry_t *sqe;
 	inet_ep2_t rident;
-	errno_t rc;
+	struct timespec now;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_ncsim_fibril()");
 
@@ -137,14 +215,22 @@ static errno_t tcp_ncsim_fibril(void *arg)
 		while (list_empty(&sim_queue))
 			fibril_condvar_wait(&sim_queue_cv, &sim_queue_lock);
 
-		do {
-			link = list_first(&sim_queue);
-			sqe = list_get_instance(link, tcp_squeue_entry_t, link);
+		link = list_first(&sim_queue);
+		sqe = list_get_instance(link, tcp_squeue_entry_t, link);
 
+		getuptime(&now);
+		if (ts_gt(&sqe->due, &now)) {
+			/*
+			 * Sleep until the first segment is due. We are woken
+			 * up early if an earlier segment is queued meanwhile.
+			 */
 			log_msg(LOG_DEFAULT, LVL_DEBUG, "NCSim - Sleep");
-			rc = fibril_condvar_wait_timeout(&sim_queue_cv,
-			    &sim_queue_lock, sqe->delay);
-		} while (rc != ETIMEOUT);
+			(void) fibril_condvar_wait_timeout(&sim_queue_cv,
+			    &sim_queue_lock,
+			    max(NSEC2USEC(ts_sub_diff(&sqe->due, &now)), 1));
+			fibril_mutex_unlock(&sim_queue_lock);
+			continue;
+		}
 
 		list_remove(link);
 		fibril_mutex_unlock(&sim_queue_lock);
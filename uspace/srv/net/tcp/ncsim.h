@@ -35,10 +35,13 @@
 #ifndef NCSIM_H
 #define NCSIM_H
 
+#include <errno.h>
 #include <inet/endpoint.h>
 #include "tcp_type.h"
 
 extern void tcp_ncsim_init(void);
+extern errno_t tcp_ncsim_set_scenario(const char *);
+extern void tcp_ncsim_get_stats(unsigned long *, unsigned long *);
 extern void tcp_ncsim_bounce_seg(inet_ep2_t *, tcp_segment_t *);
 extern void tcp_ncsim_fibril_start(void);
 
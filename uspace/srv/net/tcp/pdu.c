@@ -38,6 +38,7 @@
 #include <byteorder.h>
 #include <errno.h>
 #include <inet/endpoint.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 #include "pdu.h"
@@ -125,7 +126,188 @@ static void tcp_header_encode_flags(tcp_control_t ctl, uint16_t doff_flags0,
 	*rdoff_flags = doff_flags;
 }
 
-static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *hdr)
+/** Store 16-bit value in network byte order at unaligned address. */
+static void tcp_opt_put16(uint8_t *p, uint16_t val)
+{
+	p[0] = val >> 8;
+	p[1] = val & 0xff;
+}
+
+/** Store 32-bit value in network byte order at unaligned address. */
+static void tcp_opt_put32(uint8_t *p, uint32_t val)
+{
+	tcp_opt_put16(p, val >> 16);
+	tcp_opt_put16(p + 2, val & 0xffff);
+}
+
+/** Load 16-bit value in network byte order from unaligned address. */
+static uint16_t tcp_opt_get16(uint8_t *p)
+{
+	return ((uint16_t)p[0] << 8) | p[1];
+}
+
+/** Load 32-bit value in network byte order from unaligned address. */
+static uint32_t tcp_opt_get32(uint8_t *p)
+{
+	return ((uint32_t)tcp_opt_get16(p) << 16) | tcp_opt_get16(p + 2);
+}
+
+/** Encode TCP options.
+ *
+ * Options are laid out the usual way so that each 32-bit or 16-bit field
+ * is naturally aligned, padding with No-Operation as needed.
+ *
+ * @param opts	Segment options
+ * @param buf	Buffer of at least TCP_OPTS_MAX_SIZE bytes
+ * @return	Size of encoded options, multiple of four
+ */
+static size_t tcp_opts_encode(tcp_seg_opts_t *opts, uint8_t *buf)
+{
+	uint8_t *p = buf;
+	unsigned i;
+
+	if (opts->has_mss) {
+		p[0] = OPT_MAX_SEG_SIZE;
+		p[1] = OPT_MAX_SEG_SIZE_LEN;
+		tcp_opt_put16(p + 2, opts->mss);
+		p += 4;
+	}
+
+	if (opts->has_wscale) {
+		p[0] = OPT_NOP;
+		p[1] = OPT_WINDOW_SCALE;
+		p[2] = OPT_WINDOW_SCALE_LEN;
+		p[3] = opts->wscale;
+		p += 4;
+	}
+
+	if (opts->sack_perm) {
+		if (opts->has_ts) {
+			/* Fill the padding before Timestamps */
+			p[0] = OPT_SACK_PERMITTED;
+			p[1] = OPT_SACK_PERMITTED_LEN;
+		} else {
+			p[0] = OPT_NOP;
+			p[1] = OPT_NOP;
+			p[2] = OPT_SACK_PERMITTED;
+			p[3] = OPT_SACK_PERMITTED_LEN;
+			p += 2;
+		}
+		p += 2;
+	} else if (opts->has_ts) {
+		p[0] = OPT_NOP;
+		p[1] = OPT_NOP;
+		p += 2;
+	}
+
+	if (opts->has_ts) {
+		p[0] = OPT_TIMESTAMP;
+		p[1] = OPT_TIMESTAMP_LEN;
+		tcp_opt_put32(p + 2, opts->ts_val);
+		tcp_opt_put32(p + 6, opts->ts_ecr);
+		p += OPT_TIMESTAMP_LEN;
+	}
+
+	if (opts->sack_cnt > 0) {
+		p[0] = OPT_NOP;
+		p[1] = OPT_NOP;
+		p[2] = OPT_SACK;
+		p[3] = OPT_SACK_LEN + opts->sack_cnt * OPT_SACK_BLOCK_LEN;
+		p += 4;
+
+		for (i = 0; i < opts->sack_cnt; i++) {
+			tcp_opt_put32(p, opts->sack[i].start);
+			tcp_opt_put32(p + 4, opts->sack[i].end);
+			p += OPT_SACK_BLOCK_LEN;
+		}
+	}
+
+	assert((size_t)(p - buf) <= TCP_OPTS_MAX_SIZE);
+	assert((p - buf) % 4 == 0);
+	return p - buf;
+}
+
+/** Decode TCP options.
+ *
+ * Unknown options are skipped. Decoding stops at a malformed option,
+ * keeping what has been decoded so far.
+ *
+ * @param data	Encoded options
+ * @param size	Size of encoded options
+ * @param opts	Place to store decoded options
+ */
+static void tcp_opts_decode(uint8_t *data, size_t size, tcp_seg_opts_t *opts)
+{
+	uint8_t *p = data;
+	uint8_t *end = data + size;
+	uint8_t kind;
+	uint8_t len;
+	unsigned i;
+
+	memset(opts, 0, sizeof(tcp_seg_opts_t));
+
+	while (p < end) {
+		kind = p[0];
+		if (kind == OPT_END_LIST)
+			break;
+		if (kind == OPT_NOP) {
+			++p;
+			continue;
+		}
+
+		if (end - p < 2)
+			break;
+		len = p[1];
+		if (len < 2 || len > end - p)
+			break;
+
+		switch (kind) {
+		case OPT_MAX_SEG_SIZE:
+			if (len != OPT_MAX_SEG_SIZE_LEN)
+				break;
+			opts->has_mss = true;
+			opts->mss = tcp_opt_get16(p + 2);
+			break;
+		case OPT_WINDOW_SCALE:
+			if (len != OPT_WINDOW_SCALE_LEN)
+				break;
+			opts->has_wscale = true;
+			opts->wscale = min(p[2], TCP_WSCALE_MAX);
+			break;
+		case OPT_SACK_PERMITTED:
+			if (len != OPT_SACK_PERMITTED_LEN)
+				break;
+			opts->sack_perm = true;
+			break;
+		case OPT_TIMESTAMP:
+			if (len != OPT_TIMESTAMP_LEN)
+				break;
+			opts->has_ts = true;
+			opts->ts_val = tcp_opt_get32(p + 2);
+			opts->ts_ecr = tcp_opt_get32(p + 6);
+			break;
+		case OPT_SACK:
+			if ((len - OPT_SACK_LEN) % OPT_SACK_BLOCK_LEN != 0)
+				break;
+			opts->sack_cnt = min((len - OPT_SACK_LEN) /
+			    OPT_SACK_BLOCK_LEN, TCP_SACK_BLOCKS_MAX);
+			for (i = 0; i < opts->sack_cnt; i++) {
+				opts->sack[i].start = tcp_opt_get32(p +
+				    OPT_SACK_LEN + i * OPT_SACK_BLOCK_LEN);
+				opts->sack[i].end = tcp_opt_get32(p +
+				    OPT_SACK_LEN + i * OPT_SACK_BLOCK_LEN + 4);
+			}
+			break;
+		default:
+			break;
+		}
+
+		p += len;
+	}
+}
+
+static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg,
+    size_t hdr_size, tcp_header_t *hdr)
 {
 	uint16_t doff_flags;
 	uint16_t doff;
@@ -135,7 +317,7 @@ static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *
 	hdr->seq = host2uint32_t_be(seg->seq);
 	hdr->ack = host2uint32_t_be(seg->ack);
 
-	doff = (sizeof(tcp_header_t) / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
+	doff = (hdr_size / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
 	tcp_header_encode_flags(seg->ctrl, doff, &doff_flags);
 
 	hdr->doff_flags = host2uint16_t_be(doff_flags);
@@ -181,27 +363,37 @@ static ip_ver_t tcp_phdr_setup(tcp_pdu_t *pdu, tcp_phdr_t *phdr,
 	return src_ver;
 }
 
-static void tcp_header_decode(tcp_header_t *hdr, tcp_segment_t *seg)
+static void tcp_header_decode(tcp_header_t *hdr, size_t hdr_size,
+    tcp_segment_t *seg)
 {
 	tcp_header_decode_flags(uint16_t_be2host(hdr->doff_flags), &seg->ctrl);
 	seg->seq = uint32_t_be2host(hdr->seq);
 	seg->ack = uint32_t_be2host(hdr->ack);
 	seg->wnd = uint16_t_be2host(hdr->window);
 	seg->up = uint16_t_be2host(hdr->urg_ptr);
+
+	tcp_opts_decode((uint8_t *)hdr + sizeof(tcp_header_t),
+	    hdr_size - sizeof(tcp_header_t), &seg->opts);
 }
 
 static errno_t tcp_header_encode(inet_ep2_t *epp, tcp_segment_t *seg,
     void **header, size_t *size)
 {
+	uint8_t opts[TCP_OPTS_MAX_SIZE];
+	size_t opts_size;
 	tcp_header_t *hdr;
 
-	hdr = calloc(1, sizeof(tcp_header_t));
+	opts_size = tcp_opts_encode(&seg->opts, opts);
+
+	hdr = calloc(1, sizeof(tcp_header_t) + opts_size);
 	if (hdr == NULL)
 		return ENOMEM;
 
-	tcp_header_setup(epp, seg, hdr);
+	tcp_header_setup(epp, seg, sizeof(tcp_header_t) + opts_size, hdr);
+	memcpy((uint8_t *)hdr + sizeof(tcp_header_t), opts, opts_size);
+
 	*header = hdr;
-	*size = sizeof(tcp_header_t);
+	*size = sizeof(tcp_header_t) + opts_size;
 
 	return EOK;
 }
@@ -260,10 +452,10 @@ void tcp_pdu_delete(tcp_pdu_t *pdu)
 	free(pdu);
 }
 
-static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
+/** Compute checksum of TCP pseudo-header of PDU. */
+static uint16_t tcp_pdu_phdr_checksum_calc(tcp_pdu_t *pdu)
 {
 	uint16_t cs_phdr;
-	uint16_t cs_headers;
 	tcp_phdr_t phdr;
 	tcp_phdr6_t phdr6;
 
@@ -281,6 +473,15 @@ static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
 		assert(false);
 	}
 
+	return cs_phdr;
+}
+
+static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
+{
+	uint16_t cs_phdr;
+	uint16_t cs_headers;
+
+	cs_phdr = tcp_pdu_phdr_checksum_calc(pdu);
 	cs_headers = tcp_checksum_calc(cs_phdr, pdu->header, pdu->header_size);
 	return tcp_checksum_calc(cs_headers, pdu->text, pdu->text_size);
 }
@@ -303,7 +504,7 @@ errno_t tcp_pdu_decode(tcp_pdu_t *pdu, inet_ep2_t *epp, tcp_segment_t **seg)
 	if (nseg == NULL)
 		return ENOMEM;
 
-	tcp_header_decode(pdu->header, nseg);
+	tcp_header_decode(pdu->header, pdu->header_size, nseg);
 	nseg->len += seq_no_control_len(nseg->ctrl);
 
 	hdr = (tcp_header_t *)pdu->header;
@@ -348,8 +549,19 @@ errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
 	npdu->text_size = text_size;
 	memcpy(npdu->text, seg->data, text_size);
 
-	/* Checksum calculation */
-	checksum = tcp_pdu_checksum_calc(npdu);
+	if (seg->gso_size != 0 && npdu->src.version == ip_v4) {
+		/*
+		 * Leave checksum and segmentation to the network stack.
+		 * The checksum field holds the pseudo-header sum.
+		 */
+		npdu->offload.csum_partial = true;
+		if (text_size > seg->gso_size)
+			npdu->offload.gso_size = seg->gso_size;
+		checksum = ~tcp_pdu_phdr_checksum_calc(npdu);
+	} else {
+		checksum = tcp_pdu_checksum_calc(npdu);
+	}
+
 	tcp_pdu_set_checksum(npdu, checksum);
 
 	*pdu = npdu;
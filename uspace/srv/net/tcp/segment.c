@@ -74,6 +74,8 @@ tcp_segment_t *tcp_segment_dup(tcp_segment_t *seg)
 	scopy->len = seg->len;
 	scopy->wnd = seg->wnd;
 	scopy->up = seg->up;
+	scopy->opts = seg->opts;
+	scopy->gso_size = seg->gso_size;
 
 	tsize = tcp_segment_text_size(seg);
 	scopy->data = calloc(tsize, 1);
@@ -87,6 +87,26 @@ bool seq_no_ack_duplicate(tcp_conn_t *conn, uint32_t seg_ack)
 	return diff == 0 || (diff & (0x1 << 31)) != 0;
 }
 
+/** Determine whether the recovery point has been acknowledged.
+ *
+ * True if RECOVER <= SND.UNA, using the same best-effort comparison
+ * as seq_no_ack_duplicate().
+ */
+bool seq_no_recover_acked(tcp_conn_t *conn)
+{
+	uint32_t diff;
+
+	diff = conn->snd_una - conn->cc.recover;
+	return (diff & (0x1U << 31)) == 0;
+}
+
+/** Determine whether SND.UNA is past the recovery point (RECOVER < SND.UNA). */
+bool seq_no_recover_passed(tcp_conn_t *conn)
+{
+	return conn->snd_una != conn->cc.recover &&
+	    seq_no_recover_acked(conn);
+}
+
 /** Determine if sequence number is in receive window. */
 bool seq_no_in_rcv_wnd(tcp_conn_t *conn, uint32_t sn)
 {
@@ -143,8 +163,50 @@ bool seq_no_segment_ready(tcp_conn_t *conn, tcp_segment_t *seg)
  */
 bool seq_no_segment_acked(tcp_conn_t *conn, tcp_segment_t *seg, uint32_t ack)
 {
+	uint32_t diff;
+
 	assert(seg->len > 0);
-	return seq_no_lt_le(seg->seq, seg->seq + seg->len, ack);
+
+	/*
+	 * SEG.SEQ + SEG.LEN <= ACK. Segments beyond ACK must not count
+	 * as acked, so compare based on the difference, as in
+	 * seq_no_ack_duplicate().
+	 */
+	diff = ack - seg->seq;
+	return diff >= seg->len && (diff & (0x1U << 31)) == 0;
+}
+
+/** Determine whether segment should be rejected by PAWS.
+ *
+ * Protection Against Wrapped Sequences (RFC 7323 section 5): reject
+ * a non-RST segment whose SEG.TSval is older than TS.Recent.
+ */
+bool seq_no_paws_reject(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	uint32_t diff;
+
+	if (!conn->ts_ok || !seg->opts.has_ts || (seg->ctrl & CTL_RST) != 0)
+		return false;
+
+	diff = seg->opts.ts_val - conn->ts_recent;
+	return (diff & (0x1U << 31)) != 0;
+}
+
+/** Determine whether SEG.TSval should be recorded as TS.Recent.
+ *
+ * True if the segment carries a timestamp and SEG.SEQ <= Last.ACK.sent
+ * (RFC 7323 section 4.3), so that we echo the timestamp of the segment
+ * that caused us to send the ACK.
+ */
+bool seq_no_ts_recent_valid(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	uint32_t diff;
+
+	if (!conn->ts_ok || !seg->opts.has_ts)
+		return false;
+
+	diff = conn->last_ack_sent - seg->seq;
+	return (diff & (0x1U << 31)) == 0;
 }
 
 /** Determine whether initial SYN is acked.
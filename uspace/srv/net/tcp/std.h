@@ -109,9 +109,35 @@ enum opt_kind {
 	/** No-operation */
 	OPT_NOP			= 1,
 	/** Maximum segment size */
-	OPT_MAX_SEG_SIZE	= 2
+	OPT_MAX_SEG_SIZE	= 2,
+	/** Window scale (RFC 7323) */
+	OPT_WINDOW_SCALE	= 3,
+	/** SACK permitted (RFC 2018) */
+	OPT_SACK_PERMITTED	= 4,
+	/** SACK (RFC 2018) */
+	OPT_SACK		= 5,
+	/** Timestamps (RFC 7323) */
+	OPT_TIMESTAMP		= 8
 };
 
+/** Option length (including kind and length octets) */
+enum opt_len {
+	OPT_MAX_SEG_SIZE_LEN	= 4,
+	OPT_WINDOW_SCALE_LEN	= 3,
+	OPT_SACK_PERMITTED_LEN	= 2,
+	/** Length of SACK option without the blocks */
+	OPT_SACK_LEN		= 2,
+	/** Length of one SACK block */
+	OPT_SACK_BLOCK_LEN	= 8,
+	OPT_TIMESTAMP_LEN	= 10
+};
+
+/** Maximum size of TCP options */
+#define TCP_OPTS_MAX_SIZE 40
+
+/** Maximum window scale shift count (RFC 7323) */
+#define TCP_WSCALE_MAX 14
+
 #endif
 
 /** @}
@@ -38,8 +38,10 @@
 #include <errno.h>
 #include <io/log.h>
 #include <stdio.h>
+#include <str.h>
 #include <task.h>
 
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
 #include "ncsim.h"
@@ -54,6 +56,50 @@ static tcp_rqueue_cb_t tcp_rqueue_cb = {
 	.seg_received = tcp_as_segment_arrived
 };
 
+/** Run loopback benchmark instead of normal operation */
+static bool tcp_bench = false;
+
+static void print_syntax(void)
+{
+	printf("Syntax: %s [--cc <algorithm>] [--bench <scenario>]\n", NAME);
+	printf("\t--cc <algorithm>\tCongestion control (newreno, cubic)\n");
+	printf("\t--bench <scenario>\tBenchmark over internal loopback with "
+	    "simulated\n\t\t\t\tnetwork conditions (none, lan, wan, lossy, "
+	    "reorder, sat)\n");
+}
+
+static errno_t tcp_parse_args(int argc, char **argv)
+{
+	int i;
+
+	for (i = 1; i < argc; i += 2) {
+		if (i + 1 >= argc)
+			return EINVAL;
+
+		if (str_cmp(argv[i], "--cc") == 0) {
+			if (tcp_cc_set_default(argv[i + 1]) != EOK) {
+				printf(NAME ": Unknown congestion control "
+				    "algorithm '%s'.\n", argv[i + 1]);
+				return EINVAL;
+			}
+		} else if (str_cmp(argv[i], "--bench") == 0) {
+			if (tcp_ncsim_set_scenario(argv[i + 1]) != EOK) {
+				printf(NAME ": Unknown scenario '%s'.\n",
+				    argv[i + 1]);
+				return EINVAL;
+			}
+
+			/* All segments are looped back via the simulator */
+			tcp_conn_lb = tcp_lb_segment;
+			tcp_bench = true;
+		} else {
+			return EINVAL;
+		}
+	}
+
+	return EOK;
+}
+
 static errno_t tcp_init(void)
 {
 	errno_t rc;
@@ -76,6 +122,9 @@ static errno_t tcp_init(void)
 	if (0)
 		tcp_test();
 
+	if (tcp_bench)
+		tcp_test_bulk();
+
 	rc = tcp_inet_init();
 	if (rc != EOK)
 		return ENOENT;
@@ -95,6 +144,11 @@ int main(int argc, char **argv)
 
 	printf(NAME ": TCP (Transmission Control Protocol) network module\n");
 
+	if (tcp_parse_args(argc, argv) != EOK) {
+		print_syntax();
+		return 1;
+	}
+
 	rc = log_init(NAME);
 	if (rc != EOK) {
 		printf(NAME ": Failed to initialize log.\n");
@@ -43,8 +43,10 @@
 #include <refcount.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 #include <inet/addr.h>
 #include <inet/endpoint.h>
+#include <types/inet.h>
 
 struct tcp_conn;
 
@@ -154,6 +156,41 @@ typedef struct {
 	tcp_cstate_t cstate;
 } tcp_conn_status_t;
 
+/** Maximum number of SACK blocks in a segment */
+#define TCP_SACK_BLOCKS_MAX 4
+
+/** SACK block */
+typedef struct {
+	/** First sequence number in block */
+	uint32_t start;
+	/** Sequence number following the block */
+	uint32_t end;
+} tcp_sack_block_t;
+
+/** Segment options */
+typedef struct {
+	/** Maximum Segment Size option present */
+	bool has_mss;
+	/** Maximum segment size */
+	uint16_t mss;
+	/** Window Scale option present */
+	bool has_wscale;
+	/** Window scale (shift count) */
+	uint8_t wscale;
+	/** SACK-Permitted option present */
+	bool sack_perm;
+	/** Timestamps option present */
+	bool has_ts;
+	/** Timestamp value (TSval) */
+	uint32_t ts_val;
+	/** Timestamp echo reply (TSecr) */
+	uint32_t ts_ecr;
+	/** Number of SACK blocks */
+	unsigned sack_cnt;
+	/** SACK blocks */
+	tcp_sack_block_t sack[TCP_SACK_BLOCKS_MAX];
+} tcp_seg_opts_t;
+
 typedef struct {
 	/** SYN, FIN */
 	tcp_control_t ctrl;
@@ -164,10 +201,17 @@ typedef struct {
 	uint32_t ack;
 	/** Segment length in sequence space */
 	uint32_t len;
-	/** Segment window */
+	/** Segment window (as sent, not scaled) */
 	uint32_t wnd;
 	/** Segment urgent pointer */
 	uint32_t up;
+	/** Segment options */
+	tcp_seg_opts_t opts;
+	/**
+	 * Maximum text size of one transmitted segment. If non-zero, the
+	 * segment may carry more text and the network stack splits it.
+	 */
+	uint32_t gso_size;
 
 	/** Segment data, may be moved when trimming segment */
 	void *data;
@@ -191,7 +235,8 @@ typedef struct {
 /** NCSim queue entry */
 typedef struct {
 	link_t link;
-	usec_t delay;
+	/** Time when the segment should be delivered */
+	struct timespec due;
 	inet_ep2_t epp;
 	tcp_segment_t *seg;
 } tcp_squeue_entry_t;
@@ -207,6 +252,8 @@ typedef struct {
 	link_t link;
 	tcp_conn_t *conn;
 	tcp_segment_t *seg;
+	/** Segment has been selectively acknowledged by the peer */
+	bool sacked;
 } tcp_tqueue_entry_t;
 
 /** Retransmission queue callbacks */
@@ -225,8 +272,88 @@ typedef struct {
 
 	/** Callbacks */
 	tcp_tqueue_cb_t *cb;
+
+	/** Smoothed round-trip time (SRTT), zero until first measurement */
+	usec_t srtt;
+	/** Round-trip time variation (RTTVAR) */
+	usec_t rttvar;
+	/** Retransmission timeout (RTO), including any backoff */
+	usec_t rto;
+	/** Number of consecutive timeouts without forward progress */
+	unsigned backoff;
+
+	/** A segment is being timed for RTT measurement */
+	bool rtt_timing;
+	/** Sequence number of the segment being timed */
+	uint32_t rtt_seq;
+	/** Time when the segment being timed was sent */
+	struct timespec rtt_start;
+
+	/** Retransmitting the queue after a timeout */
+	bool rtx_active;
+	/** Next sequence number to retransmit after a timeout */
+	uint32_t rtx_nxt;
+
+	/** Sequence number following the highest SACKed segment */
+	uint32_t sack_high;
+	/** Next sequence number to retransmit in SACK-based recovery */
+	uint32_t sack_rtx_nxt;
 } tcp_tqueue_t;
 
+/** CUBIC congestion control state */
+typedef struct {
+	/** Window size just before the last reduction (bytes) */
+	uint32_t w_max;
+	/** W_max before the last reduction, for fast convergence */
+	uint32_t w_last_max;
+	/** Time to increase the window back to W_max (ms) */
+	uint32_t k;
+	/** Congestion avoidance epoch has started */
+	bool epoch_valid;
+	/** Start of the current congestion avoidance epoch */
+	struct timespec epoch;
+	/** Reno-friendly window estimate (bytes) */
+	uint32_t w_est;
+	/** Bytes acked towards the next increase of @c w_est */
+	uint32_t est_acked;
+} tcp_cubic_t;
+
+struct tcp_cc_ops;
+
+/** Congestion control state */
+typedef struct {
+	/** Congestion control algorithm */
+	struct tcp_cc_ops *ops;
+	/** Sender maximum segment size */
+	uint32_t smss;
+	/** Congestion window */
+	uint32_t cwnd;
+	/** Slow start threshold */
+	uint32_t ssthresh;
+	/** Bytes acked towards the next increase in congestion avoidance */
+	uint32_t ca_acked;
+	/** Number of duplicate ACKs received in a row */
+	unsigned dupacks;
+	/** Performing fast recovery */
+	bool in_recovery;
+	/** Highest sequence number sent when loss was detected */
+	uint32_t recover;
+	/** CUBIC state */
+	tcp_cubic_t cubic;
+} tcp_cc_t;
+
+/** Congestion control algorithm */
+typedef struct tcp_cc_ops {
+	/** Algorithm name */
+	const char *name;
+	/** Initialize per-connection state */
+	void (*init)(struct tcp_conn *);
+	/** New data has been acknowledged outside of fast recovery */
+	void (*ack)(struct tcp_conn *, uint32_t);
+	/** Loss has been detected, set new slow start threshold */
+	void (*loss)(struct tcp_conn *);
+} tcp_cc_ops_t;
+
 /** Connection */
 struct tcp_conn {
 	char *name;
@@ -267,6 +394,8 @@ struct tcp_conn {
 
 	/** Retransmission queue */
 	tcp_tqueue_t retransmit;
+	/** Congestion control */
+	tcp_cc_t cc;
 
 	/** Time-Wait timeout timer */
 	fibril_timer_t *tw_timer;
@@ -275,6 +404,8 @@ struct tcp_conn {
 	uint8_t *rcv_buf;
 	/** Receive buffer size */
 	size_t rcv_buf_size;
+	/** Receive buffer offset of first unread byte */
+	size_t rcv_buf_start;
 	/** Receive buffer number of bytes used */
 	size_t rcv_buf_used;
 	/** Receive buffer contains FIN */
@@ -316,6 +447,23 @@ struct tcp_conn {
 	uint32_t rcv_up;
 	/** Initial receive sequence number */
 	uint32_t irs;
+
+	/** Window scaling is in use */
+	bool ws_ok;
+	/** Send window scale (shift count), as announced by peer */
+	uint8_t snd_wscale;
+	/** Receive window scale (shift count), as announced by us */
+	uint8_t rcv_wscale;
+	/** Peer accepts SACK */
+	bool sack_ok;
+	/** Sequence number of most recently received out-of-order segment */
+	uint32_t rcv_sack_seq;
+	/** Timestamps are in use */
+	bool ts_ok;
+	/** Timestamp to echo in next segment (TS.Recent) */
+	uint32_t ts_recent;
+	/** Last acknowledgement number sent (Last.ACK.sent) */
+	uint32_t last_ack_sent;
 };
 
 /** Continuation of processing.
@@ -342,6 +490,8 @@ typedef struct {
 	void *text;
 	/** Text size */
 	size_t text_size;
+	/** Transmit offload (checksum is partial if requested) */
+	inet_offload_t offload;
 } tcp_pdu_t;
 
 /** TCP client connection */
@@ -36,9 +36,15 @@
 
 #include <async.h>
 #include <errno.h>
+#include <inttypes.h>
+#include <macros.h>
 #include <stdio.h>
 #include <fibril.h>
+#include <fibril_synch.h>
 #include <str.h>
+#include <time.h>
+#include "conn.h"
+#include "ncsim.h"
 #include "tcp_type.h"
 #include "ucall.h"
 
@@ -46,6 +52,16 @@
 
 #define RCV_BUF_SIZE 64
 
+/** Amount of data transferred by the bulk transfer test */
+#define BULK_SIZE (1024 * 1024)
+/** Size of chunks passed to the send and receive user calls */
+#define BULK_CHUNK 4096
+
+/** Client side of bulk transfer test */
+static tcp_conn_t *bulk_cconn;
+static FIBRIL_MUTEX_INITIALIZE(bulk_lock);
+static FIBRIL_CONDVAR_INITIALIZE(bulk_cv);
+
 static errno_t test_srv(void *arg)
 {
 	tcp_conn_t *conn;
@@ -152,6 +168,152 @@ void tcp_test(void)
 	}
 }
 
+static errno_t test_bulk_cli(void *arg)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+	static uint8_t buf[BULK_CHUNK];
+	size_t sent;
+	size_t i;
+
+	inet_ep2_init(&epp);
+
+	inet_addr(&epp.local.addr, 127, 0, 0, 1);
+	epp.local.port = 1024;
+
+	inet_addr(&epp.remote.addr, 127, 0, 0, 1);
+	epp.remote.port = 80;
+
+	for (i = 0; i < BULK_CHUNK; i++)
+		buf[i] = i;
+
+	if (tcp_uc_open(&epp, ap_active, 0, &conn) != TCP_EOK) {
+		printf("C: Failed to open connection.\n");
+		return 0;
+	}
+
+	conn->name = (char *) "C";
+
+	fibril_mutex_lock(&bulk_lock);
+	bulk_cconn = conn;
+	fibril_condvar_broadcast(&bulk_cv);
+	fibril_mutex_unlock(&bulk_lock);
+
+	sent = 0;
+	while (sent < BULK_SIZE) {
+		if (tcp_uc_send(conn, buf, BULK_CHUNK, 0) != TCP_EOK) {
+			printf("C: Send failed.\n");
+			break;
+		}
+
+		sent += BULK_CHUNK;
+	}
+
+	tcp_uc_close(conn);
+	return 0;
+}
+
+static errno_t test_bulk(void *arg)
+{
+	tcp_conn_t *conn;
+	tcp_conn_t *cconn;
+	inet_ep2_t epp;
+	static uint8_t buf[BULK_CHUNK];
+	struct timespec start, end;
+	unsigned long segs, dropped;
+	tcp_error_t trc;
+	size_t total;
+	size_t rcvd;
+	xflags_t xflags;
+	usec_t elapsed;
+	fid_t fid;
+
+	inet_ep2_init(&epp);
+
+	inet_addr(&epp.local.addr, 127, 0, 0, 1);
+	epp.local.port = 80;
+
+	trc = tcp_uc_open(&epp, ap_passive, tcp_open_nonblock, &conn);
+	if (trc != TCP_EOK) {
+		printf("S: Failed to open connection.\n");
+		return 0;
+	}
+
+	conn->name = (char *) "S";
+
+	fid = fibril_create(test_bulk_cli, NULL);
+	if (fid == 0) {
+		printf("Failed to create client fibril.\n");
+		return 0;
+	}
+
+	fibril_add_ready(fid);
+
+	fibril_mutex_lock(&bulk_lock);
+	while (bulk_cconn == NULL)
+		fibril_condvar_wait(&bulk_cv, &bulk_lock);
+	cconn = bulk_cconn;
+	fibril_mutex_unlock(&bulk_lock);
+
+	getuptime(&start);
+
+	total = 0;
+	while (true) {
+		tcp_conn_lock(conn);
+		while (conn->rcv_buf_used == 0 && !conn->rcv_buf_fin &&
+		    !conn->reset)
+			fibril_condvar_wait(&conn->rcv_buf_cv, &conn->lock);
+		tcp_conn_unlock(conn);
+
+		trc = tcp_uc_receive(conn, buf, BULK_CHUNK, &rcvd, &xflags);
+		if (trc != TCP_EOK)
+			break;
+
+		total += rcvd;
+	}
+
+	getuptime(&end);
+	elapsed = max(NSEC2USEC(ts_sub_diff(&end, &start)), 1);
+
+	printf("Received %zu bytes in %lld ms, %lld KiB/s (%s).\n", total,
+	    elapsed / 1000, (long long) total * 1000000 / elapsed / 1024,
+	    trc == TCP_ECLOSING ? "complete" : "connection reset");
+
+	tcp_conn_lock(cconn);
+	printf("Sender: %s cwnd=%" PRIu32 " ssthresh=%" PRIu32 " "
+	    "srtt=%lld us rto=%lld us\n", cconn->cc.ops->name,
+	    cconn->cc.cwnd, cconn->cc.ssthresh, cconn->retransmit.srtt,
+	    cconn->retransmit.rto);
+	tcp_conn_unlock(cconn);
+
+	tcp_ncsim_get_stats(&segs, &dropped);
+	printf("Segments: %lu, dropped: %lu\n", segs, dropped);
+
+	tcp_uc_close(conn);
+	return 0;
+}
+
+/** Run bulk transfer test over internal loopback.
+ *
+ * Transfers a fixed amount of data between two connections and reports
+ * throughput and sender congestion control state. Intended to be used
+ * together with the network condition simulator.
+ */
+void tcp_test_bulk(void)
+{
+	fid_t fid;
+
+	printf("tcp_test_bulk()\n");
+
+	fid = fibril_create(test_bulk, NULL);
+	if (fid == 0) {
+		printf("Failed to create test fibril.\n");
+		return;
+	}
+
+	fibril_add_ready(fid);
+}
+
 /**
  * @}
  */
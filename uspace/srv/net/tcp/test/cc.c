@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <io/log.h>
+#include <pcut/pcut.h>
+
+#include "../cc.h"
+#include "../conn.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(cc);
+
+PCUT_TEST_BEFORE
+{
+	errno_t rc;
+
+	/* We will be calling functions that perform logging */
+	rc = log_init("test-tcp");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = tcp_conns_init();
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+PCUT_TEST_AFTER
+{
+	tcp_cc_set_default("newreno");
+	tcp_conns_fini();
+}
+
+/** Create connection with some data in flight */
+static tcp_conn_t *cc_test_conn(void)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->cstate = st_established;
+	conn->snd_una = 1000;
+	conn->snd_nxt = 1000 + conn->cc.cwnd;
+	conn->snd_wnd = 1024 * 1024;
+	/* As after the SYN has been acked */
+	conn->cc.recover = conn->snd_una - 1;
+	return conn;
+}
+
+/** Tear down connection created by cc_test_conn() */
+static void cc_test_conn_fini(tcp_conn_t *conn)
+{
+	tcp_conn_lock(conn);
+	tcp_conn_reset(conn);
+	tcp_conn_unlock(conn);
+	tcp_conn_delete(conn);
+}
+
+/** Selecting algorithm by name */
+PCUT_TEST(set_default)
+{
+	PCUT_ASSERT_ERRNO_VAL(EOK, tcp_cc_set_default("cubic"));
+	PCUT_ASSERT_ERRNO_VAL(EOK, tcp_cc_set_default("newreno"));
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, tcp_cc_set_default("foo"));
+}
+
+/** Initial window and window available for sending */
+PCUT_TEST(init_avail)
+{
+	tcp_conn_t *conn;
+
+	conn = cc_test_conn();
+	PCUT_ASSERT_INT_EQUALS(3 * conn->cc.smss, conn->cc.cwnd);
+	PCUT_ASSERT_INT_EQUALS(0, tcp_cc_avail(conn));
+
+	conn->snd_una += conn->cc.smss;
+	PCUT_ASSERT_INT_EQUALS(conn->cc.smss, tcp_cc_avail(conn));
+
+	cc_test_conn_fini(conn);
+}
+
+/** Slow start grows the window by one segment per ACK */
+PCUT_TEST(slow_start)
+{
+	tcp_conn_t *conn;
+	uint32_t cwnd;
+
+	conn = cc_test_conn();
+	cwnd = conn->cc.cwnd;
+
+	conn->snd_una += 2 * conn->cc.smss;
+	PCUT_ASSERT_FALSE(tcp_cc_ack(conn, 2 * conn->cc.smss));
+	PCUT_ASSERT_INT_EQUALS(cwnd + conn->cc.smss, conn->cc.cwnd);
+
+	cc_test_conn_fini(conn);
+}
+
+/** Third duplicate ACK triggers fast retransmit, full ACK ends recovery */
+PCUT_TEST(fast_recovery)
+{
+	tcp_conn_t *conn;
+	uint32_t flight;
+
+	conn = cc_test_conn();
+	conn->snd_nxt = conn->snd_una + 10 * conn->cc.smss;
+	flight = conn->snd_nxt - conn->snd_una;
+
+	PCUT_ASSERT_FALSE(tcp_cc_dup_ack(conn));
+	PCUT_ASSERT_FALSE(tcp_cc_dup_ack(conn));
+	PCUT_ASSERT_TRUE(tcp_cc_dup_ack(conn));
+	PCUT_ASSERT_TRUE(conn->cc.in_recovery);
+	PCUT_ASSERT_INT_EQUALS(flight / 2, conn->cc.ssthresh);
+	PCUT_ASSERT_INT_EQUALS(conn->cc.ssthresh + 3 * conn->cc.smss,
+	    conn->cc.cwnd);
+
+	/* Partial ACK asks for another retransmission */
+	conn->snd_una += conn->cc.smss;
+	PCUT_ASSERT_TRUE(tcp_cc_ack(conn, conn->cc.smss));
+	PCUT_ASSERT_TRUE(conn->cc.in_recovery);
+
+	/* Full ACK */
+	conn->snd_una = conn->snd_nxt;
+	PCUT_ASSERT_FALSE(tcp_cc_ack(conn, flight - conn->cc.smss));
+	PCUT_ASSERT_FALSE(conn->cc.in_recovery);
+	PCUT_ASSERT_TRUE(conn->cc.cwnd <= conn->cc.ssthresh);
+
+	cc_test_conn_fini(conn);
+}
+
+/** Retransmission timeout collapses the window to one segment */
+PCUT_TEST(timeout)
+{
+	tcp_conn_t *conn;
+	uint32_t ssthresh;
+
+	conn = cc_test_conn();
+
+	tcp_cc_timeout(conn, true);
+	PCUT_ASSERT_INT_EQUALS(conn->cc.smss, conn->cc.cwnd);
+	ssthresh = conn->cc.ssthresh;
+	PCUT_ASSERT_INT_EQUALS(2 * conn->cc.smss, ssthresh);
+
+	/* Repeated timeout of the same segment does not touch ssthresh */
+	tcp_cc_timeout(conn, false);
+	PCUT_ASSERT_INT_EQUALS(ssthresh, conn->cc.ssthresh);
+
+	cc_test_conn_fini(conn);
+}
+
+/** CUBIC reduces the window by beta on loss */
+PCUT_TEST(cubic_loss)
+{
+	tcp_conn_t *conn;
+	uint32_t cwnd;
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, tcp_cc_set_default("cubic"));
+	conn = cc_test_conn();
+	conn->cc.cwnd = 10 * conn->cc.smss;
+	conn->snd_nxt = conn->snd_una + conn->cc.cwnd;
+	cwnd = conn->cc.cwnd;
+
+	tcp_cc_dup_ack(conn);
+	tcp_cc_dup_ack(conn);
+	PCUT_ASSERT_TRUE(tcp_cc_dup_ack(conn));
+	PCUT_ASSERT_INT_EQUALS(cwnd * 7 / 10, conn->cc.ssthresh);
+
+	cc_test_conn_fini(conn);
+}
+
+PCUT_EXPORT(cc);
@@ -175,4 +175,82 @@ PCUT_TEST(two_segments)
 	tcp_conn_delete(conn);
 }
 
+/** Test SACK blocks describing out-of-order segments */
+PCUT_TEST(sack_blocks)
+{
+	tcp_conn_t *conn;
+	tcp_iqueue_t iqueue;
+	inet_ep2_t epp;
+	tcp_segment_t *seg1, *seg2, *seg3;
+	tcp_sack_block_t blocks[TCP_SACK_BLOCKS_MAX];
+	void *data;
+	size_t dsize;
+	unsigned cnt;
+
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->rcv_nxt = 10;
+	conn->rcv_wnd = 100;
+
+	dsize = 10;
+	data = calloc(dsize, 1);
+	PCUT_ASSERT_NOT_NULL(data);
+
+	seg1 = tcp_segment_make_data(0, data, dsize);
+	PCUT_ASSERT_NOT_NULL(seg1);
+	seg2 = tcp_segment_make_data(0, data, dsize);
+	PCUT_ASSERT_NOT_NULL(seg2);
+	seg3 = tcp_segment_make_data(0, data, dsize);
+	PCUT_ASSERT_NOT_NULL(seg3);
+
+	tcp_iqueue_init(&iqueue, conn);
+	cnt = tcp_iqueue_sack_blocks(&iqueue, blocks, TCP_SACK_BLOCKS_MAX);
+	PCUT_ASSERT_INT_EQUALS(0, cnt);
+
+	/* Two adjacent segments and one after a gap */
+	seg1->seq = 20;
+	tcp_iqueue_insert_seg(&iqueue, seg1);
+	seg2->seq = 30;
+	tcp_iqueue_insert_seg(&iqueue, seg2);
+	seg3->seq = 60;
+	tcp_iqueue_insert_seg(&iqueue, seg3);
+
+	/* Block with the most recently received segment goes first */
+	conn->rcv_sack_seq = 60;
+
+	cnt = tcp_iqueue_sack_blocks(&iqueue, blocks, TCP_SACK_BLOCKS_MAX);
+	PCUT_ASSERT_INT_EQUALS(2, cnt);
+	PCUT_ASSERT_INT_EQUALS(60, blocks[0].start);
+	PCUT_ASSERT_INT_EQUALS(70, blocks[0].end);
+	PCUT_ASSERT_INT_EQUALS(20, blocks[1].start);
+	PCUT_ASSERT_INT_EQUALS(40, blocks[1].end);
+
+	cnt = tcp_iqueue_sack_blocks(&iqueue, blocks, 1);
+	PCUT_ASSERT_INT_EQUALS(1, cnt);
+	PCUT_ASSERT_INT_EQUALS(60, blocks[0].start);
+
+	/* Segment starting at RCV.NXT is not out of order */
+	conn->rcv_nxt = 20;
+	conn->rcv_sack_seq = 30;
+
+	cnt = tcp_iqueue_sack_blocks(&iqueue, blocks, TCP_SACK_BLOCKS_MAX);
+	PCUT_ASSERT_INT_EQUALS(2, cnt);
+	PCUT_ASSERT_INT_EQUALS(30, blocks[0].start);
+	PCUT_ASSERT_INT_EQUALS(40, blocks[0].end);
+	PCUT_ASSERT_INT_EQUALS(60, blocks[1].start);
+	PCUT_ASSERT_INT_EQUALS(70, blocks[1].end);
+
+	tcp_iqueue_remove_seg(&iqueue, seg1);
+	tcp_iqueue_remove_seg(&iqueue, seg2);
+	tcp_iqueue_remove_seg(&iqueue, seg3);
+
+	tcp_segment_delete(seg1);
+	tcp_segment_delete(seg2);
+	tcp_segment_delete(seg3);
+	free(data);
+	tcp_conn_delete(conn);
+}
+
 PCUT_EXPORT(iqueue);
@@ -36,6 +36,8 @@
 /** Verify that two segments have the same content */
 void test_seg_same(tcp_segment_t *a, tcp_segment_t *b)
 {
+	unsigned i;
+
 	PCUT_ASSERT_INT_EQUALS(a->ctrl, b->ctrl);
 	PCUT_ASSERT_INT_EQUALS(a->seq, b->seq);
 	PCUT_ASSERT_INT_EQUALS(a->ack, b->ack);
@@ -52,10 +54,31 @@ void test_seg_same(tcp_segment_t *a, tcp_segment_t *b)
 		PCUT_ASSERT_INT_EQUALS(0, memcmp(a->data, b->data,
 		    tcp_segment_text_size(a)));
 	}
+
+	PCUT_ASSERT_EQUALS(a->opts.has_mss, b->opts.has_mss);
+	if (a->opts.has_mss)
+		PCUT_ASSERT_INT_EQUALS(a->opts.mss, b->opts.mss);
+	PCUT_ASSERT_EQUALS(a->opts.has_wscale, b->opts.has_wscale);
+	if (a->opts.has_wscale)
+		PCUT_ASSERT_INT_EQUALS(a->opts.wscale, b->opts.wscale);
+	PCUT_ASSERT_EQUALS(a->opts.sack_perm, b->opts.sack_perm);
+	PCUT_ASSERT_EQUALS(a->opts.has_ts, b->opts.has_ts);
+	if (a->opts.has_ts) {
+		PCUT_ASSERT_INT_EQUALS(a->opts.ts_val, b->opts.ts_val);
+		PCUT_ASSERT_INT_EQUALS(a->opts.ts_ecr, b->opts.ts_ecr);
+	}
+	PCUT_ASSERT_INT_EQUALS(a->opts.sack_cnt, b->opts.sack_cnt);
+	for (i = 0; i < a->opts.sack_cnt; i++) {
+		PCUT_ASSERT_INT_EQUALS(a->opts.sack[i].start,
+		    b->opts.sack[i].start);
+		PCUT_ASSERT_INT_EQUALS(a->opts.sack[i].end,
+		    b->opts.sack[i].end);
+	}
 }
 
 PCUT_INIT;
 
+PCUT_IMPORT(cc);
 PCUT_IMPORT(conn);
 PCUT_IMPORT(iqueue);
 PCUT_IMPORT(pdu);
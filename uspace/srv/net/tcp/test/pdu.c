@@ -108,4 +108,132 @@ PCUT_TEST(encdec_data)
 	free(data);
 }
 
+/** Test encode/decode round trip for SYN PDU with options */
+PCUT_TEST(encdec_syn_opts)
+{
+	tcp_segment_t *seg, *dseg;
+	tcp_pdu_t *pdu;
+	inet_ep2_t epp, depp;
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 1, 2, 3, 4);
+	inet_addr(&epp.remote.addr, 5, 6, 7, 8);
+
+	seg = tcp_segment_make_ctrl(CTL_SYN | CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	seg->seq = 20;
+	seg->ack = 19;
+	seg->wnd = 18;
+	seg->up = 17;
+	seg->opts.has_mss = true;
+	seg->opts.mss = 1460;
+	seg->opts.has_wscale = true;
+	seg->opts.wscale = 7;
+	seg->opts.sack_perm = true;
+	seg->opts.has_ts = true;
+	seg->opts.ts_val = 0x12345678;
+	seg->opts.ts_ecr = 0x9abcdef0;
+
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	/* 20 bytes of fixed header + 20 bytes of options */
+	PCUT_ASSERT_INT_EQUALS(40, pdu->header_size);
+	rc = tcp_pdu_decode(pdu, &depp, &dseg);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	test_seg_same(seg, dseg);
+	tcp_segment_delete(seg);
+}
+
+/** Test encode/decode round trip for ACK PDU with SACK blocks */
+PCUT_TEST(encdec_sack)
+{
+	tcp_segment_t *seg, *dseg;
+	tcp_pdu_t *pdu;
+	inet_ep2_t epp, depp;
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 1, 2, 3, 4);
+	inet_addr(&epp.remote.addr, 5, 6, 7, 8);
+
+	seg = tcp_segment_make_ctrl(CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	seg->seq = 20;
+	seg->ack = 19;
+	seg->wnd = 18;
+	seg->opts.has_ts = true;
+	seg->opts.ts_val = 1;
+	seg->opts.ts_ecr = 2;
+	seg->opts.sack_cnt = 3;
+	seg->opts.sack[0].start = 3000;
+	seg->opts.sack[0].end = 4000;
+	seg->opts.sack[1].start = 1000;
+	seg->opts.sack[1].end = 2000;
+	seg->opts.sack[2].start = 0xfffffff0;
+	seg->opts.sack[2].end = 0x10;
+
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	/* Timestamps (12) + SACK with three blocks (28) */
+	PCUT_ASSERT_INT_EQUALS(60, pdu->header_size);
+	rc = tcp_pdu_decode(pdu, &depp, &dseg);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	test_seg_same(seg, dseg);
+	tcp_segment_delete(seg);
+}
+
+/** Test data PDU is encoded with transmit offload if requested */
+PCUT_TEST(encode_offload)
+{
+	tcp_segment_t *seg;
+	tcp_pdu_t *pdu;
+	inet_ep2_t epp;
+	uint8_t *data;
+	size_t dsize;
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 1, 2, 3, 4);
+	inet_addr(&epp.remote.addr, 5, 6, 7, 8);
+
+	dsize = 3000;
+	data = calloc(1, dsize);
+	PCUT_ASSERT_NOT_NULL(data);
+
+	seg = tcp_segment_make_data(CTL_ACK, data, dsize);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	/* No offload requested */
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_FALSE(pdu->offload.csum_partial);
+	PCUT_ASSERT_INT_EQUALS(0, pdu->offload.gso_size);
+	tcp_pdu_delete(pdu);
+
+	/* Segment needs to be split */
+	seg->gso_size = 1460;
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(pdu->offload.csum_partial);
+	PCUT_ASSERT_INT_EQUALS(1460, pdu->offload.gso_size);
+	PCUT_ASSERT_INT_EQUALS(dsize, pdu->text_size);
+	tcp_pdu_delete(pdu);
+
+	/* Segment fits, only checksum is offloaded */
+	seg->gso_size = 3000;
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(pdu->offload.csum_partial);
+	PCUT_ASSERT_INT_EQUALS(0, pdu->offload.gso_size);
+	tcp_pdu_delete(pdu);
+
+	tcp_segment_delete(seg);
+	free(data);
+}
+
 PCUT_EXPORT(pdu);
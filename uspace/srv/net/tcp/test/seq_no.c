@@ -214,6 +214,9 @@ PCUT_TEST(segment_acked)
 	PCUT_ASSERT_FALSE(seq_no_segment_acked(conn, seg, 24));
 	PCUT_ASSERT_TRUE(seq_no_segment_acked(conn, seg, 25));
 
+	/* Segment beyond SND.UNA is not acked */
+	PCUT_ASSERT_FALSE(seq_no_segment_acked(conn, seg, 5));
+
 	tcp_segment_delete(seg);
 	tcp_conn_delete(conn);
 	free(data);
@@ -520,6 +523,83 @@ PCUT_TEST(seg_cmp)
 	free(data);
 }
 
+/** Test seq_no_paws_reject() */
+PCUT_TEST(paws_reject)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+	tcp_segment_t *seg;
+
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	seg = tcp_segment_make_ctrl(CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	conn->ts_recent = 100;
+	seg->opts.has_ts = true;
+	seg->opts.ts_val = 99;
+
+	/* Timestamps not negotiated */
+	PCUT_ASSERT_FALSE(seq_no_paws_reject(conn, seg));
+
+	conn->ts_ok = true;
+	PCUT_ASSERT_TRUE(seq_no_paws_reject(conn, seg));
+	seg->opts.ts_val = 100;
+	PCUT_ASSERT_FALSE(seq_no_paws_reject(conn, seg));
+	seg->opts.ts_val = 101;
+	PCUT_ASSERT_FALSE(seq_no_paws_reject(conn, seg));
+
+	/* Timestamp clock wraps around */
+	conn->ts_recent = 0xfffffff0;
+	seg->opts.ts_val = 0x10;
+	PCUT_ASSERT_FALSE(seq_no_paws_reject(conn, seg));
+	seg->opts.ts_val = 0xffffffe0;
+	PCUT_ASSERT_TRUE(seq_no_paws_reject(conn, seg));
+
+	/* Segment without timestamp */
+	seg->opts.has_ts = false;
+	PCUT_ASSERT_FALSE(seq_no_paws_reject(conn, seg));
+
+	tcp_segment_delete(seg);
+	tcp_conn_delete(conn);
+}
+
+/** Test seq_no_ts_recent_valid() */
+PCUT_TEST(ts_recent_valid)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+	tcp_segment_t *seg;
+
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	seg = tcp_segment_make_ctrl(CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	conn->ts_ok = true;
+	conn->last_ack_sent = 10;
+	seg->opts.has_ts = true;
+
+	/* SEG.SEQ <= Last.ACK.sent */
+	seg->seq = 9;
+	PCUT_ASSERT_TRUE(seq_no_ts_recent_valid(conn, seg));
+	seg->seq = 10;
+	PCUT_ASSERT_TRUE(seq_no_ts_recent_valid(conn, seg));
+	seg->seq = 11;
+	PCUT_ASSERT_FALSE(seq_no_ts_recent_valid(conn, seg));
+
+	seg->seq = 10;
+	seg->opts.has_ts = false;
+	PCUT_ASSERT_FALSE(seq_no_ts_recent_valid(conn, seg));
+
+	tcp_segment_delete(seg);
+	tcp_conn_delete(conn);
+}
+
 /** Test seq_no_control_len() */
 PCUT_TEST(control_len)
 {
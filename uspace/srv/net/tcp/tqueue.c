@@ -42,9 +42,12 @@
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
+#include "iqueue.h"
 #include "ncsim.h"
 #include "rqueue.h"
 #include "segment.h"
@@ -52,7 +55,14 @@
 #include "tqueue.h"
 #include "tcp_type.h"
 
-#define RETRANSMIT_TIMEOUT	(2*1000*1000)
+/** Initial retransmission timeout */
+#define RTO_INITIAL	SEC2USEC(1)
+/** Lower bound on retransmission timeout */
+#define RTO_MIN		SEC2USEC(1)
+/** Upper bound on retransmission timeout */
+#define RTO_MAX		SEC2USEC(60)
+/** Clock granularity */
+#define RTO_CLOCK_G	MSEC2USEC(1)
 
 static void retransmit_timeout_func(void *);
 static void tcp_tqueue_timer_set(tcp_conn_t *);
@@ -61,6 +71,7 @@ static void tcp_tqueue_seg(tcp_conn_t *, tcp_segment_t *);
 static void tcp_conn_transmit_segment(tcp_conn_t *, tcp_segment_t *);
 static void tcp_prepare_transmit_segment(tcp_conn_t *, tcp_segment_t *);
 static void tcp_tqueue_send_immed(tcp_conn_t *, tcp_segment_t *);
+static void tcp_tqueue_retransmit(tcp_conn_t *, tcp_tqueue_entry_t *);
 
 errno_t tcp_tqueue_init(tcp_tqueue_t *tqueue, tcp_conn_t *conn,
     tcp_tqueue_cb_t *cb)
@@ -73,6 +84,15 @@ errno_t tcp_tqueue_init(tcp_tqueue_t *tqueue, tcp_conn_t *conn,
 
 	list_initialize(&tqueue->list);
 
+	tqueue->srtt = 0;
+	tqueue->rttvar = 0;
+	tqueue->rto = RTO_INITIAL;
+	tqueue->backoff = 0;
+	tqueue->rtt_timing = false;
+	tqueue->rtx_active = false;
+	tqueue->sack_high = 0;
+	tqueue->sack_rtx_nxt = 0;
+
 	return EOK;
 }
 
@@ -114,11 +134,106 @@ void tcp_tqueue_ctrl_seg(tcp_conn_t *conn, tcp_control_t ctrl)
 	tcp_segment_delete(seg);
 }
 
-static void tcp_tqueue_seg(tcp_conn_t *conn, tcp_segment_t *seg)
+/** Determine maximum amount of data to put into one segment.
+ *
+ * Over IPv4 the network stack can split segments (in the NIC or in
+ * software), so we hand it as many full-sized segments as fit into one
+ * datagram. Otherwise segments carry at most one SMSS.
+ *
+ * @param conn	Connection
+ * @return Maximum text size of one segment
+ */
+static size_t tcp_tqueue_seg_max(tcp_conn_t *conn)
+{
+	size_t smss = conn->cc.smss;
+
+	if (conn->ident.remote.addr.version != ip_v4 || smss == 0)
+		return smss;
+
+	return max(smss, (TCP_GSO_MAX / smss) * smss);
+}
+
+/** Add segment to retransmission queue.
+ *
+ * @param conn	Connection
+ * @param seg	Segment (will be copied)
+ * @param seq	Sequence number of the segment
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t tcp_tqueue_rtx_add(tcp_conn_t *conn, tcp_segment_t *seg,
+    uint32_t seq)
 {
 	tcp_segment_t *rt_seg;
 	tcp_tqueue_entry_t *tqe;
 
+	rt_seg = tcp_segment_dup(seg);
+	if (rt_seg == NULL)
+		return ENOMEM;
+
+	tqe = calloc(1, sizeof(tcp_tqueue_entry_t));
+	if (tqe == NULL) {
+		tcp_segment_delete(rt_seg);
+		return ENOMEM;
+	}
+
+	tqe->conn = conn;
+	tqe->seg = rt_seg;
+	rt_seg->seq = seq;
+
+	list_append(&tqe->link, &conn->retransmit.list);
+	return EOK;
+}
+
+/** Add segment to retransmission queue in pieces of at most one SMSS.
+ *
+ * A segment carrying more than one SMSS of data is split by the network
+ * stack on transmission. Queueing the individual segments allows
+ * acknowledging and retransmitting them separately.
+ *
+ * @param conn	Connection
+ * @param seg	Segment
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t tcp_tqueue_rtx_add_split(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	tcp_segment_t *piece;
+	size_t text_size;
+	size_t offs;
+	size_t xfer;
+	tcp_control_t ctrl;
+	errno_t rc;
+
+	text_size = tcp_segment_text_size(seg);
+	if (text_size <= conn->cc.smss)
+		return tcp_tqueue_rtx_add(conn, seg, conn->snd_nxt);
+
+	offs = 0;
+	while (offs < text_size) {
+		xfer = min(conn->cc.smss, text_size - offs);
+
+		/* FIN only belongs to the last piece */
+		ctrl = seg->ctrl;
+		if (offs + xfer < text_size)
+			ctrl &= ~CTL_FIN;
+
+		piece = tcp_segment_make_data(ctrl, (uint8_t *) seg->data + offs,
+		    xfer);
+		if (piece == NULL)
+			return ENOMEM;
+
+		rc = tcp_tqueue_rtx_add(conn, piece, conn->snd_nxt + offs);
+		tcp_segment_delete(piece);
+		if (rc != EOK)
+			return rc;
+
+		offs += xfer;
+	}
+
+	return EOK;
+}
+
+static void tcp_tqueue_seg(tcp_conn_t *conn, tcp_segment_t *seg)
+{
 	assert(fibril_mutex_is_locked(&conn->lock));
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_seg(%p, %p)", conn->name, conn,
@@ -129,28 +244,25 @@ static void tcp_tqueue_seg(tcp_conn_t *conn, tcp_segment_t *seg)
 	 */
 
 	if (seg->len > 0) {
-		rt_seg = tcp_segment_dup(seg);
-		if (rt_seg == NULL) {
+		if (tcp_tqueue_rtx_add_split(conn, seg) != EOK) {
 			log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
 			/* XXX Handle properly */
 			return;
 		}
 
-		tqe = calloc(1, sizeof(tcp_tqueue_entry_t));
-		if (tqe == NULL) {
-			log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
-			/* XXX Handle properly */
-			return;
+		/*
+		 * Time one segment at a time to measure round-trip time,
+		 * unless timestamps give us a measurement with every ACK.
+		 */
+		if (!conn->ts_ok && !conn->retransmit.rtt_timing) {
+			conn->retransmit.rtt_timing = true;
+			conn->retransmit.rtt_seq = conn->snd_nxt;
+			getuptime(&conn->retransmit.rtt_start);
 		}
 
-		tqe->conn = conn;
-		tqe->seg = rt_seg;
-		rt_seg->seq = conn->snd_nxt;
-
-		list_append(&tqe->link, &conn->retransmit.list);
-
-		/* Set retransmission timer */
-		tcp_tqueue_timer_set(conn);
+		/* Set retransmission timer unless it is already running */
+		if (conn->retransmit.timer->state != fts_active)
+			tcp_tqueue_timer_set(conn);
 	}
 
 	tcp_prepare_transmit_segment(conn, seg);
@@ -158,14 +270,6 @@ static void tcp_tqueue_seg(tcp_conn_t *conn, tcp_segment_t *seg)
 
 static void tcp_prepare_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 {
-	/*
-	 * Always send ACK once we have received SYN, except for RST segments.
-	 * (Spec says we should always send ACK once connection has been
-	 * established.)
-	 */
-	if (tcp_conn_got_syn(conn) && (seg->ctrl & CTL_RST) == 0)
-		seg->ctrl |= CTL_ACK;
-
 	seg->seq = conn->snd_nxt;
 	conn->snd_nxt += seg->len;
 
@@ -173,15 +277,21 @@ static void tcp_prepare_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 }
 
 /** Transmit data from the send buffer.
+ *
+ * Data is sent in segments of at most one SMSS, as long as both the
+ * send window and the congestion window allow it. Consecutive full-sized
+ * segments may be passed down together for the network stack to split.
  *
  * @param conn	Connection
  */
 void tcp_tqueue_new_data(tcp_conn_t *conn)
 {
+	uint32_t in_flight;
 	size_t avail_wnd;
 	size_t xfer_seqlen;
 	size_t snd_buf_seqlen;
 	size_t data_size;
+	size_t seg_max;
 	tcp_control_t ctrl;
 	bool send_fin;
 
@@ -189,52 +299,289 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_new_data()", conn->name);
 
-	/* Number of free sequence numbers in send window */
-	avail_wnd = (conn->snd_una + conn->snd_wnd) - conn->snd_nxt;
-	snd_buf_seqlen = conn->snd_buf_used + (conn->snd_buf_fin ? 1 : 0);
+	while (true) {
+		/* Number of free sequence numbers in send window */
+		in_flight = conn->snd_nxt - conn->snd_una;
+		avail_wnd = conn->snd_wnd > in_flight ?
+		    conn->snd_wnd - in_flight : 0;
+		avail_wnd = min(avail_wnd, tcp_cc_avail(conn));
+		snd_buf_seqlen = conn->snd_buf_used + (conn->snd_buf_fin ? 1 : 0);
+
+		xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: snd_buf_seqlen = %zu, "
+		    "SND.WND = %" PRIu32 ", cwnd = %" PRIu32 ", "
+		    "xfer_seqlen = %zu", conn->name, snd_buf_seqlen,
+		    conn->snd_wnd, conn->cc.cwnd, xfer_seqlen);
+
+		if (xfer_seqlen == 0)
+			return;
 
-	xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: snd_buf_seqlen = %zu, SND.WND = %" PRIu32 ", "
-	    "xfer_seqlen = %zu", conn->name, snd_buf_seqlen, conn->snd_wnd,
-	    xfer_seqlen);
+		/* XXX Do not always send immediately */
 
-	if (xfer_seqlen == 0)
-		return;
+		send_fin = conn->snd_buf_fin && xfer_seqlen == snd_buf_seqlen;
+		data_size = xfer_seqlen - (send_fin ? 1 : 0);
+
+		seg_max = tcp_tqueue_seg_max(conn);
+		if (data_size > seg_max) {
+			data_size = seg_max;
+			send_fin = false;
+		}
+
+		/* Only the last segment of the send buffer may be short */
+		if (data_size > conn->cc.smss && data_size < conn->snd_buf_used)
+			data_size -= data_size % conn->cc.smss;
+
+		/*
+		 * Avoid silly window syndrome. Wait for a full segment
+		 * worth of window while there is still data in flight.
+		 */
+		if (data_size < conn->cc.smss &&
+		    data_size < conn->snd_buf_used &&
+		    conn->snd_nxt != conn->snd_una)
+			return;
+
+		if (send_fin) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.",
+			    conn->name);
+			/* We are sending out FIN */
+			ctrl = CTL_FIN;
+		} else {
+			ctrl = 0;
+		}
+
+		seg = tcp_segment_make_data(ctrl, conn->snd_buf, data_size);
+		if (seg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
+			return;
+		}
+
+		/* Remove data from send buffer */
+		memmove(conn->snd_buf, conn->snd_buf + data_size,
+		    conn->snd_buf_used - data_size);
+		conn->snd_buf_used -= data_size;
+
+		if (send_fin)
+			conn->snd_buf_fin = false;
+
+		fibril_condvar_broadcast(&conn->snd_buf_cv);
 
-	/* XXX Do not always send immediately */
+		if (send_fin)
+			tcp_conn_fin_sent(conn);
 
-	send_fin = conn->snd_buf_fin && xfer_seqlen == snd_buf_seqlen;
-	data_size = xfer_seqlen - (send_fin ? 1 : 0);
+		tcp_tqueue_seg(conn, seg);
+		tcp_segment_delete(seg);
+	}
+}
+
+/** Update round-trip time estimate with a new measurement.
+ *
+ * Computes SRTT, RTTVAR and RTO according to RFC 6298.
+ *
+ * @param conn	Connection
+ * @param rtt	Measured round-trip time
+ */
+static void tcp_tqueue_rtt_update(tcp_conn_t *conn, usec_t rtt)
+{
+	tcp_tqueue_t *tqueue = &conn->retransmit;
+	usec_t err;
+
+	/* Zero SRTT means no measurement yet */
+	rtt = max(rtt, 1);
 
-	if (send_fin) {
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.", conn->name);
-		/* We are sending out FIN */
-		ctrl = CTL_FIN;
+	if (tqueue->srtt == 0) {
+		tqueue->srtt = rtt;
+		tqueue->rttvar = rtt / 2;
 	} else {
-		ctrl = 0;
+		err = tqueue->srtt > rtt ? tqueue->srtt - rtt :
+		    rtt - tqueue->srtt;
+		tqueue->rttvar = (3 * tqueue->rttvar + err) / 4;
+		tqueue->srtt = (7 * tqueue->srtt + rtt) / 8;
 	}
 
-	seg = tcp_segment_make_data(ctrl, conn->snd_buf, data_size);
-	if (seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
+	tqueue->rto = tqueue->srtt + max(RTO_CLOCK_G, 4 * tqueue->rttvar);
+	tqueue->rto = max(tqueue->rto, RTO_MIN);
+	tqueue->rto = min(tqueue->rto, RTO_MAX);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: RTT=%lld SRTT=%lld RTTVAR=%lld "
+	    "RTO=%lld", conn->name, rtt, tqueue->srtt, tqueue->rttvar,
+	    tqueue->rto);
+}
+
+/** Current value of timestamp clock (1 ms per tick). */
+static uint32_t tcp_ts_now(void)
+{
+	struct timespec now;
+
+	getuptime(&now);
+	return SEC2MSEC(now.tv_sec) + NSEC2MSEC(now.tv_nsec);
+}
+
+/** Take round-trip time measurement from echoed timestamp.
+ *
+ * @param conn		Connection
+ * @param ts_ecr	Timestamp echoed in ACK of new data
+ */
+void tcp_tqueue_ts_rtt(tcp_conn_t *conn, uint32_t ts_ecr)
+{
+	uint32_t rtt;
+
+	rtt = tcp_ts_now() - ts_ecr;
+
+	/* Ignore bogus echo */
+	if (rtt > USEC2MSEC(RTO_MAX))
 		return;
+
+	tcp_tqueue_rtt_update(conn, MSEC2USEC(rtt));
+}
+
+/** Process SACK blocks received from the peer.
+ *
+ * Mark segments in the retransmission queue which the peer has received
+ * so that we do not retransmit them during loss recovery.
+ *
+ * @param conn	Connection
+ * @param opts	Options of the received segment
+ */
+void tcp_tqueue_sack_received(tcp_conn_t *conn, tcp_seg_opts_t *opts)
+{
+	tcp_tqueue_t *tqueue = &conn->retransmit;
+	uint32_t flight;
+	uint32_t high;
+	uint32_t start, end;
+	uint32_t sstart;
+	unsigned i;
+
+	/* Work with offsets from SND.UNA */
+	flight = conn->snd_nxt - conn->snd_una;
+	high = tqueue->sack_high - conn->snd_una;
+	if (high > flight)
+		high = 0;
+
+	for (i = 0; i < opts->sack_cnt; i++) {
+		start = opts->sack[i].start - conn->snd_una;
+		end = opts->sack[i].end - conn->snd_una;
+
+		/* Ignore blocks below SND.UNA or beyond SND.NXT */
+		if (start >= end || end > flight)
+			continue;
+
+		list_foreach(tqueue->list, link, tcp_tqueue_entry_t, tqe) {
+			sstart = tqe->seg->seq - conn->snd_una;
+
+			/* Acked, but not removed from the queue yet */
+			if (sstart >= flight)
+				continue;
+
+			if (sstart >= end)
+				break;
+
+			if (sstart >= start && sstart + tqe->seg->len <= end) {
+				tqe->sacked = true;
+				high = max(high, sstart + tqe->seg->len);
+			}
+		}
 	}
 
-	/* Remove data from send buffer */
-	memmove(conn->snd_buf, conn->snd_buf + data_size,
-	    conn->snd_buf_used - data_size);
-	conn->snd_buf_used -= data_size;
+	tqueue->sack_high = conn->snd_una + high;
+}
+
+/** Find next segment to retransmit in SACK-based loss recovery.
+ *
+ * A segment is considered lost if it has not been SACKed, but more than
+ * (DupThresh - 1) * SMSS bytes above it have been (RFC 6675 section 4).
+ * Each segment is retransmitted at most once during a recovery.
+ *
+ * @param conn	Connection
+ * @return	Queue entry or @c NULL if there is no segment to retransmit
+ */
+static tcp_tqueue_entry_t *tcp_tqueue_sack_hole(tcp_conn_t *conn)
+{
+	tcp_tqueue_t *tqueue = &conn->retransmit;
+	uint32_t sacked_above;
+	uint32_t flight;
+	uint32_t rtx_off;
+	uint32_t off;
+
+	sacked_above = 0;
+	list_foreach(tqueue->list, link, tcp_tqueue_entry_t, tqe) {
+		if (tqe->sacked)
+			sacked_above += tqe->seg->len;
+	}
 
-	if (send_fin)
-		conn->snd_buf_fin = false;
+	flight = conn->snd_nxt - conn->snd_una;
+	rtx_off = tqueue->sack_rtx_nxt - conn->snd_una;
+	if (rtx_off > flight)
+		rtx_off = 0;
 
-	fibril_condvar_broadcast(&conn->snd_buf_cv);
+	list_foreach(tqueue->list, link, tcp_tqueue_entry_t, tqe) {
+		if (sacked_above <= (TCP_DUPACK_THRESH - 1) * conn->cc.smss)
+			break;
 
-	if (send_fin)
-		tcp_conn_fin_sent(conn);
+		if (tqe->sacked) {
+			sacked_above -= tqe->seg->len;
+			continue;
+		}
 
-	tcp_tqueue_seg(conn, seg);
-	tcp_segment_delete(seg);
+		off = tqe->seg->seq - conn->snd_una;
+		if (off < rtx_off || off >= flight)
+			continue;
+
+		return tqe;
+	}
+
+	return NULL;
+}
+
+/** Retransmit segment as part of fast recovery.
+ *
+ * @param conn	Connection
+ * @param tqe	Retransmission queue entry
+ */
+static void tcp_tqueue_recovery_rtx(tcp_conn_t *conn, tcp_tqueue_entry_t *tqe)
+{
+	tcp_tqueue_retransmit(conn, tqe);
+	conn->retransmit.sack_rtx_nxt = tqe->seg->seq + tqe->seg->len;
+}
+
+/** Retransmit more of the queue after a timeout.
+ *
+ * After the retransmission timer expires, segments are retransmitted
+ * again in order as the congestion window opens up, until everything
+ * that was outstanding at the time of the timeout has been acknowledged.
+ *
+ * @param conn	Connection
+ */
+static void tcp_tqueue_rtx_more(tcp_conn_t *conn)
+{
+	tcp_tqueue_t *tqueue = &conn->retransmit;
+	uint32_t done;
+
+	if (seq_no_recover_acked(conn) || list_empty(&tqueue->list)) {
+		tqueue->rtx_active = false;
+		return;
+	}
+
+	/* Offset of the first byte not yet retransmitted again */
+	done = tqueue->rtx_nxt - conn->snd_una;
+	if (done > conn->snd_nxt - conn->snd_una)
+		done = 0;
+
+	list_foreach(tqueue->list, link, tcp_tqueue_entry_t, tqe) {
+		/* Skip segments that have already been retransmitted */
+		if (tqe->seg->seq + tqe->seg->len - conn->snd_una <= done)
+			continue;
+
+		/* Skip segments the peer has reported as received */
+		if (tqe->sacked)
+			continue;
+
+		if (done + tqe->seg->len > conn->cc.cwnd && done != 0)
+			break;
+
+		tcp_tqueue_retransmit(conn, tqe);
+		tqueue->rtx_nxt = tqe->seg->seq + tqe->seg->len;
+		done = tqueue->rtx_nxt - conn->snd_una;
+	}
 }
 
 /** Remove ACKed segments from retransmission queue and possibly transmit
@@ -244,11 +591,17 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
  */
 void tcp_tqueue_ack_received(tcp_conn_t *conn)
 {
+	tcp_tqueue_t *tqueue = &conn->retransmit;
 	link_t *cur, *next;
+	tcp_tqueue_entry_t *tqe;
+	struct timespec now;
+	uint32_t acked;
+	link_t *link;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_ack_received(%p)", conn->name,
 	    conn);
 
+	acked = 0;
 	cur = conn->retransmit.list.head.next;
 
 	while (cur != &conn->retransmit.list.head) {
@@ -270,6 +623,15 @@ void tcp_tqueue_ack_received(tcp_conn_t *conn)
 				conn->fin_is_acked = true;
 			}
 
+			/* Round-trip time measurement complete */
+			if (tqueue->rtt_timing && tqe->seg->seq == tqueue->rtt_seq) {
+				tqueue->rtt_timing = false;
+				getuptime(&now);
+				tcp_tqueue_rtt_update(conn,
+				    NSEC2USEC(ts_sub_diff(&now, &tqueue->rtt_start)));
+			}
+
+			acked += tqe->seg->len;
 			tcp_segment_delete(tqe->seg);
 			free(tqe);
 
@@ -280,6 +642,32 @@ void tcp_tqueue_ack_received(tcp_conn_t *conn)
 		cur = next;
 	}
 
+	if (acked > 0) {
+		tqueue->backoff = 0;
+
+		if (tcp_cc_ack(conn, acked)) {
+			/* Partial ACK in fast recovery, resend next hole */
+			link = list_first(&tqueue->list);
+			tqe = NULL;
+			if (link != NULL) {
+				tqe = list_get_instance(link,
+				    tcp_tqueue_entry_t, link);
+			}
+
+			/* With SACK skip holes we have already filled */
+			if (tqe != NULL && conn->sack_ok &&
+			    tqe->seg->seq - conn->snd_una <
+			    tqueue->sack_rtx_nxt - conn->snd_una)
+				tqe = tcp_tqueue_sack_hole(conn);
+
+			if (tqe != NULL)
+				tcp_tqueue_recovery_rtx(conn, tqe);
+		}
+
+		if (tqueue->rtx_active)
+			tcp_tqueue_rtx_more(conn);
+	}
+
 	/* Clear retransmission timer if the queue is empty. */
 	if (list_empty(&conn->retransmit.list))
 		tcp_tqueue_timer_clear(conn);
@@ -288,17 +676,146 @@ void tcp_tqueue_ack_received(tcp_conn_t *conn)
 	tcp_tqueue_new_data(conn);
 }
 
+/** Duplicate ACK has been received.
+ *
+ * Counts duplicate ACKs and performs fast retransmit of the first
+ * unacknowledged segment once enough of them have been received.
+ * The caller is expected to call tcp_tqueue_ack_received() afterwards,
+ * which may transmit more data thanks to the inflated window.
+ *
+ * @param conn	Connection
+ */
+void tcp_tqueue_dup_ack(tcp_conn_t *conn)
+{
+	tcp_tqueue_entry_t *tqe;
+	link_t *link;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_dup_ack()", conn->name);
+
+	if (!tcp_cc_dup_ack(conn)) {
+		/*
+		 * In recovery each further duplicate ACK means a segment
+		 * has left the network, use it to fill another hole.
+		 */
+		if (conn->sack_ok && conn->cc.in_recovery) {
+			tqe = tcp_tqueue_sack_hole(conn);
+			if (tqe != NULL)
+				tcp_tqueue_recovery_rtx(conn, tqe);
+		}
+
+		return;
+	}
+
+	/* Fast retransmit */
+	link = list_first(&conn->retransmit.list);
+	if (link != NULL) {
+		tcp_tqueue_recovery_rtx(conn, list_get_instance(link,
+		    tcp_tqueue_entry_t, link));
+	}
+}
+
+/** Retransmit segment from retransmission queue.
+ *
+ * @param conn	Connection
+ * @param tqe	Retransmission queue entry
+ */
+static void tcp_tqueue_retransmit(tcp_conn_t *conn, tcp_tqueue_entry_t *tqe)
+{
+	tcp_segment_t *rt_seg;
+
+	rt_seg = tcp_segment_dup(tqe->seg);
+	if (rt_seg == NULL) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
+		/* XXX Handle properly */
+		return;
+	}
+
+	/* Do not measure RTT across retransmissions (Karn's algorithm) */
+	conn->retransmit.rtt_timing = false;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment "
+	    "SEG.SEQ=%" PRIu32, conn->name, rt_seg->seq);
+	tcp_conn_transmit_segment(conn, rt_seg);
+	tcp_segment_delete(rt_seg);
+}
+
+/** Fill in options of outgoing segment.
+ *
+ * @param conn	Connection
+ * @param seg	Segment
+ */
+static void tcp_tqueue_seg_opts(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	tcp_seg_opts_t *opts = &seg->opts;
+	bool offer;
+
+	memset(opts, 0, sizeof(tcp_seg_opts_t));
+
+	if ((seg->ctrl & CTL_RST) != 0)
+		return;
+
+	if ((seg->ctrl & CTL_SYN) != 0) {
+		/* Offer everything in SYN, accept the offer in SYN-ACK */
+		offer = !tcp_conn_got_syn(conn);
+
+		opts->has_mss = true;
+		opts->mss = TCP_MSS;
+		opts->has_wscale = offer || conn->ws_ok;
+		opts->wscale = conn->rcv_wscale;
+		opts->sack_perm = offer || conn->sack_ok;
+		opts->has_ts = offer || conn->ts_ok;
+	} else {
+		opts->has_ts = conn->ts_ok;
+	}
+
+	if (opts->has_ts) {
+		opts->ts_val = tcp_ts_now();
+		if ((seg->ctrl & CTL_ACK) != 0)
+			opts->ts_ecr = conn->ts_recent;
+	}
+
+	/* Tell the peer about out-of-order data we are holding */
+	if (conn->sack_ok && (seg->ctrl & (CTL_SYN | CTL_ACK)) == CTL_ACK) {
+		opts->sack_cnt = tcp_iqueue_sack_blocks(&conn->incoming,
+		    opts->sack, opts->has_ts ? TCP_SACK_BLOCKS_MAX - 1 :
+		    TCP_SACK_BLOCKS_MAX);
+	}
+}
+
 static void tcp_conn_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 {
+	uint32_t wnd;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_conn_transmit_segment(%p, %p)",
 	    conn->name, conn, seg);
 
-	seg->wnd = conn->rcv_wnd;
+	/*
+	 * Always send ACK once we have received SYN, except for RST segments.
+	 * (Spec says we should always send ACK once connection has been
+	 * established.) This applies to retransmitted segments, too.
+	 */
+	if (tcp_conn_got_syn(conn) && (seg->ctrl & CTL_RST) == 0)
+		seg->ctrl |= CTL_ACK;
+
+	/* The window in SYN segments is never scaled */
+	wnd = conn->rcv_wnd;
+	if ((seg->ctrl & CTL_SYN) == 0 && conn->ws_ok)
+		wnd >>= conn->rcv_wscale;
+	seg->wnd = min(wnd, UINT16_MAX);
 
-	if ((seg->ctrl & CTL_ACK) != 0)
+	if ((seg->ctrl & CTL_ACK) != 0) {
 		seg->ack = conn->rcv_nxt;
-	else
+		conn->last_ack_sent = seg->ack;
+	} else {
 		seg->ack = 0;
+	}
+
+	tcp_tqueue_seg_opts(conn, seg);
+
+	/* Let the network stack split segments and compute checksum */
+	if (conn->ident.remote.addr.version == ip_v4 &&
+	    tcp_segment_text_size(seg) > 0)
+		seg->gso_size = conn->cc.smss;
 
 	tcp_tqueue_send_immed(conn, seg);
 }
@@ -320,8 +837,8 @@ void tcp_tqueue_send_immed(tcp_conn_t *conn, tcp_segment_t *seg)
 static void retransmit_timeout_func(void *arg)
 {
 	tcp_conn_t *conn = (tcp_conn_t *) arg;
+	tcp_tqueue_t *tqueue = &conn->retransmit;
 	tcp_tqueue_entry_t *tqe;
-	tcp_segment_t *rt_seg;
 	link_t *link;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmit_timeout_func(%p)", conn->name, conn);
@@ -345,20 +862,27 @@ static void retransmit_timeout_func(void *arg)
 
 	tqe = list_get_instance(link, tcp_tqueue_entry_t, link);
 
-	rt_seg = tcp_segment_dup(tqe->seg);
-	if (rt_seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
-		tcp_conn_unlock(conn);
-		tcp_conn_delref(conn);
-		/* XXX Handle properly */
-		return;
-	}
+	/*
+	 * The peer may discard data it has SACKed, so forget about it
+	 * (RFC 2018 section 8).
+	 */
+	list_foreach(tqueue->list, link, tcp_tqueue_entry_t, e)
+		e->sacked = false;
+	tqueue->sack_high = conn->snd_una;
+
+	/* Collapse congestion window and go back to the first segment */
+	tcp_cc_timeout(conn, tqueue->backoff == 0);
+	tqueue->rtx_active = true;
+	tqueue->rtx_nxt = tqe->seg->seq + tqe->seg->len;
+
+	tcp_tqueue_retransmit(conn, tqe);
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment", conn->name);
-	tcp_conn_transmit_segment(tqe->conn, rt_seg);
+	/* Back off the timer */
+	++tqueue->backoff;
+	tqueue->rto = min(2 * tqueue->rto, RTO_MAX);
 
 	/* Reset retransmission timer */
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
+	fibril_timer_set_locked(conn->retransmit.timer, tqueue->rto,
 	    retransmit_timeout_func, (void *) conn);
 
 	tcp_conn_unlock(conn);
@@ -377,7 +901,7 @@ static void tcp_tqueue_timer_set(tcp_conn_t *conn)
 	tcp_tqueue_timer_clear(conn);
 
 	tcp_conn_addref(conn);
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
+	fibril_timer_set_locked(conn->retransmit.timer, conn->retransmit.rto,
 	    retransmit_timeout_func, (void *) conn);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_set() end", conn->name);
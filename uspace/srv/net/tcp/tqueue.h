@@ -46,6 +46,9 @@ extern void tcp_tqueue_fini(tcp_tqueue_t *);
 extern void tcp_tqueue_ctrl_seg(tcp_conn_t *, tcp_control_t);
 extern void tcp_tqueue_new_data(tcp_conn_t *);
 extern void tcp_tqueue_ack_received(tcp_conn_t *);
+extern void tcp_tqueue_dup_ack(tcp_conn_t *);
+extern void tcp_tqueue_sack_received(tcp_conn_t *, tcp_seg_opts_t *);
+extern void tcp_tqueue_ts_rtt(tcp_conn_t *, uint32_t);
 
 #endif
 
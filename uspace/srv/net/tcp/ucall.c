@@ -217,20 +217,21 @@ tcp_error_t tcp_uc_receive(tcp_conn_t *conn, void *buf, size_t size,
 
 	/* Copy data from receive buffer to user buffer */
 	xfer_size = min(size, conn->rcv_buf_used);
-	memcpy(buf, conn->rcv_buf, xfer_size);
+	memcpy(buf, conn->rcv_buf + conn->rcv_buf_start, xfer_size);
 	*rcvd = xfer_size;
 
 	/* Remove data from receive buffer */
-	memmove(conn->rcv_buf, conn->rcv_buf + xfer_size, conn->rcv_buf_used -
-	    xfer_size);
+	conn->rcv_buf_start += xfer_size;
 	conn->rcv_buf_used -= xfer_size;
-	conn->rcv_wnd += xfer_size;
+	if (conn->rcv_buf_used == 0)
+		conn->rcv_buf_start = 0;
 
 	/* TODO */
 	*xflags = 0;
 
-	/* Send new size of receive window */
-	tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+	/* Send new size of receive window if it opened enough */
+	if (tcp_conn_rcv_wnd_update(conn))
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_uc_receive() - returning %zu bytes",
 	    conn->name, xfer_size);
@@ -89,6 +89,8 @@ errno_t udp_transmit_pdu(udp_pdu_t *pdu)
 	dgram.tos = 0;
 	dgram.data = pdu->data;
 	dgram.size = pdu->data_size;
+	dgram.offload.csum_partial = false;
+	dgram.offload.gso_size = 0;
 
 	rc = inet_send(&dgram, INET_TTL_MAX, 0);
 	if (rc != EOK)
@@ -39,7 +39,9 @@
 
 #include <as.h>
 #include <async.h>
+#include <async_ring.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <str_error.h>
 #include <io/log.h>
 #include <ipc/ipc_test.h>
@@ -80,6 +82,9 @@ static void *rw_buf;
 /** Read/write buffer size */
 size_t rw_buf_size;
 
+/** Serializes ring requests with read/write buffer reallocation */
+static FIBRIL_MUTEX_INITIALIZE(rw_buf_lock);
+
 static void ipc_test_get_ro_area_size_srv(ipc_call_t *icall)
 {
 	errno_t rc;
@@ -217,8 +222,11 @@ static void ipc_test_set_rw_buf_size_srv(ipc_call_t *icall)
 		return;
 	}
 
+	fibril_mutex_lock(&rw_buf_lock);
+
 	nbuf = realloc(rw_buf, size);
 	if (nbuf == NULL) {
+		fibril_mutex_unlock(&rw_buf_lock);
 		async_answer_0(icall, ENOMEM);
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Out of memory.");
 		return;
@@ -226,6 +234,8 @@ static void ipc_test_set_rw_buf_size_srv(ipc_call_t *icall)
 
 	rw_buf = nbuf;
 	rw_buf_size = size;
+
+	fibril_mutex_unlock(&rw_buf_lock);
 	async_answer_0(icall, EOK);
 }
 
@@ -293,8 +303,62 @@ static void ipc_test_write_srv(ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+/** Handle a request submitted through a ring.
+ *
+ * Called from the ring service thread.
+ */
+static errno_t ipc_test_ring_handler(void *arg, sysarg_t *args, void *buf,
+    size_t *size, size_t bufsize)
+{
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&rw_buf_lock);
+
+	if (*size > rw_buf_size) {
+		rc = EINVAL;
+		goto out;
+	}
+
+	switch (args[0]) {
+	case IPC_TEST_READ:
+		memcpy(buf, rw_buf, *size);
+		break;
+	case IPC_TEST_WRITE:
+		memcpy(rw_buf, buf, *size);
+		break;
+	default:
+		rc = ENOTSUP;
+		break;
+	}
+
+out:
+	fibril_mutex_unlock(&rw_buf_lock);
+	return rc;
+}
+
+static void ipc_test_ring_setup_srv(ipc_call_t *icall, async_ring_t **ring)
+{
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ipc_test_ring_setup_srv");
+
+	if (*ring != NULL) {
+		async_answer_0(icall, EBUSY);
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Ring already set up.");
+		return;
+	}
+
+	rc = async_ring_accept(icall, ipc_test_ring_handler, NULL, ring);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed accepting ring (%s).",
+		    str_error(rc));
+	}
+}
+
 static void ipc_test_connection(ipc_call_t *icall, void *arg)
 {
+	async_ring_t *ring = NULL;
+
 	/* Accept connection */
 	async_accept_0(icall);
 
@@ -303,6 +367,9 @@ static void ipc_test_connection(ipc_call_t *icall, void *arg)
 		async_get_call(&call);
 
 		if (!ipc_get_imethod(&call)) {
+			if (ring != NULL)
+				async_ring_destroy(ring);
+
 			async_answer_0(&call, EOK);
 			break;
 		}
@@ -332,6 +399,9 @@ static void ipc_test_connection(ipc_call_t *icall, void *arg)
 		case IPC_TEST_WRITE:
 			ipc_test_write_srv(&call);
 			break;
+		case IPC_TEST_RING_SETUP:
+			ipc_test_ring_setup_srv(&call, &ring);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
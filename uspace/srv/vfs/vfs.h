@@ -191,6 +191,18 @@ extern unsigned vfs_nodes_refcount_sum_get(fs_handle_t, service_id_t);
 
 extern bool vfs_node_has_children(vfs_node_t *node);
 
+extern bool vfs_dcache_init(void);
+extern bool vfs_dcache_enabled(fs_handle_t);
+extern unsigned vfs_dcache_generation(void);
+extern errno_t vfs_dcache_lookup(const vfs_triplet_t *, const char *, size_t,
+    vfs_lookup_res_t *);
+extern void vfs_dcache_insert(unsigned, const vfs_triplet_t *, const char *,
+    size_t, vfs_lookup_res_t *);
+extern void vfs_dcache_remove(const vfs_triplet_t *, const char *, size_t);
+extern void vfs_dcache_remove_dir(const vfs_triplet_t *);
+extern void vfs_dcache_purge(fs_handle_t, service_id_t);
+extern void vfs_dcache_size_update(const vfs_triplet_t *, aoff64_t);
+
 extern void *vfs_client_data_create(void);
 extern void vfs_client_data_destroy(void *);
 
@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2026 Patrik Pritrsky
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup vfs
+ * @{
+ */
+
+/**
+ * @file	vfs_dcache.c
+ * @brief	Cache of name lookups.
+ *
+ * The cache maps (parent directory triplet, name component) pairs to lookup
+ * results so that repeated resolution of the same paths does not require a
+ * VFS_OUT_LOOKUP round-trip to the file system server. Names known not to
+ * exist are cached as negative entries.
+ *
+ * Only file systems which register with vfs_info_t.lookup_cacheable set take
+ * part, as the namespace of the others can change behind the back of VFS.
+ *
+ * Names are created and destroyed by VFS_OUT_LOOKUP with L_CREATE or L_UNLINK
+ * and by VFS_OUT_LINK, so it is sufficient to invalidate the affected entry
+ * after each such operation. Since L_CREATE lookups only hold the namespace
+ * rwlock for reading, every invalidation bumps a generation counter and
+ * results obtained from the file system before the counter changed are not
+ * inserted.
+ */
+
+#include "vfs.h"
+#include <stdlib.h>
+#include <str.h>
+#include <mem.h>
+#include <fibril_synch.h>
+#include <adt/hash_table.h>
+#include <adt/hash.h>
+#include <adt/list.h>
+#include <errno.h>
+
+/** Maximum number of cached names. */
+#define DCACHE_MAX_ENTRIES	4096
+
+/** Cached name. */
+typedef struct {
+	/** Link in dentries, keyed by parent and name. */
+	ht_link_t name_link;
+	/** Link in dentries_by_node, keyed by res.triplet. */
+	ht_link_t node_link;
+	/** Link in dcache_lru. */
+	link_t lru_link;
+
+	/** Directory containing the name. */
+	vfs_triplet_t parent;
+	/** The name does not exist in the parent. */
+	bool negative;
+	/** Lookup result for a positive entry. */
+	vfs_lookup_res_t res;
+
+	/** Length of name. */
+	size_t nlen;
+	/** Name component, not NUL-terminated. */
+	char name[];
+} dentry_t;
+
+typedef struct {
+	const vfs_triplet_t *parent;
+	const char *name;
+	size_t nlen;
+} dentry_key_t;
+
+/** Mutex protecting all of the cache state. */
+static FIBRIL_MUTEX_INITIALIZE(dcache_mutex);
+
+/** Cached names, most recently used last. */
+static LIST_INITIALIZE(dcache_lru);
+
+/** Invalidation generation. */
+static unsigned dcache_gen;
+
+static hash_table_t dentries;
+static hash_table_t dentries_by_node;
+
+static size_t triplet_hash(const vfs_triplet_t *tri)
+{
+	size_t hash = hash_combine(tri->fs_handle, tri->index);
+	return hash_combine(hash, tri->service_id);
+}
+
+static bool triplet_equal(const vfs_triplet_t *a, const vfs_triplet_t *b)
+{
+	return a->fs_handle == b->fs_handle &&
+	    a->service_id == b->service_id && a->index == b->index;
+}
+
+static size_t dentries_key_hash(const void *key)
+{
+	const dentry_key_t *dkey = key;
+	return hash_combine(triplet_hash(dkey->parent),
+	    hash_bytes(dkey->name, dkey->nlen));
+}
+
+static size_t dentries_hash(const ht_link_t *item)
+{
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, name_link);
+	dentry_key_t dkey = {
+		.parent = &dentry->parent,
+		.name = dentry->name,
+		.nlen = dentry->nlen
+	};
+
+	return dentries_key_hash(&dkey);
+}
+
+static bool dentries_key_equal(const void *key, size_t hash,
+    const ht_link_t *item)
+{
+	const dentry_key_t *dkey = key;
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, name_link);
+
+	return dentry->nlen == dkey->nlen &&
+	    triplet_equal(&dentry->parent, dkey->parent) &&
+	    memcmp(dentry->name, dkey->name, dkey->nlen) == 0;
+}
+
+static bool dentries_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	dentry_t *dentry = hash_table_get_inst(item1, dentry_t, name_link);
+	dentry_key_t dkey = {
+		.parent = &dentry->parent,
+		.name = dentry->name,
+		.nlen = dentry->nlen
+	};
+
+	return dentries_key_equal(&dkey, 0, item2);
+}
+
+static size_t dentries_by_node_key_hash(const void *key)
+{
+	return triplet_hash(key);
+}
+
+static size_t dentries_by_node_hash(const ht_link_t *item)
+{
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, node_link);
+	return triplet_hash(&dentry->res.triplet);
+}
+
+static bool dentries_by_node_key_equal(const void *key, size_t hash,
+    const ht_link_t *item)
+{
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, node_link);
+	return triplet_equal(&dentry->res.triplet, key);
+}
+
+static bool dentries_by_node_equal(const ht_link_t *item1,
+    const ht_link_t *item2)
+{
+	dentry_t *dentry = hash_table_get_inst(item1, dentry_t, node_link);
+	return dentries_by_node_key_equal(&dentry->res.triplet, 0, item2);
+}
+
+static const hash_table_ops_t dentries_ops = {
+	.hash = dentries_hash,
+	.key_hash = dentries_key_hash,
+	.key_equal = dentries_key_equal,
+	.equal = dentries_equal,
+	.remove_callback = NULL
+};
+
+static const hash_table_ops_t dentries_by_node_ops = {
+	.hash = dentries_by_node_hash,
+	.key_hash = dentries_by_node_key_hash,
+	.key_equal = dentries_by_node_key_equal,
+	.equal = dentries_by_node_equal,
+	.remove_callback = NULL
+};
+
+/** Initialize the name lookup cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_dcache_init(void)
+{
+	if (!hash_table_create(&dentries, 0, 0, &dentries_ops))
+		return false;
+
+	if (!hash_table_create(&dentries_by_node, 0, 0,
+	    &dentries_by_node_ops)) {
+		hash_table_destroy(&dentries);
+		return false;
+	}
+
+	return true;
+}
+
+/** Remove an entry from the cache and free it.
+ *
+ * Must be called with dcache_mutex held.
+ */
+static void dentry_destroy(dentry_t *dentry)
+{
+	hash_table_remove_item(&dentries, &dentry->name_link);
+	if (!dentry->negative)
+		hash_table_remove_item(&dentries_by_node, &dentry->node_link);
+	list_remove(&dentry->lru_link);
+	free(dentry);
+}
+
+/** Find an entry.
+ *
+ * Must be called with dcache_mutex held.
+ */
+static dentry_t *dentry_find(const vfs_triplet_t *parent, const char *name,
+    size_t nlen)
+{
+	dentry_key_t dkey = {
+		.parent = parent,
+		.name = name,
+		.nlen = nlen
+	};
+
+	ht_link_t *link = hash_table_find(&dentries, &dkey);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, dentry_t, name_link);
+}
+
+/** Check whether names of a file system may be cached.
+ *
+ * @param fs_handle	File system handle.
+ *
+ * @return		True if the file system allows caching of its names.
+ */
+bool vfs_dcache_enabled(fs_handle_t fs_handle)
+{
+	vfs_info_t *info = fs_handle_to_info(fs_handle);
+	return info != NULL && info->lookup_cacheable;
+}
+
+/** Get the current invalidation generation.
+ *
+ * The value must be sampled before asking the file system server for a result
+ * which is going to be passed to vfs_dcache_insert().
+ *
+ * @return		Current generation.
+ */
+unsigned vfs_dcache_generation(void)
+{
+	fibril_mutex_lock(&dcache_mutex);
+	unsigned gen = dcache_gen;
+	fibril_mutex_unlock(&dcache_mutex);
+
+	return gen;
+}
+
+/** Look up a name in the cache.
+ *
+ * @param parent	Directory to look the name up in.
+ * @param name		Name component, need not be NUL-terminated.
+ * @param nlen		Length of @a name.
+ * @param res		Place to store the cached result of a positive entry.
+ *
+ * @return		EOK if a positive entry was found, ENOENT if the name
+ *			is known not to exist, EAGAIN if the name is not
+ *			cached.
+ */
+errno_t vfs_dcache_lookup(const vfs_triplet_t *parent, const char *name,
+    size_t nlen, vfs_lookup_res_t *res)
+{
+	errno_t rc;
+
+	fibril_mutex_lock(&dcache_mutex);
+
+	dentry_t *dentry = dentry_find(parent, name, nlen);
+	if (dentry == NULL) {
+		rc = EAGAIN;
+	} else {
+		list_remove(&dentry->lru_link);
+		list_append(&dentry->lru_link, &dcache_lru);
+
+		if (dentry->negative) {
+			rc = ENOENT;
+		} else {
+			*res = dentry->res;
+			rc = EOK;
+		}
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+	return rc;
+}
+
+/** Insert a lookup result into the cache.
+ *
+ * Nothing is inserted if the cache was invalidated since @a gen was sampled.
+ * The caller must check that the file system of @a parent allows caching of
+ * its names using vfs_dcache_enabled().
+ *
+ * @param gen		Generation returned by vfs_dcache_generation() before
+ *			the result was obtained.
+ * @param parent	Directory containing the name.
+ * @param name		Name component, need not be NUL-terminated.
+ * @param nlen		Length of @a name.
+ * @param res		Lookup result or NULL if the name does not exist.
+ */
+void vfs_dcache_insert(unsigned gen, const vfs_triplet_t *parent,
+    const char *name, size_t nlen, vfs_lookup_res_t *res)
+{
+	dentry_t *dentry = malloc(sizeof(dentry_t) + nlen);
+	if (dentry == NULL)
+		return;
+
+	dentry->parent = *parent;
+	dentry->negative = (res == NULL);
+	if (res != NULL)
+		dentry->res = *res;
+	dentry->nlen = nlen;
+	memcpy(dentry->name, name, nlen);
+
+	fibril_mutex_lock(&dcache_mutex);
+
+	if (gen != dcache_gen || dentry_find(parent, name, nlen) != NULL) {
+		fibril_mutex_unlock(&dcache_mutex);
+		free(dentry);
+		return;
+	}
+
+	if (hash_table_size(&dentries) >= DCACHE_MAX_ENTRIES) {
+		dentry_t *oldest = list_get_instance(list_first(&dcache_lru),
+		    dentry_t, lru_link);
+		dentry_destroy(oldest);
+	}
+
+	hash_table_insert(&dentries, &dentry->name_link);
+	if (!dentry->negative)
+		hash_table_insert(&dentries_by_node, &dentry->node_link);
+	list_append(&dentry->lru_link, &dcache_lru);
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Invalidate a name.
+ *
+ * Must be called after every operation which may have created or destroyed
+ * the name.
+ *
+ * @param parent	Directory containing the name.
+ * @param name		Name component, need not be NUL-terminated.
+ * @param nlen		Length of @a name.
+ */
+void vfs_dcache_remove(const vfs_triplet_t *parent, const char *name,
+    size_t nlen)
+{
+	fibril_mutex_lock(&dcache_mutex);
+
+	dcache_gen++;
+
+	dentry_t *dentry = dentry_find(parent, name, nlen);
+	if (dentry != NULL)
+		dentry_destroy(dentry);
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Invalidate all names contained in a directory.
+ *
+ * Must be called when a directory is destroyed, because its index may be
+ * reused by the file system.
+ *
+ * @param dir		Directory being destroyed.
+ */
+void vfs_dcache_remove_dir(const vfs_triplet_t *dir)
+{
+	fibril_mutex_lock(&dcache_mutex);
+
+	dcache_gen++;
+
+	list_foreach_safe(dcache_lru, cur, next) {
+		dentry_t *dentry = list_get_instance(cur, dentry_t, lru_link);
+		if (triplet_equal(&dentry->parent, dir))
+			dentry_destroy(dentry);
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Invalidate all names of a file system instance.
+ *
+ * @param fs_handle	File system handle.
+ * @param service_id	Service ID of the file system instance.
+ */
+void vfs_dcache_purge(fs_handle_t fs_handle, service_id_t service_id)
+{
+	fibril_mutex_lock(&dcache_mutex);
+
+	dcache_gen++;
+
+	list_foreach_safe(dcache_lru, cur, next) {
+		dentry_t *dentry = list_get_instance(cur, dentry_t, lru_link);
+		if (dentry->parent.fs_handle == fs_handle &&
+		    dentry->parent.service_id == service_id)
+			dentry_destroy(dentry);
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Update the size cached for a node.
+ *
+ * The size of a file may only change while it has a VFS node, so it suffices
+ * to update the cache when the node goes away.
+ *
+ * @param node		Node triplet.
+ * @param size		Current size of the node.
+ */
+void vfs_dcache_size_update(const vfs_triplet_t *node, aoff64_t size)
+{
+	fibril_mutex_lock(&dcache_mutex);
+
+	ht_link_t *link = hash_table_find(&dentries_by_node, node);
+	while (link != NULL) {
+		dentry_t *dentry = hash_table_get_inst(link, dentry_t,
+		    node_link);
+		dentry->res.size = size;
+		link = hash_table_find_next(&dentries_by_node, link);
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/**
+ * @}
+ */
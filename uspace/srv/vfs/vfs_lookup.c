@@ -202,6 +202,8 @@ errno_t vfs_link_internal(vfs_node_t *base, char *path, vfs_triplet_t *child)
 	if (orig_rc != EOK)
 		rc = orig_rc;
 
+	vfs_dcache_remove(triplet, component, str_size(component));
+
 out:
 	return rc;
 }
@@ -237,12 +239,148 @@ static errno_t out_lookup(vfs_triplet_t *base, size_t *pfirst, size_t *plen,
 	return EOK;
 }
 
+/** Replace @a res with the root of the file system mounted on it, if any. */
+static void cross_mounts(vfs_lookup_res_t *res)
+{
+	vfs_node_t *node = vfs_node_peek(res);
+	if (!node)
+		return;
+
+	while (node->mount) {
+		vfs_node_addref(node->mount);
+		vfs_node_t *nnode = node->mount;
+		vfs_node_put(node);
+		node = nnode;
+	}
+
+	res->triplet = *((vfs_triplet_t *) node);
+	res->type = node->type;
+	res->size = node->size;
+	vfs_node_put(node);
+}
+
+/** Perform a path lookup using the name lookup cache.
+ *
+ * The path is resolved one component at a time. Components missing in the
+ * cache are looked up individually in the file system server, so that the
+ * results can be cached for subsequent lookups.
+ *
+ * @return EOK on success, ENOENT if a path component does not exist or
+ *         EAGAIN if the lookup must be done by _vfs_lookup_internal().
+ */
+static errno_t vfs_lookup_cached(vfs_node_t *base, char *path, int lflag,
+    vfs_lookup_res_t *result, size_t len)
+{
+	plb_entry_t entry;
+	bool in_plb = false;
+	size_t first = 0;
+	errno_t rc = EOK;
+
+	if ((lflag & L_DISABLE_MOUNTS) || len <= 1)
+		return EAGAIN;
+
+	vfs_lookup_res_t cur = {
+		.triplet = *((vfs_triplet_t *) base),
+		.type = base->type,
+		.size = base->size
+	};
+
+	size_t pos = 0;
+	while (pos < len) {
+		assert(path[pos] == '/');
+
+		size_t end = pos + 1;
+		while (end < len && path[end] != '/')
+			end++;
+
+		const char *name = &path[pos + 1];
+		size_t nlen = end - pos - 1;
+
+		cross_mounts(&cur);
+		if (cur.type != VFS_NODE_DIRECTORY ||
+		    !vfs_dcache_enabled(cur.triplet.fs_handle)) {
+			rc = EAGAIN;
+			goto out;
+		}
+
+		vfs_lookup_res_t res;
+		rc = vfs_dcache_lookup(&cur.triplet, name, nlen, &res);
+		if (rc == ENOENT)
+			goto out;
+
+		if (rc == EAGAIN) {
+			unsigned gen = vfs_dcache_generation();
+
+			if (!in_plb) {
+				rc = plb_insert_entry(&entry, path, &first,
+				    len);
+				if (rc != EOK)
+					return rc;
+				in_plb = true;
+			}
+
+			size_t next = (first + pos) % PLB_SIZE;
+			size_t clen = end - pos;
+			rc = out_lookup(&cur.triplet, &next, &clen, L_NONE,
+			    &res);
+			if (rc != EOK) {
+				rc = EAGAIN;
+				goto out;
+			}
+
+			if (clen > 0) {
+				vfs_dcache_insert(gen, &cur.triplet, name,
+				    nlen, NULL);
+				rc = ENOENT;
+				goto out;
+			}
+
+			vfs_dcache_insert(gen, &cur.triplet, name, nlen, &res);
+		}
+
+		cur = res;
+		pos = end;
+	}
+
+	if (!(lflag & L_MP))
+		cross_mounts(&cur);
+	else {
+		/* Prefer the size of an active node over the cached one. */
+		vfs_node_t *node = vfs_node_peek(&cur);
+		if (node) {
+			cur.size = node->size;
+			vfs_node_put(node);
+		}
+	}
+
+	if (((lflag & L_FILE) && cur.type == VFS_NODE_DIRECTORY) ||
+	    ((lflag & L_DIRECTORY) && cur.type == VFS_NODE_FILE)) {
+		rc = EAGAIN;
+		goto out;
+	}
+
+	if (result != NULL)
+		*result = cur;
+	rc = EOK;
+
+out:
+	if (in_plb)
+		plb_clear_entry(&entry, first, len);
+	return rc;
+}
+
 static errno_t _vfs_lookup_internal(vfs_node_t *base, char *path, int lflag,
     vfs_lookup_res_t *result, size_t len)
 {
 	size_t first;
 	errno_t rc;
 
+	if (!(lflag & (L_CREATE | L_UNLINK))) {
+		rc = vfs_lookup_cached(base, path, lflag, result, len);
+		if (rc != EAGAIN)
+			return rc;
+	}
+
 	plb_entry_t entry;
 	rc = plb_insert_entry(&entry, path, &first, len);
 	if (rc != EOK)
@@ -382,11 +520,28 @@ errno_t vfs_lookup_internal(vfs_node_t *base, char *path, int lflag,
 		} else
 			vfs_node_addref(parent);
 
-		rc = _vfs_lookup_internal(parent, slash, lflag, result,
+		vfs_lookup_res_t res;
+		rc = _vfs_lookup_internal(parent, slash, lflag, &res,
 		    len - (slash - path));
 
+		/*
+		 * The name may have been created or destroyed even if the
+		 * lookup failed, so invalidate it unconditionally.
+		 */
+		vfs_node_t *dir = parent;
+		while (dir->mount)
+			dir = dir->mount;
+		vfs_dcache_remove((vfs_triplet_t *) dir, slash + 1,
+		    len - (slash - path) - 1);
+		if (rc == EOK && (lflag & L_UNLINK) &&
+		    res.type == VFS_NODE_DIRECTORY)
+			vfs_dcache_remove_dir(&res.triplet);
+
 		vfs_node_put(parent);
 
+		if (rc == EOK && result != NULL)
+			*result = res;
+
 	} else {
 		rc = _vfs_lookup_internal(base, path, lflag, result, len);
 	}
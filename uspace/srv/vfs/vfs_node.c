@@ -124,6 +124,9 @@ void vfs_node_delref(vfs_node_t *node)
 	fibril_mutex_unlock(&nodes_mutex);
 
 	if (free_node) {
+		vfs_triplet_t tri = node_triplet(node);
+		vfs_dcache_size_update(&tri, node->size);
+
 		/*
 		 * VFS_OUT_DESTROY will free up the file's resources if there
 		 * are no more hard links.
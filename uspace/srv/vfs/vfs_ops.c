@@ -267,6 +267,8 @@ errno_t vfs_op_mount(int mpfd, unsigned service_id, unsigned flags,
 
 	rc = vfs_connect_internal(service_id, flags, instance, opts, fs_name,
 	    &root);
+	if (rc == EOK)
+		vfs_dcache_purge(root->fs_handle, root->service_id);
 	if (rc == EOK && !(flags & VFS_MOUNT_CONNECT_ONLY)) {
 		vfs_node_addref(mp->node);
 		vfs_node_addref(root);
@@ -822,6 +824,8 @@ errno_t vfs_op_unmount(int mpfd)
 		return rc;
 	}
 
+	vfs_dcache_purge(mp->node->mount->fs_handle,
+	    mp->node->mount->service_id);
 	vfs_node_forget(mp->node->mount);
 	vfs_node_put(mp->node);
 	mp->node->mount = NULL;